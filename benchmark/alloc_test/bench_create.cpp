@@ -0,0 +1,108 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <chrono>
+#include <cstring>
+#include <deque>
+#include <memory>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "glog/logging.h"
+
+#include "client/client.h"
+#include "common/util/status.h"
+
+#include "alloc_test.h"
+
+using namespace vineyard;  // NOLINT(build/namespaces)
+
+// Exposes the buffer requests of the client, which are protected.
+class BenchClient : public Client {
+ public:
+  using Client::CreateBuffer;
+  using Client::DropBuffer;
+};
+
+// Each thread creates blobs of random sizes from its own connection and keeps
+// at most `window` of them alive, so the server-side allocator sees both the
+// allocations and the frees from many worker threads at the same time.
+void create_loop(std::string const& ipc_socket, size_t seed, size_t rounds,
+                 size_t window, size_t max_size_exp) {
+  BenchClient client;
+  VINEYARD_CHECK_OK(client.Connect(ipc_socket));
+
+  PRNG rng(seed);
+  std::deque<std::pair<ObjectID, int>> alive;
+  for (size_t i = 0; i < rounds; ++i) {
+    size_t size = calcSizeWithStatsAdjustment(rng.rng64(), max_size_exp);
+    ObjectID id = InvalidObjectID();
+    Payload payload;
+    std::shared_ptr<arrow::MutableBuffer> buffer;
+    VINEYARD_CHECK_OK(client.CreateBuffer(size, id, payload, buffer));
+    alive.emplace_back(id, payload.store_fd);
+    if (alive.size() > window) {
+      VINEYARD_CHECK_OK(
+          client.DropBuffer(alive.front().first, alive.front().second));
+      alive.pop_front();
+    }
+  }
+  for (auto const& item : alive) {
+    VINEYARD_CHECK_OK(client.DropBuffer(item.first, item.second));
+  }
+  client.Disconnect();
+}
+
+void bench(std::string const& ipc_socket, size_t threads, size_t rounds,
+           size_t window, size_t max_size_exp) {
+  auto start = std::chrono::steady_clock::now();
+  std::vector<std::thread> workers;
+  for (size_t i = 0; i < threads; ++i) {
+    workers.emplace_back(create_loop, ipc_socket, i + 1, rounds, window,
+                         max_size_exp);
+  }
+  for (auto& worker : workers) {
+    worker.join();
+  }
+  auto end = std::chrono::steady_clock::now();
+  double seconds = std::chrono::duration<double>(end - start).count();
+  LOG(INFO) << "threads = " << threads << ", creates: " << threads * rounds
+            << ", usage: " << seconds * 1000 << " milliseconds, throughput: "
+            << (threads * rounds) / seconds << " creates/s";
+}
+
+int main(int argc, char** argv) {
+  if (argc < 2) {
+    printf("usage ./bench_create <ipc_socket> [max_threads] [rounds]\n");
+    return 1;
+  }
+  std::string ipc_socket = std::string(argv[1]);
+  size_t max_threads = argc > 2 ? std::stoul(argv[2])
+                                : std::thread::hardware_concurrency();
+  size_t rounds = argc > 3 ? std::stoul(argv[3]) : 10000;
+
+  // blobs from 64 bytes up to 1MB, at most 64 blobs per thread are alive.
+  constexpr size_t window = 64;
+  constexpr size_t max_size_exp = 20;
+
+  for (size_t threads = 1; threads <= max_threads; threads *= 2) {
+    bench(ipc_socket, threads, rounds, window, max_size_exp);
+  }
+
+  LOG(INFO) << "Finish server-side create benchmarks...";
+  return 0;
+}
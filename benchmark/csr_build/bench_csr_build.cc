@@ -0,0 +1,141 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <chrono>
+#include <cmath>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "glog/logging.h"
+
+#include "graph/fragment/property_graph_types.h"
+#include "graph/fragment/property_graph_utils.h"
+
+using namespace vineyard;  // NOLINT(build/namespaces)
+
+using vid_t = property_graph_types::VID_TYPE;
+using eid_t = property_graph_types::EID_TYPE;
+using vid_array_t = typename ConvertToArrowType<vid_t>::ArrayType;
+using nbr_unit_t = property_graph_utils::NbrUnit<vid_t, eid_t>;
+
+// The endpoints follow a power-law distribution: the vertex of rank `r` is
+// picked with a probability that is proportional to `r ^ (-skew)`, by
+// inverting the continuous approximation of the CDF.
+std::shared_ptr<vid_array_t> generate_endpoints(IdParser<vid_t> const& parser,
+                                                int64_t vnum, int64_t enum_,
+                                                double skew, size_t seed) {
+  std::mt19937_64 rng(seed);
+  std::uniform_real_distribution<double> uniform(0.0, 1.0);
+  typename ConvertToArrowType<vid_t>::BuilderType builder;
+  CHECK(builder.Reserve(enum_).ok());
+  double n = static_cast<double>(vnum);
+  for (int64_t i = 0; i < enum_; ++i) {
+    double u = uniform(rng);
+    double rank = std::abs(skew - 1.0) < 1e-6
+                      ? std::pow(n, u)
+                      : std::pow(1 + u * (std::pow(n, 1 - skew) - 1),
+                                 1 / (1 - skew));
+    int64_t offset = std::min(std::max(static_cast<int64_t>(rank) - 1,
+                                       static_cast<int64_t>(0)),
+                              vnum - 1);
+    // scatters the hubs over the id space, as the loaders do.
+    offset = static_cast<int64_t>((offset * 2654435761ULL) % vnum);
+    builder.UnsafeAppend(parser.GenerateId(0, 0, offset));
+  }
+  std::shared_ptr<vid_array_t> array;
+  CHECK(builder.Finish(&array).ok());
+  return array;
+}
+
+template <typename F>
+double measure_ms(F&& f) {
+  auto start = std::chrono::steady_clock::now();
+  f();
+  auto end = std::chrono::steady_clock::now();
+  return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+void check_same(std::shared_ptr<arrow::FixedSizeBinaryArray> const& lhs,
+                std::shared_ptr<arrow::Int64Array> const& lhs_offsets,
+                std::shared_ptr<arrow::FixedSizeBinaryArray> const& rhs,
+                std::shared_ptr<arrow::Int64Array> const& rhs_offsets) {
+  CHECK(lhs_offsets->Equals(*rhs_offsets));
+  auto lhs_nbrs = reinterpret_cast<const nbr_unit_t*>(lhs->GetValue(0));
+  auto rhs_nbrs = reinterpret_cast<const nbr_unit_t*>(rhs->GetValue(0));
+  for (int64_t i = 0; i < lhs->length(); ++i) {
+    CHECK_EQ(lhs_nbrs[i].vid, rhs_nbrs[i].vid);
+  }
+}
+
+void bench(int64_t vnum, int64_t enum_, double skew, int concurrency) {
+  IdParser<vid_t> parser;
+  parser.Init(1, 1);
+  auto src = generate_endpoints(parser, vnum, enum_, skew, 1);
+  auto dst = generate_endpoints(parser, vnum, enum_, skew, 2);
+  std::vector<vid_t> tvnums{static_cast<vid_t>(vnum)};
+
+  for (bool undirected : {false, true}) {
+    std::vector<std::shared_ptr<arrow::FixedSizeBinaryArray>> atomic_edges(1),
+        partition_edges(1);
+    std::vector<std::shared_ptr<arrow::Int64Array>> atomic_offsets(1),
+        partition_offsets(1);
+    double atomic_ms = measure_ms([&]() {
+      if (undirected) {
+        CHECK(generate_undirected_csr<vid_t, eid_t>(parser, src, dst, tvnums, 1,
+                                                    concurrency, atomic_edges,
+                                                    atomic_offsets));
+      } else {
+        CHECK(generate_directed_csr<vid_t, eid_t>(parser, src, dst, tvnums, 1,
+                                                  concurrency, atomic_edges,
+                                                  atomic_offsets));
+      }
+    });
+    double partition_ms = measure_ms([&]() {
+      CHECK(generate_csr_by_partition<vid_t, eid_t>(
+          parser, src, dst, tvnums, 1, concurrency, undirected,
+          partition_edges, partition_offsets));
+    });
+    check_same(atomic_edges[0], atomic_offsets[0], partition_edges[0],
+               partition_offsets[0]);
+
+    LOG(INFO) << (undirected ? "undirected" : "directed")
+              << ", skew = " << skew << ", threads = " << concurrency
+              << ": atomic scatter " << atomic_ms << " ms, partitioned "
+              << partition_ms << " ms, speedup "
+              << atomic_ms / partition_ms;
+  }
+}
+
+int main(int argc, char** argv) {
+  if (argc < 3) {
+    printf("usage ./bench_csr_build <vnum> <enum> [skew] [max_threads]\n");
+    return 1;
+  }
+  int64_t vnum = std::stoll(argv[1]);
+  int64_t enum_ = std::stoll(argv[2]);
+  double skew = argc > 3 ? std::stod(argv[3]) : 1.0;
+  int max_threads = argc > 4 ? std::stoi(argv[4])
+                             : std::thread::hardware_concurrency();
+
+  for (int concurrency = 1; concurrency <= max_threads; concurrency *= 2) {
+    bench(vnum, enum_, skew, concurrency);
+  }
+
+  LOG(INFO) << "Finish CSR construction benchmarks...";
+  return 0;
+}
@@ -0,0 +1,107 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <stdlib.h>
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "basic/ds/scalar.h"
+#include "client/client.h"
+#include "common/util/logging.h"
+
+using namespace vineyard;  // NOLINT(build/namespaces)
+
+// Each client issues `rounds` GetData requests, returns the throughput of all
+// clients in requests per second.
+double bench_get_data(std::string const& ipc_socket,
+                      std::vector<ObjectID> const& ids, size_t clients,
+                      size_t rounds) {
+  std::vector<std::unique_ptr<Client>> connections;
+  for (size_t i = 0; i < clients; ++i) {
+    connections.emplace_back(new Client());
+    VINEYARD_CHECK_OK(connections.back()->Connect(ipc_socket));
+  }
+
+  std::atomic<size_t> ready(0);
+  std::atomic<bool> start(false);
+  std::vector<std::thread> threads;
+  for (size_t i = 0; i < clients; ++i) {
+    threads.emplace_back([&, i]() {
+      Client& client = *connections[i];
+      ready.fetch_add(1);
+      while (!start.load()) {
+        std::this_thread::yield();
+      }
+      for (size_t r = 0; r < rounds; ++r) {
+        json tree;
+        VINEYARD_CHECK_OK(client.GetData(ids[(i + r) % ids.size()], tree));
+      }
+    });
+  }
+  while (ready.load() != clients) {
+    std::this_thread::yield();
+  }
+  auto begin = std::chrono::steady_clock::now();
+  start.store(true);
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  auto end = std::chrono::steady_clock::now();
+
+  for (auto& client : connections) {
+    client->Disconnect();
+  }
+  double seconds = std::chrono::duration<double>(end - begin).count();
+  return clients * rounds / seconds;
+}
+
+int main(int argc, char** argv) {
+  if (argc < 2) {
+    printf(
+        "usage ./bench_get_data <ipc_socket> [max_clients] [rounds] "
+        "[objects]\n");
+    return 1;
+  }
+  std::string ipc_socket = std::string(argv[1]);
+  size_t max_clients = argc > 2 ? std::stoul(argv[2]) : 64;
+  size_t rounds = argc > 3 ? std::stoul(argv[3]) : 1000;
+  size_t objects = argc > 4 ? std::stoul(argv[4]) : 1024;
+
+  Client client;
+  VINEYARD_CHECK_OK(client.Connect(ipc_socket));
+  std::vector<ObjectID> ids;
+  for (size_t i = 0; i < objects; ++i) {
+    ScalarBuilder<int64_t> builder(client);
+    builder.SetValue(static_cast<int64_t>(i));
+    ids.emplace_back(builder.Seal(client)->id());
+  }
+
+  for (size_t clients = 1; clients <= max_clients; clients *= 2) {
+    double throughput = bench_get_data(ipc_socket, ids, clients, rounds);
+    LOG(INFO) << "get_data with " << clients << " clients: " << throughput
+              << " requests/s";
+  }
+
+  VINEYARD_CHECK_OK(client.DelData(ids));
+  client.Disconnect();
+
+  LOG(INFO) << "Passed get data benchmark.";
+  return 0;
+}
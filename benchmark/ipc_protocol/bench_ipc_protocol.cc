@@ -0,0 +1,167 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <stdlib.h>
+
+#include <chrono>
+#include <map>
+#include <memory>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "client/client.h"
+#include "common/util/logging.h"
+#include "common/util/protocols.h"
+
+using namespace vineyard;  // NOLINT(build/namespaces)
+
+// Exposes the buffer requests of the client, which are protected.
+class BenchClient : public Client {
+ public:
+  using Client::CreateBuffer;
+  using Client::DropBuffer;
+  using Client::GetBuffers;
+};
+
+template <typename F>
+double measure_us(size_t rounds, F&& f) {
+  auto start = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < rounds; ++i) {
+    f();
+  }
+  auto end = std::chrono::steady_clock::now();
+  return std::chrono::duration<double, std::micro>(end - start).count() /
+         rounds;
+}
+
+// Encode a request and decode the reply, without the socket in between.
+void bench_codec(size_t rounds, size_t batch) {
+  auto payload = std::make_shared<Payload>(GenerateBlobID(nullptr), 4096,
+                                           nullptr, 3, 1 << 30, 1024);
+  std::set<ObjectID> ids;
+  std::vector<std::shared_ptr<Payload>> payloads;
+  for (size_t i = 0; i < batch; ++i) {
+    ids.emplace(GenerateBlobID(reinterpret_cast<void*>(i + 1)));
+    payloads.emplace_back(payload);
+  }
+
+  double json_create = measure_us(rounds, [&]() {
+    std::string request, reply;
+    size_t size = 0;
+    ObjectID id = InvalidObjectID();
+    Payload object;
+    WriteCreateBufferRequest(4096, request);
+    VINEYARD_CHECK_OK(ReadCreateBufferRequest(json::parse(request), size));
+    WriteCreateBufferReply(payload->object_id, payload, reply);
+    VINEYARD_CHECK_OK(ReadCreateBufferReply(reply, id, object));
+  });
+  double binary_create = measure_us(rounds, [&]() {
+    std::string request, reply;
+    size_t size = 0;
+    ObjectID id = InvalidObjectID();
+    Payload object;
+    WriteCreateBufferRequestBinary(4096, request);
+    VINEYARD_CHECK_OK(ReadCreateBufferRequestBinary(request, size));
+    WriteCreateBufferReplyBinary(payload->object_id, payload, reply);
+    VINEYARD_CHECK_OK(ReadCreateBufferReply(reply, id, object));
+  });
+  double json_get = measure_us(rounds, [&]() {
+    std::string request, reply;
+    std::vector<ObjectID> request_ids;
+    std::vector<Payload> objects;
+    WriteGetBuffersRequest(ids, request);
+    VINEYARD_CHECK_OK(ReadGetBuffersRequest(json::parse(request), request_ids));
+    WriteGetBuffersReply(payloads, reply);
+    VINEYARD_CHECK_OK(ReadGetBuffersReply(reply, objects));
+  });
+  double binary_get = measure_us(rounds, [&]() {
+    std::string request, reply;
+    std::vector<ObjectID> request_ids;
+    std::vector<Payload> objects;
+    WriteGetBuffersRequestBinary(ids, request);
+    VINEYARD_CHECK_OK(ReadGetBuffersRequestBinary(request, request_ids));
+    WriteGetBuffersReplyBinary(payloads, reply);
+    VINEYARD_CHECK_OK(ReadGetBuffersReply(reply, objects));
+  });
+
+  LOG(INFO) << "codec, create_buffer: json " << json_create << " us, binary "
+            << binary_create << " us";
+  LOG(INFO) << "codec, get_buffers(" << batch << "): json " << json_get
+            << " us, binary " << binary_get << " us";
+}
+
+// Issue requests to a running vineyardd, includes the socket round trip.
+void bench_round_trip(std::string const& ipc_socket, bool binary,
+                      size_t rounds, size_t batch) {
+  setenv("VINEYARD_IPC_PROTOCOL", binary ? "binary" : "json", 1);
+  BenchClient client;
+  VINEYARD_CHECK_OK(client.Connect(ipc_socket));
+  CHECK_EQ(client.BinaryProtocol(), binary);
+
+  std::set<ObjectID> ids;
+  std::vector<std::pair<ObjectID, int>> created;
+  for (size_t i = 0; i < batch; ++i) {
+    ObjectID id = InvalidObjectID();
+    Payload payload;
+    std::shared_ptr<arrow::MutableBuffer> buffer;
+    VINEYARD_CHECK_OK(client.CreateBuffer(64, id, payload, buffer));
+    ids.emplace(id);
+    created.emplace_back(id, payload.store_fd);
+  }
+
+  std::vector<std::pair<ObjectID, int>> temporaries;
+  temporaries.reserve(rounds);
+  double create = measure_us(rounds, [&]() {
+    ObjectID id = InvalidObjectID();
+    Payload payload;
+    std::shared_ptr<arrow::MutableBuffer> buffer;
+    VINEYARD_CHECK_OK(client.CreateBuffer(64, id, payload, buffer));
+    temporaries.emplace_back(id, payload.store_fd);
+  });
+  double get = measure_us(rounds, [&]() {
+    std::map<ObjectID, std::shared_ptr<arrow::Buffer>> buffers;
+    VINEYARD_CHECK_OK(client.GetBuffers(ids, buffers));
+  });
+
+  for (auto const& item : temporaries) {
+    VINEYARD_CHECK_OK(client.DropBuffer(item.first, item.second));
+  }
+  for (auto const& item : created) {
+    VINEYARD_CHECK_OK(client.DropBuffer(item.first, item.second));
+  }
+  client.Disconnect();
+
+  LOG(INFO) << "round trip (" << (binary ? "binary" : "json")
+            << "), create_buffer: " << create << " us, get_buffers(" << batch
+            << "): " << get << " us";
+}
+
+int main(int argc, char** argv) {
+  if (argc < 2) {
+    printf("usage ./bench_ipc_protocol <ipc_socket> [rounds] [batch]\n");
+    return 1;
+  }
+  std::string ipc_socket = std::string(argv[1]);
+  size_t rounds = argc > 2 ? std::stoul(argv[2]) : 10000;
+  size_t batch = argc > 3 ? std::stoul(argv[3]) : 64;
+
+  bench_codec(rounds, batch);
+  bench_round_trip(ipc_socket, false, rounds, batch);
+  bench_round_trip(ipc_socket, true, rounds, batch);
+
+  LOG(INFO) << "Passed ipc protocol benchmark.";
+  return 0;
+}
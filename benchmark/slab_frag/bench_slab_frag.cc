@@ -0,0 +1,113 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <fstream>
+#include <memory>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "client/client.h"
+#include "common/util/logging.h"
+#include "common/util/protocols.h"
+
+using namespace vineyard;  // NOLINT(build/namespaces)
+
+// Exposes the buffer requests of the client, and the raw status reply, which
+// contains the statistics of slabs in each size class.
+class BenchClient : public Client {
+ public:
+  using Client::CreateBuffer;
+  using Client::DropBuffer;
+
+  Status RawInstanceStatus(json& status) {
+    std::string message_out;
+    WriteInstanceStatusRequest(message_out);
+    RETURN_ON_ERROR(doWrite(message_out));
+    json message_in;
+    RETURN_ON_ERROR(doRead(message_in));
+    return ReadInstanceStatusReply(message_in, status);
+  }
+};
+
+// The tiny blobs of fragment builders are mostly offset arrays and
+// ivnums/ovnums arrays of a few labels or partitions, i.e., a handful of
+// int64_t values.
+size_t next_size(std::mt19937_64& rng) {
+  std::uniform_int_distribution<size_t> tiny(1, 16);
+  std::uniform_int_distribution<size_t> small(1, 512);
+  if (rng() % 4 != 0) {
+    return tiny(rng) * sizeof(int64_t);
+  }
+  return small(rng) * sizeof(int64_t);
+}
+
+int main(int argc, char** argv) {
+  if (argc < 2) {
+    printf("usage ./bench_slab_frag <ipc_socket> [blobs] [output]\n");
+    return 1;
+  }
+  std::string ipc_socket = std::string(argv[1]);
+  size_t blobs = argc > 2 ? std::stoul(argv[2]) : 100000;
+  std::string output = argc > 3 ? std::string(argv[3]) : "stats.json";
+
+  BenchClient client;
+  VINEYARD_CHECK_OK(client.Connect(ipc_socket));
+
+  json before;
+  VINEYARD_CHECK_OK(client.RawInstanceStatus(before));
+
+  std::mt19937_64 rng(blobs);
+  std::vector<std::pair<ObjectID, int>> created;
+  size_t requested = 0;
+  for (size_t i = 0; i < blobs; ++i) {
+    size_t size = next_size(rng);
+    ObjectID id = InvalidObjectID();
+    Payload payload;
+    std::shared_ptr<arrow::MutableBuffer> buffer;
+    VINEYARD_CHECK_OK(client.CreateBuffer(size, id, payload, buffer));
+    created.emplace_back(id, payload.store_fd);
+    requested += size;
+  }
+  json created_status;
+  VINEYARD_CHECK_OK(client.RawInstanceStatus(created_status));
+  size_t usage = created_status["memory_usage"].get<size_t>() -
+                 before["memory_usage"].get<size_t>();
+  LOG(INFO) << "created " << blobs << " tiny blobs (" << requested
+            << " bytes), memory usage increased by " << usage
+            << " bytes, fragmentation "
+            << created_status.value("slab_fragmentation", 0.0);
+
+  // drop every other blob to leave holes in the slabs.
+  for (size_t i = 0; i < created.size(); i += 2) {
+    VINEYARD_CHECK_OK(client.DropBuffer(created[i].first, created[i].second));
+  }
+
+  json after;
+  VINEYARD_CHECK_OK(client.RawInstanceStatus(after));
+  std::ofstream(output) << after.dump(4);
+  LOG(INFO) << "after dropping half of them: slab usage "
+            << after.value("slab_usage", static_cast<size_t>(0))
+            << " bytes, fragmentation "
+            << after.value("slab_fragmentation", 0.0)
+            << ", statistics written to " << output;
+
+  for (size_t i = 1; i < created.size(); i += 2) {
+    VINEYARD_CHECK_OK(client.DropBuffer(created[i].first, created[i].second));
+  }
+  client.Disconnect();
+  return 0;
+}
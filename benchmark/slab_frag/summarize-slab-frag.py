@@ -0,0 +1,45 @@
+#!/usr/bin/env python3
+
+# Summarize the internal fragmentation of the slabs of tiny blobs in vineyardd,
+# in the same layout as ../jemalloc_experiments/summarize-internal-frag.py.
+#
+# The input is the status of a vineyardd instance, e.g., the file written by
+# bench_slab_frag.
+
+import json
+import sys
+
+def main(contents):
+    slabs = contents['slabs']
+
+    print( "%4s"  "%10s"  "%8s"  "%14s"
+           "%16s"            "%12s"        "%12s"       "%18s" %
+          ("ind", "size", "slabs", "total",
+           "live_requested", "live_count", "live_frag", "total_live_frag"))
+
+    for ind, stats in enumerate(slabs['classes']):
+        size = stats['size']
+        count = stats['count']
+        live_r = stats['requested']
+        total = count * size
+
+        live_frag = 0.0 if count == 0 else 1.0 - live_r / total
+        total_live_frag = total - live_r
+
+        print( "%4d" "%10d" "%8d" "%14d" "%16d"  "%12d"  "%12.4f"   "%18d" %
+              (ind,  size,  stats['slabs'], total, live_r, count, live_frag,
+               total_live_frag))
+
+    print()
+    print("reserved: %d, occupied: %d, requested: %d" %
+          (slabs['reserved'], slabs['occupied'], slabs['requested']))
+    print("internal fragmentation: %.4f, utilization: %.4f" %
+          (slabs['fragmentation'], slabs['utilization']))
+
+if __name__ == "__main__":
+    if len(sys.argv) != 2:
+        print("Usage:", sys.argv[0], "stats.json")
+        sys.exit(1)
+    with open(sys.argv[1]) as f:
+        contents = json.load(f)
+    main(contents)
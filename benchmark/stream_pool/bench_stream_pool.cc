@@ -0,0 +1,111 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>
+#include <unordered_map>
+
+#include "basic/stream/byte_stream.h"
+#include "client/client.h"
+#include "common/util/logging.h"
+
+using namespace vineyard;  // NOLINT(build/namespaces)
+
+// Streams `chunks` chunks of `chunk_size` bytes from a producer to a consumer,
+// each on its own connection, returns the throughput in bytes per second.
+double bench_stream(std::string const& ipc_socket, size_t pooled_chunks,
+                    size_t chunks, size_t chunk_size) {
+  Client client;
+  VINEYARD_CHECK_OK(client.Connect(ipc_socket));
+
+  ObjectID stream_id = InvalidObjectID();
+  {
+    ByteStreamBuilder builder(client);
+    builder.SetParams(std::unordered_map<std::string, std::string>{
+        {"kind", "bench"}, {"bench_name", "stream_pool"}});
+    StreamOptions options;
+    options.pooled_chunks = pooled_chunks;
+    builder.SetStreamOptions(options);
+    stream_id = builder.Seal(client)->id();
+  }
+
+  auto start = std::chrono::steady_clock::now();
+  std::thread consumer([&]() {
+    Client reader_client;
+    VINEYARD_CHECK_OK(reader_client.Connect(ipc_socket));
+    VINEYARD_CHECK_OK(
+        reader_client.OpenStream(stream_id, OpenStreamMode::read));
+    size_t received = 0;
+    while (true) {
+      std::unique_ptr<arrow::Buffer> buffer = nullptr;
+      auto status = reader_client.PullNextStreamChunk(stream_id, buffer);
+      if (!status.ok()) {
+        CHECK(status.IsStreamDrained());
+        break;
+      }
+      received += buffer->size();
+    }
+    CHECK_EQ(received, chunks * chunk_size);
+    reader_client.Disconnect();
+  });
+
+  Client writer_client;
+  VINEYARD_CHECK_OK(writer_client.Connect(ipc_socket));
+  VINEYARD_CHECK_OK(writer_client.OpenStream(stream_id, OpenStreamMode::write));
+  for (size_t i = 0; i < chunks; ++i) {
+    std::unique_ptr<arrow::MutableBuffer> buffer = nullptr;
+    VINEYARD_CHECK_OK(
+        writer_client.GetNextStreamChunk(stream_id, chunk_size, buffer));
+    memset(buffer->mutable_data(), static_cast<int>(i), chunk_size);
+  }
+  VINEYARD_CHECK_OK(writer_client.StopStream(stream_id, false));
+  consumer.join();
+  auto finish = std::chrono::steady_clock::now();
+
+  writer_client.Disconnect();
+  client.Disconnect();
+  double seconds = std::chrono::duration<double>(finish - start).count();
+  return chunks * chunk_size / seconds;
+}
+
+int main(int argc, char** argv) {
+  if (argc < 2) {
+    printf(
+        "usage ./bench_stream_pool <ipc_socket> [chunks] [chunk_size] "
+        "[pooled_chunks]\n");
+    return 1;
+  }
+  std::string ipc_socket = std::string(argv[1]);
+  size_t chunks = argc > 2 ? std::stoul(argv[2]) : 4096;
+  size_t chunk_size = argc > 3 ? std::stoul(argv[3]) : 2 * 1024 * 1024;
+  size_t pooled_chunks =
+      argc > 4 ? std::stoul(argv[4]) : StreamOptions{}.pooled_chunks;
+
+  // warm up
+  bench_stream(ipc_socket, pooled_chunks, chunks / 16 + 1, chunk_size);
+
+  for (size_t pooled : {static_cast<size_t>(0), pooled_chunks}) {
+    double throughput = bench_stream(ipc_socket, pooled, chunks, chunk_size);
+    LOG(INFO) << "pooled chunks: " << pooled << ", " << chunks << " chunks of "
+              << chunk_size << " bytes: " << throughput / (1 << 20)
+              << " MiB/s";
+  }
+  return 0;
+}
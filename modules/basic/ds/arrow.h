@@ -29,22 +29,50 @@ limitations under the License.
 
 namespace vineyard {
 
-#ifndef BUILD_NULL_BITMAP
-#define BUILD_NULL_BITMAP(builder, array)                                \
-  {                                                                      \
-    if (array->null_bitmap() && array->null_count() > 0) {               \
-      std::unique_ptr<BlobWriter> bitmap_buffer_writer;                  \
-      RETURN_ON_ERROR(client.CreateBlob(array->null_bitmap()->size(),    \
-                                        bitmap_buffer_writer));          \
-      memcpy(bitmap_buffer_writer->data(), array->null_bitmap()->data(), \
-             array->null_bitmap()->size());                              \
-      builder->set_null_bitmap_(                                         \
-          std::shared_ptr<BlobWriter>(std::move(bitmap_buffer_writer))); \
-    } else {                                                             \
-      builder->set_null_bitmap_(Blob::MakeEmpty(client));                \
-    }                                                                    \
+namespace detail {
+
+/**
+ * @brief Copy the arrow buffers into blobs, which are allocated in a single
+ * batch to save the round trips to vineyard server. A `nullptr` buffer results
+ * in an empty blob.
+ */
+inline Status CopyBuffersToBlobs(
+    Client& client, std::vector<std::shared_ptr<arrow::Buffer>> const& buffers,
+    std::vector<std::shared_ptr<ObjectBase>>& blobs) {
+  std::vector<size_t> sizes;
+  for (auto const& buffer : buffers) {
+    if (buffer != nullptr) {
+      sizes.emplace_back(buffer->size());
+    }
   }
-#endif
+  std::vector<std::unique_ptr<BlobWriter>> writers;
+  RETURN_ON_ERROR(client.CreateBlobs(sizes, writers));
+  size_t index = 0;
+  for (auto const& buffer : buffers) {
+    if (buffer == nullptr) {
+      blobs.emplace_back(Blob::MakeEmpty(client));
+      continue;
+    }
+    auto& writer = writers[index++];
+    memcpy(writer->data(), buffer->data(), buffer->size());
+    blobs.emplace_back(std::shared_ptr<BlobWriter>(std::move(writer)));
+  }
+  return Status::OK();
+}
+
+/**
+ * @brief The null bitmap that needs to be copied, or `nullptr` if there's no
+ * null values in the array.
+ */
+inline std::shared_ptr<arrow::Buffer> NullBitmapToCopy(
+    std::shared_ptr<arrow::Array> const& array) {
+  if (array->null_bitmap() && array->null_count() > 0) {
+    return array->null_bitmap();
+  }
+  return nullptr;
+}
+
+}  // namespace detail
 
 /**
  * @brief NumericArrayBuilder is designed for building Arrow numeric arrays
@@ -62,16 +90,15 @@ class NumericArrayBuilder : public NumericArrayBaseBuilder<T> {
   std::shared_ptr<ArrayType> GetArray() { return array_; }
 
   Status Build(Client& client) override {
-    std::unique_ptr<BlobWriter> buffer_writer;
-    RETURN_ON_ERROR(client.CreateBlob(array_->values()->size(), buffer_writer));
-    memcpy(buffer_writer->data(), array_->values()->data(),
-           array_->values()->size());
+    std::vector<std::shared_ptr<ObjectBase>> blobs;
+    RETURN_ON_ERROR(detail::CopyBuffersToBlobs(
+        client, {array_->values(), detail::NullBitmapToCopy(array_)}, blobs));
 
     this->set_length_(array_->length());
     this->set_null_count_(array_->null_count());
     this->set_offset_(array_->offset());
-    this->set_buffer_(std::shared_ptr<BlobWriter>(std::move(buffer_writer)));
-    BUILD_NULL_BITMAP(this, array_);
+    this->set_buffer_(blobs[0]);
+    this->set_null_bitmap_(blobs[1]);
     return Status::OK();
   }
 
@@ -94,16 +121,15 @@ class BooleanArrayBuilder : public BooleanArrayBaseBuilder {
   std::shared_ptr<ArrayType> GetArray() { return array_; }
 
   Status Build(Client& client) override {
-    std::unique_ptr<BlobWriter> buffer_writer;
-    RETURN_ON_ERROR(client.CreateBlob(array_->values()->size(), buffer_writer));
-    memcpy(buffer_writer->data(), array_->values()->data(),
-           array_->values()->size());
+    std::vector<std::shared_ptr<ObjectBase>> blobs;
+    RETURN_ON_ERROR(detail::CopyBuffersToBlobs(
+        client, {array_->values(), detail::NullBitmapToCopy(array_)}, blobs));
 
     this->set_length_(array_->length());
     this->set_null_count_(array_->null_count());
     this->set_offset_(array_->offset());
-    this->set_buffer_(std::shared_ptr<BlobWriter>(std::move(buffer_writer)));
-    BUILD_NULL_BITMAP(this, array_);
+    this->set_buffer_(blobs[0]);
+    this->set_null_bitmap_(blobs[1]);
     return Status::OK();
   }
 
@@ -125,30 +151,19 @@ class BaseBinaryArrayBuilder : public BaseBinaryArrayBaseBuilder<ArrayType> {
   std::shared_ptr<ArrayType> GetArray() { return array_; }
 
   Status Build(Client& client) override {
-    {
-      std::unique_ptr<BlobWriter> buffer_writer;
-      RETURN_ON_ERROR(
-          client.CreateBlob(array_->value_offsets()->size(), buffer_writer));
-      memcpy(buffer_writer->data(), array_->value_offsets()->data(),
-             array_->value_offsets()->size());
+    std::vector<std::shared_ptr<ObjectBase>> blobs;
+    RETURN_ON_ERROR(detail::CopyBuffersToBlobs(
+        client,
+        {array_->value_offsets(), array_->value_data(),
+         detail::NullBitmapToCopy(array_)},
+        blobs));
+    this->set_buffer_offsets_(blobs[0]);
+    this->set_buffer_data_(blobs[1]);
+    this->set_null_bitmap_(blobs[2]);
 
-      this->set_buffer_offsets_(
-          std::shared_ptr<BlobWriter>(std::move(buffer_writer)));
-    }
-    {
-      std::unique_ptr<BlobWriter> buffer_writer;
-      RETURN_ON_ERROR(
-          client.CreateBlob(array_->value_data()->size(), buffer_writer));
-      memcpy(buffer_writer->data(), array_->value_data()->data(),
-             array_->value_data()->size());
-
-      this->set_buffer_data_(
-          std::shared_ptr<BlobWriter>(std::move(buffer_writer)));
-    }
     this->set_length_(array_->length());
     this->set_null_count_(array_->null_count());
     this->set_offset_(array_->offset());
-    BUILD_NULL_BITMAP(this, array_);
     return Status::OK();
   }
 
@@ -178,17 +193,16 @@ class FixedSizeBinaryArrayBuilder : public FixedSizeBinaryArrayBaseBuilder {
     VINEYARD_ASSERT(array_->length() == 0 || array_->values()->size() != 0,
                     "Invalid array values");
 
-    std::unique_ptr<BlobWriter> buffer_writer;
-    RETURN_ON_ERROR(client.CreateBlob(array_->values()->size(), buffer_writer));
-    memcpy(buffer_writer->data(), array_->values()->data(),
-           array_->values()->size());
+    std::vector<std::shared_ptr<ObjectBase>> blobs;
+    RETURN_ON_ERROR(detail::CopyBuffersToBlobs(
+        client, {array_->values(), detail::NullBitmapToCopy(array_)}, blobs));
 
     this->set_byte_width_(array_->byte_width());
     this->set_length_(array_->length());
     this->set_null_count_(array_->null_count());
     this->set_offset_(array_->offset());
-    this->set_buffer_(std::shared_ptr<BlobWriter>(std::move(buffer_writer)));
-    BUILD_NULL_BITMAP(this, array_);
+    this->set_buffer_(blobs[0]);
+    this->set_null_bitmap_(blobs[1]);
     return Status::OK();
   }
 
@@ -312,14 +326,12 @@ class BaseListArrayBuilder : public BaseListArrayBaseBuilder<ArrayType> {
 
   Status Build(Client& client) override {
     {
-      std::unique_ptr<BlobWriter> buffer_writer;
-      RETURN_ON_ERROR(
-          client.CreateBlob(array_->value_offsets()->size(), buffer_writer));
-      memcpy(buffer_writer->data(), array_->value_offsets()->data(),
-             array_->value_offsets()->size());
-
-      this->set_buffer_offsets_(
-          std::shared_ptr<BlobWriter>(std::move(buffer_writer)));
+      std::vector<std::shared_ptr<ObjectBase>> blobs;
+      RETURN_ON_ERROR(detail::CopyBuffersToBlobs(
+          client, {array_->value_offsets(), detail::NullBitmapToCopy(array_)},
+          blobs));
+      this->set_buffer_offsets_(blobs[0]);
+      this->set_null_bitmap_(blobs[1]);
     }
     {
       // Assuming the list is not nested.
@@ -330,7 +342,6 @@ class BaseListArrayBuilder : public BaseListArrayBaseBuilder<ArrayType> {
     this->set_length_(array_->length());
     this->set_null_count_(array_->null_count());
     this->set_offset_(array_->offset());
-    BUILD_NULL_BITMAP(this, array_);
     return Status::OK();
   }
 
@@ -341,8 +352,6 @@ class BaseListArrayBuilder : public BaseListArrayBaseBuilder<ArrayType> {
 using ListArrayBuilder = BaseListArrayBuilder<arrow::ListArray>;
 using LargeListArrayBuilder = BaseListArrayBuilder<arrow::LargeListArray>;
 
-#undef BUILD_NULL_BITMAP
-
 namespace detail {
 inline std::shared_ptr<ObjectBuilder> BuildArray(
     Client& client, std::shared_ptr<arrow::Array> array) {
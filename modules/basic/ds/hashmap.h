@@ -18,9 +18,12 @@ limitations under the License.
 
 #include <algorithm>
 #include <functional>
+#include <limits>
 #include <memory>
 #include <string>
+#include <thread>
 #include <utility>
+#include <vector>
 
 #include "flat_hash_map/flat_hash_map.hpp"
 
@@ -181,6 +184,314 @@ class HashmapBuilder : public HashmapBaseBuilder<K, V, H, E> {
   ska::flat_hash_map<K, V, H, E> hashmap_;
 };
 
+/**
+ * @brief ParallelHashmapBuilder is used for constructing hashmaps that the
+ * number of elements is known in advance, e.g., the oid-to-gid mapping of
+ * vertices.
+ *
+ * The table is sized from the number of elements once, the elements are
+ * placed in parallel, and the entries are written into the blob directly
+ * rather than being copied from a process-local ska::flat_hash_map.
+ *
+ * The elements are laid out in the order of their desired slots, which is
+ * exactly the layout of the robin hood hashing that Hashmap expects. For
+ * duplicated keys the first element wins, as what `emplace` does.
+ *
+ * @tparam K The type for the key.
+ * @tparam V The type for the value.
+ * @tparam std::hash<K> The hash function for the key.
+ * @tparam std::equal_to<K> The compare function for the key.
+ */
+template <typename K, typename V, typename H = std::hash<K>,
+          typename E = std::equal_to<K>>
+class ParallelHashmapBuilder : public HashmapBaseBuilder<K, V, H, E> {
+ public:
+  /**
+   * @brief Generates the key-value pair of the element at the given index,
+   * it will be invoked from multiple threads.
+   */
+  using generator_t = std::function<std::pair<K, V>(size_t)>;
+
+  /**
+   * @brief Initialize the builder with the number of elements.
+   *
+   * @param client The client connected to the vineyard server.
+   * @param size The number of elements.
+   * @param generator The generator of the elements.
+   * @param concurrency The number of threads used to build the hashmap.
+   */
+  ParallelHashmapBuilder(
+      Client& client, size_t size, generator_t generator,
+      size_t concurrency = std::thread::hardware_concurrency())
+      : HashmapBaseBuilder<K, V, H, E>(client),
+        size_(size),
+        generator_(std::move(generator)),
+        concurrency_(std::max(concurrency, static_cast<size_t>(1))) {}
+
+  /**
+   * @brief Runs `func(i)` for i in [0, num) in parallel, and returns after all
+   * of them finish.
+   */
+  using executor_t =
+      std::function<void(size_t, const std::function<void(size_t)>&)>;
+
+  /**
+   * @brief Get the number of the elements, including the duplicated ones.
+   *
+   */
+  size_t size() const { return size_; }
+
+  /**
+   * @brief Set the executor of the parallel steps, e.g., to run them on a
+   * shared thread pool. By default each step spawns `concurrency` threads.
+   *
+   */
+  void set_executor(executor_t executor) { executor_ = std::move(executor); }
+
+  /**
+   * @brief Build the hashmap object.
+   *
+   */
+  Status Build(Client& client) override {
+    using entry_t = typename Hashmap<K, V, H, E>::Entry;
+    constexpr size_t kSkipped = std::numeric_limits<size_t>::max();
+
+    // the same load factor and the prime number of slots as flat_hash_map.
+    placement_t placement;
+    size_t max_distance = place(nextPrime(size_ * 2), placement);
+    // the distance from the desired slot is kept in an int8_t, grow the
+    // table and place the elements again when it is exceeded, as what
+    // flat_hash_map does.
+    while (max_distance >=
+           static_cast<size_t>(std::numeric_limits<int8_t>::max())) {
+      if (placement.num_slots >
+          kMaxGrowth * std::max(size_, static_cast<size_t>(1))) {
+        return Status::Invalid(
+            "Too many collisions in the hashmap, the hash function is "
+            "inappropriate for the keys");
+      }
+      max_distance = place(nextPrime(placement.num_slots * 2), placement);
+    }
+    size_t const num_slots = placement.num_slots;
+    size_t const concurrency = placement.concurrency;
+    auto const& range_offsets = placement.range_offsets;
+    auto const& desired = placement.desired;
+    auto const& order = placement.order;
+    auto const& slots = placement.slots;
+    auto const& elements = placement.elements;
+    int8_t max_lookups = std::max(ska::detailv3::min_lookups,
+                                  static_cast<int8_t>(max_distance + 1));
+
+    // write the entries into the blob directly.
+    size_t entry_size = num_slots + max_lookups;
+    auto entries_builder =
+        std::make_shared<ArrayBuilder<entry_t>>(client, entry_size);
+    entry_t* entries = entries_builder->data();
+    parallelFor(concurrency, [&](size_t chunk) {
+      for (size_t i = entry_size * chunk / concurrency;
+           i < entry_size * (chunk + 1) / concurrency; ++i) {
+        entries[i].distance_from_desired = -1;
+      }
+    });
+    entries[entry_size - 1].distance_from_desired = entry_t::special_end_value;
+    parallelFor(concurrency, [&](size_t range) {
+      for (size_t k = range_offsets[range]; k < range_offsets[range + 1];
+           ++k) {
+        if (slots[k] != kSkipped) {
+          entries[slots[k]].emplace(
+              static_cast<int8_t>(slots[k] - desired[order[k]]),
+              generator_(order[k]));
+        }
+      }
+    });
+
+    size_t num_elements = 0;
+    for (size_t count : elements) {
+      num_elements += count;
+    }
+    this->set_num_slots_minus_one_(num_slots - 1);
+    this->set_max_lookups_(max_lookups);
+    this->set_num_elements_(num_elements);
+    this->set_entries_(std::static_pointer_cast<ObjectBase>(entries_builder));
+    return Status::OK();
+  }
+
+ private:
+  // the table grows up to such times of the number of elements.
+  static constexpr size_t kMaxGrowth = 64;
+
+  struct placement_t {
+    size_t num_slots = 0;
+    size_t concurrency = 0;
+    // the desired slot of each element.
+    std::vector<size_t> desired;
+    // the elements grouped by the ranges of slots, and their slots.
+    std::vector<size_t> order, slots;
+    std::vector<size_t> range_offsets;
+    // the number of placed elements in each range.
+    std::vector<size_t> elements;
+  };
+
+  /**
+   * @brief Places the elements into a table of `num_slots` slots, returns the
+   * maximum distance of the elements from their desired slots.
+   */
+  size_t place(size_t const num_slots, placement_t& placement) const {
+    constexpr size_t kSkipped = std::numeric_limits<size_t>::max();
+
+    // the slots are split into contiguous ranges, one per thread.
+    size_t const concurrency = std::min(concurrency_, num_slots);
+    size_t const range_size = num_slots / concurrency + 1;
+    auto range_of = [&](size_t slot) { return slot / range_size; };
+    auto chunk_begin = [&](size_t chunk) {
+      return size_ * chunk / concurrency;
+    };
+    placement.num_slots = num_slots;
+    placement.concurrency = concurrency;
+
+    // the desired slot of each element, and the number of elements per range
+    // in each chunk of the elements.
+    std::vector<size_t>& desired = placement.desired;
+    desired.resize(size_);
+    std::vector<std::vector<size_t>> counts(
+        concurrency, std::vector<size_t>(concurrency, 0));
+    parallelFor(concurrency, [&](size_t chunk) {
+      H hasher;
+      for (size_t i = chunk_begin(chunk); i < chunk_begin(chunk + 1); ++i) {
+        desired[i] = hasher(generator_(i).first) % num_slots;
+        ++counts[chunk][range_of(desired[i])];
+      }
+    });
+
+    // group the elements by the ranges, stable in the order of elements.
+    std::vector<size_t>& range_offsets = placement.range_offsets;
+    range_offsets.assign(concurrency + 1, 0);
+    std::vector<std::vector<size_t>> offsets(concurrency,
+                                             std::vector<size_t>(concurrency));
+    for (size_t range = 0, offset = 0; range < concurrency; ++range) {
+      range_offsets[range] = offset;
+      for (size_t chunk = 0; chunk < concurrency; ++chunk) {
+        offsets[chunk][range] = offset;
+        offset += counts[chunk][range];
+      }
+    }
+    range_offsets[concurrency] = size_;
+    std::vector<size_t>& order = placement.order;
+    order.resize(size_);
+    parallelFor(concurrency, [&](size_t chunk) {
+      auto& offset = offsets[chunk];
+      for (size_t i = chunk_begin(chunk); i < chunk_begin(chunk + 1); ++i) {
+        order[offset[range_of(desired[i])]++] = i;
+      }
+    });
+
+    // sort each range by the desired slots and place the elements linearly,
+    // each range is placed as if it starts from an empty table.
+    std::vector<size_t>& slots = placement.slots;
+    slots.resize(size_);
+    parallelFor(concurrency, [&](size_t range) {
+      size_t begin = range_offsets[range], end = range_offsets[range + 1];
+      std::stable_sort(
+          order.begin() + begin, order.begin() + end,
+          [&](size_t lhs, size_t rhs) { return desired[lhs] < desired[rhs]; });
+      E equal;
+      size_t last = kSkipped;
+      for (size_t k = begin, run = begin; k < end; ++k) {
+        size_t slot = desired[order[k]];
+        if (k == begin || desired[order[k - 1]] != slot) {
+          run = k;
+        }
+        // keys that are equal have the same desired slot.
+        bool duplicated = false;
+        if (run < k) {
+          auto key = generator_(order[k]).first;
+          for (size_t r = run; r < k && !duplicated; ++r) {
+            duplicated = slots[r] != kSkipped &&
+                         equal(generator_(order[r]).first, key);
+          }
+        }
+        if (duplicated) {
+          slots[k] = kSkipped;
+          continue;
+        }
+        if (last != kSkipped) {
+          slot = std::max(slot, last + 1);
+        }
+        slots[k] = last = slot;
+      }
+    });
+
+    // shift the heading elements of each range that overlap with the tail of
+    // the previous range, the shifting stops once an element stays in place.
+    for (size_t range = 0, carry = kSkipped; range < concurrency; ++range) {
+      size_t begin = range_offsets[range], end = range_offsets[range + 1];
+      for (size_t k = begin; k < end && carry != kSkipped; ++k) {
+        if (slots[k] != kSkipped) {
+          size_t slot = std::max(desired[order[k]], carry + 1);
+          if (slot == slots[k]) {
+            break;
+          }
+          slots[k] = carry = slot;
+        }
+      }
+      for (size_t k = end; k > begin; --k) {
+        if (slots[k - 1] != kSkipped) {
+          carry = slots[k - 1];
+          break;
+        }
+      }
+    }
+
+    std::vector<size_t> distances(concurrency, 0);
+    std::vector<size_t>& elements = placement.elements;
+    elements.assign(concurrency, 0);
+    parallelFor(concurrency, [&](size_t range) {
+      for (size_t k = range_offsets[range]; k < range_offsets[range + 1];
+           ++k) {
+        if (slots[k] != kSkipped) {
+          distances[range] = std::max(distances[range],
+                                      slots[k] - desired[order[k]]);
+          ++elements[range];
+        }
+      }
+    });
+    return *std::max_element(distances.begin(), distances.end());
+  }
+
+  static size_t nextPrime(size_t value) {
+    for (value = std::max(value, static_cast<size_t>(2));; ++value) {
+      bool prime = true;
+      for (size_t divisor = 2; divisor * divisor <= value && prime;
+           ++divisor) {
+        prime = value % divisor != 0;
+      }
+      if (prime) {
+        return value;
+      }
+    }
+  }
+
+  void parallelFor(size_t concurrency,
+                   const std::function<void(size_t)>& func) const {
+    if (executor_) {
+      executor_(concurrency, func);
+      return;
+    }
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < concurrency; ++i) {
+      threads.emplace_back(func, i);
+    }
+    for (auto& thrd : threads) {
+      thrd.join();
+    }
+  }
+
+  size_t size_;
+  generator_t generator_;
+  size_t concurrency_;
+  executor_t executor_;
+};
+
 }  // namespace vineyard
 
 #endif  // MODULES_BASIC_DS_HASHMAP_H_
@@ -21,6 +21,7 @@ limitations under the License.
 #include <unordered_map>
 
 #include "basic/stream/byte_stream.vineyard.h"
+#include "basic/stream/stream_utils.h"
 #include "client/client.h"
 
 namespace vineyard {
@@ -50,11 +51,18 @@ class ByteStreamBuilder : public ByteStreamBaseBuilder {
     }
   }
 
+  void SetStreamOptions(const StreamOptions& options) {
+    this->options_ = options;
+  }
+
   std::shared_ptr<Object> Seal(Client& client) {
     auto bstream = ByteStreamBaseBuilder::Seal(client);
-    VINEYARD_CHECK_OK(client.CreateStream(bstream->id()));
+    VINEYARD_CHECK_OK(client.CreateStream(bstream->id(), options_));
     return std::static_pointer_cast<Object>(bstream);
   }
+
+ private:
+  StreamOptions options_;
 };
 
 }  // namespace vineyard
@@ -22,6 +22,7 @@ limitations under the License.
 #include <vector>
 
 #include "basic/stream/dataframe_stream.vineyard.h"
+#include "basic/stream/stream_utils.h"
 #include "client/client.h"
 
 namespace vineyard {
@@ -52,11 +53,18 @@ class DataframeStreamBuilder : public DataframeStreamBaseBuilder {
     }
   }
 
+  void SetStreamOptions(const StreamOptions& options) {
+    this->options_ = options;
+  }
+
   std::shared_ptr<Object> Seal(Client& client) {
     auto bstream = DataframeStreamBaseBuilder::Seal(client);
-    VINEYARD_CHECK_OK(client.CreateStream(bstream->id()));
+    VINEYARD_CHECK_OK(client.CreateStream(bstream->id(), options_));
     return std::static_pointer_cast<Object>(bstream);
   }
+
+ private:
+  StreamOptions options_;
 };
 }  // namespace vineyard
 
@@ -0,0 +1,60 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef MODULES_BASIC_STREAM_LINE_SPLITTER_H_
+#define MODULES_BASIC_STREAM_LINE_SPLITTER_H_
+
+#include <cstddef>
+#include <cstring>
+
+#include "arrow/util/string_view.h"
+
+namespace vineyard {
+
+/**
+ * @brief Splits the bytes into lines and invokes `fn` with the string_view of
+ * each complete line, exclusive of the line break. The line breaks are found
+ * with memchr, which scans the bytes a word (or a SIMD register) at a time.
+ *
+ * @return The number of bytes that have been consumed, the rest of the bytes
+ * is an incomplete line.
+ */
+template <typename Fn>
+size_t SplitLines(const char* data, size_t size, Fn&& fn) {
+  const char* begin = data;
+  const char* end = data + size;
+  while (begin < end) {
+    auto eol = static_cast<const char*>(memchr(begin, '\n', end - begin));
+    if (eol == nullptr) {
+      break;
+    }
+    fn(arrow::util::string_view(begin, eol - begin));
+    begin = eol + 1;
+  }
+  return begin - data;
+}
+
+/**
+ * @brief The offset next to the last line break in the first `size` bytes, or
+ * zero if there's no line break.
+ */
+inline size_t LastLineBreak(const char* data, size_t size) {
+  auto eol = static_cast<const char*>(memrchr(data, '\n', size));
+  return eol == nullptr ? 0 : eol - data + 1;
+}
+
+}  // namespace vineyard
+
+#endif  // MODULES_BASIC_STREAM_LINE_SPLITTER_H_
@@ -16,6 +16,8 @@ limitations under the License.
 #ifndef MODULES_BASIC_STREAM_STREAM_UTILS_H_
 #define MODULES_BASIC_STREAM_STREAM_UTILS_H_
 
+#include <cstddef>
+
 namespace vineyard {
 
 enum class OpenStreamMode {
@@ -23,6 +25,30 @@ enum class OpenStreamMode {
   write = 2,
 };
 
+/**
+ * @brief The options of a stream that are specified when the stream is
+ * created.
+ */
+struct StreamOptions {
+  // The number of the consumers of the stream. Each consumer of a broadcast
+  // stream, i.e., a stream with more than one consumers, reads every chunk
+  // with its own cursor, and a chunk is reclaimed after all of them have
+  // released it.
+  size_t consumers = 1;
+  // The maximum number of the sealed chunks that a consumer hasn't read yet,
+  // beyond which the producer is blocked until the consumers catch up. Zero
+  // means no limit, except that a broadcast stream defaults to a bounded
+  // backlog.
+  size_t max_chunks = 0;
+  // The maximum bytes of the chunks that the stream holds, including the ones
+  // being written, read or retained by the consumers. Zero means no limit.
+  size_t max_bytes = 0;
+  // The number of the consumed chunks that are kept to be reused by the
+  // producer, as the chunks of a stream are usually of the same size. Zero
+  // disables the pooling.
+  size_t pooled_chunks = 4;
+};
+
 }  // namespace vineyard
 
 #endif  // MODULES_BASIC_STREAM_STREAM_UTILS_H_
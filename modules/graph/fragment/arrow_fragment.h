@@ -17,8 +17,10 @@ limitations under the License.
 #define MODULES_GRAPH_FRAGMENT_ARROW_FRAGMENT_H_
 
 #include <algorithm>
+#include <atomic>
 #include <map>
 #include <memory>
+#include <mutex>
 #include <set>
 #include <string>
 #include <unordered_map>
@@ -189,6 +191,9 @@ class ArrowFragment
   using nbr_t = property_graph_utils::Nbr<vid_t, eid_t>;
   using nbr_unit_t = property_graph_utils::NbrUnit<vid_t, eid_t>;
   using adj_list_t = property_graph_utils::AdjList<vid_t, eid_t>;
+  using merged_adj_list_t = property_graph_utils::MergedAdjList<vid_t, eid_t>;
+  using compressed_adj_list_t =
+      property_graph_utils::CompressedAdjList<vid_t, eid_t>;
   using raw_adj_list_t = property_graph_utils::RawAdjList<vid_t, eid_t>;
   using vertex_map_t = ArrowVertexMap<internal_oid_t, vid_t>;
   using vertex_t = grape::Vertex<vid_t>;
@@ -214,58 +219,15 @@ class ArrowFragment
 
   vineyard::ObjectID vertex_map_id() const override { return vm_ptr_->id(); }
 
-#define CONSTRUCT_ARRAY_VECTOR(type, vec, label_num, prefix)                   \
-  do {                                                                         \
-    vec.resize(label_num);                                                     \
-    for (label_id_t i = 0; i < label_num; ++i) {                               \
-      vineyard::NumericArray<type> array;                                      \
-      array.Construct(                                                         \
-          meta.GetMemberMeta(vineyard::generate_name_with_suffix(prefix, i))); \
-      vec[i] = array.GetArray();                                               \
-    }                                                                          \
-  } while (0)
-
-#define CONSTRUCT_ARRAY_VECTOR_VECTOR(type, vec, v_label_num, e_label_num, \
-                                      prefix)                              \
-  do {                                                                     \
-    vec.resize(v_label_num);                                               \
-    for (label_id_t i = 0; i < v_label_num; ++i) {                         \
-      vec[i].resize(e_label_num);                                          \
-      for (label_id_t j = 0; j < e_label_num; ++j) {                       \
-        vineyard::NumericArray<type> array;                                \
-        array.Construct(meta.GetMemberMeta(                                \
-            vineyard::generate_name_with_suffix(prefix, i, j)));           \
-        vec[i][j] = array.GetArray();                                      \
-      }                                                                    \
-    }                                                                      \
-  } while (0)
-
-#define CONSTRUCT_BINARY_ARRAY_VECTOR_VECTOR(vec, v_label_num, e_label_num, \
-                                             prefix)                        \
-  do {                                                                      \
-    vec.resize(v_label_num);                                                \
-    for (label_id_t i = 0; i < v_label_num; ++i) {                          \
-      vec[i].resize(e_label_num);                                           \
-      for (label_id_t j = 0; j < e_label_num; ++j) {                        \
-        vineyard::FixedSizeBinaryArray array;                               \
-        array.Construct(meta.GetMemberMeta(                                 \
-            vineyard::generate_name_with_suffix(prefix, i, j)));            \
-        vec[i][j] = array.GetArray();                                       \
-      }                                                                     \
-    }                                                                       \
-  } while (0)
-
-#define CONSTRUCT_TABLE_VECTOR(vec, label_num, prefix)                         \
-  do {                                                                         \
-    vec.resize(label_num);                                                     \
-    for (label_id_t i = 0; i < label_num; ++i) {                               \
-      vineyard::Table table;                                                   \
-      table.Construct(                                                         \
-          meta.GetMemberMeta(vineyard::generate_name_with_suffix(prefix, i))); \
-      vec[i] = table.GetTable();                                               \
-    }                                                                          \
-  } while (0)
-
+  /**
+   * @brief Constructs the fragment from the metadata.
+   *
+   * When the buffers of the metadata haven't been fetched, i.e., the metadata
+   * is obtained by `Client::GetMetaDataLazily`, only the vertex map and the
+   * vertex numbers are fetched here, the tables and the CSRs of a vertex label
+   * or an edge label are fetched and constructed on the first access to the
+   * label.
+   */
   void Construct(const vineyard::ObjectMeta& meta) override {
     this->meta_ = meta;
     this->id_ = meta.GetId();
@@ -280,40 +242,39 @@ class ArrowFragment
 
     vid_parser_.Init(fnum_, vertex_label_num_);
 
-    this->ivnums_.Construct(meta.GetMemberMeta("ivnums"));
-    this->ovnums_.Construct(meta.GetMemberMeta("ovnums"));
-    this->tvnums_.Construct(meta.GetMemberMeta("tvnums"));
-
-    CONSTRUCT_TABLE_VECTOR(vertex_tables_, vertex_label_num_, "vertex_tables");
-    CONSTRUCT_ARRAY_VECTOR(vid_t, ovgid_lists_, vertex_label_num_,
-                           "ovgid_lists");
-    ovg2l_maps_.resize(vertex_label_num_);
-    for (label_id_t i = 0; i < vertex_label_num_; ++i) {
-      ovg2l_maps_[i] = std::make_shared<vineyard::Hashmap<vid_t, vid_t>>();
-      ovg2l_maps_[i]->Construct(
-          meta.GetMemberMeta(generate_name_with_suffix("ovg2l_maps", i)));
+    lazy_ = false;
+    for (auto const& item : meta.GetBufferSet()->AllBuffers()) {
+      if (item.second == nullptr) {
+        lazy_ = true;
+        break;
+      }
     }
 
-    CONSTRUCT_TABLE_VECTOR(edge_tables_, edge_label_num_, "edge_tables");
+    this->ivnums_.Construct(memberMeta("ivnums"));
+    this->ovnums_.Construct(memberMeta("ovnums"));
+    this->tvnums_.Construct(memberMeta("tvnums"));
 
-    if (directed_) {
-      CONSTRUCT_BINARY_ARRAY_VECTOR_VECTOR(ie_lists_, vertex_label_num_,
-                                           edge_label_num_, "ie_lists");
-    }
-    CONSTRUCT_BINARY_ARRAY_VECTOR_VECTOR(oe_lists_, vertex_label_num_,
-                                         edge_label_num_, "oe_lists");
+    // the compressed CSRs have only the packed lists.
+    compressed_ = meta.Haskey("compressed_edges") &&
+                  meta.GetKeyValue<int>("compressed_edges") != 0;
 
-    if (directed_) {
-      CONSTRUCT_ARRAY_VECTOR_VECTOR(int64_t, ie_offsets_lists_,
-                                    vertex_label_num_, edge_label_num_,
-                                    "ie_offsets_lists");
+    // the delta CSR of the edge labels that have delta edges.
+    has_delta_ = false;
+    for (label_id_t j = 0; j < edge_label_num_; ++j) {
+      if (meta.Haskey(
+              vineyard::generate_name_with_suffix("delta_edge_tables", j))) {
+        has_delta_ = true;
+      }
     }
-    CONSTRUCT_ARRAY_VECTOR_VECTOR(int64_t, oe_offsets_lists_, vertex_label_num_,
-                                  edge_label_num_, "oe_offsets_lists");
+
+    initLabels();
+
     vm_ptr_ = std::make_shared<vertex_map_t>();
-    vm_ptr_->Construct(meta.GetMemberMeta("vertex_map"));
+    vm_ptr_->Construct(memberMeta("vertex_map"));
 
-    initPointers();
+    if (!lazy_) {
+      ensureAllLabels();
+    }
   }
 
   fid_t fid() const { return fid_; }
@@ -339,6 +300,7 @@ class ArrowFragment
 
   std::shared_ptr<arrow::DataType> vertex_property_type(label_id_t label,
                                                         prop_id_t prop) const {
+    ensureVertexLabel(label);
     return vertex_tables_[label]->schema()->field(prop)->type();
   }
 
@@ -349,20 +311,24 @@ class ArrowFragment
 
   std::shared_ptr<arrow::DataType> edge_property_type(label_id_t label,
                                                       prop_id_t prop) const {
+    ensureEdgeLabel(label);
     return edge_tables_[label]->schema()->field(prop)->type();
   }
 
   std::shared_ptr<arrow::Table> vertex_data_table(label_id_t i) const {
+    ensureVertexLabel(i);
     return vertex_tables_[i];
   }
 
   std::shared_ptr<arrow::Table> edge_data_table(label_id_t i) const {
+    ensureEdgeLabel(i);
     return edge_tables_[i];
   }
 
   template <typename DATA_T>
   property_graph_utils::EdgeDataColumn<DATA_T, nbr_unit_t> edge_data_column(
       label_id_t label, prop_id_t prop) const {
+    ensureEdgeLabel(label);
     if (edge_tables_[label]->num_rows() == 0) {
       return property_graph_utils::EdgeDataColumn<DATA_T, nbr_unit_t>();
     } else {
@@ -374,6 +340,7 @@ class ArrowFragment
   template <typename DATA_T>
   property_graph_utils::VertexDataColumn<DATA_T, vid_t> vertex_data_column(
       label_id_t label, prop_id_t prop) const {
+    ensureVertexLabel(label);
     if (vertex_tables_[label]->num_rows() == 0) {
       return property_graph_utils::VertexDataColumn<DATA_T, vid_t>(
           InnerVertices(label));
@@ -442,13 +409,41 @@ class ArrowFragment
     return vm_ptr_->GetTotalNodesNum(label);
   }
 
+  /**
+   * @brief The number of edges in the base CSR, i.e., the edges that
+   * `GetOutgoingAdjList`, `GetIncomingAdjList` and the degrees see, see also
+   * `GetMergedEdgeNum`.
+   */
   size_t GetEdgeNum() const {
     size_t edge_num = 0;
+    for (label_id_t j = 0; j < edge_label_num_; j++) {
+      ensureEdgeLabel(j);
+    }
     for (label_id_t i = 0; i < vertex_label_num_; i++) {
       for (label_id_t j = 0; j < edge_label_num_; j++) {
-        edge_num += oe_lists_.at(i).at(j)->length();
+        edge_num += oe_offsets_ptr_lists_.at(i).at(j)[tvnums_[i]];
         if (directed_) {
-          edge_num += ie_lists_.at(i).at(j)->length();
+          edge_num += ie_offsets_ptr_lists_.at(i).at(j)[tvnums_[i]];
+        }
+      }
+    }
+    return edge_num;
+  }
+
+  /**
+   * @brief The number of edges in both the base CSR and the delta CSR, i.e.,
+   * the edges that `GetOutgoingMergedAdjList` and `GetIncomingMergedAdjList`
+   * see.
+   */
+  size_t GetMergedEdgeNum() const {
+    size_t edge_num = GetEdgeNum();
+    for (label_id_t i = 0; i < vertex_label_num_; i++) {
+      for (label_id_t j = 0; j < edge_label_num_; j++) {
+        if (delta_oe_lists_.at(i).at(j) != nullptr) {
+          edge_num += delta_oe_lists_[i][j]->length();
+          if (directed_) {
+            edge_num += delta_ie_lists_[i][j]->length();
+          }
         }
       }
     }
@@ -457,8 +452,10 @@ class ArrowFragment
 
   template <typename T>
   T GetData(const vertex_t& v, prop_id_t prop_id) const {
+    label_id_t v_label = vid_parser_.GetLabelId(v.GetValue());
+    ensureVertexLabel(v_label);
     return property_graph_utils::ValueGetter<T>::Value(
-        vertex_tables_columns_[vid_parser_.GetLabelId(v.GetValue())][prop_id],
+        vertex_tables_columns_[v_label][prop_id],
         vid_parser_.GetOffset(v.GetValue()));
   }
 
@@ -470,11 +467,27 @@ class ArrowFragment
     return GetLocalInDegree(v, e_label) != 0;
   }
 
+  /**
+   * @brief The degree of the vertex in the base CSR, i.e., the number of
+   * edges that `GetOutgoingAdjList` iterates. The delta edges that haven't
+   * been compacted are visible only through `GetOutgoingMergedAdjList`, whose
+   * `Size()` is the degree that includes them.
+   */
   int GetLocalOutDegree(const vertex_t& v, label_id_t e_label) const {
+    if (compressed_) {
+      return GetOutgoingCompressedAdjList(v, e_label).Size();
+    }
     return GetOutgoingAdjList(v, e_label).Size();
   }
 
+  /**
+   * @brief The degree of the vertex in the base CSR, see also
+   * `GetLocalOutDegree`.
+   */
   int GetLocalInDegree(const vertex_t& v, label_id_t e_label) const {
+    if (compressed_) {
+      return GetIncomingCompressedAdjList(v, e_label).Size();
+    }
     return GetIncomingAdjList(v, e_label).Size();
   }
 
@@ -567,7 +580,9 @@ class ArrowFragment
   }
 
   inline bool OuterVertexGid2Vertex(const vid_t& gid, vertex_t& v) const {
-    auto map = ovg2l_maps_ptr_[vid_parser_.GetLabelId(gid)];
+    label_id_t v_label = vid_parser_.GetLabelId(gid);
+    ensureVertexLabel(v_label);
+    auto map = ovg2l_maps_ptr_[v_label];
     auto iter = map->find(gid);
     if (iter != map->end()) {
       v.SetValue(iter->second);
@@ -579,6 +594,7 @@ class ArrowFragment
 
   inline vid_t GetOuterVertexGid(const vertex_t& v) const {
     label_id_t v_label = vid_parser_.GetLabelId(v.GetValue());
+    ensureVertexLabel(v_label);
     return ovgid_lists_ptr_[v_label][vid_parser_.GetOffset(v.GetValue()) -
                                      static_cast<int64_t>(ivnums_[v_label])];
   }
@@ -589,6 +605,11 @@ class ArrowFragment
 
   inline adj_list_t GetIncomingAdjList(const vertex_t& v,
                                        label_id_t e_label) const {
+    ensureEdgeLabel(e_label);
+    if (compressed_) {
+      return adj_list_t(decodeAdjList(GetIncomingCompressedAdjList(v, e_label)),
+                        flatten_edge_tables_columns_[e_label]);
+    }
     vid_t vid = v.GetValue();
     label_id_t v_label = vid_parser_.GetLabelId(vid);
     int64_t v_offset = vid_parser_.GetOffset(vid);
@@ -601,6 +622,11 @@ class ArrowFragment
 
   inline raw_adj_list_t GetIncomingRawAdjList(const vertex_t& v,
                                               label_id_t e_label) const {
+    ensureEdgeLabel(e_label);
+    if (compressed_) {
+      return raw_adj_list_t(
+          decodeAdjList(GetIncomingCompressedAdjList(v, e_label)));
+    }
     vid_t vid = v.GetValue();
     label_id_t v_label = vid_parser_.GetLabelId(vid);
     int64_t v_offset = vid_parser_.GetOffset(vid);
@@ -612,6 +638,11 @@ class ArrowFragment
 
   inline adj_list_t GetOutgoingAdjList(const vertex_t& v,
                                        label_id_t e_label) const {
+    ensureEdgeLabel(e_label);
+    if (compressed_) {
+      return adj_list_t(decodeAdjList(GetOutgoingCompressedAdjList(v, e_label)),
+                        flatten_edge_tables_columns_[e_label]);
+    }
     vid_t vid = v.GetValue();
     label_id_t v_label = vid_parser_.GetLabelId(vid);
     int64_t v_offset = vid_parser_.GetOffset(vid);
@@ -624,6 +655,11 @@ class ArrowFragment
 
   inline raw_adj_list_t GetOutgoingRawAdjList(const vertex_t& v,
                                               label_id_t e_label) const {
+    ensureEdgeLabel(e_label);
+    if (compressed_) {
+      return raw_adj_list_t(
+          decodeAdjList(GetOutgoingCompressedAdjList(v, e_label)));
+    }
     vid_t vid = v.GetValue();
     label_id_t v_label = vid_parser_.GetLabelId(vid);
     int64_t v_offset = vid_parser_.GetOffset(vid);
@@ -633,12 +669,120 @@ class ArrowFragment
                           &oe[offset_array[v_offset + 1]]);
   }
 
+  /**
+   * @brief The incoming edges of the vertex in both the base CSR and the delta
+   * CSR, see also `AddDeltaEdges`.
+   */
+  inline merged_adj_list_t GetIncomingMergedAdjList(const vertex_t& v,
+                                                    label_id_t e_label) const {
+    ensureEdgeLabel(e_label);
+    vid_t vid = v.GetValue();
+    label_id_t v_label = vid_parser_.GetLabelId(vid);
+    int64_t v_offset = vid_parser_.GetOffset(vid);
+    const int64_t* offset_array = delta_ie_offsets_ptr_lists_[v_label][e_label];
+    const nbr_unit_t* ie = delta_ie_ptr_lists_[v_label][e_label];
+    if (offset_array == nullptr) {
+      return merged_adj_list_t(GetIncomingAdjList(v, e_label), adj_list_t(),
+                               flatten_edge_tables_columns_[e_label], nullptr);
+    }
+    return merged_adj_list_t(
+        GetIncomingAdjList(v, e_label),
+        adj_list_t(&ie[offset_array[v_offset]], &ie[offset_array[v_offset + 1]],
+                   flatten_delta_edge_tables_columns_[e_label]),
+        flatten_edge_tables_columns_[e_label],
+        flatten_delta_edge_tables_columns_[e_label]);
+  }
+
+  /**
+   * @brief The outgoing edges of the vertex in both the base CSR and the delta
+   * CSR, see also `AddDeltaEdges`.
+   */
+  inline merged_adj_list_t GetOutgoingMergedAdjList(const vertex_t& v,
+                                                    label_id_t e_label) const {
+    ensureEdgeLabel(e_label);
+    vid_t vid = v.GetValue();
+    label_id_t v_label = vid_parser_.GetLabelId(vid);
+    int64_t v_offset = vid_parser_.GetOffset(vid);
+    const int64_t* offset_array = delta_oe_offsets_ptr_lists_[v_label][e_label];
+    const nbr_unit_t* oe = delta_oe_ptr_lists_[v_label][e_label];
+    if (offset_array == nullptr) {
+      return merged_adj_list_t(GetOutgoingAdjList(v, e_label), adj_list_t(),
+                               flatten_edge_tables_columns_[e_label], nullptr);
+    }
+    return merged_adj_list_t(
+        GetOutgoingAdjList(v, e_label),
+        adj_list_t(&oe[offset_array[v_offset]], &oe[offset_array[v_offset + 1]],
+                   flatten_delta_edge_tables_columns_[e_label]),
+        flatten_edge_tables_columns_[e_label],
+        flatten_delta_edge_tables_columns_[e_label]);
+  }
+
+  /**
+   * @brief The incoming edges of the vertex in the compressed CSR, which are
+   * decoded block by block while iterating, whereas `GetIncomingAdjList`
+   * decodes the whole list to a buffer when the edges are compressed.
+   */
+  inline compressed_adj_list_t GetIncomingCompressedAdjList(
+      const vertex_t& v, label_id_t e_label) const {
+    ensureEdgeLabel(e_label);
+    vid_t vid = v.GetValue();
+    label_id_t v_label = vid_parser_.GetLabelId(vid);
+    int64_t v_offset = vid_parser_.GetOffset(vid);
+    const int64_t* offset_array = ie_offsets_ptr_lists_[v_label][e_label];
+    const int64_t* packed_offset_array =
+        ie_packed_offsets_ptr_lists_[v_label][e_label];
+    const uint8_t* ie = ie_packed_ptr_lists_[v_label][e_label];
+    return compressed_adj_list_t(
+        &ie[packed_offset_array[v_offset]],
+        offset_array[v_offset + 1] - offset_array[v_offset],
+        flatten_edge_tables_columns_[e_label]);
+  }
+
+  /**
+   * @brief The outgoing edges of the vertex in the compressed CSR, which are
+   * decoded block by block while iterating, whereas `GetOutgoingAdjList`
+   * decodes the whole list to a buffer when the edges are compressed.
+   */
+  inline compressed_adj_list_t GetOutgoingCompressedAdjList(
+      const vertex_t& v, label_id_t e_label) const {
+    ensureEdgeLabel(e_label);
+    vid_t vid = v.GetValue();
+    label_id_t v_label = vid_parser_.GetLabelId(vid);
+    int64_t v_offset = vid_parser_.GetOffset(vid);
+    const int64_t* offset_array = oe_offsets_ptr_lists_[v_label][e_label];
+    const int64_t* packed_offset_array =
+        oe_packed_offsets_ptr_lists_[v_label][e_label];
+    const uint8_t* oe = oe_packed_ptr_lists_[v_label][e_label];
+    return compressed_adj_list_t(
+        &oe[packed_offset_array[v_offset]],
+        offset_array[v_offset + 1] - offset_array[v_offset],
+        flatten_edge_tables_columns_[e_label]);
+  }
+
+  /**
+   * @brief Whether the adjacent lists are compressed, see also
+   * `GetOutgoingCompressedAdjList` and `GetIncomingCompressedAdjList`.
+   */
+  bool compressed_edges() const { return compressed_; }
+
+  /**
+   * @brief Whether there are delta edges that haven't been compacted into the
+   * base CSR.
+   */
+  bool has_delta_edges() const { return has_delta_; }
+
+  std::shared_ptr<arrow::Table> delta_edge_data_table(label_id_t i) const {
+    ensureEdgeLabel(i);
+    return delta_edge_tables_[i];
+  }
+
   /**
    * N.B.: as an temporary solution, for POC of graph-learn, will be removed
    * later.
    */
   inline std::pair<int64_t, int64_t> GetOutgoingAdjOffsets(
       const vertex_t& v, label_id_t e_label) const {
+    ensureEdgeLabel(e_label);
     vid_t vid = v.GetValue();
     label_id_t v_label = vid_parser_.GetLabelId(vid);
     int64_t v_offset = vid_parser_.GetOffset(vid);
@@ -677,6 +821,11 @@ class ArrowFragment
 
   const PropertyGraphSchema& schema() const override { return schema_; }
 
+  /**
+   * The destination fragments of `IEDests`, `OEDests` and `IOEDests` are
+   * collected from the merged adjacent lists, thus the messages sent along
+   * either the base edges or the delta edges reach all their fragments.
+   */
   void PrepareToRunApp(grape::MessageStrategy strategy, bool need_split_edges) {
     if (strategy == grape::MessageStrategy::kAlongEdgeToOuterVertex) {
       initDestFidList(true, true, iodst_, iodoffset_);
@@ -851,6 +1000,15 @@ class ArrowFragment
       const std::vector<std::set<std::pair<std::string, std::string>>>&
           edge_relations,
       int concurrency) {
+    if (has_delta_) {
+      RETURN_GS_ERROR(ErrorCode::kInvalidOperationError,
+                      "The delta edges must be compacted before adding labels");
+    }
+    if (compressed_) {
+      RETURN_GS_ERROR(ErrorCode::kInvalidOperationError,
+                      "Cannot add labels to fragments with compressed edges");
+    }
+    ensureAllLabels();
     int extra_vertex_label_num = vertex_tables.size();
     int total_vertex_label_num = vertex_label_num_ + extra_vertex_label_num;
     int extra_edge_label_num = edge_tables.size();
@@ -1131,18 +1289,18 @@ class ArrowFragment
         // Process v_num...total_v_num  X  0...e_num  part.
         if (directed_) {
           // Process 0...total_v_num  X  e_num...total_e_num  part.
-          generate_directed_csr<vid_t, eid_t>(
+          generate_csr_by_partition<vid_t, eid_t>(
               vid_parser_, edge_src[cur_label_index], edge_dst[cur_label_index],
-              tvnums, total_vertex_label_num, concurrency, sub_oe_lists,
+              tvnums, total_vertex_label_num, concurrency, false, sub_oe_lists,
               sub_oe_offset_lists);
-          generate_directed_csr<vid_t, eid_t>(
+          generate_csr_by_partition<vid_t, eid_t>(
               vid_parser_, edge_dst[cur_label_index], edge_src[cur_label_index],
-              tvnums, total_vertex_label_num, concurrency, sub_ie_lists,
+              tvnums, total_vertex_label_num, concurrency, false, sub_ie_lists,
               sub_ie_offset_lists);
         } else {
-          generate_undirected_csr<vid_t, eid_t>(
+          generate_csr_by_partition<vid_t, eid_t>(
               vid_parser_, edge_src[cur_label_index], edge_dst[cur_label_index],
-              tvnums, total_vertex_label_num, concurrency, sub_oe_lists,
+              tvnums, total_vertex_label_num, concurrency, true, sub_oe_lists,
               sub_oe_offset_lists);
         }
       }
@@ -1400,6 +1558,15 @@ class ArrowFragment
       Client& client,
       std::vector<std::shared_ptr<arrow::Table>>&& vertex_tables,
       ObjectID vm_id) {
+    if (has_delta_) {
+      RETURN_GS_ERROR(ErrorCode::kInvalidOperationError,
+                      "The delta edges must be compacted before adding labels");
+    }
+    if (compressed_) {
+      RETURN_GS_ERROR(ErrorCode::kInvalidOperationError,
+                      "Cannot add labels to fragments with compressed edges");
+    }
+    ensureAllLabels();
     int extra_vertex_label_num = vertex_tables.size();
     int total_vertex_label_num = vertex_label_num_ + extra_vertex_label_num;
 
@@ -1639,6 +1806,15 @@ class ArrowFragment
       const std::vector<std::set<std::pair<std::string, std::string>>>&
           edge_relations,
       int concurrency) {
+    if (has_delta_) {
+      RETURN_GS_ERROR(ErrorCode::kInvalidOperationError,
+                      "The delta edges must be compacted before adding labels");
+    }
+    if (compressed_) {
+      RETURN_GS_ERROR(ErrorCode::kInvalidOperationError,
+                      "Cannot add labels to fragments with compressed edges");
+    }
+    ensureAllLabels();
     int extra_edge_label_num = edge_tables.size();
     int total_edge_label_num = edge_label_num_ + extra_edge_label_num;
     // Newly constructed data structures
@@ -1855,16 +2031,19 @@ class ArrowFragment
       std::vector<std::shared_ptr<arrow::Int64Array>> sub_oe_offset_lists(
           vertex_label_num_);
       if (directed_) {
-        generate_directed_csr<vid_t, eid_t>(
+        generate_csr_by_partition<vid_t, eid_t>(
             vid_parser_, edge_src[e_label], edge_dst[e_label], tvnums,
-            vertex_label_num_, concurrency, sub_oe_lists, sub_oe_offset_lists);
-        generate_directed_csr<vid_t, eid_t>(
+            vertex_label_num_, concurrency, false, sub_oe_lists,
+            sub_oe_offset_lists);
+        generate_csr_by_partition<vid_t, eid_t>(
             vid_parser_, edge_dst[e_label], edge_src[e_label], tvnums,
-            vertex_label_num_, concurrency, sub_ie_lists, sub_ie_offset_lists);
+            vertex_label_num_, concurrency, false, sub_ie_lists,
+            sub_ie_offset_lists);
       } else {
-        generate_undirected_csr<vid_t, eid_t>(
+        generate_csr_by_partition<vid_t, eid_t>(
             vid_parser_, edge_src[e_label], edge_dst[e_label], tvnums,
-            vertex_label_num_, concurrency, sub_oe_lists, sub_oe_offset_lists);
+            vertex_label_num_, concurrency, true, sub_oe_lists,
+            sub_oe_offset_lists);
       }
 
       for (label_id_t v_label = 0; v_label < vertex_label_num_; ++v_label) {
@@ -2072,95 +2251,641 @@ class ArrowFragment
     return ret;
   }
 
-  template <typename ArrayType = arrow::Array>
-  boost::leaf::result<vineyard::ObjectID> AddVertexColumnsImpl(
-      vineyard::Client& client,
-      const std::map<
-          label_id_t,
-          std::vector<std::pair<std::string, std::shared_ptr<ArrayType>>>>
-          columns) {
-    vineyard::ObjectMeta old_meta, new_meta;
-    VINEYARD_CHECK_OK(client.GetMetaData(this->id_, old_meta));
+  /**
+   * @brief Adds new edges of the existing edge labels as delta edges.
+   *
+   * The delta edges land in a small CSR overlay, i.e., the delta CSR and the
+   * delta edge tables, while the CSR blobs of this fragment are shared with
+   * the new fragment as they are. The delta edges are visible through
+   * `GetOutgoingMergedAdjList` and `GetIncomingMergedAdjList`, and are folded
+   * into the base CSR by `CompactDeltaEdges`.
+   *
+   * Each table consists of the gids of the source and destination vertices,
+   * followed by the properties of the edge label.
+   */
+  boost::leaf::result<ObjectID> AddDeltaEdges(
+      Client& client,
+      std::map<label_id_t, std::shared_ptr<arrow::Table>>&& edge_tables_map,
+      int concurrency) {
+    if (compressed_) {
+      RETURN_GS_ERROR(ErrorCode::kInvalidOperationError,
+                      "Cannot add delta edges to fragments with compressed "
+                      "edges");
+    }
+    ensureAllLabels();
+    std::vector<std::shared_ptr<arrow::Table>> edge_tables(edge_label_num_);
+    for (auto& pair : edge_tables_map) {
+      label_id_t e_label = pair.first;
+      if (e_label < 0 || e_label >= edge_label_num_) {
+        RETURN_GS_ERROR(ErrorCode::kInvalidValueError,
+                        "Invalid edge label id: " + std::to_string(e_label));
+      }
+      auto table = pair.second;
+      auto base_table = edge_tables_[e_label];
+      bool matched = table->num_columns() == base_table->num_columns() + 2;
+      for (int k = 0; matched && k < base_table->num_columns(); ++k) {
+        matched = table->field(k + 2)->type()->Equals(
+            base_table->field(k)->type());
+      }
+      if (!matched) {
+        RETURN_GS_ERROR(ErrorCode::kInvalidValueError,
+                        "The properties of delta edges don't match the ones "
+                        "of edge label " +
+                            std::to_string(e_label));
+      }
+      if (table->num_rows() == 0) {
+        continue;
+      }
+#if defined(ARROW_VERSION) && ARROW_VERSION < 17000
+      ARROW_OK_OR_RAISE(table->CombineChunks(arrow::default_memory_pool(),
+                                             &edge_tables[e_label]));
+#else
+      ARROW_OK_ASSIGN_OR_RAISE(
+          edge_tables[e_label],
+          table->CombineChunks(arrow::default_memory_pool()));
+#endif
+    }
 
-    new_meta.SetTypeName(type_name<ArrowFragment<oid_t, vid_t>>());
-    new_meta.AddKeyValue("fid", fid_);
-    new_meta.AddKeyValue("fnum", fnum_);
-    new_meta.AddKeyValue("directed", static_cast<int>(directed_));
-    new_meta.AddKeyValue("oid_type", TypeName<oid_t>::Get());
-    new_meta.AddKeyValue("vid_type", TypeName<vid_t>::Get());
-    new_meta.AddKeyValue("vertex_label_num", vertex_label_num_);
-    new_meta.AddKeyValue("edge_label_num", edge_label_num_);
+    // Collect the outer vertices pulled in by the delta edges.
+    std::vector<std::vector<vid_t>> extra_ovgids(vertex_label_num_);
+    for (auto const& table : edge_tables) {
+      if (table == nullptr) {
+        continue;
+      }
+      for (int col = 0; col < 2; ++col) {
+        auto gid_array = std::dynamic_pointer_cast<vid_array_t>(
+            table->column(col)->chunk(0));
+        const vid_t* arr = gid_array->raw_values();
+        for (int64_t k = 0; k < gid_array->length(); ++k) {
+          label_id_t label_id = vid_parser_.GetLabelId(arr[k]);
+          auto cur_map = ovg2l_maps_ptr_[label_id];
+          if (vid_parser_.GetFid(arr[k]) != fid_ &&
+              cur_map->find(arr[k]) == cur_map->end()) {
+            extra_ovgids[label_id].push_back(arr[k]);
+          }
+        }
+      }
+    }
 
-    auto schema = schema_;
+    std::vector<vid_t> start_ids(vertex_label_num_);
+    std::vector<ska::flat_hash_map<vid_t, vid_t>> ovg2l_maps(vertex_label_num_);
     for (label_id_t i = 0; i < vertex_label_num_; ++i) {
-      std::string table_name = generate_name_with_suffix("vertex_tables", i);
-      if (columns.find(i) != columns.end()) {
-        std::shared_ptr<vineyard::Table> old_table =
-            std::make_shared<vineyard::Table>();
-        old_table->Construct(old_meta.GetMemberMeta(table_name));
-        prop_id_t old_prop_num = old_table->num_columns();
-        vineyard::TableExtender extender(client, old_table);
-        auto& vec = columns.at(i);
-        for (auto& pair : vec) {
-          auto status = extender.AddColumn(client, pair.first, pair.second);
-          CHECK(status.ok());
-        }
-        std::shared_ptr<vineyard::Table> new_table =
-            std::dynamic_pointer_cast<vineyard::Table>(extender.Seal(client));
-        new_meta.AddMember(table_name, new_table->meta());
-        std::shared_ptr<arrow::Table> arrow_table = new_table->GetTable();
-        GENERATE_TABLE_META("vertex", i, arrow_table);
-        auto label =
-            old_meta.GetKeyValue("vertex_label_name_" + std::to_string(i));
-        auto& entry = schema.GetMutableEntry(label, "VERTEX");
-        prop_id_t prop_num = arrow_table->num_columns();
-        for (prop_id_t j = old_prop_num; j < prop_num; ++j) {
-          entry.AddProperty(arrow_table->field(j)->name(),
-                            arrow_table->field(j)->type());
-        }
-      } else {
-        GENERATE_TABLE_META("vertex", i, this->vertex_tables_[i]);
-        new_meta.AddMember(table_name, old_meta.GetMemberMeta(table_name));
+      start_ids[i] = vid_parser_.GenerateId(0, i, ivnums_[i]) + ovnums_[i];
+      for (auto iter = ovg2l_maps_ptr_[i]->begin();
+           iter != ovg2l_maps_ptr_[i]->end(); ++iter) {
+        ovg2l_maps[i].emplace(iter->first, iter->second);
       }
     }
-    if (!schema.Validate()) {
-      RETURN_GS_ERROR(ErrorCode::kInvalidValueError, "Invalid schema.");
+    std::vector<std::shared_ptr<vid_array_t>> extra_ovgid_lists(
+        vertex_label_num_);
+    BOOST_LEAF_CHECK(generate_outer_vertices_map(extra_ovgids, start_ids,
+                                                 vertex_label_num_, ovg2l_maps,
+                                                 extra_ovgid_lists));
+    extra_ovgids.clear();
+
+    // Only the vertex labels that have extra outer vertices get new ovgid
+    // lists and ovg2l maps.
+    bool has_extra_outer_vertices = false;
+    std::vector<std::shared_ptr<vid_array_t>> ovgid_lists(vertex_label_num_);
+    std::vector<vid_t> ovnums(vertex_label_num_), tvnums(vertex_label_num_);
+    for (label_id_t i = 0; i < vertex_label_num_; ++i) {
+      if (extra_ovgid_lists[i]->length() > 0) {
+        has_extra_outer_vertices = true;
+        vid_builder_t ovgid_list_builder;
+        ARROW_OK_OR_RAISE(ovgid_list_builder.AppendValues(
+            ovgid_lists_[i]->raw_values(), ovgid_lists_[i]->length()));
+        ARROW_OK_OR_RAISE(ovgid_list_builder.AppendValues(
+            extra_ovgid_lists[i]->raw_values(),
+            extra_ovgid_lists[i]->length()));
+        ARROW_OK_OR_RAISE(ovgid_list_builder.Finish(&ovgid_lists[i]));
+      }
+      ovnums[i] = ovnums_[i] + extra_ovgid_lists[i]->length();
+      tvnums[i] = ivnums_[i] + ovnums[i];
     }
-    new_meta.AddKeyValue("schema", schema.ToJSONString());
 
-    size_t nbytes = 0;
-    new_meta.AddMember("ivnums", old_meta.GetMemberMeta("ivnums"));
-    nbytes += old_meta.GetMemberMeta("ivnums").GetNBytes();
-    new_meta.AddMember("ovnums", old_meta.GetMemberMeta("ovnums"));
-    nbytes += old_meta.GetMemberMeta("ovnums").GetNBytes();
-    new_meta.AddMember("tvnums", old_meta.GetMemberMeta("tvnums"));
-    nbytes += old_meta.GetMemberMeta("tvnums").GetNBytes();
+    // Build the delta CSR of the new edges, and merge it with the existing
+    // delta CSR of the edge label, if any.
+    std::vector<std::vector<std::shared_ptr<arrow::FixedSizeBinaryArray>>>
+        ie_lists, oe_lists;
+    std::vector<std::vector<std::shared_ptr<arrow::Int64Array>>>
+        ie_offsets_lists, oe_offsets_lists;
+    resizeListsVector(ie_lists);
+    resizeListsVector(oe_lists);
+    resizeListsVector(ie_offsets_lists);
+    resizeListsVector(oe_offsets_lists);
+    std::vector<std::shared_ptr<arrow::Table>> delta_tables(edge_label_num_);
+    for (label_id_t j = 0; j < edge_label_num_; ++j) {
+      if (edge_tables[j] == nullptr) {
+        continue;
+      }
+      std::shared_ptr<vid_array_t> edge_src, edge_dst;
+      BOOST_LEAF_CHECK(generate_local_id_list(
+          vid_parser_,
+          std::dynamic_pointer_cast<vid_array_t>(
+              edge_tables[j]->column(0)->chunk(0)),
+          fid_, ovg2l_maps, concurrency, edge_src));
+      BOOST_LEAF_CHECK(generate_local_id_list(
+          vid_parser_,
+          std::dynamic_pointer_cast<vid_array_t>(
+              edge_tables[j]->column(1)->chunk(0)),
+          fid_, ovg2l_maps, concurrency, edge_dst));
+      std::shared_ptr<arrow::Table> tmp_table0, table;
+#if defined(ARROW_VERSION) && ARROW_VERSION < 17000
+      ARROW_OK_OR_RAISE(edge_tables[j]->RemoveColumn(0, &tmp_table0));
+      ARROW_OK_OR_RAISE(tmp_table0->RemoveColumn(0, &table));
+#else
+      ARROW_OK_ASSIGN_OR_RAISE(tmp_table0, edge_tables[j]->RemoveColumn(0));
+      ARROW_OK_ASSIGN_OR_RAISE(table, tmp_table0->RemoveColumn(0));
+#endif
 
-    ASSIGN_IDENTICAL_VEC_META("ovgid_lists", vertex_label_num_);
-    ASSIGN_IDENTICAL_VEC_META("ovg2l_maps", vertex_label_num_);
-    ASSIGN_IDENTICAL_VEC_META("edge_tables", edge_label_num_);
+      std::vector<std::shared_ptr<arrow::FixedSizeBinaryArray>> sub_ie_lists(
+          vertex_label_num_);
+      std::vector<std::shared_ptr<arrow::FixedSizeBinaryArray>> sub_oe_lists(
+          vertex_label_num_);
+      std::vector<std::shared_ptr<arrow::Int64Array>> sub_ie_offset_lists(
+          vertex_label_num_);
+      std::vector<std::shared_ptr<arrow::Int64Array>> sub_oe_offset_lists(
+          vertex_label_num_);
+      if (directed_) {
+        BOOST_LEAF_CHECK(generate_csr_by_partition<vid_t, eid_t>(
+            vid_parser_, edge_src, edge_dst, tvnums, vertex_label_num_,
+            concurrency, false, sub_oe_lists, sub_oe_offset_lists));
+        BOOST_LEAF_CHECK(generate_csr_by_partition<vid_t, eid_t>(
+            vid_parser_, edge_dst, edge_src, tvnums, vertex_label_num_,
+            concurrency, false, sub_ie_lists, sub_ie_offset_lists));
+      } else {
+        BOOST_LEAF_CHECK(generate_csr_by_partition<vid_t, eid_t>(
+            vid_parser_, edge_src, edge_dst, tvnums, vertex_label_num_,
+            concurrency, true, sub_oe_lists, sub_oe_offset_lists));
+      }
 
-    GENERATE_TABLE_VEC_META("edge", 0, edge_label_num_, this->edge_tables_);
+      if (delta_edge_tables_[j] == nullptr) {
+        for (label_id_t i = 0; i < vertex_label_num_; ++i) {
+          if (directed_) {
+            ie_lists[i][j] = sub_ie_lists[i];
+            ie_offsets_lists[i][j] = sub_ie_offset_lists[i];
+          }
+          oe_lists[i][j] = sub_oe_lists[i];
+          oe_offsets_lists[i][j] = sub_oe_offset_lists[i];
+        }
+        delta_tables[j] = table;
+        continue;
+      }
 
-    if (directed_) {
-      ASSIGN_IDENTICAL_VEC_VEC_META("ie_lists", vertex_label_num_,
-                                    edge_label_num_);
-      ASSIGN_IDENTICAL_VEC_VEC_META("ie_offsets_lists", vertex_label_num_,
-                                    edge_label_num_);
+      // the new delta edges are appended to the existing delta edge table.
+      eid_t eid_shift = delta_edge_tables_[j]->num_rows();
+      for (label_id_t i = 0; i < vertex_label_num_; ++i) {
+        if (directed_) {
+          BOOST_LEAF_CHECK(merge_csr<vid_t, eid_t>(
+              delta_ie_offsets_ptr_lists_[i][j], tvnums_[i],
+              delta_ie_ptr_lists_[i][j], sub_ie_offset_lists[i]->raw_values(),
+              reinterpret_cast<const nbr_unit_t*>(
+                  sub_ie_lists[i]->GetValue(0)),
+              tvnums[i], eid_shift, concurrency, ie_lists[i][j],
+              ie_offsets_lists[i][j]));
+        }
+        BOOST_LEAF_CHECK(merge_csr<vid_t, eid_t>(
+            delta_oe_offsets_ptr_lists_[i][j], tvnums_[i],
+            delta_oe_ptr_lists_[i][j], sub_oe_offset_lists[i]->raw_values(),
+            reinterpret_cast<const nbr_unit_t*>(sub_oe_lists[i]->GetValue(0)),
+            tvnums[i], eid_shift, concurrency, oe_lists[i][j],
+            oe_offsets_lists[i][j]));
+      }
+      std::vector<std::shared_ptr<arrow::Table>> tables{delta_edge_tables_[j],
+                                                        table};
+      table = ConcatenateTables(tables);
+#if defined(ARROW_VERSION) && ARROW_VERSION < 17000
+      ARROW_OK_OR_RAISE(
+          table->CombineChunks(arrow::default_memory_pool(), &delta_tables[j]));
+#else
+      ARROW_OK_ASSIGN_OR_RAISE(
+          delta_tables[j], table->CombineChunks(arrow::default_memory_pool()));
+#endif
     }
-    ASSIGN_IDENTICAL_VEC_VEC_META("oe_lists", vertex_label_num_,
-                                  edge_label_num_);
-    ASSIGN_IDENTICAL_VEC_VEC_META("oe_offsets_lists", vertex_label_num_,
-                                  edge_label_num_);
-
-    new_meta.AddMember("vertex_map", old_meta.GetMemberMeta("vertex_map"));
 
-    new_meta.SetNBytes(nbytes);
+    vineyard::Array<vid_t> vy_ovnums, vy_tvnums;
+    std::vector<std::shared_ptr<vineyard::NumericArray<vid_t>>> vy_ovgid_lists(
+        vertex_label_num_);
+    std::vector<std::shared_ptr<vineyard::Hashmap<vid_t, vid_t>>> vy_ovg2l_maps(
+        vertex_label_num_);
+    std::vector<std::shared_ptr<vineyard::Table>> vy_delta_tables(
+        edge_label_num_);
+    std::vector<std::vector<std::shared_ptr<vineyard::FixedSizeBinaryArray>>>
+        vy_ie_lists, vy_oe_lists;
+    std::vector<std::vector<std::shared_ptr<vineyard::NumericArray<int64_t>>>>
+        vy_ie_offsets_lists, vy_oe_offsets_lists;
+    resizeListsVector(vy_ie_lists);
+    resizeListsVector(vy_oe_lists);
+    resizeListsVector(vy_ie_offsets_lists);
+    resizeListsVector(vy_oe_offsets_lists);
 
-    vineyard::ObjectID ret;
-    VINEYARD_CHECK_OK(client.CreateMetaData(new_meta, ret));
-    return ret;
-  }
+    ThreadGroup tg;
+    if (has_extra_outer_vertices) {
+      auto fn = [&vy_ovnums, &vy_tvnums, &ovnums, &tvnums](Client& client) {
+        vineyard::ArrayBuilder<vid_t> ovnums_builder(client, ovnums);
+        vineyard::ArrayBuilder<vid_t> tvnums_builder(client, tvnums);
+        vy_ovnums = *std::dynamic_pointer_cast<vineyard::Array<vid_t>>(
+            ovnums_builder.Seal(client));
+        vy_tvnums = *std::dynamic_pointer_cast<vineyard::Array<vid_t>>(
+            tvnums_builder.Seal(client));
+        return Status::OK();
+      };
+      tg.AddTask(fn, std::ref(client));
+    }
+    for (label_id_t i = 0; i < vertex_label_num_; ++i) {
+      if (ovgid_lists[i] == nullptr) {
+        continue;
+      }
+      auto fn = [i, &vy_ovgid_lists, &vy_ovg2l_maps, &ovgid_lists,
+                 &ovg2l_maps](Client& client) {
+        vineyard::NumericArrayBuilder<vid_t> ovgid_list_builder(client,
+                                                                ovgid_lists[i]);
+        vy_ovgid_lists[i] =
+            std::dynamic_pointer_cast<vineyard::NumericArray<vid_t>>(
+                ovgid_list_builder.Seal(client));
+
+        vineyard::HashmapBuilder<vid_t, vid_t> ovg2l_builder(
+            client, std::move(ovg2l_maps[i]));
+        vy_ovg2l_maps[i] =
+            std::dynamic_pointer_cast<vineyard::Hashmap<vid_t, vid_t>>(
+                ovg2l_builder.Seal(client));
+        return Status::OK();
+      };
+      tg.AddTask(fn, std::ref(client));
+    }
+    for (label_id_t j = 0; j < edge_label_num_; ++j) {
+      if (delta_tables[j] == nullptr) {
+        continue;
+      }
+      auto fn = [j, &vy_delta_tables, &delta_tables](Client& client) {
+        vineyard::TableBuilder builder(client, delta_tables[j]);
+        vy_delta_tables[j] =
+            std::dynamic_pointer_cast<vineyard::Table>(builder.Seal(client));
+        return Status::OK();
+      };
+      tg.AddTask(fn, std::ref(client));
+      for (label_id_t i = 0; i < vertex_label_num_; ++i) {
+        auto fn = [this, i, j, &vy_ie_lists, &vy_oe_lists, &vy_ie_offsets_lists,
+                   &vy_oe_offsets_lists, &ie_lists, &oe_lists,
+                   &ie_offsets_lists, &oe_offsets_lists](Client& client) {
+          if (directed_) {
+            sealCSR(client, ie_lists[i][j], ie_offsets_lists[i][j],
+                    vy_ie_lists[i][j], vy_ie_offsets_lists[i][j]);
+          }
+          sealCSR(client, oe_lists[i][j], oe_offsets_lists[i][j],
+                  vy_oe_lists[i][j], vy_oe_offsets_lists[i][j]);
+          return Status::OK();
+        };
+        tg.AddTask(fn, std::ref(client));
+      }
+    }
+    tg.TakeResults();
+
+    vineyard::ObjectMeta old_meta, new_meta;
+    VINEYARD_CHECK_OK(client.GetMetaData(this->id_, old_meta));
+
+    new_meta.SetTypeName(type_name<ArrowFragment<oid_t, vid_t>>());
+    new_meta.AddKeyValue("fid", fid_);
+    new_meta.AddKeyValue("fnum", fnum_);
+    new_meta.AddKeyValue("directed", static_cast<int>(directed_));
+    new_meta.AddKeyValue("oid_type", TypeName<oid_t>::Get());
+    new_meta.AddKeyValue("vid_type", TypeName<vid_t>::Get());
+    new_meta.AddKeyValue("vertex_label_num", vertex_label_num_);
+    new_meta.AddKeyValue("edge_label_num", edge_label_num_);
+    new_meta.AddKeyValue("schema", old_meta.GetKeyValue("schema"));
+
+    size_t nbytes = 0;
+    auto assign_identical = [&](const std::string& name) {
+      new_meta.AddMember(name, old_meta.GetMemberMeta(name));
+      nbytes += old_meta.GetMemberMeta(name).GetNBytes();
+    };
+    auto assign_new = [&](const std::string& name,
+                          const vineyard::Object& object) {
+      new_meta.AddMember(name, object.meta());
+      nbytes += object.nbytes();
+    };
+
+    assign_identical("ivnums");
+    if (has_extra_outer_vertices) {
+      assign_new("ovnums", vy_ovnums);
+      assign_new("tvnums", vy_tvnums);
+    } else {
+      assign_identical("ovnums");
+      assign_identical("tvnums");
+    }
+    for (label_id_t i = 0; i < vertex_label_num_; ++i) {
+      std::string ovgid_name = generate_name_with_suffix("ovgid_lists", i);
+      std::string ovg2l_name = generate_name_with_suffix("ovg2l_maps", i);
+      if (vy_ovgid_lists[i] != nullptr) {
+        assign_new(ovgid_name, *vy_ovgid_lists[i]);
+        assign_new(ovg2l_name, *vy_ovg2l_maps[i]);
+      } else {
+        assign_identical(ovgid_name);
+        assign_identical(ovg2l_name);
+      }
+    }
+
+    ASSIGN_IDENTICAL_VEC_META("vertex_tables", vertex_label_num_);
+    ASSIGN_IDENTICAL_VEC_META("edge_tables", edge_label_num_);
+    GENERATE_TABLE_VEC_META("vertex", 0, vertex_label_num_, vertex_tables_);
+    GENERATE_TABLE_VEC_META("edge", 0, edge_label_num_, edge_tables_);
+
+    if (directed_) {
+      ASSIGN_IDENTICAL_VEC_VEC_META("ie_lists", vertex_label_num_,
+                                    edge_label_num_);
+      ASSIGN_IDENTICAL_VEC_VEC_META("ie_offsets_lists", vertex_label_num_,
+                                    edge_label_num_);
+    }
+    ASSIGN_IDENTICAL_VEC_VEC_META("oe_lists", vertex_label_num_,
+                                  edge_label_num_);
+    ASSIGN_IDENTICAL_VEC_VEC_META("oe_offsets_lists", vertex_label_num_,
+                                  edge_label_num_);
+
+    for (label_id_t j = 0; j < edge_label_num_; ++j) {
+      if (vy_delta_tables[j] == nullptr) {
+        assignDeltaEdgesMeta(j, old_meta, new_meta, nbytes);
+        continue;
+      }
+      assign_new(generate_name_with_suffix("delta_edge_tables", j),
+                 *vy_delta_tables[j]);
+      for (label_id_t i = 0; i < vertex_label_num_; ++i) {
+        if (directed_) {
+          assign_new(generate_name_with_suffix("delta_ie_lists", i, j),
+                     *vy_ie_lists[i][j]);
+          assign_new(generate_name_with_suffix("delta_ie_offsets_lists", i, j),
+                     *vy_ie_offsets_lists[i][j]);
+        }
+        assign_new(generate_name_with_suffix("delta_oe_lists", i, j),
+                   *vy_oe_lists[i][j]);
+        assign_new(generate_name_with_suffix("delta_oe_offsets_lists", i, j),
+                   *vy_oe_offsets_lists[i][j]);
+      }
+    }
+
+    new_meta.AddMember("vertex_map", old_meta.GetMemberMeta("vertex_map"));
+
+    new_meta.SetNBytes(nbytes);
+
+    vineyard::ObjectID ret;
+    VINEYARD_CHECK_OK(client.CreateMetaData(new_meta, ret));
+    return ret;
+  }
+
+  /**
+   * @brief Folds the delta CSR into the base CSR, and appends the delta edge
+   * tables to the edge tables, i.e., the edge ids of the delta edges are
+   * shifted by the number of rows of the edge tables.
+   *
+   * This fragment itself is not modified, thus the compaction can run in the
+   * background while this fragment keeps serving, and the compacted fragment
+   * takes its place once it is ready. The CSR blobs of the edge labels
+   * without delta edges are shared with the compacted fragment.
+   */
+  boost::leaf::result<ObjectID> CompactDeltaEdges(Client& client,
+                                                  int concurrency) {
+    if (!has_delta_) {
+      return this->id_;
+    }
+    ensureAllLabels();
+
+    std::vector<std::vector<std::shared_ptr<arrow::FixedSizeBinaryArray>>>
+        ie_lists, oe_lists;
+    std::vector<std::vector<std::shared_ptr<arrow::Int64Array>>>
+        ie_offsets_lists, oe_offsets_lists;
+    resizeListsVector(ie_lists);
+    resizeListsVector(oe_lists);
+    resizeListsVector(ie_offsets_lists);
+    resizeListsVector(oe_offsets_lists);
+    std::vector<std::shared_ptr<arrow::Table>> edge_tables(edge_label_num_);
+    for (label_id_t j = 0; j < edge_label_num_; ++j) {
+      if (delta_edge_tables_[j] == nullptr) {
+        continue;
+      }
+      eid_t eid_shift = edge_tables_[j]->num_rows();
+      for (label_id_t i = 0; i < vertex_label_num_; ++i) {
+        if (directed_) {
+          BOOST_LEAF_CHECK(merge_csr<vid_t, eid_t>(
+              ie_offsets_ptr_lists_[i][j], tvnums_[i], ie_ptr_lists_[i][j],
+              delta_ie_offsets_ptr_lists_[i][j], delta_ie_ptr_lists_[i][j],
+              tvnums_[i], eid_shift, concurrency, ie_lists[i][j],
+              ie_offsets_lists[i][j]));
+        }
+        BOOST_LEAF_CHECK(merge_csr<vid_t, eid_t>(
+            oe_offsets_ptr_lists_[i][j], tvnums_[i], oe_ptr_lists_[i][j],
+            delta_oe_offsets_ptr_lists_[i][j], delta_oe_ptr_lists_[i][j],
+            tvnums_[i], eid_shift, concurrency, oe_lists[i][j],
+            oe_offsets_lists[i][j]));
+      }
+      std::vector<std::shared_ptr<arrow::Table>> tables{edge_tables_[j],
+                                                        delta_edge_tables_[j]};
+      auto table = ConcatenateTables(tables);
+#if defined(ARROW_VERSION) && ARROW_VERSION < 17000
+      ARROW_OK_OR_RAISE(
+          table->CombineChunks(arrow::default_memory_pool(), &edge_tables[j]));
+#else
+      ARROW_OK_ASSIGN_OR_RAISE(
+          edge_tables[j], table->CombineChunks(arrow::default_memory_pool()));
+#endif
+    }
+
+    std::vector<std::shared_ptr<vineyard::Table>> vy_edge_tables(
+        edge_label_num_);
+    std::vector<std::vector<std::shared_ptr<vineyard::FixedSizeBinaryArray>>>
+        vy_ie_lists, vy_oe_lists;
+    std::vector<std::vector<std::shared_ptr<vineyard::NumericArray<int64_t>>>>
+        vy_ie_offsets_lists, vy_oe_offsets_lists;
+    resizeListsVector(vy_ie_lists);
+    resizeListsVector(vy_oe_lists);
+    resizeListsVector(vy_ie_offsets_lists);
+    resizeListsVector(vy_oe_offsets_lists);
+
+    ThreadGroup tg;
+    for (label_id_t j = 0; j < edge_label_num_; ++j) {
+      if (edge_tables[j] == nullptr) {
+        continue;
+      }
+      auto fn = [j, &vy_edge_tables, &edge_tables](Client& client) {
+        vineyard::TableBuilder builder(client, edge_tables[j]);
+        vy_edge_tables[j] =
+            std::dynamic_pointer_cast<vineyard::Table>(builder.Seal(client));
+        return Status::OK();
+      };
+      tg.AddTask(fn, std::ref(client));
+      for (label_id_t i = 0; i < vertex_label_num_; ++i) {
+        auto fn = [this, i, j, &vy_ie_lists, &vy_oe_lists, &vy_ie_offsets_lists,
+                   &vy_oe_offsets_lists, &ie_lists, &oe_lists,
+                   &ie_offsets_lists, &oe_offsets_lists](Client& client) {
+          if (directed_) {
+            sealCSR(client, ie_lists[i][j], ie_offsets_lists[i][j],
+                    vy_ie_lists[i][j], vy_ie_offsets_lists[i][j]);
+          }
+          sealCSR(client, oe_lists[i][j], oe_offsets_lists[i][j],
+                  vy_oe_lists[i][j], vy_oe_offsets_lists[i][j]);
+          return Status::OK();
+        };
+        tg.AddTask(fn, std::ref(client));
+      }
+    }
+    tg.TakeResults();
+
+    vineyard::ObjectMeta old_meta, new_meta;
+    VINEYARD_CHECK_OK(client.GetMetaData(this->id_, old_meta));
+
+    new_meta.SetTypeName(type_name<ArrowFragment<oid_t, vid_t>>());
+    new_meta.AddKeyValue("fid", fid_);
+    new_meta.AddKeyValue("fnum", fnum_);
+    new_meta.AddKeyValue("directed", static_cast<int>(directed_));
+    new_meta.AddKeyValue("oid_type", TypeName<oid_t>::Get());
+    new_meta.AddKeyValue("vid_type", TypeName<vid_t>::Get());
+    new_meta.AddKeyValue("vertex_label_num", vertex_label_num_);
+    new_meta.AddKeyValue("edge_label_num", edge_label_num_);
+    new_meta.AddKeyValue("schema", old_meta.GetKeyValue("schema"));
+
+    size_t nbytes = 0;
+    auto assign_identical = [&](const std::string& name) {
+      new_meta.AddMember(name, old_meta.GetMemberMeta(name));
+      nbytes += old_meta.GetMemberMeta(name).GetNBytes();
+    };
+    auto assign_new = [&](const std::string& name,
+                          const vineyard::Object& object) {
+      new_meta.AddMember(name, object.meta());
+      nbytes += object.nbytes();
+    };
+
+    assign_identical("ivnums");
+    assign_identical("ovnums");
+    assign_identical("tvnums");
+    ASSIGN_IDENTICAL_VEC_META("ovgid_lists", vertex_label_num_);
+    ASSIGN_IDENTICAL_VEC_META("ovg2l_maps", vertex_label_num_);
+    ASSIGN_IDENTICAL_VEC_META("vertex_tables", vertex_label_num_);
+    GENERATE_TABLE_VEC_META("vertex", 0, vertex_label_num_, vertex_tables_);
+    GENERATE_TABLE_VEC_META("edge", 0, edge_label_num_, edge_tables_);
+
+    for (label_id_t j = 0; j < edge_label_num_; ++j) {
+      std::string table_name = generate_name_with_suffix("edge_tables", j);
+      if (vy_edge_tables[j] == nullptr) {
+        assign_identical(table_name);
+      } else {
+        assign_new(table_name, *vy_edge_tables[j]);
+      }
+      for (label_id_t i = 0; i < vertex_label_num_; ++i) {
+        std::string ie_name = generate_name_with_suffix("ie_lists", i, j);
+        std::string ieo_name =
+            generate_name_with_suffix("ie_offsets_lists", i, j);
+        std::string oe_name = generate_name_with_suffix("oe_lists", i, j);
+        std::string oeo_name =
+            generate_name_with_suffix("oe_offsets_lists", i, j);
+        if (vy_edge_tables[j] == nullptr) {
+          if (directed_) {
+            assign_identical(ie_name);
+            assign_identical(ieo_name);
+          }
+          assign_identical(oe_name);
+          assign_identical(oeo_name);
+        } else {
+          if (directed_) {
+            assign_new(ie_name, *vy_ie_lists[i][j]);
+            assign_new(ieo_name, *vy_ie_offsets_lists[i][j]);
+          }
+          assign_new(oe_name, *vy_oe_lists[i][j]);
+          assign_new(oeo_name, *vy_oe_offsets_lists[i][j]);
+        }
+      }
+    }
+
+    new_meta.AddMember("vertex_map", old_meta.GetMemberMeta("vertex_map"));
+
+    new_meta.SetNBytes(nbytes);
+
+    vineyard::ObjectID ret;
+    VINEYARD_CHECK_OK(client.CreateMetaData(new_meta, ret));
+    return ret;
+  }
+
+  template <typename ArrayType = arrow::Array>
+  boost::leaf::result<vineyard::ObjectID> AddVertexColumnsImpl(
+      vineyard::Client& client,
+      const std::map<
+          label_id_t,
+          std::vector<std::pair<std::string, std::shared_ptr<ArrayType>>>>
+          columns) {
+    ensureAllLabels();
+    vineyard::ObjectMeta old_meta, new_meta;
+    VINEYARD_CHECK_OK(client.GetMetaData(this->id_, old_meta));
+
+    new_meta.SetTypeName(type_name<ArrowFragment<oid_t, vid_t>>());
+    new_meta.AddKeyValue("fid", fid_);
+    new_meta.AddKeyValue("fnum", fnum_);
+    new_meta.AddKeyValue("directed", static_cast<int>(directed_));
+    new_meta.AddKeyValue("oid_type", TypeName<oid_t>::Get());
+    new_meta.AddKeyValue("vid_type", TypeName<vid_t>::Get());
+    new_meta.AddKeyValue("vertex_label_num", vertex_label_num_);
+    new_meta.AddKeyValue("edge_label_num", edge_label_num_);
+
+    auto schema = schema_;
+    for (label_id_t i = 0; i < vertex_label_num_; ++i) {
+      std::string table_name = generate_name_with_suffix("vertex_tables", i);
+      if (columns.find(i) != columns.end()) {
+        std::shared_ptr<vineyard::Table> old_table =
+            std::make_shared<vineyard::Table>();
+        old_table->Construct(old_meta.GetMemberMeta(table_name));
+        prop_id_t old_prop_num = old_table->num_columns();
+        vineyard::TableExtender extender(client, old_table);
+        auto& vec = columns.at(i);
+        for (auto& pair : vec) {
+          auto status = extender.AddColumn(client, pair.first, pair.second);
+          CHECK(status.ok());
+        }
+        std::shared_ptr<vineyard::Table> new_table =
+            std::dynamic_pointer_cast<vineyard::Table>(extender.Seal(client));
+        new_meta.AddMember(table_name, new_table->meta());
+        std::shared_ptr<arrow::Table> arrow_table = new_table->GetTable();
+        GENERATE_TABLE_META("vertex", i, arrow_table);
+        auto label =
+            old_meta.GetKeyValue("vertex_label_name_" + std::to_string(i));
+        auto& entry = schema.GetMutableEntry(label, "VERTEX");
+        prop_id_t prop_num = arrow_table->num_columns();
+        for (prop_id_t j = old_prop_num; j < prop_num; ++j) {
+          entry.AddProperty(arrow_table->field(j)->name(),
+                            arrow_table->field(j)->type());
+        }
+      } else {
+        GENERATE_TABLE_META("vertex", i, this->vertex_tables_[i]);
+        new_meta.AddMember(table_name, old_meta.GetMemberMeta(table_name));
+      }
+    }
+    if (!schema.Validate()) {
+      RETURN_GS_ERROR(ErrorCode::kInvalidValueError, "Invalid schema.");
+    }
+    new_meta.AddKeyValue("schema", schema.ToJSONString());
+
+    size_t nbytes = 0;
+    new_meta.AddMember("ivnums", old_meta.GetMemberMeta("ivnums"));
+    nbytes += old_meta.GetMemberMeta("ivnums").GetNBytes();
+    new_meta.AddMember("ovnums", old_meta.GetMemberMeta("ovnums"));
+    nbytes += old_meta.GetMemberMeta("ovnums").GetNBytes();
+    new_meta.AddMember("tvnums", old_meta.GetMemberMeta("tvnums"));
+    nbytes += old_meta.GetMemberMeta("tvnums").GetNBytes();
+
+    ASSIGN_IDENTICAL_VEC_META("ovgid_lists", vertex_label_num_);
+    ASSIGN_IDENTICAL_VEC_META("ovg2l_maps", vertex_label_num_);
+    ASSIGN_IDENTICAL_VEC_META("edge_tables", edge_label_num_);
+
+    GENERATE_TABLE_VEC_META("edge", 0, edge_label_num_, this->edge_tables_);
+
+    assignCSRMeta(old_meta, new_meta, nbytes);
+    for (label_id_t j = 0; j < edge_label_num_; ++j) {
+      assignDeltaEdgesMeta(j, old_meta, new_meta, nbytes);
+    }
+
+    new_meta.AddMember("vertex_map", old_meta.GetMemberMeta("vertex_map"));
+
+    new_meta.SetNBytes(nbytes);
+
+    vineyard::ObjectID ret;
+    VINEYARD_CHECK_OK(client.CreateMetaData(new_meta, ret));
+    return ret;
+  }
 
   boost::leaf::result<vineyard::ObjectID> AddVertexColumns(
       vineyard::Client& client,
@@ -2184,6 +2909,7 @@ class ArrowFragment
       vineyard::Client& client,
       std::map<label_id_t, std::vector<label_id_t>> vertices,
       std::map<label_id_t, std::vector<label_id_t>> edges) {
+    ensureAllLabels();
     vineyard::ObjectMeta old_meta, new_meta;
     VINEYARD_CHECK_OK(client.GetMetaData(this->id_, old_meta));
 
@@ -2291,16 +3017,10 @@ class ArrowFragment
                             this->vertex_tables_);
     GENERATE_TABLE_VEC_META("edge", 0, edge_label_num_, this->edge_tables_);
 
-    if (directed_) {
-      ASSIGN_IDENTICAL_VEC_VEC_META("ie_lists", vertex_label_num_,
-                                    edge_label_num_);
-      ASSIGN_IDENTICAL_VEC_VEC_META("ie_offsets_lists", vertex_label_num_,
-                                    edge_label_num_);
+    assignCSRMeta(old_meta, new_meta, nbytes);
+    for (label_id_t j = 0; j < edge_label_num_; ++j) {
+      assignDeltaEdgesMeta(j, old_meta, new_meta, nbytes);
     }
-    ASSIGN_IDENTICAL_VEC_VEC_META("oe_lists", vertex_label_num_,
-                                  edge_label_num_);
-    ASSIGN_IDENTICAL_VEC_VEC_META("oe_offsets_lists", vertex_label_num_,
-                                  edge_label_num_);
 
     new_meta.AddMember("vertex_map", old_meta.GetMemberMeta("vertex_map"));
 
@@ -2318,90 +3038,369 @@ class ArrowFragment
 #undef GENERATE_VEC_VEC_META
 
  private:
-  void initPointers() {
-    edge_tables_columns_.resize(edge_label_num_);
-    flatten_edge_tables_columns_.resize(edge_label_num_);
-    for (label_id_t i = 0; i < edge_label_num_; ++i) {
-      prop_id_t prop_num =
-          static_cast<prop_id_t>(edge_tables_[i]->num_columns());
-      edge_tables_columns_[i].resize(prop_num);
-      if (edge_tables_[i]->num_rows() == 0) {
-        continue;
-      }
-      for (prop_id_t j = 0; j < prop_num; ++j) {
-        edge_tables_columns_[i][j] =
-            get_arrow_array_ptr(edge_tables_[i]->column(j)->chunk(0));
-      }
-      flatten_edge_tables_columns_[i] = &edge_tables_columns_[i][0];
-    }
+  // Resets the containers of the labels, which are filled by
+  // `constructVertexLabel` and `constructEdgeLabel`.
+  void initLabels() {
+    padded_offsets_.clear();
 
+    vertex_tables_.clear();
+    vertex_tables_.resize(vertex_label_num_);
+    vertex_tables_columns_.clear();
     vertex_tables_columns_.resize(vertex_label_num_);
+    ovgid_lists_.clear();
+    ovgid_lists_.resize(vertex_label_num_);
+    ovgid_lists_ptr_.clear();
+    ovgid_lists_ptr_.resize(vertex_label_num_, nullptr);
+    ovg2l_maps_.clear();
+    ovg2l_maps_.resize(vertex_label_num_);
+    ovg2l_maps_ptr_.clear();
+    ovg2l_maps_ptr_.resize(vertex_label_num_, nullptr);
+
+    edge_tables_.clear();
+    edge_tables_.resize(edge_label_num_);
+    edge_tables_columns_.clear();
+    edge_tables_columns_.resize(edge_label_num_);
+    flatten_edge_tables_columns_.clear();
+    flatten_edge_tables_columns_.resize(edge_label_num_, nullptr);
+
+    resizeListsVector(ie_lists_);
+    resizeListsVector(oe_lists_);
+    resizeListsVector(ie_ptr_lists_);
+    resizeListsVector(oe_ptr_lists_);
+    resizeListsVector(ie_offsets_lists_);
+    resizeListsVector(oe_offsets_lists_);
+    resizeListsVector(ie_offsets_ptr_lists_);
+    resizeListsVector(oe_offsets_ptr_lists_);
+
+    resizeListsVector(ie_packed_lists_);
+    resizeListsVector(oe_packed_lists_);
+    resizeListsVector(ie_packed_ptr_lists_);
+    resizeListsVector(oe_packed_ptr_lists_);
+    resizeListsVector(ie_packed_offsets_lists_);
+    resizeListsVector(oe_packed_offsets_lists_);
+    resizeListsVector(ie_packed_offsets_ptr_lists_);
+    resizeListsVector(oe_packed_offsets_ptr_lists_);
+
+    delta_edge_tables_.clear();
+    delta_edge_tables_.resize(edge_label_num_);
+    delta_edge_tables_columns_.clear();
+    delta_edge_tables_columns_.resize(edge_label_num_);
+    flatten_delta_edge_tables_columns_.clear();
+    flatten_delta_edge_tables_columns_.resize(edge_label_num_, nullptr);
+    resizeListsVector(delta_ie_lists_);
+    resizeListsVector(delta_oe_lists_);
+    resizeListsVector(delta_ie_ptr_lists_);
+    resizeListsVector(delta_oe_ptr_lists_);
+    resizeListsVector(delta_ie_offsets_lists_);
+    resizeListsVector(delta_oe_offsets_lists_);
+    resizeListsVector(delta_ie_offsets_ptr_lists_);
+    resizeListsVector(delta_oe_offsets_ptr_lists_);
+
+    resizeListsVector(idst_);
+    resizeListsVector(odst_);
+    resizeListsVector(iodst_);
+    resizeListsVector(idoffset_);
+    resizeListsVector(odoffset_);
+    resizeListsVector(iodoffset_);
+
+    vertex_label_ready_.reset(new std::atomic<bool>[vertex_label_num_]);
     for (label_id_t i = 0; i < vertex_label_num_; ++i) {
-      prop_id_t prop_num =
-          static_cast<prop_id_t>(vertex_tables_[i]->num_columns());
-      vertex_tables_columns_[i].resize(prop_num);
-      if (vertex_tables_[i]->num_rows() == 0) {
-        continue;
-      }
-      for (prop_id_t j = 0; j < prop_num; ++j) {
-        vertex_tables_columns_[i][j] =
-            get_arrow_array_ptr(vertex_tables_[i]->column(j)->chunk(0));
-      }
+      vertex_label_ready_[i].store(false, std::memory_order_relaxed);
+    }
+    edge_label_ready_.reset(new std::atomic<bool>[edge_label_num_]);
+    for (label_id_t j = 0; j < edge_label_num_; ++j) {
+      edge_label_ready_[j].store(false, std::memory_order_relaxed);
+    }
+  }
+
+  // The member of the fragment, whose buffers are fetched first if the
+  // fragment is constructed lazily.
+  vineyard::ObjectMeta memberMeta(const std::string& name) const {
+    vineyard::ObjectMeta member = meta_.GetMemberMeta(name);
+    if (lazy_) {
+      auto client = dynamic_cast<Client*>(meta_.GetClient());
+      VINEYARD_ASSERT(client != nullptr,
+                      "A connected IPC client is required to fetch " + name);
+      VINEYARD_CHECK_OK(client->FetchBuffers(member));
     }
+    return member;
+  }
+
+  std::shared_ptr<arrow::Table> constructTable(const std::string& name) const {
+    vineyard::Table table;
+    table.Construct(memberMeta(name));
+    return table.GetTable();
+  }
+
+  template <typename T>
+  std::shared_ptr<typename ConvertToArrowType<T>::ArrayType> constructArray(
+      const std::string& name) const {
+    vineyard::NumericArray<T> array;
+    array.Construct(memberMeta(name));
+    return array.GetArray();
+  }
+
+  std::shared_ptr<arrow::FixedSizeBinaryArray> constructBinaryArray(
+      const std::string& name) const {
+    vineyard::FixedSizeBinaryArray array;
+    array.Construct(memberMeta(name));
+    return array.GetArray();
+  }
 
-    oe_ptr_lists_.resize(vertex_label_num_);
-    oe_offsets_ptr_lists_.resize(vertex_label_num_);
+  // The pointers of the columns of the table, or nullptr for empty tables.
+  static const void** tableColumns(const std::shared_ptr<arrow::Table>& table,
+                                   std::vector<const void*>& columns) {
+    prop_id_t prop_num = static_cast<prop_id_t>(table->num_columns());
+    columns.resize(prop_num);
+    if (table->num_rows() == 0 || prop_num == 0) {
+      return nullptr;
+    }
+    for (prop_id_t j = 0; j < prop_num; ++j) {
+      columns[j] = get_arrow_array_ptr(table->column(j)->chunk(0));
+    }
+    return &columns[0];
+  }
 
-    idst_.resize(vertex_label_num_);
-    odst_.resize(vertex_label_num_);
-    iodst_.resize(vertex_label_num_);
+  // The fast path of the lazy construction is a single acquire load, as the
+  // accessors of the labels are on the hot path.
+  inline void ensureVertexLabel(label_id_t label) const {
+    if (!vertex_label_ready_[label].load(std::memory_order_acquire)) {
+      const_cast<ArrowFragment*>(this)->constructVertexLabel(label);
+    }
+  }
 
-    idoffset_.resize(vertex_label_num_);
-    odoffset_.resize(vertex_label_num_);
-    iodoffset_.resize(vertex_label_num_);
+  // The plain adjacent lists are null when the edges are compressed, thus
+  // the plain accessors decode the compressed lists instead.
+  inline std::shared_ptr<std::vector<nbr_unit_t>> decodeAdjList(
+      const compressed_adj_list_t& list) const {
+    auto nbrs = std::make_shared<std::vector<nbr_unit_t>>(list.Size());
+    list.Decode(nbrs->data());
+    return nbrs;
+  }
 
-    ovgid_lists_ptr_.resize(vertex_label_num_);
-    ovg2l_maps_ptr_.resize(vertex_label_num_);
+  inline void ensureEdgeLabel(label_id_t label) const {
+    if (!edge_label_ready_[label].load(std::memory_order_acquire)) {
+      const_cast<ArrowFragment*>(this)->constructEdgeLabel(label);
+    }
+  }
+
+  void ensureAllLabels() const {
     for (label_id_t i = 0; i < vertex_label_num_; ++i) {
-      ovgid_lists_ptr_[i] = ovgid_lists_[i]->raw_values();
-      ovg2l_maps_ptr_[i] = ovg2l_maps_[i].get();
+      ensureVertexLabel(i);
+    }
+    for (label_id_t j = 0; j < edge_label_num_; ++j) {
+      ensureEdgeLabel(j);
+    }
+  }
 
-      oe_ptr_lists_[i].resize(edge_label_num_);
-      oe_offsets_ptr_lists_[i].resize(edge_label_num_);
+  void constructVertexLabel(label_id_t i) {
+    std::lock_guard<std::mutex> guard(label_mutex_);
+    if (vertex_label_ready_[i].load(std::memory_order_relaxed)) {
+      return;
+    }
+    vertex_tables_[i] =
+        constructTable(generate_name_with_suffix("vertex_tables", i));
+    tableColumns(vertex_tables_[i], vertex_tables_columns_[i]);
+
+    ovgid_lists_[i] =
+        constructArray<vid_t>(generate_name_with_suffix("ovgid_lists", i));
+    ovgid_lists_ptr_[i] = ovgid_lists_[i]->raw_values();
+    ovg2l_maps_[i] = std::make_shared<vineyard::Hashmap<vid_t, vid_t>>();
+    ovg2l_maps_[i]->Construct(
+        memberMeta(generate_name_with_suffix("ovg2l_maps", i)));
+    ovg2l_maps_ptr_[i] = ovg2l_maps_[i].get();
+
+    vertex_label_ready_[i].store(true, std::memory_order_release);
+  }
 
-      idst_[i].resize(edge_label_num_);
-      odst_[i].resize(edge_label_num_);
-      iodst_[i].resize(edge_label_num_);
+  void constructEdgeLabel(label_id_t j) {
+    std::lock_guard<std::mutex> guard(label_mutex_);
+    if (edge_label_ready_[j].load(std::memory_order_relaxed)) {
+      return;
+    }
+    edge_tables_[j] =
+        constructTable(generate_name_with_suffix("edge_tables", j));
+    flatten_edge_tables_columns_[j] =
+        tableColumns(edge_tables_[j], edge_tables_columns_[j]);
+
+    std::string delta_table_name =
+        generate_name_with_suffix("delta_edge_tables", j);
+    if (meta_.Haskey(delta_table_name)) {
+      delta_edge_tables_[j] = constructTable(delta_table_name);
+      flatten_delta_edge_tables_columns_[j] =
+          tableColumns(delta_edge_tables_[j], delta_edge_tables_columns_[j]);
+    }
 
-      idoffset_[i].resize(edge_label_num_);
-      odoffset_[i].resize(edge_label_num_);
-      iodoffset_[i].resize(edge_label_num_);
+    for (label_id_t i = 0; i < vertex_label_num_; ++i) {
+      constructCSR("oe", i, j, oe_lists_[i][j], oe_ptr_lists_[i][j],
+                   oe_offsets_lists_[i][j], oe_offsets_ptr_lists_[i][j],
+                   oe_packed_lists_[i][j], oe_packed_ptr_lists_[i][j],
+                   oe_packed_offsets_lists_[i][j],
+                   oe_packed_offsets_ptr_lists_[i][j]);
+      if (directed_) {
+        constructCSR("ie", i, j, ie_lists_[i][j], ie_ptr_lists_[i][j],
+                     ie_offsets_lists_[i][j], ie_offsets_ptr_lists_[i][j],
+                     ie_packed_lists_[i][j], ie_packed_ptr_lists_[i][j],
+                     ie_packed_offsets_lists_[i][j],
+                     ie_packed_offsets_ptr_lists_[i][j]);
+      } else {
+        ie_ptr_lists_[i][j] = oe_ptr_lists_[i][j];
+        ie_offsets_ptr_lists_[i][j] = oe_offsets_ptr_lists_[i][j];
+        ie_packed_ptr_lists_[i][j] = oe_packed_ptr_lists_[i][j];
+        ie_packed_offsets_ptr_lists_[i][j] =
+            oe_packed_offsets_ptr_lists_[i][j];
+      }
 
-      for (label_id_t j = 0; j < edge_label_num_; ++j) {
-        oe_ptr_lists_[i][j] =
-            reinterpret_cast<const nbr_unit_t*>(oe_lists_[i][j]->GetValue(0));
-        oe_offsets_ptr_lists_[i][j] = oe_offsets_lists_[i][j]->raw_values();
+      if (delta_edge_tables_[j] == nullptr) {
+        continue;
       }
+      constructDeltaCSR("delta_oe", i, j, delta_oe_lists_[i][j],
+                        delta_oe_offsets_lists_[i][j]);
+      delta_oe_ptr_lists_[i][j] = reinterpret_cast<const nbr_unit_t*>(
+          delta_oe_lists_[i][j]->GetValue(0));
+      delta_oe_offsets_ptr_lists_[i][j] =
+          paddedOffsets(delta_oe_offsets_lists_[i][j], tvnums_[i]);
+      if (directed_) {
+        constructDeltaCSR("delta_ie", i, j, delta_ie_lists_[i][j],
+                          delta_ie_offsets_lists_[i][j]);
+        delta_ie_ptr_lists_[i][j] = reinterpret_cast<const nbr_unit_t*>(
+            delta_ie_lists_[i][j]->GetValue(0));
+        delta_ie_offsets_ptr_lists_[i][j] =
+            paddedOffsets(delta_ie_offsets_lists_[i][j], tvnums_[i]);
+      } else {
+        delta_ie_ptr_lists_[i][j] = delta_oe_ptr_lists_[i][j];
+        delta_ie_offsets_ptr_lists_[i][j] = delta_oe_offsets_ptr_lists_[i][j];
+      }
+    }
+
+    edge_label_ready_[j].store(true, std::memory_order_release);
+  }
+
+  // Constructs the plain or the compressed CSR of the `prefix` ("ie" or "oe").
+  void constructCSR(
+      const std::string& prefix, label_id_t i, label_id_t j,
+      std::shared_ptr<arrow::FixedSizeBinaryArray>& list,
+      const nbr_unit_t*& list_ptr, std::shared_ptr<arrow::Int64Array>& offsets,
+      const int64_t*& offsets_ptr, std::shared_ptr<arrow::UInt8Array>& packed,
+      const uint8_t*& packed_ptr,
+      std::shared_ptr<arrow::Int64Array>& packed_offsets,
+      const int64_t*& packed_offsets_ptr) {
+    if (compressed_) {
+      packed = constructArray<uint8_t>(
+          generate_name_with_suffix(prefix + "_packed_lists", i, j));
+      packed_ptr = packed->raw_values();
+      packed_offsets = constructArray<int64_t>(
+          generate_name_with_suffix(prefix + "_packed_offsets_lists", i, j));
+      packed_offsets_ptr = packed_offsets->raw_values();
+    } else {
+      list = constructBinaryArray(
+          generate_name_with_suffix(prefix + "_lists", i, j));
+      list_ptr = reinterpret_cast<const nbr_unit_t*>(list->GetValue(0));
     }
+    offsets = constructArray<int64_t>(
+        generate_name_with_suffix(prefix + "_offsets_lists", i, j));
+    offsets_ptr = paddedOffsets(offsets, tvnums_[i]);
+  }
 
+  // The outer vertices pulled in by the delta edges have no edges in the CSRs
+  // that are built before them, the offsets of such CSRs are padded in
+  // process, rather than rewriting the blobs.
+  const int64_t* paddedOffsets(
+      const std::shared_ptr<arrow::Int64Array>& offsets, vid_t tvnum) {
+    if (offsets->length() >= static_cast<int64_t>(tvnum) + 1) {
+      return offsets->raw_values();
+    }
+    padded_offsets_.emplace_back(offsets->raw_values(),
+                                 offsets->raw_values() + offsets->length());
+    padded_offsets_.back().resize(tvnum + 1, padded_offsets_.back().back());
+    return padded_offsets_.back().data();
+  }
+
+  void sealCSR(
+      Client& client, const std::shared_ptr<arrow::FixedSizeBinaryArray>& list,
+      const std::shared_ptr<arrow::Int64Array>& offsets,
+      std::shared_ptr<vineyard::FixedSizeBinaryArray>& vy_list,
+      std::shared_ptr<vineyard::NumericArray<int64_t>>& vy_offsets) {
+    vineyard::FixedSizeBinaryArrayBuilder list_builder(client, list);
+    vy_list = std::dynamic_pointer_cast<vineyard::FixedSizeBinaryArray>(
+        list_builder.Seal(client));
+    vineyard::NumericArrayBuilder<int64_t> offsets_builder(client, offsets);
+    vy_offsets = std::dynamic_pointer_cast<vineyard::NumericArray<int64_t>>(
+        offsets_builder.Seal(client));
+  }
+
+  // Shares the CSRs, either the plain or the compressed ones, with the new
+  // fragment.
+  void assignCSRMeta(const vineyard::ObjectMeta& old_meta,
+                     vineyard::ObjectMeta& new_meta, size_t& nbytes) {
+    std::vector<std::string> prefixes{"oe_offsets_lists"};
+    if (compressed_) {
+      new_meta.AddKeyValue("compressed_edges", 1);
+      prefixes.push_back("oe_packed_lists");
+      prefixes.push_back("oe_packed_offsets_lists");
+    } else {
+      prefixes.push_back("oe_lists");
+    }
     if (directed_) {
-      ie_ptr_lists_.resize(vertex_label_num_);
-      ie_offsets_ptr_lists_.resize(vertex_label_num_);
+      size_t oe_prefix_num = prefixes.size();
+      for (size_t k = 0; k < oe_prefix_num; ++k) {
+        prefixes.push_back("ie" + prefixes[k].substr(2));
+      }
+    }
+    for (auto const& prefix : prefixes) {
       for (label_id_t i = 0; i < vertex_label_num_; ++i) {
-        ie_ptr_lists_[i].resize(edge_label_num_);
-        ie_offsets_ptr_lists_[i].resize(edge_label_num_);
         for (label_id_t j = 0; j < edge_label_num_; ++j) {
-          ie_ptr_lists_[i][j] =
-              reinterpret_cast<const nbr_unit_t*>(ie_lists_[i][j]->GetValue(0));
-          ie_offsets_ptr_lists_[i][j] = ie_offsets_lists_[i][j]->raw_values();
+          std::string name = generate_name_with_suffix(prefix, i, j);
+          new_meta.AddMember(name, old_meta.GetMemberMeta(name));
+          nbytes += old_meta.GetMemberMeta(name).GetNBytes();
         }
       }
-    } else {
-      ie_ptr_lists_ = oe_ptr_lists_;
-      ie_offsets_ptr_lists_ = oe_offsets_ptr_lists_;
     }
   }
 
+  // Shares the delta CSR and the delta edge table of the edge label, if any,
+  // with the new fragment.
+  void assignDeltaEdgesMeta(label_id_t e_label,
+                            const vineyard::ObjectMeta& old_meta,
+                            vineyard::ObjectMeta& new_meta, size_t& nbytes) {
+    if (delta_edge_tables_[e_label] == nullptr) {
+      return;
+    }
+    std::vector<std::string> names{
+        generate_name_with_suffix("delta_edge_tables", e_label)};
+    for (label_id_t i = 0; i < vertex_label_num_; ++i) {
+      if (directed_) {
+        names.push_back(
+            generate_name_with_suffix("delta_ie_lists", i, e_label));
+        names.push_back(
+            generate_name_with_suffix("delta_ie_offsets_lists", i, e_label));
+      }
+      names.push_back(generate_name_with_suffix("delta_oe_lists", i, e_label));
+      names.push_back(
+          generate_name_with_suffix("delta_oe_offsets_lists", i, e_label));
+    }
+    for (auto const& name : names) {
+      new_meta.AddMember(name, old_meta.GetMemberMeta(name));
+      nbytes += old_meta.GetMemberMeta(name).GetNBytes();
+    }
+  }
+
+  template <typename T>
+  void resizeListsVector(std::vector<std::vector<T>>& lists) {
+    lists.clear();
+    lists.resize(vertex_label_num_, std::vector<T>(edge_label_num_));
+  }
+
+  void constructDeltaCSR(const std::string& prefix, label_id_t v_label,
+                         label_id_t e_label,
+                         std::shared_ptr<arrow::FixedSizeBinaryArray>& list,
+                         std::shared_ptr<arrow::Int64Array>& offsets) {
+    list = constructBinaryArray(
+        generate_name_with_suffix(prefix + "_lists", v_label, e_label));
+    offsets = constructArray<int64_t>(
+        generate_name_with_suffix(prefix + "_offsets_lists", v_label, e_label));
+  }
+
   void initDestFidList(
       bool in_edge, bool out_edge,
       std::vector<std::vector<std::vector<fid_t>>>& fid_lists,
@@ -2412,8 +3411,6 @@ class ArrowFragment
 
       for (auto e_label_id = 0; e_label_id < edge_label_num_; e_label_id++) {
         std::vector<int> id_num(ivnum_, 0);
-        std::set<fid_t> dstset;
-        vertex_t v = inner_vertices.begin();
         auto& fid_list = fid_lists[v_label_id][e_label_id];
         auto& fid_list_offset = fid_lists_offset[v_label_id][e_label_id];
 
@@ -2421,33 +3418,53 @@ class ArrowFragment
           return;
         }
         fid_list_offset.resize(ivnum_ + 1, NULL);
-        for (vid_t i = 0; i < ivnum_; ++i) {
-          dstset.clear();
-          if (in_edge) {
-            auto es = GetIncomingAdjList(v, e_label_id);
+
+        // the inner vertices are scanned by chunks in parallel, and the fid
+        // lists of the chunks are concatenated in order.
+        constexpr vid_t chunk_size = 4096;
+        size_t chunk_num = (ivnum_ + chunk_size - 1) / chunk_size;
+        std::vector<std::vector<fid_t>> chunk_fid_lists(chunk_num);
+        ThreadPool::Default().ParallelFor(chunk_num, [&](size_t chunk) {
+          std::set<fid_t> dstset;
+          vid_t begin = static_cast<vid_t>(chunk) * chunk_size;
+          vid_t end = std::min(begin + chunk_size, ivnum_);
+          vertex_t v(inner_vertices.begin().GetValue() + begin);
+          auto collect = [this, &dstset](auto const& es) {
             for (auto& e : es) {
               fid_t f = GetFragId(e.neighbor());
               if (f != fid_) {
                 dstset.insert(f);
               }
             }
-          }
-          if (out_edge) {
-            auto es = GetOutgoingAdjList(v, e_label_id);
-            for (auto& e : es) {
-              fid_t f = GetFragId(e.neighbor());
-              if (f != fid_) {
-                dstset.insert(f);
+          };
+          for (vid_t i = begin; i < end; ++i) {
+            dstset.clear();
+            if (in_edge) {
+              if (compressed_) {
+                collect(GetIncomingCompressedAdjList(v, e_label_id));
+              } else {
+                collect(GetIncomingMergedAdjList(v, e_label_id));
               }
             }
+            if (out_edge) {
+              if (compressed_) {
+                collect(GetOutgoingCompressedAdjList(v, e_label_id));
+              } else {
+                collect(GetOutgoingMergedAdjList(v, e_label_id));
+              }
+            }
+            id_num[i] = dstset.size();
+            for (auto fid : dstset) {
+              chunk_fid_lists[chunk].push_back(fid);
+            }
+            ++v;
           }
-          id_num[i] = dstset.size();
-          for (auto fid : dstset) {
-            fid_list.push_back(fid);
-          }
-          ++v;
-        }
+        });
 
+        for (auto const& chunk_fid_list : chunk_fid_lists) {
+          fid_list.insert(fid_list.end(), chunk_fid_list.begin(),
+                          chunk_fid_list.end());
+        }
         fid_list.shrink_to_fit();
         fid_list_offset[0] = fid_list.data();
         for (vid_t i = 0; i < ivnum_; ++i) {
@@ -2484,11 +3501,46 @@ class ArrowFragment
       ie_offsets_lists_, oe_offsets_lists_;
   std::vector<std::vector<const int64_t*>> ie_offsets_ptr_lists_,
       oe_offsets_ptr_lists_;
+  std::vector<std::vector<int64_t>> padded_offsets_;
+
+  // The compressed CSR, see also `bit_packing::Encode`, the `*_lists_` and
+  // `*_ptr_lists_` above are absent, except the offsets.
+  bool compressed_ = false;
+  std::vector<std::vector<std::shared_ptr<arrow::UInt8Array>>>
+      ie_packed_lists_, oe_packed_lists_;
+  std::vector<std::vector<const uint8_t*>> ie_packed_ptr_lists_,
+      oe_packed_ptr_lists_;
+  std::vector<std::vector<std::shared_ptr<arrow::Int64Array>>>
+      ie_packed_offsets_lists_, oe_packed_offsets_lists_;
+  std::vector<std::vector<const int64_t*>> ie_packed_offsets_ptr_lists_,
+      oe_packed_offsets_ptr_lists_;
+
+  // The delta CSR overlay, the lists of the edge labels without delta edges
+  // are nullptr.
+  bool has_delta_ = false;
+  std::vector<std::shared_ptr<arrow::Table>> delta_edge_tables_;
+  std::vector<std::vector<const void*>> delta_edge_tables_columns_;
+  std::vector<const void**> flatten_delta_edge_tables_columns_;
+
+  std::vector<std::vector<std::shared_ptr<arrow::FixedSizeBinaryArray>>>
+      delta_ie_lists_, delta_oe_lists_;
+  std::vector<std::vector<const nbr_unit_t*>> delta_ie_ptr_lists_,
+      delta_oe_ptr_lists_;
+  std::vector<std::vector<std::shared_ptr<arrow::Int64Array>>>
+      delta_ie_offsets_lists_, delta_oe_offsets_lists_;
+  std::vector<std::vector<const int64_t*>> delta_ie_offsets_ptr_lists_,
+      delta_oe_offsets_ptr_lists_;
 
   std::vector<std::vector<std::vector<fid_t>>> idst_, odst_, iodst_;
   std::vector<std::vector<std::vector<fid_t*>>> idoffset_, odoffset_,
       iodoffset_;
 
+  // The labels whose tables and CSRs have been constructed, see also
+  // `ensureVertexLabel` and `ensureEdgeLabel`.
+  bool lazy_ = false;
+  std::mutex label_mutex_;
+  std::unique_ptr<std::atomic<bool>[]> vertex_label_ready_, edge_label_ready_;
+
   std::shared_ptr<vertex_map_t> vm_ptr_;
 
   vineyard::IdParser<vid_t> vid_parser_;
@@ -2519,6 +3571,9 @@ class ArrowFragmentBuilder : public vineyard::ObjectBuilder {
   void set_fid(fid_t fid) { fid_ = fid; }
   void set_fnum(fid_t fnum) { fnum_ = fnum; }
   void set_directed(bool directed) { directed_ = directed; }
+  void set_compressed_edges(bool compressed_edges) {
+    compressed_edges_ = compressed_edges;
+  }
 
   void set_label_num(label_id_t vertex_label_num, label_id_t edge_label_num) {
     vertex_label_num_ = vertex_label_num;
@@ -2533,17 +3588,25 @@ class ArrowFragmentBuilder : public vineyard::ObjectBuilder {
     if (directed_) {
       ie_lists_.resize(vertex_label_num_);
       ie_offsets_lists_.resize(vertex_label_num_);
+      ie_packed_lists_.resize(vertex_label_num_);
+      ie_packed_offsets_lists_.resize(vertex_label_num_);
     }
     oe_lists_.resize(vertex_label_num_);
     oe_offsets_lists_.resize(vertex_label_num_);
+    oe_packed_lists_.resize(vertex_label_num_);
+    oe_packed_offsets_lists_.resize(vertex_label_num_);
 
     for (label_id_t i = 0; i < vertex_label_num_; ++i) {
       if (directed_) {
         ie_lists_[i].resize(edge_label_num_);
         ie_offsets_lists_[i].resize(edge_label_num_);
+        ie_packed_lists_[i].resize(edge_label_num_);
+        ie_packed_offsets_lists_[i].resize(edge_label_num_);
       }
       oe_lists_[i].resize(edge_label_num_);
       oe_offsets_lists_[i].resize(edge_label_num_);
+      oe_packed_lists_[i].resize(edge_label_num_);
+      oe_packed_offsets_lists_[i].resize(edge_label_num_);
     }
   }
 
@@ -2615,6 +3678,27 @@ class ArrowFragmentBuilder : public vineyard::ObjectBuilder {
     oe_offsets_lists_[v_label][e_label] = out_edge_offsets;
   }
 
+  void set_in_edge_packed_list(
+      label_id_t v_label, label_id_t e_label,
+      std::shared_ptr<vineyard::NumericArray<uint8_t>> in_edge_packed_list,
+      std::shared_ptr<vineyard::NumericArray<int64_t>> in_edge_packed_offsets) {
+    assert(ie_packed_lists_.size() > static_cast<size_t>(v_label));
+    assert(ie_packed_lists_[v_label].size() > static_cast<size_t>(e_label));
+    ie_packed_lists_[v_label][e_label] = in_edge_packed_list;
+    ie_packed_offsets_lists_[v_label][e_label] = in_edge_packed_offsets;
+  }
+
+  void set_out_edge_packed_list(
+      label_id_t v_label, label_id_t e_label,
+      std::shared_ptr<vineyard::NumericArray<uint8_t>> out_edge_packed_list,
+      std::shared_ptr<vineyard::NumericArray<int64_t>>
+          out_edge_packed_offsets) {
+    assert(oe_packed_lists_.size() > static_cast<size_t>(v_label));
+    assert(oe_packed_lists_[v_label].size() > static_cast<size_t>(e_label));
+    oe_packed_lists_[v_label][e_label] = out_edge_packed_list;
+    oe_packed_offsets_lists_[v_label][e_label] = out_edge_packed_offsets;
+  }
+
   void set_vertex_map(std::shared_ptr<vertex_map_t> vm_ptr) {
     vm_ptr_ = vm_ptr;
   }
@@ -2691,11 +3775,15 @@ class ArrowFragmentBuilder : public vineyard::ObjectBuilder {
     ASSIGN_TABLE_VECTOR(edge_tables_, frag->edge_tables_);
 
     if (directed_) {
-      ASSIGN_ARRAY_VECTOR_VECTOR(ie_lists_, frag->ie_lists_);
+      if (!compressed_edges_) {
+        ASSIGN_ARRAY_VECTOR_VECTOR(ie_lists_, frag->ie_lists_);
+      }
       ASSIGN_ARRAY_VECTOR_VECTOR(ie_offsets_lists_, frag->ie_offsets_lists_);
     }
 
-    ASSIGN_ARRAY_VECTOR_VECTOR(oe_lists_, frag->oe_lists_);
+    if (!compressed_edges_) {
+      ASSIGN_ARRAY_VECTOR_VECTOR(oe_lists_, frag->oe_lists_);
+    }
     ASSIGN_ARRAY_VECTOR_VECTOR(oe_offsets_lists_, frag->oe_offsets_lists_);
 
     frag->meta_.SetTypeName(type_name<ArrowFragment<oid_t, vid_t>>());
@@ -2764,14 +3852,31 @@ class ArrowFragmentBuilder : public vineyard::ObjectBuilder {
     GENERATE_VEC_META("ovgid_lists", ovgid_lists_, vertex_label_num_);
     GENERATE_VEC_META("ovg2l_maps", ovg2l_maps_, vertex_label_num_);
     GENERATE_VEC_META("edge_tables", edge_tables_, edge_label_num_);
-    if (directed_) {
-      GENERATE_VEC_VEC_META("ie_lists", ie_lists_, vertex_label_num_,
+    if (compressed_edges_) {
+      frag->meta_.AddKeyValue("compressed_edges", 1);
+      if (directed_) {
+        GENERATE_VEC_VEC_META("ie_packed_lists", ie_packed_lists_,
+                              vertex_label_num_, edge_label_num_);
+        GENERATE_VEC_VEC_META("ie_packed_offsets_lists",
+                              ie_packed_offsets_lists_, vertex_label_num_,
+                              edge_label_num_);
+      }
+      GENERATE_VEC_VEC_META("oe_packed_lists", oe_packed_lists_,
+                            vertex_label_num_, edge_label_num_);
+      GENERATE_VEC_VEC_META("oe_packed_offsets_lists", oe_packed_offsets_lists_,
+                            vertex_label_num_, edge_label_num_);
+    } else {
+      if (directed_) {
+        GENERATE_VEC_VEC_META("ie_lists", ie_lists_, vertex_label_num_,
+                              edge_label_num_);
+      }
+      GENERATE_VEC_VEC_META("oe_lists", oe_lists_, vertex_label_num_,
                             edge_label_num_);
+    }
+    if (directed_) {
       GENERATE_VEC_VEC_META("ie_offsets_lists", ie_offsets_lists_,
                             vertex_label_num_, edge_label_num_);
     }
-    GENERATE_VEC_VEC_META("oe_lists", oe_lists_, vertex_label_num_,
-                          edge_label_num_);
     GENERATE_VEC_VEC_META("oe_offsets_lists", oe_offsets_lists_,
                           vertex_label_num_, edge_label_num_);
 
@@ -2812,6 +3917,12 @@ class ArrowFragmentBuilder : public vineyard::ObjectBuilder {
   std::vector<std::vector<std::shared_ptr<vineyard::NumericArray<int64_t>>>>
       ie_offsets_lists_, oe_offsets_lists_;
 
+  bool compressed_edges_ = false;
+  std::vector<std::vector<std::shared_ptr<vineyard::NumericArray<uint8_t>>>>
+      ie_packed_lists_, oe_packed_lists_;
+  std::vector<std::vector<std::shared_ptr<vineyard::NumericArray<int64_t>>>>
+      ie_packed_offsets_lists_, oe_packed_offsets_lists_;
+
   std::shared_ptr<vertex_map_t> vm_ptr_;
   PropertyGraphSchema schema_;
 };
@@ -2832,10 +3943,20 @@ class BasicArrowFragmentBuilder : public ArrowFragmentBuilder<OID_T, VID_T> {
                                      std::shared_ptr<vertex_map_t> vm_ptr)
       : ArrowFragmentBuilder<oid_t, vid_t>(client), vm_ptr_(vm_ptr) {}
 
+  /**
+   * @brief Compresses the adjacent lists by delta encoding and bit-packing
+   * the neighbors, see also `bit_packing::Encode`. It must be set before
+   * `Init`.
+   */
+  void set_compress_edges(bool compress_edges) {
+    compress_edges_ = compress_edges;
+  }
+
   vineyard::Status Build(vineyard::Client& client) override {
     this->set_fid(fid_);
     this->set_fnum(fnum_);
     this->set_directed(directed_);
+    this->set_compressed_edges(compress_edges_);
     this->set_label_num(vertex_label_num_, edge_label_num_);
     this->set_property_graph_schema(schema_);
 
@@ -2892,15 +4013,24 @@ class BasicArrowFragmentBuilder : public ArrowFragmentBuilder<OID_T, VID_T> {
     for (label_id_t i = 0; i < vertex_label_num_; ++i) {
       for (label_id_t j = 0; j < edge_label_num_; ++j) {
         auto fn = [this, i, j](Client& client) {
-          if (directed_) {
-            vineyard::FixedSizeBinaryArrayBuilder ie_builder(client,
-                                                             ie_lists_[i][j]);
-            this->set_in_edge_list(
-                i, j,
-                std::dynamic_pointer_cast<vineyard::FixedSizeBinaryArray>(
-                    ie_builder.Seal(client)));
-          }
-          {
+          if (compress_edges_) {
+            if (directed_) {
+              this->set_in_edge_packed_list(
+                  i, j, sealArray<uint8_t>(client, ie_packed_lists_[i][j]),
+                  sealArray<int64_t>(client, ie_packed_offsets_lists_[i][j]));
+            }
+            this->set_out_edge_packed_list(
+                i, j, sealArray<uint8_t>(client, oe_packed_lists_[i][j]),
+                sealArray<int64_t>(client, oe_packed_offsets_lists_[i][j]));
+          } else {
+            if (directed_) {
+              vineyard::FixedSizeBinaryArrayBuilder ie_builder(
+                  client, ie_lists_[i][j]);
+              this->set_in_edge_list(
+                  i, j,
+                  std::dynamic_pointer_cast<vineyard::FixedSizeBinaryArray>(
+                      ie_builder.Seal(client)));
+            }
             vineyard::FixedSizeBinaryArrayBuilder oe_builder(client,
                                                              oe_lists_[i][j]);
             this->set_out_edge_list(
@@ -3077,16 +4207,19 @@ class BasicArrowFragmentBuilder : public ArrowFragmentBuilder<OID_T, VID_T> {
       std::vector<std::shared_ptr<arrow::Int64Array>> sub_oe_offset_lists(
           vertex_label_num_);
       if (directed_) {
-        generate_directed_csr<vid_t, eid_t>(
+        generate_csr_by_partition<vid_t, eid_t>(
             vid_parser_, edge_src[e_label], edge_dst[e_label], tvnums_,
-            vertex_label_num_, concurrency, sub_oe_lists, sub_oe_offset_lists);
-        generate_directed_csr<vid_t, eid_t>(
+            vertex_label_num_, concurrency, false, sub_oe_lists,
+            sub_oe_offset_lists);
+        generate_csr_by_partition<vid_t, eid_t>(
             vid_parser_, edge_dst[e_label], edge_src[e_label], tvnums_,
-            vertex_label_num_, concurrency, sub_ie_lists, sub_ie_offset_lists);
+            vertex_label_num_, concurrency, false, sub_ie_lists,
+            sub_ie_offset_lists);
       } else {
-        generate_undirected_csr<vid_t, eid_t>(
+        generate_csr_by_partition<vid_t, eid_t>(
             vid_parser_, edge_src[e_label], edge_dst[e_label], tvnums_,
-            vertex_label_num_, concurrency, sub_oe_lists, sub_oe_offset_lists);
+            vertex_label_num_, concurrency, true, sub_oe_lists,
+            sub_oe_offset_lists);
       }
 
       for (label_id_t v_label = 0; v_label < vertex_label_num_; ++v_label) {
@@ -3098,9 +4231,52 @@ class BasicArrowFragmentBuilder : public ArrowFragmentBuilder<OID_T, VID_T> {
         oe_offsets_lists_[v_label][e_label] = sub_oe_offset_lists[v_label];
       }
     }
+    if (compress_edges_) {
+      BOOST_LEAF_CHECK(compressEdges(concurrency));
+    }
     return {};
   }
 
+  // Replaces the adjacent lists with the compressed ones.
+  boost::leaf::result<void> compressEdges(int concurrency) {
+    auto compress = [this, concurrency](
+                        auto& lists, const auto& offsets_lists,
+                        auto& packed_lists, auto& packed_offsets_lists)
+        -> boost::leaf::result<void> {
+      packed_lists.resize(vertex_label_num_);
+      packed_offsets_lists.resize(vertex_label_num_);
+      for (label_id_t v_label = 0; v_label < vertex_label_num_; ++v_label) {
+        packed_lists[v_label].resize(edge_label_num_);
+        packed_offsets_lists[v_label].resize(edge_label_num_);
+        for (label_id_t e_label = 0; e_label < edge_label_num_; ++e_label) {
+          BOOST_LEAF_CHECK((compress_csr<vid_t, eid_t>(
+              lists[v_label][e_label], offsets_lists[v_label][e_label],
+              concurrency, packed_lists[v_label][e_label],
+              packed_offsets_lists[v_label][e_label])));
+          lists[v_label][e_label].reset();
+        }
+      }
+      return {};
+    };
+    if (directed_) {
+      BOOST_LEAF_CHECK(compress(ie_lists_, ie_offsets_lists_, ie_packed_lists_,
+                                ie_packed_offsets_lists_));
+    }
+    BOOST_LEAF_CHECK(compress(oe_lists_, oe_offsets_lists_, oe_packed_lists_,
+                              oe_packed_offsets_lists_));
+    return {};
+  }
+
+  template <typename T>
+  static std::shared_ptr<vineyard::NumericArray<T>> sealArray(
+      Client& client,
+      const std::shared_ptr<typename ConvertToArrowType<T>::ArrayType>&
+          array) {
+    vineyard::NumericArrayBuilder<T> builder(client, array);
+    return std::dynamic_pointer_cast<vineyard::NumericArray<T>>(
+        builder.Seal(client));
+  }
+
   fid_t fid_, fnum_;
   bool directed_;
   label_id_t vertex_label_num_;
@@ -3119,6 +4295,12 @@ class BasicArrowFragmentBuilder : public ArrowFragmentBuilder<OID_T, VID_T> {
   std::vector<std::vector<std::shared_ptr<arrow::Int64Array>>>
       ie_offsets_lists_, oe_offsets_lists_;
 
+  bool compress_edges_ = false;
+  std::vector<std::vector<std::shared_ptr<arrow::UInt8Array>>>
+      ie_packed_lists_, oe_packed_lists_;
+  std::vector<std::vector<std::shared_ptr<arrow::Int64Array>>>
+      ie_packed_offsets_lists_, oe_packed_offsets_lists_;
+
   std::shared_ptr<vertex_map_t> vm_ptr_;
 
   IdParser<vid_t> vid_parser_;
@@ -37,8 +37,10 @@ limitations under the License.
 #include "grape/worker/comm_spec.h"
 
 #include "graph/fragment/property_graph_types.h"
+#include "graph/utils/bit_packing.h"
 #include "graph/utils/error.h"
 #include "graph/utils/mpi_utils.h"
+#include "graph/utils/thread_group.h"
 
 namespace vineyard {
 
@@ -445,6 +447,10 @@ struct OffsetNbr {
   const VID_T* ivnums_;
 };
 
+/**
+ * The plain adjacent lists of a compressed CSR are decoded to a buffer that
+ * is owned by the lists, thus the iterators are valid as long as the lists.
+ */
 template <typename VID_T, typename EID_T>
 class RawAdjList {
  public:
@@ -452,6 +458,11 @@ class RawAdjList {
   RawAdjList(const NbrUnit<VID_T, EID_T>* begin,
              const NbrUnit<VID_T, EID_T>* end)
       : begin_(begin), end_(end) {}
+  explicit RawAdjList(
+      std::shared_ptr<std::vector<NbrUnit<VID_T, EID_T>>> const& decoded)
+      : begin_(decoded->data()),
+        end_(decoded->data() + decoded->size()),
+        decoded_(decoded) {}
 
   inline const NbrUnit<VID_T, EID_T>* begin() const { return begin_; }
 
@@ -468,6 +479,7 @@ class RawAdjList {
  private:
   const NbrUnit<VID_T, EID_T>* begin_;
   const NbrUnit<VID_T, EID_T>* end_;
+  std::shared_ptr<std::vector<NbrUnit<VID_T, EID_T>>> decoded_;
 };
 
 template <typename VID_T>
@@ -480,6 +492,12 @@ class AdjList {
   AdjList(const NbrUnit<VID_T, EID_T>* begin, const NbrUnit<VID_T, EID_T>* end,
           const void** edata_arrays)
       : begin_(begin), end_(end), edata_arrays_(edata_arrays) {}
+  AdjList(std::shared_ptr<std::vector<NbrUnit<VID_T, EID_T>>> const& decoded,
+          const void** edata_arrays)
+      : begin_(decoded->data()),
+        end_(decoded->data() + decoded->size()),
+        edata_arrays_(edata_arrays),
+        decoded_(decoded) {}
 
   inline Nbr<VID_T, EID_T> begin() const {
     return Nbr<VID_T, EID_T>(begin_, edata_arrays_);
@@ -505,6 +523,8 @@ class AdjList {
   const NbrUnit<VID_T, EID_T>* begin_;
   const NbrUnit<VID_T, EID_T>* end_;
   const void** edata_arrays_;
+  // the decoded neighbors when the CSR is compressed, see also `RawAdjList`.
+  std::shared_ptr<std::vector<NbrUnit<VID_T, EID_T>>> decoded_;
 };
 
 template <typename VID_T>
@@ -562,6 +582,319 @@ class OffsetAdjList {
   const VID_T* ivnums_;
 };
 
+/**
+ * MergedNbr walks through the adjacent list in the base CSR, then the one in
+ * the delta CSR. The edge ids of the two segments refer to the base and the
+ * delta edge tables respectively.
+ */
+template <typename VID_T, typename EID_T>
+struct MergedNbr {
+ private:
+  using prop_id_t = property_graph_types::PROP_ID_TYPE;
+  using nbr_unit_t = NbrUnit<VID_T, EID_T>;
+
+ public:
+  MergedNbr()
+      : nbr_(NULL),
+        in_delta_(true),
+        base_end_(NULL),
+        delta_begin_(NULL),
+        base_edata_arrays_(nullptr),
+        delta_edata_arrays_(nullptr) {}
+  MergedNbr(const nbr_unit_t* nbr, bool in_delta, const nbr_unit_t* base_end,
+            const nbr_unit_t* delta_begin, const void** base_edata_arrays,
+            const void** delta_edata_arrays)
+      : nbr_(nbr),
+        in_delta_(in_delta),
+        base_end_(base_end),
+        delta_begin_(delta_begin),
+        base_edata_arrays_(base_edata_arrays),
+        delta_edata_arrays_(delta_edata_arrays) {
+    skip_to_delta();
+  }
+
+  grape::Vertex<VID_T> neighbor() const {
+    return grape::Vertex<VID_T>(nbr_->vid);
+  }
+
+  grape::Vertex<VID_T> get_neighbor() const {
+    return grape::Vertex<VID_T>(nbr_->vid);
+  }
+
+  EID_T edge_id() const { return nbr_->eid; }
+
+  /// Whether the edge is in the delta CSR, i.e., the edge id refers to the
+  /// delta edge table.
+  bool is_delta() const { return in_delta_; }
+
+  template <typename T>
+  T get_data(prop_id_t prop_id) const {
+    return ValueGetter<T>::Value(edata_arrays()[prop_id], nbr_->eid);
+  }
+
+  std::string get_str(prop_id_t prop_id) const {
+    return ValueGetter<std::string>::Value(edata_arrays()[prop_id],
+                                           nbr_->eid);
+  }
+
+  double get_double(prop_id_t prop_id) const {
+    return ValueGetter<double>::Value(edata_arrays()[prop_id], nbr_->eid);
+  }
+
+  int64_t get_int(prop_id_t prop_id) const {
+    return ValueGetter<int64_t>::Value(edata_arrays()[prop_id], nbr_->eid);
+  }
+
+  inline const MergedNbr& operator++() const {
+    ++nbr_;
+    skip_to_delta();
+    return *this;
+  }
+
+  inline MergedNbr operator++(int) const {
+    MergedNbr ret(*this);
+    ++(*this);
+    return ret;
+  }
+
+  // the segments may be adjacent in memory, thus the segment is compared as
+  // well.
+  inline bool operator==(const MergedNbr& rhs) const {
+    return nbr_ == rhs.nbr_ && in_delta_ == rhs.in_delta_;
+  }
+  inline bool operator!=(const MergedNbr& rhs) const {
+    return !(*this == rhs);
+  }
+
+  inline const MergedNbr& operator*() const { return *this; }
+
+ private:
+  inline const void** edata_arrays() const {
+    return in_delta_ ? delta_edata_arrays_ : base_edata_arrays_;
+  }
+
+  inline void skip_to_delta() const {
+    if (!in_delta_ && nbr_ == base_end_) {
+      nbr_ = delta_begin_;
+      in_delta_ = true;
+    }
+  }
+
+  const mutable nbr_unit_t* nbr_;
+  mutable bool in_delta_;
+  const nbr_unit_t* base_end_;
+  const nbr_unit_t* delta_begin_;
+  const void** base_edata_arrays_;
+  const void** delta_edata_arrays_;
+};
+
+/**
+ * MergedAdjList is the adjacent list of a vertex in the base CSR followed by
+ * the one in the delta CSR, see also `ArrowFragment::AddDeltaEdges`.
+ */
+template <typename VID_T, typename EID_T>
+class MergedAdjList {
+  using nbr_unit_t = NbrUnit<VID_T, EID_T>;
+
+ public:
+  MergedAdjList() {}
+  MergedAdjList(const AdjList<VID_T, EID_T>& base,
+                const AdjList<VID_T, EID_T>& delta,
+                const void** base_edata_arrays,
+                const void** delta_edata_arrays)
+      : base_(base),
+        delta_(delta),
+        base_edata_arrays_(base_edata_arrays),
+        delta_edata_arrays_(delta_edata_arrays) {}
+
+  inline MergedNbr<VID_T, EID_T> begin() const {
+    return MergedNbr<VID_T, EID_T>(
+        base_.begin_unit(), false, base_.end_unit(), delta_.begin_unit(),
+        base_edata_arrays_, delta_edata_arrays_);
+  }
+
+  inline MergedNbr<VID_T, EID_T> end() const {
+    return MergedNbr<VID_T, EID_T>(delta_.end_unit(), true, base_.end_unit(),
+                                   delta_.begin_unit(), base_edata_arrays_,
+                                   delta_edata_arrays_);
+  }
+
+  inline size_t Size() const { return base_.Size() + delta_.Size(); }
+
+  inline bool Empty() const { return base_.Empty() && delta_.Empty(); }
+
+  inline bool NotEmpty() const { return !Empty(); }
+
+  size_t size() const { return Size(); }
+
+  /// The adjacent list in the base CSR.
+  inline const AdjList<VID_T, EID_T>& base() const { return base_; }
+
+  /// The adjacent list in the delta CSR.
+  inline const AdjList<VID_T, EID_T>& delta() const { return delta_; }
+
+ private:
+  AdjList<VID_T, EID_T> base_;
+  AdjList<VID_T, EID_T> delta_;
+  const void** base_edata_arrays_ = nullptr;
+  const void** delta_edata_arrays_ = nullptr;
+};
+
+template <typename VID_T>
+using MergedAdjListDefault =
+    MergedAdjList<VID_T, property_graph_types::EID_TYPE>;
+
+/**
+ * CompressedNbr decodes the compressed adjacent list block by block into a
+ * small buffer while iterating, see also `bit_packing::Encode`.
+ */
+template <typename VID_T, typename EID_T>
+struct CompressedNbr {
+ private:
+  using prop_id_t = property_graph_types::PROP_ID_TYPE;
+  using nbr_unit_t = NbrUnit<VID_T, EID_T>;
+
+ public:
+  CompressedNbr() : data_(NULL), left_(0), edata_arrays_(nullptr) {}
+  CompressedNbr(const uint8_t* data, int64_t size, const void** edata_arrays)
+      : data_(data), left_(size), edata_arrays_(edata_arrays) {
+    decode(0);
+  }
+  CompressedNbr(const CompressedNbr& rhs)
+      : data_(rhs.data_),
+        left_(rhs.left_),
+        index_(rhs.index_),
+        count_(rhs.count_),
+        edata_arrays_(rhs.edata_arrays_) {
+    std::copy(rhs.buffer_ + rhs.index_, rhs.buffer_ + rhs.count_,
+              buffer_ + rhs.index_);
+  }
+
+  CompressedNbr& operator=(const CompressedNbr& rhs) {
+    data_ = rhs.data_;
+    left_ = rhs.left_;
+    index_ = rhs.index_;
+    count_ = rhs.count_;
+    edata_arrays_ = rhs.edata_arrays_;
+    std::copy(rhs.buffer_ + rhs.index_, rhs.buffer_ + rhs.count_,
+              buffer_ + rhs.index_);
+    return *this;
+  }
+
+  grape::Vertex<VID_T> neighbor() const {
+    return grape::Vertex<VID_T>(buffer_[index_].vid);
+  }
+
+  grape::Vertex<VID_T> get_neighbor() const {
+    return grape::Vertex<VID_T>(buffer_[index_].vid);
+  }
+
+  EID_T edge_id() const { return buffer_[index_].eid; }
+
+  template <typename T>
+  T get_data(prop_id_t prop_id) const {
+    return ValueGetter<T>::Value(edata_arrays_[prop_id], edge_id());
+  }
+
+  std::string get_str(prop_id_t prop_id) const {
+    return ValueGetter<std::string>::Value(edata_arrays_[prop_id], edge_id());
+  }
+
+  double get_double(prop_id_t prop_id) const {
+    return ValueGetter<double>::Value(edata_arrays_[prop_id], edge_id());
+  }
+
+  int64_t get_int(prop_id_t prop_id) const {
+    return ValueGetter<int64_t>::Value(edata_arrays_[prop_id], edge_id());
+  }
+
+  inline const CompressedNbr& operator++() const {
+    --left_;
+    if (++index_ == count_ && left_ > 0) {
+      decode(buffer_[index_ - 1].vid);
+    }
+    return *this;
+  }
+
+  // the remaining neighbors identify the position in the same list.
+  inline bool operator==(const CompressedNbr& rhs) const {
+    return left_ == rhs.left_;
+  }
+  inline bool operator!=(const CompressedNbr& rhs) const {
+    return left_ != rhs.left_;
+  }
+
+  inline const CompressedNbr& operator*() const { return *this; }
+
+ private:
+  inline void decode(uint64_t prev) const {
+    index_ = 0;
+    count_ = static_cast<int>(
+        std::min<int64_t>(bit_packing::kBlockSize, left_));
+    if (count_ > 0) {
+      data_ = bit_packing::DecodeBlock(data_, count_, prev, buffer_);
+    }
+  }
+
+  mutable const uint8_t* data_;
+  mutable int64_t left_;
+  mutable int index_ = 0;
+  mutable int count_ = 0;
+  const void** edata_arrays_;
+  mutable nbr_unit_t buffer_[bit_packing::kBlockSize];
+};
+
+/**
+ * CompressedAdjList is the adjacent list in a compressed CSR, which is
+ * iterated in a forward-only manner.
+ */
+template <typename VID_T, typename EID_T>
+class CompressedAdjList {
+ public:
+  CompressedAdjList() : data_(NULL), size_(0), edata_arrays_(nullptr) {}
+  CompressedAdjList(const uint8_t* data, int64_t size,
+                    const void** edata_arrays)
+      : data_(data), size_(size), edata_arrays_(edata_arrays) {}
+
+  inline CompressedNbr<VID_T, EID_T> begin() const {
+    return CompressedNbr<VID_T, EID_T>(data_, size_, edata_arrays_);
+  }
+
+  inline CompressedNbr<VID_T, EID_T> end() const {
+    return CompressedNbr<VID_T, EID_T>(data_, 0, edata_arrays_);
+  }
+
+  inline size_t Size() const { return size_; }
+
+  inline bool Empty() const { return size_ == 0; }
+
+  inline bool NotEmpty() const { return size_ != 0; }
+
+  size_t size() const { return size_; }
+
+  /// Decodes the whole adjacent list to `nbrs`, which should have room for
+  /// `Size()` neighbors.
+  void Decode(NbrUnit<VID_T, EID_T>* nbrs) const {
+    const uint8_t* data = data_;
+    uint64_t prev = 0;
+    for (int64_t begin = 0; begin < size_; begin += bit_packing::kBlockSize) {
+      int count = static_cast<int>(
+          std::min<int64_t>(bit_packing::kBlockSize, size_ - begin));
+      data = bit_packing::DecodeBlock(data, count, prev, nbrs + begin);
+      prev = nbrs[begin + count - 1].vid;
+    }
+  }
+
+ private:
+  const uint8_t* data_;
+  int64_t size_;
+  const void** edata_arrays_;
+};
+
+template <typename VID_T>
+using CompressedAdjListDefault =
+    CompressedAdjList<VID_T, property_graph_types::EID_TYPE>;
+
 }  // namespace property_graph_utils
 
 inline std::string generate_type_name(
@@ -864,36 +1197,18 @@ inline boost::leaf::result<std::shared_ptr<arrow::Table>> SyncSchema(
 template <typename ITER_T, typename FUNC_T>
 void parallel_for(const ITER_T& begin, const ITER_T& end, const FUNC_T& func,
                   int thread_num, size_t chunk = 0) {
-  std::vector<std::thread> threads(thread_num);
   size_t num = end - begin;
-  if (chunk == 0) {
-    chunk = (num + thread_num - 1) / thread_num;
-  }
-  std::atomic<size_t> cur(0);
-  for (int i = 0; i < thread_num; ++i) {
-    threads[i] = std::thread([&]() {
-      while (true) {
-        size_t x = cur.fetch_add(chunk);
-        if (x >= num) {
-          break;
-        }
-        size_t y = std::min(x + chunk, num);
-        ITER_T a = begin + x;
-        ITER_T b = begin + y;
-        while (a != b) {
-          func(a);
-          ++a;
-        }
-      }
-    });
-  }
-  for (auto& thrd : threads) {
-    thrd.join();
-  }
+  ThreadPool::Default().ParallelFor(
+      num, [&begin, &func](size_t i) { func(static_cast<ITER_T>(begin + i)); },
+      thread_num, chunk);
 }
 
 inline void parallel_prefix_sum(const int* input, int64_t* output,
                                 size_t length, int concurrency) {
+  if (length == 0) {
+    return;
+  }
+  concurrency = std::max(concurrency, 1);
   size_t bsize =
       std::max(static_cast<size_t>(1024),
                static_cast<size_t>((length + concurrency - 1) / concurrency));
@@ -908,13 +1223,9 @@ inline void parallel_prefix_sum(const int* input, int64_t* output,
     }
   };
 
-  std::vector<std::thread> threads_prefix;
-  for (int i = 0; i < thread_num; ++i) {
-    threads_prefix.emplace_back(block_prefix, i);
-  }
-  for (auto& thrd : threads_prefix) {
-    thrd.join();
-  }
+  ThreadPool::Default().ParallelFor(
+      thread_num, [&block_prefix](size_t i) { block_prefix(i); }, concurrency,
+      1);
 
   std::vector<int64_t> block_sum(thread_num);
   {
@@ -934,13 +1245,9 @@ inline void parallel_prefix_sum(const int* input, int64_t* output,
     }
   };
 
-  std::vector<std::thread> threads_sum;
-  for (int i = 1; i < thread_num; ++i) {
-    threads_sum.emplace_back(block_add, i);
-  }
-  for (auto& thrd : threads_sum) {
-    thrd.join();
-  }
+  ThreadPool::Default().ParallelFor(
+      thread_num - 1, [&block_add](size_t i) { block_add(i + 1); },
+      concurrency, 1);
 }
 
 template <typename VID_T>
@@ -1334,6 +1641,303 @@ boost::leaf::result<void> generate_undirected_csr(
   return {};
 }
 
+/**
+ * @brief Generates the CSR by partitioning the edges into buckets, i.e.,
+ * contiguous ranges of the source vertices, rather than scattering them to
+ * the whole neighbor array with atomic cursors.
+ *
+ * Each thread counts its chunk of edges into a thread-local histogram of the
+ * buckets, then the edges are scattered to a staging array grouped by the
+ * buckets, and at last every bucket is filled and sorted by a single thread.
+ * No atomics are involved on the hot path, and the writes of each step are
+ * either sequential streams or confined in a bucket, at the cost of a
+ * staging array of the edges.
+ *
+ * For undirected graphs, each edge is added to the adjacent lists of both
+ * endpoints.
+ */
+template <typename VID_T, typename EID_T>
+boost::leaf::result<void> generate_csr_by_partition(
+    IdParser<VID_T>& parser,
+    const std::shared_ptr<
+        typename vineyard::ConvertToArrowType<VID_T>::ArrayType>& src_list,
+    const std::shared_ptr<
+        typename vineyard::ConvertToArrowType<VID_T>::ArrayType>& dst_list,
+    std::vector<VID_T> tvnums, int vertex_label_num, int concurrency,
+    bool undirected,
+    std::vector<std::shared_ptr<arrow::FixedSizeBinaryArray>>& edges,
+    std::vector<std::shared_ptr<arrow::Int64Array>>& edge_offsets) {
+  using nbr_unit_t = property_graph_utils::NbrUnit<VID_T, EID_T>;
+  struct staged_edge_t {
+    VID_T offset;
+    nbr_unit_t nbr;
+  };
+  // more buckets than threads, to balance the skewed degrees.
+  constexpr int64_t kBucketsPerThread = 16;
+
+  int thread_num = std::max(concurrency, 1);
+  int64_t edge_num = src_list->length();
+  const VID_T* src_list_ptr = src_list->raw_values();
+  const VID_T* dst_list_ptr = dst_list->raw_values();
+
+  std::vector<int64_t> bucket_width(vertex_label_num);
+  std::vector<int64_t> bucket_begin(vertex_label_num + 1, 0);
+  for (int v_label = 0; v_label != vertex_label_num; ++v_label) {
+    int64_t tvnum = tvnums[v_label];
+    int64_t width = (tvnum + thread_num * kBucketsPerThread - 1) /
+                    (thread_num * kBucketsPerThread);
+    bucket_width[v_label] = std::max(width, static_cast<int64_t>(1));
+    bucket_begin[v_label + 1] =
+        bucket_begin[v_label] +
+        (tvnum + bucket_width[v_label] - 1) / bucket_width[v_label];
+  }
+  int64_t bucket_num = bucket_begin[vertex_label_num];
+  auto bucket_of = [&parser, &bucket_width, &bucket_begin](VID_T id) {
+    auto v_label = parser.GetLabelId(id);
+    return bucket_begin[v_label] + parser.GetOffset(id) / bucket_width[v_label];
+  };
+
+  auto run_chunks = [thread_num, edge_num](auto const& func) {
+    ThreadPool::Default().ParallelFor(
+        thread_num,
+        [&](size_t i) {
+          func(i, edge_num * i / thread_num, edge_num * (i + 1) / thread_num);
+        },
+        thread_num, 1);
+  };
+
+  // thread-local histograms of the buckets.
+  std::vector<std::vector<int64_t>> cursors(
+      thread_num, std::vector<int64_t>(bucket_num, 0));
+  run_chunks([&](int tid, int64_t begin, int64_t end) {
+    auto& histogram = cursors[tid];
+    for (int64_t i = begin; i < end; ++i) {
+      ++histogram[bucket_of(src_list_ptr[i])];
+      if (undirected) {
+        ++histogram[bucket_of(dst_list_ptr[i])];
+      }
+    }
+  });
+
+  // turns the histograms into the cursors of each thread in each bucket.
+  std::vector<int64_t> bucket_offsets(bucket_num + 1, 0);
+  for (int64_t bucket = 0, offset = 0; bucket < bucket_num; ++bucket) {
+    bucket_offsets[bucket] = offset;
+    for (int tid = 0; tid < thread_num; ++tid) {
+      int64_t count = cursors[tid][bucket];
+      cursors[tid][bucket] = offset;
+      offset += count;
+    }
+    bucket_offsets[bucket + 1] = offset;
+  }
+
+  std::vector<staged_edge_t> staged_edges(bucket_offsets[bucket_num]);
+  run_chunks([&](int tid, int64_t begin, int64_t end) {
+    auto& cursor = cursors[tid];
+    for (int64_t i = begin; i < end; ++i) {
+      VID_T src_id = src_list_ptr[i];
+      VID_T dst_id = dst_list_ptr[i];
+      staged_edges[cursor[bucket_of(src_id)]++] = staged_edge_t{
+          static_cast<VID_T>(parser.GetOffset(src_id)),
+          nbr_unit_t(dst_id, static_cast<EID_T>(i))};
+      if (undirected) {
+        staged_edges[cursor[bucket_of(dst_id)]++] = staged_edge_t{
+            static_cast<VID_T>(parser.GetOffset(dst_id)),
+            nbr_unit_t(src_id, static_cast<EID_T>(i))};
+      }
+    }
+  });
+  cursors.clear();
+
+  std::vector<arrow::Int64Builder> offset_builders(vertex_label_num);
+  std::vector<vineyard::PodArrayBuilder<nbr_unit_t>> edge_builders(
+      vertex_label_num);
+  std::vector<nbr_unit_t*> nbrs(vertex_label_num, nullptr);
+  for (int v_label = 0; v_label != vertex_label_num; ++v_label) {
+    int64_t tvnum = tvnums[v_label];
+    int64_t actual_edge_num = bucket_offsets[bucket_begin[v_label + 1]] -
+                              bucket_offsets[bucket_begin[v_label]];
+    ARROW_OK_OR_RAISE(offset_builders[v_label].Resize(tvnum + 1));
+    offset_builders[v_label][tvnum] = actual_edge_num;
+    ARROW_OK_OR_RAISE(edge_builders[v_label].Resize(actual_edge_num));
+    if (actual_edge_num > 0) {
+      nbrs[v_label] = edge_builders[v_label].MutablePointer(0);
+    }
+  }
+
+  // fills and sorts the adjacent lists, bucket by bucket.
+  parallel_for(
+      static_cast<int64_t>(0), bucket_num,
+      [&](int64_t bucket) {
+        int v_label = std::upper_bound(bucket_begin.begin(),
+                                       bucket_begin.end(), bucket) -
+                      bucket_begin.begin() - 1;
+        int64_t tvnum = tvnums[v_label];
+        int64_t lo = (bucket - bucket_begin[v_label]) * bucket_width[v_label];
+        int64_t hi = std::min(lo + bucket_width[v_label], tvnum);
+        int64_t base = bucket_offsets[bucket] -
+                       bucket_offsets[bucket_begin[v_label]];
+        auto& offset_builder = offset_builders[v_label];
+        nbr_unit_t* nbr = nbrs[v_label];
+
+        std::vector<int64_t> cursor(hi - lo + 1, 0);
+        for (int64_t k = bucket_offsets[bucket]; k < bucket_offsets[bucket + 1];
+             ++k) {
+          ++cursor[staged_edges[k].offset - lo + 1];
+        }
+        for (int64_t v = lo; v < hi; ++v) {
+          cursor[v - lo + 1] += cursor[v - lo];
+          offset_builder[v] = base + cursor[v - lo];
+        }
+        for (int64_t k = bucket_offsets[bucket]; k < bucket_offsets[bucket + 1];
+             ++k) {
+          auto const& staged = staged_edges[k];
+          nbr[base + cursor[staged.offset - lo]++] = staged.nbr;
+        }
+        // the cursors have been moved to the end of each adjacent list.
+        for (int64_t v = lo; v < hi; ++v) {
+          std::sort(nbr + offset_builder[v], nbr + base + cursor[v - lo],
+                    [](const nbr_unit_t& lhs, const nbr_unit_t& rhs) {
+                      return lhs.vid < rhs.vid;
+                    });
+        }
+      },
+      thread_num, 1);
+
+  for (int v_label = 0; v_label != vertex_label_num; ++v_label) {
+    int64_t tvnum = tvnums[v_label];
+    int64_t actual_edge_num = offset_builders[v_label][tvnum];
+    ARROW_OK_OR_RAISE(offset_builders[v_label].Advance(tvnum + 1));
+    ARROW_OK_OR_RAISE(offset_builders[v_label].Finish(&edge_offsets[v_label]));
+    ARROW_OK_OR_RAISE(edge_builders[v_label].Advance(actual_edge_num));
+    ARROW_OK_OR_RAISE(edge_builders[v_label].Finish(&edges[v_label]));
+  }
+  return {};
+}
+
+/**
+ * @brief Merges two CSRs of the same vertex label into one, the adjacent list
+ * of each vertex is the merge of its adjacent lists in both CSRs and is kept
+ * sorted by the neighbor ids.
+ *
+ * The `lhs_offsets` may cover only the first `lhs_vnum` vertices, the ones
+ * beyond have no edges in `lhs`. The edge ids of `rhs` are shifted by
+ * `eid_shift`, i.e., the edge table of `rhs` is appended to the one of `lhs`.
+ */
+template <typename VID_T, typename EID_T>
+boost::leaf::result<void> merge_csr(
+    const int64_t* lhs_offsets, int64_t lhs_vnum,
+    const property_graph_utils::NbrUnit<VID_T, EID_T>* lhs_edges,
+    const int64_t* rhs_offsets,
+    const property_graph_utils::NbrUnit<VID_T, EID_T>* rhs_edges,
+    int64_t tvnum, EID_T eid_shift, int concurrency,
+    std::shared_ptr<arrow::FixedSizeBinaryArray>& edges,
+    std::shared_ptr<arrow::Int64Array>& edge_offsets) {
+  using nbr_unit_t = property_graph_utils::NbrUnit<VID_T, EID_T>;
+  auto lhs_begin = [&](int64_t v) {
+    return v < lhs_vnum ? lhs_offsets[v] : lhs_offsets[lhs_vnum];
+  };
+
+  arrow::Int64Builder offset_builder;
+  ARROW_OK_OR_RAISE(offset_builder.Resize(tvnum + 1));
+  int64_t edge_num = 0;
+  for (int64_t v = 0; v < tvnum; ++v) {
+    offset_builder[v] = edge_num;
+    edge_num += lhs_begin(v + 1) - lhs_begin(v) + rhs_offsets[v + 1] -
+                rhs_offsets[v];
+  }
+  offset_builder[tvnum] = edge_num;
+
+  vineyard::PodArrayBuilder<nbr_unit_t> edge_builder;
+  ARROW_OK_OR_RAISE(edge_builder.Resize(edge_num));
+  nbr_unit_t* nbr = edge_num > 0 ? edge_builder.MutablePointer(0) : nullptr;
+  parallel_for(
+      static_cast<int64_t>(0), tvnum,
+      [&](int64_t v) {
+        const nbr_unit_t *lhs = lhs_edges + lhs_begin(v),
+                         *lhs_end = lhs_edges + lhs_begin(v + 1);
+        const nbr_unit_t *rhs = rhs_edges + rhs_offsets[v],
+                         *rhs_end = rhs_edges + rhs_offsets[v + 1];
+        nbr_unit_t* out = nbr + offset_builder[v];
+        while (lhs != lhs_end && rhs != rhs_end) {
+          if (rhs->vid < lhs->vid) {
+            *out++ = nbr_unit_t(rhs->vid, rhs->eid + eid_shift);
+            ++rhs;
+          } else {
+            *out++ = *lhs++;
+          }
+        }
+        out = std::copy(lhs, lhs_end, out);
+        for (; rhs != rhs_end; ++rhs) {
+          *out++ = nbr_unit_t(rhs->vid, rhs->eid + eid_shift);
+        }
+      },
+      std::max(concurrency, 1), 1024);
+
+  ARROW_OK_OR_RAISE(offset_builder.Advance(tvnum + 1));
+  ARROW_OK_OR_RAISE(offset_builder.Finish(&edge_offsets));
+  ARROW_OK_OR_RAISE(edge_builder.Advance(edge_num));
+  ARROW_OK_OR_RAISE(edge_builder.Finish(&edges));
+  return {};
+}
+
+/**
+ * @brief Compresses the adjacent lists of a CSR by `bit_packing::Encode`.
+ *
+ * The `packed_offsets` are the byte offsets of the encoded adjacent lists in
+ * `packed_edges`, and the `packed_edges` are followed by the padding that is
+ * required by the decoding. The sizes are computed in a first pass, thus the
+ * lists are encoded in place, in parallel.
+ */
+template <typename VID_T, typename EID_T>
+boost::leaf::result<void> compress_csr(
+    const std::shared_ptr<arrow::FixedSizeBinaryArray>& edges,
+    const std::shared_ptr<arrow::Int64Array>& edge_offsets, int concurrency,
+    std::shared_ptr<arrow::UInt8Array>& packed_edges,
+    std::shared_ptr<arrow::Int64Array>& packed_offsets) {
+  using nbr_unit_t = property_graph_utils::NbrUnit<VID_T, EID_T>;
+  int64_t vnum = edge_offsets->length() - 1;
+  const int64_t* offsets = edge_offsets->raw_values();
+  const nbr_unit_t* nbrs =
+      edges->length() > 0
+          ? reinterpret_cast<const nbr_unit_t*>(edges->GetValue(0))
+          : nullptr;
+  int thread_num = std::max(concurrency, 1);
+
+  arrow::Int64Builder offset_builder;
+  ARROW_OK_OR_RAISE(offset_builder.Resize(vnum + 1));
+  parallel_for(
+      static_cast<int64_t>(0), vnum,
+      [&](int64_t v) {
+        offset_builder[v + 1] = bit_packing::EncodedSize(
+            nbrs + offsets[v], offsets[v + 1] - offsets[v]);
+      },
+      thread_num, 1024);
+  offset_builder[0] = 0;
+  for (int64_t v = 0; v < vnum; ++v) {
+    offset_builder[v + 1] += offset_builder[v];
+  }
+  int64_t packed_size = offset_builder[vnum] + bit_packing::kPadding;
+
+  arrow::UInt8Builder packed_builder;
+  ARROW_OK_OR_RAISE(packed_builder.Resize(packed_size));
+  uint8_t* out = packed_builder.GetMutableValue(0);
+  std::fill_n(out + offset_builder[vnum], bit_packing::kPadding, 0);
+  parallel_for(
+      static_cast<int64_t>(0), vnum,
+      [&](int64_t v) {
+        bit_packing::Encode(nbrs + offsets[v], offsets[v + 1] - offsets[v],
+                            out + offset_builder[v]);
+      },
+      thread_num, 1024);
+
+  ARROW_OK_OR_RAISE(offset_builder.Advance(vnum + 1));
+  ARROW_OK_OR_RAISE(offset_builder.Finish(&packed_offsets));
+  ARROW_OK_OR_RAISE(packed_builder.Advance(packed_size));
+  ARROW_OK_OR_RAISE(packed_builder.Finish(&packed_edges));
+  return {};
+}
+
 }  // namespace vineyard
 
 namespace grape {
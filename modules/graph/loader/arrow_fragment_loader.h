@@ -50,7 +50,12 @@ limitations under the License.
 #include "graph/utils/thread_group.h"
 #include "graph/vertex_map/arrow_vertex_map.h"
 
+// The partitioner of the loader is selected by defining one of the
+// HASH_PARTITION, RANGE_PARTITION and SEGMENTED_PARTITION, and defaults to the
+// hash one.
+#if !defined(RANGE_PARTITION) && !defined(SEGMENTED_PARTITION)
 #define HASH_PARTITION
+#endif
 
 namespace vineyard {
 
@@ -384,8 +389,10 @@ class ArrowFragmentLoader {
   static constexpr const char* DST_LABEL_TAG = "dst_label";
 
   static constexpr int id_column = 0;
-#ifdef HASH_PARTITION
+#if defined(HASH_PARTITION)
   using partitioner_t = HashPartitioner<oid_t>;
+#elif defined(RANGE_PARTITION)
+  using partitioner_t = RangePartitioner<oid_t>;
 #else
   using partitioner_t = SegmentedPartitioner<oid_t>;
 #endif
@@ -462,6 +469,14 @@ class ArrowFragmentLoader {
 
   ~ArrowFragmentLoader() = default;
 
+  /**
+   * @brief Compresses the adjacent lists of the loaded fragment, see also
+   * `BasicArrowFragmentBuilder::set_compress_edges`.
+   */
+  void set_compress_edges(bool compress_edges) {
+    compress_edges_ = compress_edges;
+  }
+
   boost::leaf::result<ObjectID> LoadFragment() {
     BOOST_LEAF_CHECK(initPartitioner());
 
@@ -529,6 +544,7 @@ class ArrowFragmentLoader {
         basic_fragment_loader = std::make_shared<
             BasicEVFragmentLoader<OID_T, VID_T, partitioner_t>>(
             client_, comm_spec_, partitioner_, directed_, true, generate_eid_);
+    basic_fragment_loader->set_compress_edges(compress_edges_);
 
     BOOST_LEAF_AUTO(v_e_tables,
                     preprocessInputs(partial_v_tables, partial_e_tables));
@@ -569,8 +585,53 @@ class ArrowFragmentLoader {
 
  protected:  // for subclasses
   boost::leaf::result<void> initPartitioner() {
-#ifdef HASH_PARTITION
+#if defined(HASH_PARTITION)
     partitioner_.Init(comm_spec_.fnum());
+#elif defined(RANGE_PARTITION)
+    if (vfiles_.empty()) {
+      RETURN_GS_ERROR(
+          ErrorCode::kInvalidOperationError,
+          "Range partitioner is not supported when the v-file is "
+          "not provided");
+    }
+    // Each worker samples the oids of its own part of the v-files, the
+    // splitters are selected from the samples of all workers.
+    std::vector<std::shared_ptr<arrow::Table>> vtables;
+    {
+      BOOST_LEAF_AUTO(tmp, loadVertexTables(vfiles_, comm_spec_.worker_id(),
+                                            comm_spec_.worker_num()));
+      vtables = tmp;
+    }
+    std::vector<std::shared_ptr<arrow::Array>> oid_arrays;
+    int64_t local_vnum = 0;
+    for (auto& table : vtables) {
+      for (auto const& chunk : table->column(id_column)->chunks()) {
+        oid_arrays.emplace_back(chunk);
+        local_vnum += chunk->length();
+      }
+    }
+    constexpr int64_t sample_num_per_frag = 1024;
+    int64_t stride = std::max<int64_t>(
+        1, local_vnum / (sample_num_per_frag * comm_spec_.fnum()));
+    std::vector<oid_t> samples;
+    int64_t index = 0;
+    for (auto const& chunk : oid_arrays) {
+      auto array = std::dynamic_pointer_cast<oid_array_t>(chunk);
+      for (int64_t i = 0; i < array->length(); ++i, ++index) {
+        if (index % stride == 0) {
+          samples.emplace_back(oid_t(array->GetView(i)));
+        }
+      }
+    }
+    std::vector<std::vector<oid_t>> gathered_samples;
+    GlobalAllGatherv(samples, gathered_samples, comm_spec_);
+    samples.clear();
+    for (auto const& worker_samples : gathered_samples) {
+      samples.insert(samples.end(), worker_samples.begin(),
+                     worker_samples.end());
+    }
+    partitioner_.Init(comm_spec_.fnum(), partitioner_t::SelectSplitters(
+                                             samples, comm_spec_.fnum()));
 #else
     if (vfiles_.empty()) {
       RETURN_GS_ERROR(
@@ -825,6 +886,7 @@ class ArrowFragmentLoader {
 
   bool directed_;
   bool generate_eid_;
+  bool compress_edges_ = false;
 
   std::function<void(IIOAdaptor*)> io_deleter_ = [](IIOAdaptor* adaptor) {
     VINEYARD_CHECK_OK(adaptor->Close());
@@ -436,6 +436,7 @@ class BasicEVFragmentLoader {
     PropertyGraphSchema schema;
     BOOST_LEAF_CHECK(initSchema(schema));
     frag_builder.SetPropertyGraphSchema(std::move(schema));
+    frag_builder.set_compress_edges(compress_edges_);
 
     int thread_num =
         (std::thread::hardware_concurrency() + comm_spec_.local_num() - 1) /
@@ -464,6 +465,10 @@ class BasicEVFragmentLoader {
     vm_ptr_ = in;
   }
 
+  void set_compress_edges(bool compress_edges) {
+    compress_edges_ = compress_edges;
+  }
+
  private:
   boost::leaf::result<std::shared_ptr<arrow::ChunkedArray>>
   parseOidChunkedArray(label_id_t label_id,
@@ -517,10 +522,11 @@ class BasicEVFragmentLoader {
                 return;
               }
 
+              std::vector<fid_t> fids;
+              partitioner_.GetPartitionIds(oid_array, fids);
               for (size_t k = 0; k != size; ++k) {
                 internal_oid_t oid = oid_array->GetView(k);
-                fid_t fid = partitioner_.GetPartitionId(oid_t(oid));
-                if (!vm->GetGid(fid, label_id, oid, builder[k])) {
+                if (!vm->GetGid(fids[k], label_id, oid, builder[k])) {
                   LOG(ERROR) << "Mapping vertex " << oid << " failed.";
                 }
               }
@@ -656,6 +662,7 @@ class BasicEVFragmentLoader {
   bool directed_;
   bool retain_oid_;
   bool generate_eid_;
+  bool compress_edges_ = false;
 
   std::map<std::string, label_id_t> vertex_label_to_index_;
   std::vector<std::string> vertex_labels_;
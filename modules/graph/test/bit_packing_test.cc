@@ -0,0 +1,167 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+#include "glog/logging.h"
+
+#include "graph/fragment/property_graph_types.h"
+#include "graph/fragment/property_graph_utils.h"
+#include "graph/utils/bit_packing.h"
+
+using namespace vineyard;  // NOLINT(build/namespaces)
+
+using vid_t = property_graph_types::VID_TYPE;
+using eid_t = property_graph_types::EID_TYPE;
+using nbr_unit_t = property_graph_utils::NbrUnit<vid_t, eid_t>;
+using compressed_adj_list_t =
+    property_graph_utils::CompressedAdjList<vid_t, eid_t>;
+
+static std::mt19937_64 rng(2021);
+
+uint64_t random_bits(int width) {
+  if (width == 0) {
+    return 0;
+  }
+  uint64_t mask = width == 64 ? ~0ULL : (1ULL << width) - 1;
+  // the highest bit is set, thus the value is exactly `width` bits wide
+  return (rng() & mask) | (1ULL << (width - 1));
+}
+
+// The values of the widths above 57 bits straddle 9 bytes, which are
+// unpacked by the slower path.
+void test_pack_unpack() {
+  for (int width = 0; width <= 64; ++width) {
+    for (int num : {0, 1, 7, 8, 63, 64}) {
+      std::vector<uint64_t> values(num);
+      for (auto& value : values) {
+        value = random_bits(width);
+      }
+      size_t size = bit_packing::PackedSize(num, width);
+      // only the padding is readable past the packed bytes
+      std::vector<uint8_t> packed(size + bit_packing::kPadding);
+      CHECK(bit_packing::Pack(values.data(), num, width, packed.data()) ==
+            packed.data() + size);
+      std::vector<uint64_t> unpacked(num, 0xa5a5a5a5ULL);
+      CHECK(bit_packing::Unpack(packed.data(), num, width, unpacked.data()) ==
+            packed.data() + size);
+      CHECK(unpacked == values);
+    }
+  }
+}
+
+// Encodes the list, then decodes it both block by block and by iterating
+// the compressed adjacent list.
+void check_round_trip(std::vector<nbr_unit_t> const& nbrs) {
+  int64_t num = nbrs.size();
+  size_t size = bit_packing::EncodedSize(nbrs.data(), num);
+  std::vector<uint8_t> encoded(size + bit_packing::kPadding);
+  CHECK(bit_packing::Encode(nbrs.data(), num, encoded.data()) ==
+        encoded.data() + size);
+
+  std::vector<nbr_unit_t> decoded(num);
+  const uint8_t* data = encoded.data();
+  uint64_t prev = 0;
+  for (int64_t begin = 0; begin < num; begin += bit_packing::kBlockSize) {
+    int count = static_cast<int>(
+        std::min<int64_t>(bit_packing::kBlockSize, num - begin));
+    data = bit_packing::DecodeBlock(data, count, prev, decoded.data() + begin);
+    prev = decoded[begin + count - 1].vid;
+  }
+  CHECK(data == encoded.data() + size);
+  for (int64_t k = 0; k < num; ++k) {
+    CHECK_EQ(decoded[k].vid, nbrs[k].vid);
+    CHECK_EQ(decoded[k].eid, nbrs[k].eid);
+  }
+
+  compressed_adj_list_t list(encoded.data(), num, nullptr);
+  CHECK_EQ(list.Size(), static_cast<size_t>(num));
+  int64_t index = 0;
+  for (auto& e : list) {
+    CHECK_LT(index, num);
+    CHECK_EQ(e.neighbor().GetValue(), nbrs[index].vid);
+    CHECK_EQ(e.edge_id(), nbrs[index].eid);
+    ++index;
+  }
+  CHECK_EQ(index, num);
+
+  std::vector<nbr_unit_t> whole(num);
+  list.Decode(whole.data());
+  for (int64_t k = 0; k < num; ++k) {
+    CHECK_EQ(whole[k].vid, nbrs[k].vid);
+    CHECK_EQ(whole[k].eid, nbrs[k].eid);
+  }
+}
+
+std::vector<nbr_unit_t> sorted_nbrs(int64_t num, int vid_width,
+                                    int eid_width) {
+  std::vector<nbr_unit_t> nbrs(num);
+  vid_t vid = rng() % 1000;
+  for (auto& nbr : nbrs) {
+    nbr.vid = vid;
+    nbr.eid = random_bits(eid_width);
+    vid += random_bits(vid_width) % 1000;
+  }
+  return nbrs;
+}
+
+void test_encode_decode() {
+  // the empty list and the lists around the block size
+  for (int64_t num : {0, 1, 2, 63, 64, 65, 128, 129, 1000}) {
+    check_round_trip(sorted_nbrs(num, 10, 20));
+  }
+
+  // width 0: the same neighbor and the same edge id repeated
+  for (int64_t num : {1, 64, 200}) {
+    std::vector<nbr_unit_t> nbrs(num, nbr_unit_t(12345, 678));
+    check_round_trip(nbrs);
+  }
+
+  // the deltas and the edge id offsets of 58 to 64 bits
+  for (int width = 58; width <= 64; ++width) {
+    for (int64_t num : {2, 64, 130}) {
+      std::vector<nbr_unit_t> nbrs(num);
+      for (int64_t k = 0; k < num; ++k) {
+        // alternating between 0 and a `width` bits wide value, every block
+        // has both the smallest and the widest edge ids
+        nbrs[k].eid = k % 2 == 0 ? 0 : random_bits(width);
+        nbrs[k].vid = k;
+      }
+      nbrs[num - 1].vid = random_bits(width);
+      std::sort(nbrs.begin(), nbrs.end(),
+                [](const nbr_unit_t& lhs, const nbr_unit_t& rhs) {
+                  return lhs.vid < rhs.vid;
+                });
+      check_round_trip(nbrs);
+    }
+  }
+
+  // the unsorted lists are still round-tripped, as the deltas wrap around,
+  // though they are packed in 64 bits.
+  for (int64_t num : {2, 64, 65, 300}) {
+    auto nbrs = sorted_nbrs(num, 10, 20);
+    std::shuffle(nbrs.begin(), nbrs.end(), rng);
+    check_round_trip(nbrs);
+  }
+}
+
+int main(int argc, char** argv) {
+  test_pack_unpack();
+  test_encode_decode();
+  LOG(INFO) << "Passed bit packing tests...";
+  return 0;
+}
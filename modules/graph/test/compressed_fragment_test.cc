@@ -0,0 +1,198 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <stdio.h>
+
+#include <algorithm>
+#include <memory>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "arrow/api.h"
+#include "glog/logging.h"
+
+#include "client/client.h"
+
+#include "graph/fragment/arrow_fragment.h"
+#include "graph/loader/arrow_fragment_loader.h"
+
+using namespace vineyard;  // NOLINT(build/namespaces)
+
+using oid_t = property_graph_types::OID_TYPE;
+using vid_t = property_graph_types::VID_TYPE;
+using GraphType = ArrowFragment<oid_t, vid_t>;
+using LoaderType = ArrowFragmentLoader<oid_t, vid_t>;
+
+// (neighbor, weight) of the edges of a vertex
+using nbrs_t = std::vector<std::pair<oid_t, int64_t>>;
+
+const oid_t vertex_num = 2000;
+
+std::shared_ptr<arrow::Array> finish(arrow::ArrayBuilder& builder) {
+  std::shared_ptr<arrow::Array> array;
+  CHECK(builder.Finish(&array).ok());
+  return array;
+}
+
+// The vertices below 4 are hubs that have hundreds of neighbors, i.e.,
+// several blocks of the compressed lists, and there are parallel edges.
+void generate_tables(const grape::CommSpec& comm_spec,
+                     std::vector<std::shared_ptr<arrow::Table>>& v_tables,
+                     std::vector<std::vector<std::shared_ptr<arrow::Table>>>&
+                         e_tables) {
+  arrow::Int64Builder id_builder, src_builder, dst_builder, weight_builder;
+  for (oid_t i = comm_spec.worker_id(); i < vertex_num;
+       i += comm_spec.worker_num()) {
+    CHECK(id_builder.Append(i).ok());
+  }
+  std::mt19937_64 rng(comm_spec.worker_id());
+  int64_t weight = comm_spec.worker_id() * 1000000;
+  for (oid_t i = comm_spec.worker_id(); i < vertex_num;
+       i += comm_spec.worker_num()) {
+    int degree = i < 4 ? 500 : static_cast<int>(rng() % 5);
+    for (int k = 0; k < degree; ++k) {
+      oid_t dst = k % 7 == 0 ? static_cast<oid_t>(rng() % 4)
+                             : static_cast<oid_t>(rng() % vertex_num);
+      CHECK(src_builder.Append(i).ok());
+      CHECK(dst_builder.Append(dst).ok());
+      CHECK(weight_builder.Append(weight++).ok());
+    }
+  }
+  auto v_table =
+      arrow::Table::Make(arrow::schema({arrow::field("id", arrow::int64())}),
+                         {finish(id_builder)});
+  auto e_table = arrow::Table::Make(
+      arrow::schema({arrow::field("src", arrow::int64()),
+                     arrow::field("dst", arrow::int64()),
+                     arrow::field("weight", arrow::int64())}),
+      {finish(src_builder), finish(dst_builder), finish(weight_builder)});
+  v_tables.emplace_back(v_table->ReplaceSchemaMetadata(
+      arrow::key_value_metadata({LoaderType::LABEL_TAG}, {"v"})));
+  e_tables.emplace_back();
+  e_tables.back().emplace_back(
+      e_table->ReplaceSchemaMetadata(arrow::key_value_metadata(
+          {LoaderType::LABEL_TAG, LoaderType::SRC_LABEL_TAG,
+           LoaderType::DST_LABEL_TAG},
+          {"e", "v", "v"})));
+}
+
+ObjectID load_fragment(Client& client, const grape::CommSpec& comm_spec,
+                       bool directed, bool compress_edges) {
+  std::vector<std::shared_ptr<arrow::Table>> v_tables;
+  std::vector<std::vector<std::shared_ptr<arrow::Table>>> e_tables;
+  generate_tables(comm_spec, v_tables, e_tables);
+  auto loader = std::make_unique<LoaderType>(client, comm_spec, v_tables,
+                                             e_tables, directed);
+  loader->set_compress_edges(compress_edges);
+  return boost::leaf::try_handle_all(
+      [&loader]() { return loader->LoadFragment(); },
+      [](const GSError& e) {
+        LOG(FATAL) << e.error_msg;
+        return 0;
+      },
+      [](const boost::leaf::error_info& unmatched) {
+        LOG(FATAL) << "Unmatched error " << unmatched;
+        return 0;
+      });
+}
+
+template <typename ADJ_LIST_T>
+nbrs_t collect(std::shared_ptr<GraphType> const& frag, ADJ_LIST_T const& list,
+               bool sorted) {
+  nbrs_t nbrs;
+  vid_t prev = 0;
+  for (auto& e : list) {
+    // the compressed lists are sorted by the neighbor ids
+    CHECK(!sorted || prev <= e.neighbor().GetValue());
+    prev = e.neighbor().GetValue();
+    nbrs.emplace_back(frag->GetId(e.neighbor()),
+                      e.template get_data<int64_t>(0));
+  }
+  std::sort(nbrs.begin(), nbrs.end());
+  return nbrs;
+}
+
+// The compressed lists, and the plain lists decoded from them, have the same
+// edges and edge data as the plain lists of the same graph, for both the
+// inner and the outer vertices.
+void check_compressed(std::shared_ptr<GraphType> const& plain,
+                      std::shared_ptr<GraphType> const& compressed) {
+  CHECK(!plain->compressed_edges());
+  CHECK(compressed->compressed_edges());
+  CHECK_EQ(plain->GetEdgeNum(), compressed->GetEdgeNum());
+  for (auto v : plain->Vertices(0)) {
+    GraphType::vertex_t u;
+    CHECK(compressed->GetVertex(0, plain->GetId(v), u));
+    CHECK(collect(plain, plain->GetOutgoingAdjList(v, 0), false) ==
+          collect(compressed, compressed->GetOutgoingCompressedAdjList(u, 0),
+                  true));
+    CHECK(collect(plain, plain->GetIncomingAdjList(v, 0), false) ==
+          collect(compressed, compressed->GetIncomingCompressedAdjList(u, 0),
+                  true));
+    CHECK(collect(plain, plain->GetOutgoingAdjList(v, 0), false) ==
+          collect(compressed, compressed->GetOutgoingAdjList(u, 0), true));
+    CHECK(collect(plain, plain->GetIncomingAdjList(v, 0), false) ==
+          collect(compressed, compressed->GetIncomingAdjList(u, 0), true));
+
+    // the decoded lists own their buffers, thus are kept while iterating.
+    auto raw = compressed->GetOutgoingRawAdjList(u, 0);
+    auto list = compressed->GetOutgoingAdjList(u, 0);
+    auto nbr = list.begin();
+    CHECK_EQ(raw.Size(), list.Size());
+    for (auto& unit : raw) {
+      CHECK_EQ(unit.vid, nbr.neighbor().GetValue());
+      CHECK_EQ(unit.eid, nbr.edge_id());
+      ++nbr;
+    }
+
+    CHECK_EQ(plain->GetLocalOutDegree(v, 0),
+             compressed->GetLocalOutDegree(u, 0));
+    CHECK_EQ(plain->GetLocalInDegree(v, 0),
+             compressed->GetLocalInDegree(u, 0));
+  }
+}
+
+int main(int argc, char** argv) {
+  if (argc < 2) {
+    printf("usage: ./compressed_fragment_test <ipc_socket>\n");
+    return 1;
+  }
+  std::string ipc_socket = std::string(argv[1]);
+
+  Client client;
+  VINEYARD_CHECK_OK(client.Connect(ipc_socket));
+  LOG(INFO) << "Connected to IPCServer: " << ipc_socket;
+
+  grape::InitMPIComm();
+  {
+    grape::CommSpec comm_spec;
+    comm_spec.Init(MPI_COMM_WORLD);
+
+    for (bool directed : {true, false}) {
+      auto plain = std::dynamic_pointer_cast<GraphType>(client.GetObject(
+          load_fragment(client, comm_spec, directed, false)));
+      auto compressed = std::dynamic_pointer_cast<GraphType>(client.GetObject(
+          load_fragment(client, comm_spec, directed, true)));
+      check_compressed(plain, compressed);
+    }
+    LOG(INFO) << "Passed compressed fragment tests...";
+  }
+  grape::FinalizeMPIComm();
+
+  client.Disconnect();
+  return 0;
+}
@@ -0,0 +1,141 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <algorithm>
+#include <memory>
+#include <random>
+#include <tuple>
+#include <vector>
+
+#include "glog/logging.h"
+
+#include "graph/fragment/property_graph_types.h"
+#include "graph/fragment/property_graph_utils.h"
+
+using namespace vineyard;  // NOLINT(build/namespaces)
+
+using vid_t = property_graph_types::VID_TYPE;
+using eid_t = property_graph_types::EID_TYPE;
+using vid_array_t = typename ConvertToArrowType<vid_t>::ArrayType;
+using nbr_unit_t = property_graph_utils::NbrUnit<vid_t, eid_t>;
+
+using edges_t = std::vector<std::shared_ptr<arrow::FixedSizeBinaryArray>>;
+using offsets_t = std::vector<std::shared_ptr<arrow::Int64Array>>;
+
+// Picks the endpoints uniformly from all the labels, except that every
+// `hub_every`-th endpoint is the first vertex of its label.
+std::shared_ptr<vid_array_t> generate_endpoints(
+    IdParser<vid_t> const& parser, std::vector<vid_t> const& tvnums,
+    int64_t edge_num, int64_t hub_every, size_t seed) {
+  std::vector<int> labels;
+  for (size_t label = 0; label < tvnums.size(); ++label) {
+    if (tvnums[label] > 0) {
+      labels.push_back(static_cast<int>(label));
+    }
+  }
+  std::mt19937_64 rng(seed);
+  typename ConvertToArrowType<vid_t>::BuilderType builder;
+  CHECK(builder.Reserve(edge_num).ok());
+  for (int64_t i = 0; i < edge_num; ++i) {
+    int label = labels[rng() % labels.size()];
+    int64_t offset = i % hub_every == 0 ? 0 : rng() % tvnums[label];
+    builder.UnsafeAppend(parser.GenerateId(0, label, offset));
+  }
+  std::shared_ptr<vid_array_t> array;
+  CHECK(builder.Finish(&array).ok());
+  return array;
+}
+
+// The order of the neighbors with the same vid is unspecified, thus the
+// adjacent lists are compared after being sorted by (vid, eid).
+void check_same(edges_t const& expected_edges,
+                offsets_t const& expected_offsets, edges_t const& edges,
+                offsets_t const& offsets) {
+  CHECK_EQ(expected_edges.size(), edges.size());
+  for (size_t label = 0; label < edges.size(); ++label) {
+    CHECK(expected_offsets[label]->Equals(*offsets[label]));
+    CHECK_EQ(expected_edges[label]->length(), edges[label]->length());
+    if (edges[label]->length() == 0) {
+      continue;
+    }
+    auto expected_nbrs =
+        reinterpret_cast<const nbr_unit_t*>(expected_edges[label]->GetValue(0));
+    auto nbrs = reinterpret_cast<const nbr_unit_t*>(edges[label]->GetValue(0));
+    auto less = [](const nbr_unit_t& lhs, const nbr_unit_t& rhs) {
+      return std::tie(lhs.vid, lhs.eid) < std::tie(rhs.vid, rhs.eid);
+    };
+    const int64_t* offsets_ptr = offsets[label]->raw_values();
+    for (int64_t v = 0; v + 1 < offsets[label]->length(); ++v) {
+      std::vector<nbr_unit_t> lhs(expected_nbrs + offsets_ptr[v],
+                                  expected_nbrs + offsets_ptr[v + 1]);
+      std::vector<nbr_unit_t> rhs(nbrs + offsets_ptr[v],
+                                  nbrs + offsets_ptr[v + 1]);
+      // the lists are sorted by the neighbor ids
+      for (size_t k = 1; k < rhs.size(); ++k) {
+        CHECK_LE(rhs[k - 1].vid, rhs[k].vid);
+      }
+      std::sort(lhs.begin(), lhs.end(), less);
+      std::sort(rhs.begin(), rhs.end(), less);
+      for (size_t k = 0; k < lhs.size(); ++k) {
+        CHECK_EQ(lhs[k].vid, rhs[k].vid);
+        CHECK_EQ(lhs[k].eid, rhs[k].eid);
+      }
+    }
+  }
+}
+
+void test_csr(std::vector<vid_t> const& tvnums, int64_t edge_num,
+              int64_t hub_every, int concurrency) {
+  int label_num = static_cast<int>(tvnums.size());
+  IdParser<vid_t> parser;
+  parser.Init(1, label_num);
+  auto src = generate_endpoints(parser, tvnums, edge_num, hub_every, 1);
+  auto dst = generate_endpoints(parser, tvnums, edge_num, hub_every, 2);
+
+  for (bool undirected : {false, true}) {
+    edges_t expected_edges(label_num), edges(label_num);
+    offsets_t expected_offsets(label_num), offsets(label_num);
+    if (undirected) {
+      CHECK(generate_undirected_csr<vid_t, eid_t>(parser, src, dst, tvnums,
+                                                  label_num, 1, expected_edges,
+                                                  expected_offsets));
+    } else {
+      CHECK(generate_directed_csr<vid_t, eid_t>(parser, src, dst, tvnums,
+                                                label_num, 1, expected_edges,
+                                                expected_offsets));
+    }
+    CHECK(generate_csr_by_partition<vid_t, eid_t>(parser, src, dst, tvnums,
+                                                  label_num, concurrency,
+                                                  undirected, edges, offsets));
+    check_same(expected_edges, expected_offsets, edges, offsets);
+  }
+}
+
+int main(int argc, char** argv) {
+  for (int concurrency : {1, 3, 8}) {
+    // a single label
+    test_csr({1000}, 10000, 100, concurrency);
+    // multiple labels, with an empty one in the middle
+    test_csr({100, 0, 4000, 17}, 20000, 50, concurrency);
+    // heavy hubs
+    test_csr({5000, 5000}, 20000, 2, concurrency);
+    // fewer vertices and edges than the buckets
+    test_csr({3, 1}, 5, 1000, concurrency);
+    // no edges at all
+    test_csr({10, 20}, 0, 1, concurrency);
+  }
+  LOG(INFO) << "Passed CSR construction by partition tests...";
+  return 0;
+}
@@ -0,0 +1,293 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <stdio.h>
+
+#include <algorithm>
+#include <map>
+#include <memory>
+#include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include "arrow/api.h"
+#include "glog/logging.h"
+
+#include "client/client.h"
+
+#include "graph/fragment/arrow_fragment.h"
+#include "graph/loader/arrow_fragment_loader.h"
+
+using namespace vineyard;  // NOLINT(build/namespaces)
+
+using oid_t = property_graph_types::OID_TYPE;
+using vid_t = property_graph_types::VID_TYPE;
+using GraphType = ArrowFragment<oid_t, vid_t>;
+using LoaderType = ArrowFragmentLoader<oid_t, vid_t>;
+using vertex_t = typename GraphType::vertex_t;
+
+// (src, dst, weight)
+using edge_t = std::tuple<oid_t, oid_t, int64_t>;
+// (neighbor, weight) of the edges of a vertex
+using nbrs_t = std::vector<std::pair<oid_t, int64_t>>;
+
+const oid_t vertex_num = 100;
+
+std::vector<edge_t> base_edges() {
+  std::vector<edge_t> edges;
+  for (oid_t i = 0; i < vertex_num; ++i) {
+    edges.emplace_back(i, (i * 7 + 1) % vertex_num, i * 100);
+    edges.emplace_back(i, (i + 3) % vertex_num, i * 100 + 1);
+  }
+  return edges;
+}
+
+// The destinations of the delta edges are spread over all the fragments, some
+// of them are not the outer vertices of the base fragment yet.
+std::vector<edge_t> delta_edges(int round) {
+  std::vector<edge_t> edges;
+  for (oid_t i = 0; i < vertex_num; ++i) {
+    if (round == 0 && i % 3 == 0) {
+      edges.emplace_back(i, (i * 11 + 5) % vertex_num, 10000 + i);
+    }
+    if (round == 1 && i % 4 == 0) {
+      edges.emplace_back(i, (i + 50) % vertex_num, 20000 + i);
+      edges.emplace_back(i, (i * 7 + 1) % vertex_num, 30000 + i);
+    }
+  }
+  return edges;
+}
+
+std::shared_ptr<arrow::Table> make_table(
+    std::shared_ptr<arrow::Schema> const& schema,
+    std::vector<std::shared_ptr<arrow::Array>> const& columns,
+    std::vector<std::string> const& keys,
+    std::vector<std::string> const& values) {
+  return arrow::Table::Make(schema, columns)
+      ->ReplaceSchemaMetadata(arrow::key_value_metadata(keys, values));
+}
+
+std::shared_ptr<arrow::Array> finish(arrow::ArrayBuilder& builder) {
+  std::shared_ptr<arrow::Array> array;
+  CHECK(builder.Finish(&array).ok());
+  return array;
+}
+
+ObjectID load_fragment(Client& client, const grape::CommSpec& comm_spec) {
+  arrow::Int64Builder id_builder, src_builder, dst_builder, weight_builder;
+  arrow::DoubleBuilder value_builder;
+  for (oid_t i = comm_spec.worker_id(); i < vertex_num;
+       i += comm_spec.worker_num()) {
+    CHECK(id_builder.Append(i).ok());
+    CHECK(value_builder.Append(i * 0.5).ok());
+  }
+  for (auto const& edge : base_edges()) {
+    if (std::get<0>(edge) % comm_spec.worker_num() == comm_spec.worker_id()) {
+      CHECK(src_builder.Append(std::get<0>(edge)).ok());
+      CHECK(dst_builder.Append(std::get<1>(edge)).ok());
+      CHECK(weight_builder.Append(std::get<2>(edge)).ok());
+    }
+  }
+  auto vertex_table = make_table(
+      arrow::schema({arrow::field("id", arrow::int64()),
+                     arrow::field("value", arrow::float64())}),
+      {finish(id_builder), finish(value_builder)}, {LoaderType::LABEL_TAG},
+      {"v"});
+  auto edge_table = make_table(
+      arrow::schema({arrow::field("src", arrow::int64()),
+                     arrow::field("dst", arrow::int64()),
+                     arrow::field("weight", arrow::int64())}),
+      {finish(src_builder), finish(dst_builder), finish(weight_builder)},
+      {LoaderType::LABEL_TAG, LoaderType::SRC_LABEL_TAG,
+       LoaderType::DST_LABEL_TAG},
+      {"e", "v", "v"});
+
+  std::vector<std::shared_ptr<arrow::Table>> vertex_tables{vertex_table};
+  std::vector<std::vector<std::shared_ptr<arrow::Table>>> edge_tables{
+      {edge_table}};
+  auto loader = std::make_unique<LoaderType>(client, comm_spec, vertex_tables,
+                                             edge_tables, true);
+  return boost::leaf::try_handle_all(
+      [&loader]() { return loader->LoadFragment(); },
+      [](const GSError& e) {
+        LOG(FATAL) << e.error_msg;
+        return 0;
+      },
+      [](const boost::leaf::error_info& unmatched) {
+        LOG(FATAL) << "Unmatched error " << unmatched;
+        return 0;
+      });
+}
+
+// Each fragment gets the delta edges that have an endpoint in itself, in the
+// same way as the loader distributes the edges.
+ObjectID add_delta_edges(Client& client, std::shared_ptr<GraphType> frag,
+                         std::vector<edge_t> const& edges) {
+  auto vm = frag->GetVertexMap();
+  typename ConvertToArrowType<vid_t>::BuilderType src_builder, dst_builder;
+  arrow::Int64Builder weight_builder;
+  for (auto const& edge : edges) {
+    vid_t src_gid, dst_gid;
+    CHECK(vm->GetGid(0, std::get<0>(edge), src_gid));
+    CHECK(vm->GetGid(0, std::get<1>(edge), dst_gid));
+    vertex_t src, dst;
+    if (!frag->GetInnerVertex(0, std::get<0>(edge), src) &&
+        !frag->GetInnerVertex(0, std::get<1>(edge), dst)) {
+      continue;
+    }
+    CHECK(src_builder.Append(src_gid).ok());
+    CHECK(dst_builder.Append(dst_gid).ok());
+    CHECK(weight_builder.Append(std::get<2>(edge)).ok());
+  }
+  auto vid_type = ConvertToArrowType<vid_t>::TypeValue();
+  auto table = arrow::Table::Make(
+      arrow::schema({arrow::field("src", vid_type),
+                     arrow::field("dst", vid_type),
+                     arrow::field("weight", arrow::int64())}),
+      {finish(src_builder), finish(dst_builder), finish(weight_builder)});
+  std::map<GraphType::label_id_t, std::shared_ptr<arrow::Table>> tables;
+  tables[0] = table;
+  return boost::leaf::try_handle_all(
+      [&]() { return frag->AddDeltaEdges(client, std::move(tables), 4); },
+      [](const GSError& e) {
+        LOG(FATAL) << e.error_msg;
+        return 0;
+      },
+      [](const boost::leaf::error_info& unmatched) {
+        LOG(FATAL) << "Unmatched error " << unmatched;
+        return 0;
+      });
+}
+
+template <typename ADJ_LIST_T>
+nbrs_t collect(std::shared_ptr<GraphType> const& frag, ADJ_LIST_T const& list) {
+  nbrs_t nbrs;
+  for (auto& e : list) {
+    nbrs.emplace_back(frag->GetId(e.neighbor()),
+                      e.template get_data<int64_t>(0));
+  }
+  std::sort(nbrs.begin(), nbrs.end());
+  return nbrs;
+}
+
+// The expected outgoing and incoming edges of every vertex.
+void expected_nbrs(std::vector<std::vector<edge_t>> const& edge_lists,
+                   std::map<oid_t, nbrs_t>& oe, std::map<oid_t, nbrs_t>& ie) {
+  for (auto const& edges : edge_lists) {
+    for (auto const& edge : edges) {
+      oe[std::get<0>(edge)].emplace_back(std::get<1>(edge), std::get<2>(edge));
+      ie[std::get<1>(edge)].emplace_back(std::get<0>(edge), std::get<2>(edge));
+    }
+  }
+  for (auto& pair : oe) {
+    std::sort(pair.second.begin(), pair.second.end());
+  }
+  for (auto& pair : ie) {
+    std::sort(pair.second.begin(), pair.second.end());
+  }
+}
+
+// The plain adjacent lists, the degrees and the edge number cover the base
+// CSR only, while the merged ones cover both the base CSR and the delta CSR.
+void check_fragment(std::shared_ptr<GraphType> const& frag,
+                    std::vector<std::vector<edge_t>> const& base_lists,
+                    std::vector<std::vector<edge_t>> const& all_lists) {
+  std::map<oid_t, nbrs_t> base_oe, base_ie, all_oe, all_ie;
+  expected_nbrs(base_lists, base_oe, base_ie);
+  expected_nbrs(all_lists, all_oe, all_ie);
+  for (auto v : frag->InnerVertices(0)) {
+    oid_t id = frag->GetId(v);
+    CHECK(collect(frag, frag->GetOutgoingAdjList(v, 0)) == base_oe[id]);
+    CHECK(collect(frag, frag->GetIncomingAdjList(v, 0)) == base_ie[id]);
+    CHECK(collect(frag, frag->GetOutgoingMergedAdjList(v, 0)) == all_oe[id]);
+    CHECK(collect(frag, frag->GetIncomingMergedAdjList(v, 0)) == all_ie[id]);
+
+    CHECK_EQ(static_cast<size_t>(frag->GetLocalOutDegree(v, 0)),
+             base_oe[id].size());
+    CHECK_EQ(static_cast<size_t>(frag->GetLocalInDegree(v, 0)),
+             base_ie[id].size());
+    CHECK_EQ(frag->GetOutgoingMergedAdjList(v, 0).Size(), all_oe[id].size());
+    CHECK_EQ(frag->GetIncomingMergedAdjList(v, 0).Size(), all_ie[id].size());
+  }
+
+  size_t base_num = 0, all_num = 0;
+  for (auto v : frag->Vertices(0)) {
+    base_num += frag->GetLocalOutDegree(v, 0);
+    all_num += frag->GetOutgoingMergedAdjList(v, 0).Size();
+    if (frag->directed()) {
+      base_num += frag->GetLocalInDegree(v, 0);
+      all_num += frag->GetIncomingMergedAdjList(v, 0).Size();
+    }
+  }
+  CHECK_EQ(frag->GetEdgeNum(), base_num);
+  CHECK_EQ(frag->GetMergedEdgeNum(), all_num);
+}
+
+int main(int argc, char** argv) {
+  if (argc < 2) {
+    printf("usage: ./delta_edges_test <ipc_socket>\n");
+    return 1;
+  }
+  std::string ipc_socket = std::string(argv[1]);
+
+  Client client;
+  VINEYARD_CHECK_OK(client.Connect(ipc_socket));
+  LOG(INFO) << "Connected to IPCServer: " << ipc_socket;
+
+  grape::InitMPIComm();
+  {
+    grape::CommSpec comm_spec;
+    comm_spec.Init(MPI_COMM_WORLD);
+
+    auto base = base_edges();
+    ObjectID frag_id = load_fragment(client, comm_spec);
+    auto frag = std::dynamic_pointer_cast<GraphType>(client.GetObject(frag_id));
+    CHECK(!frag->has_delta_edges());
+    check_fragment(frag, {base}, {base});
+
+    // the second round is merged into the existing delta CSR
+    std::vector<std::vector<edge_t>> all_lists{base};
+    for (int round = 0; round < 2; ++round) {
+      auto delta = delta_edges(round);
+      all_lists.emplace_back(delta);
+      frag_id = add_delta_edges(client, frag, delta);
+      frag = std::dynamic_pointer_cast<GraphType>(client.GetObject(frag_id));
+      CHECK(frag->has_delta_edges());
+      check_fragment(frag, {base}, all_lists);
+    }
+    LOG(INFO) << "Passed add delta edges tests...";
+
+    // after the compaction the plain adjacent lists cover all the edges
+    frag_id = boost::leaf::try_handle_all(
+        [&]() { return frag->CompactDeltaEdges(client, 4); },
+        [](const GSError& e) {
+          LOG(FATAL) << e.error_msg;
+          return 0;
+        },
+        [](const boost::leaf::error_info& unmatched) {
+          LOG(FATAL) << "Unmatched error " << unmatched;
+          return 0;
+        });
+    frag = std::dynamic_pointer_cast<GraphType>(client.GetObject(frag_id));
+    CHECK(!frag->has_delta_edges());
+    check_fragment(frag, all_lists, all_lists);
+    LOG(INFO) << "Passed compact delta edges tests...";
+  }
+  grape::FinalizeMPIComm();
+
+  client.Disconnect();
+  return 0;
+}
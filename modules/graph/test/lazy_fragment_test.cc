@@ -0,0 +1,223 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <stdio.h>
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "arrow/api.h"
+#include "glog/logging.h"
+
+#include "client/client.h"
+
+#include "graph/fragment/arrow_fragment.h"
+#include "graph/loader/arrow_fragment_loader.h"
+
+using namespace vineyard;  // NOLINT(build/namespaces)
+
+using oid_t = property_graph_types::OID_TYPE;
+using vid_t = property_graph_types::VID_TYPE;
+using GraphType = ArrowFragment<oid_t, vid_t>;
+using LoaderType = ArrowFragmentLoader<oid_t, vid_t>;
+using label_id_t = typename GraphType::label_id_t;
+
+const oid_t vertex_num = 500;
+
+std::shared_ptr<arrow::Array> finish(arrow::ArrayBuilder& builder) {
+  std::shared_ptr<arrow::Array> array;
+  CHECK(builder.Finish(&array).ok());
+  return array;
+}
+
+std::shared_ptr<arrow::Table> vertex_table(const grape::CommSpec& comm_spec,
+                                           const std::string& label,
+                                           int64_t base) {
+  arrow::Int64Builder id_builder, value_builder;
+  for (oid_t i = comm_spec.worker_id(); i < vertex_num;
+       i += comm_spec.worker_num()) {
+    CHECK(id_builder.Append(i).ok());
+    CHECK(value_builder.Append(base + i).ok());
+  }
+  return arrow::Table::Make(
+             arrow::schema({arrow::field("id", arrow::int64()),
+                            arrow::field("value", arrow::int64())}),
+             {finish(id_builder), finish(value_builder)})
+      ->ReplaceSchemaMetadata(
+          arrow::key_value_metadata({LoaderType::LABEL_TAG}, {label}));
+}
+
+std::shared_ptr<arrow::Table> edge_table(const grape::CommSpec& comm_spec,
+                                         const std::string& label,
+                                         const std::string& src_label,
+                                         const std::string& dst_label,
+                                         int64_t step) {
+  arrow::Int64Builder src_builder, dst_builder, weight_builder;
+  for (oid_t i = comm_spec.worker_id(); i < vertex_num;
+       i += comm_spec.worker_num()) {
+    for (int64_t k = 0; k < i % 4; ++k) {
+      CHECK(src_builder.Append(i).ok());
+      CHECK(dst_builder.Append((i * step + k) % vertex_num).ok());
+      CHECK(weight_builder.Append(i * 10 + k).ok());
+    }
+  }
+  return arrow::Table::Make(
+             arrow::schema({arrow::field("src", arrow::int64()),
+                            arrow::field("dst", arrow::int64()),
+                            arrow::field("weight", arrow::int64())}),
+             {finish(src_builder), finish(dst_builder), finish(weight_builder)})
+      ->ReplaceSchemaMetadata(arrow::key_value_metadata(
+          {LoaderType::LABEL_TAG, LoaderType::SRC_LABEL_TAG,
+           LoaderType::DST_LABEL_TAG},
+          {label, src_label, dst_label}));
+}
+
+// Two vertex labels and three edge labels, thus the labels are constructed
+// on the first access separately.
+ObjectID load_fragment(Client& client, const grape::CommSpec& comm_spec) {
+  std::vector<std::shared_ptr<arrow::Table>> v_tables{
+      vertex_table(comm_spec, "a", 0), vertex_table(comm_spec, "b", 100000)};
+  std::vector<std::vector<std::shared_ptr<arrow::Table>>> e_tables{
+      {edge_table(comm_spec, "ab", "a", "b", 7)},
+      {edge_table(comm_spec, "ba", "b", "a", 13)},
+      {edge_table(comm_spec, "aa", "a", "a", 3)}};
+  auto loader = std::make_unique<LoaderType>(client, comm_spec, v_tables,
+                                             e_tables, true);
+  return boost::leaf::try_handle_all(
+      [&loader]() { return loader->LoadFragment(); },
+      [](const GSError& e) {
+        LOG(FATAL) << e.error_msg;
+        return 0;
+      },
+      [](const boost::leaf::error_info& unmatched) {
+        LOG(FATAL) << "Unmatched error " << unmatched;
+        return 0;
+      });
+}
+
+// Dumps everything reachable from the vertices of `v_label`, the vertex
+// data, the outer vertices, the degrees and the edges with their data.
+std::string traverse(std::shared_ptr<GraphType> const& frag,
+                     label_id_t v_label) {
+  std::stringstream ss;
+  for (auto v : frag->InnerVertices(v_label)) {
+    ss << frag->GetId(v) << ":" << frag->GetData<int64_t>(v, 0) << "\n";
+  }
+  for (auto v : frag->OuterVertices(v_label)) {
+    ss << frag->GetId(v) << "@" << frag->GetFragId(v) << "\n";
+  }
+  for (label_id_t e_label = 0; e_label < frag->edge_label_num(); ++e_label) {
+    for (auto v : frag->InnerVertices(v_label)) {
+      ss << frag->GetId(v) << "[" << e_label << "] "
+         << frag->GetLocalOutDegree(v, e_label) << " "
+         << frag->GetLocalInDegree(v, e_label) << ":";
+      for (auto& e : frag->GetOutgoingAdjList(v, e_label)) {
+        ss << " " << frag->GetId(e.neighbor()) << "/"
+           << e.get_data<int64_t>(0);
+      }
+      for (auto& e : frag->GetIncomingAdjList(v, e_label)) {
+        ss << " " << frag->GetId(e.neighbor()) << "\\"
+           << e.get_data<int64_t>(0);
+      }
+      ss << "\n";
+    }
+  }
+  return ss.str();
+}
+
+std::shared_ptr<GraphType> get_lazily(Client& client, ObjectID frag_id) {
+  ObjectMeta meta;
+  VINEYARD_CHECK_OK(client.GetMetaDataLazily(frag_id, meta));
+  auto frag = std::make_shared<GraphType>();
+  frag->Construct(meta);
+  return frag;
+}
+
+void test_lazy_fragment(Client& client, ObjectID frag_id) {
+  auto eager = std::dynamic_pointer_cast<GraphType>(client.GetObject(frag_id));
+  label_id_t v_label_num = eager->vertex_label_num();
+  std::vector<std::string> expected(v_label_num);
+  for (label_id_t v_label = 0; v_label < v_label_num; ++v_label) {
+    expected[v_label] = traverse(eager, v_label);
+  }
+
+  // a single thread
+  {
+    auto lazy = get_lazily(client, frag_id);
+    for (label_id_t v_label = v_label_num - 1; v_label >= 0; --v_label) {
+      CHECK_EQ(traverse(lazy, v_label), expected[v_label]);
+    }
+  }
+
+  // the threads race to construct the same labels on the first access, each
+  // starts from a different label.
+  for (int round = 0; round < 10; ++round) {
+    auto lazy = get_lazily(client, frag_id);
+    const int thread_num = 8;
+    std::atomic<int> ready(0);
+    std::vector<std::thread> threads;
+    std::vector<std::vector<std::string>> results(thread_num);
+    for (int t = 0; t < thread_num; ++t) {
+      threads.emplace_back([&, t]() {
+        ready.fetch_add(1);
+        while (ready.load() < thread_num) {
+          std::this_thread::yield();
+        }
+        results[t].resize(v_label_num);
+        for (label_id_t k = 0; k < v_label_num; ++k) {
+          label_id_t v_label = (t + k) % v_label_num;
+          results[t][v_label] = traverse(lazy, v_label);
+        }
+      });
+    }
+    for (auto& thread : threads) {
+      thread.join();
+    }
+    for (auto const& result : results) {
+      CHECK(result == expected);
+    }
+  }
+}
+
+int main(int argc, char** argv) {
+  if (argc < 2) {
+    printf("usage: ./lazy_fragment_test <ipc_socket>\n");
+    return 1;
+  }
+  std::string ipc_socket = std::string(argv[1]);
+
+  Client client;
+  VINEYARD_CHECK_OK(client.Connect(ipc_socket));
+  LOG(INFO) << "Connected to IPCServer: " << ipc_socket;
+
+  grape::InitMPIComm();
+  {
+    grape::CommSpec comm_spec;
+    comm_spec.Init(MPI_COMM_WORLD);
+
+    ObjectID frag_id = load_fragment(client, comm_spec);
+    test_lazy_fragment(client, frag_id);
+    LOG(INFO) << "Passed lazy fragment tests...";
+  }
+  grape::FinalizeMPIComm();
+
+  client.Disconnect();
+  return 0;
+}
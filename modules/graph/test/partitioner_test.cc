@@ -0,0 +1,246 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <algorithm>
+#include <memory>
+#include <random>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "arrow/api.h"
+#include "glog/logging.h"
+
+#include "graph/utils/partitioner.h"
+
+using namespace vineyard;  // NOLINT(build/namespaces)
+
+static std::mt19937_64 rng(2021);
+
+std::shared_ptr<arrow::Array> finish(arrow::ArrayBuilder& builder) {
+  std::shared_ptr<arrow::Array> array;
+  CHECK(builder.Finish(&array).ok());
+  return array;
+}
+
+std::shared_ptr<arrow::Array> int64_oids(std::vector<int64_t> const& oids) {
+  arrow::Int64Builder builder;
+  CHECK(builder.AppendValues(oids).ok());
+  return finish(builder);
+}
+
+std::shared_ptr<arrow::Array> string_oids(
+    std::vector<std::string> const& oids) {
+  arrow::LargeStringBuilder builder;
+  for (auto const& oid : oids) {
+    CHECK(builder.Append(oid).ok());
+  }
+  return finish(builder);
+}
+
+void test_partition_hash() {
+  PartitionHash<int64_t> int_hash;
+  PartitionHash<std::string> string_hash;
+  CHECK_EQ(int_hash(12345), int_hash(12345));
+  CHECK_NE(int_hash(0), int_hash(1));
+
+  // the oids and their views in the arrow arrays have the same hash
+  std::set<uint64_t> hashes;
+  for (size_t size = 0; size <= 33; ++size) {
+    std::string oid(size, '\0');
+    uint64_t hash = string_hash(oid);
+    CHECK_EQ(hash, string_hash(arrow::util::string_view(oid)));
+    // the strings of zeros differ only in the lengths
+    hashes.insert(hash);
+  }
+  CHECK_EQ(hashes.size(), 34u);
+  // the tail bytes that don't fill a word matter
+  CHECK_NE(string_hash("abcdefgh1"), string_hash("abcdefgh2"));
+  CHECK_NE(string_hash("abcdefgh"), string_hash("abcdefgi"));
+}
+
+void test_reduce_partition_hash() {
+  for (fid_t fnum : {1, 2, 3, 7, 8, 1000}) {
+    CHECK_EQ(ReducePartitionHash(0, fnum), 0u);
+    CHECK_EQ(ReducePartitionHash(~0ULL, fnum), fnum - 1);
+    uint64_t prev_hash = 0;
+    fid_t prev_fid = 0;
+    for (int k = 0; k < 10000; ++k) {
+      uint64_t hash = prev_hash + rng() % (1ULL << 50);
+      fid_t fid = ReducePartitionHash(hash, fnum);
+      CHECK_LT(fid, fnum);
+      // the reduction keeps the order of the hash values
+      CHECK_LE(prev_fid, fid);
+      prev_hash = hash;
+      prev_fid = fid;
+    }
+  }
+}
+
+// The sequential oids are spread evenly, and the whole column is partitioned
+// in the same way as the oids one by one.
+template <typename OID_T>
+void test_hash_partitioner(std::vector<OID_T> const& oids,
+                           std::shared_ptr<arrow::Array> const& array) {
+  for (fid_t fnum : {1, 3, 8}) {
+    HashPartitioner<OID_T> partitioner;
+    partitioner.Init(fnum);
+    std::vector<size_t> counts(fnum, 0);
+    for (auto const& oid : oids) {
+      fid_t fid = partitioner.GetPartitionId(oid);
+      CHECK_LT(fid, fnum);
+      ++counts[fid];
+    }
+    for (auto count : counts) {
+      CHECK_GT(count, oids.size() / fnum * 9 / 10);
+      CHECK_LT(count, oids.size() / fnum * 11 / 10);
+    }
+
+    // the sliced arrays have non-zero offsets
+    auto sliced = array->Slice(7, array->length() - 20);
+    std::vector<fid_t> fids;
+    partitioner.GetPartitionIds(sliced, fids);
+    CHECK_EQ(fids.size(), static_cast<size_t>(sliced->length()));
+    for (size_t i = 0; i < fids.size(); ++i) {
+      CHECK_EQ(fids[i], partitioner.GetPartitionId(oids[i + 7]));
+    }
+
+    HashPartitioner<OID_T> copied(partitioner);
+    CHECK_EQ(copied.GetPartitionId(oids[0]),
+             partitioner.GetPartitionId(oids[0]));
+  }
+}
+
+template <typename OID_T>
+void check_range_partitioner(RangePartitioner<OID_T> const& partitioner,
+                             std::vector<OID_T> const& oids,
+                             std::shared_ptr<arrow::Array> const& array,
+                             std::vector<OID_T> const& splitters,
+                             fid_t fnum) {
+  std::vector<fid_t> fids;
+  partitioner.GetPartitionIds(array, fids);
+  CHECK_EQ(fids.size(), oids.size());
+  for (size_t i = 0; i < oids.size(); ++i) {
+    fid_t fid = partitioner.GetPartitionId(oids[i]);
+    CHECK_EQ(fids[i], fid);
+    CHECK_LT(fid, fnum);
+    // the vertices in [splitters[fid - 1], splitters[fid]) belong to `fid`
+    CHECK(fid == 0 || !(oids[i] < splitters[fid - 1]));
+    CHECK(fid == splitters.size() || oids[i] < splitters[fid]);
+  }
+}
+
+template <typename OID_T>
+void test_range_partitioner(std::vector<OID_T> const& oids,
+                            std::shared_ptr<arrow::Array> const& array) {
+  std::vector<OID_T> sorted(oids);
+  std::sort(sorted.begin(), sorted.end());
+
+  for (fid_t fnum : {1, 2, 5, 16}) {
+    // the samples are shuffled
+    std::vector<OID_T> samples(oids);
+    std::shuffle(samples.begin(), samples.end(), rng);
+    auto splitters = RangePartitioner<OID_T>::SelectSplitters(samples, fnum);
+    CHECK_EQ(splitters.size(), static_cast<size_t>(fnum - 1));
+    CHECK(std::is_sorted(splitters.begin(), splitters.end()));
+
+    RangePartitioner<OID_T> partitioner;
+    partitioner.Init(fnum, splitters);
+    check_range_partitioner(partitioner, oids, array, splitters, fnum);
+
+    // the splitters divide the oids evenly
+    std::vector<size_t> counts(fnum, 0);
+    for (auto const& oid : oids) {
+      ++counts[partitioner.GetPartitionId(oid)];
+    }
+    for (auto count : counts) {
+      CHECK_LE(count, oids.size() / fnum + 1);
+    }
+
+    // the copy owns the splitters, even if the original is gone
+    std::unique_ptr<RangePartitioner<OID_T>> original(
+        new RangePartitioner<OID_T>());
+    original->Init(fnum, splitters);
+    RangePartitioner<OID_T> copied(*original);
+    RangePartitioner<OID_T> assigned;
+    assigned = *original;
+    original.reset();
+    check_range_partitioner(copied, oids, array, splitters, fnum);
+    check_range_partitioner(assigned, oids, array, splitters, fnum);
+  }
+
+  // no samples, every vertex goes to the first fragment
+  {
+    std::vector<OID_T> samples;
+    auto splitters = RangePartitioner<OID_T>::SelectSplitters(samples, 4);
+    CHECK(splitters.empty());
+    RangePartitioner<OID_T> partitioner;
+    partitioner.Init(4, splitters);
+    check_range_partitioner(partitioner, oids, array, splitters, 4);
+    for (auto const& oid : oids) {
+      CHECK_EQ(partitioner.GetPartitionId(oid), 0u);
+    }
+  }
+
+  // the duplicated samples make duplicated splitters, the fragments between
+  // them are empty
+  {
+    std::vector<OID_T> samples(100, sorted[sorted.size() / 2]);
+    samples.push_back(sorted.front());
+    samples.push_back(sorted.back());
+    auto splitters = RangePartitioner<OID_T>::SelectSplitters(samples, 4);
+    CHECK_EQ(splitters.size(), 3u);
+    CHECK(splitters[0] == splitters[1] && splitters[1] == splitters[2]);
+    RangePartitioner<OID_T> partitioner;
+    partitioner.Init(4, splitters);
+    check_range_partitioner(partitioner, oids, array, splitters, 4);
+    for (auto const& oid : oids) {
+      fid_t fid = partitioner.GetPartitionId(oid);
+      CHECK(fid == 0 || fid == 3);
+    }
+  }
+}
+
+int main(int argc, char** argv) {
+  test_partition_hash();
+  test_reduce_partition_hash();
+  LOG(INFO) << "Passed partition hash tests...";
+
+  std::vector<int64_t> int_oids(100000);
+  std::vector<std::string> str_oids(int_oids.size());
+  for (size_t i = 0; i < int_oids.size(); ++i) {
+    int_oids[i] = static_cast<int64_t>(i);
+    str_oids[i] = "vertex-" + std::to_string(i);
+  }
+  test_hash_partitioner(int_oids, int64_oids(int_oids));
+  test_hash_partitioner(str_oids, string_oids(str_oids));
+  LOG(INFO) << "Passed hash partitioner tests...";
+
+  // the range partitioner works on the distinct oids in any order, the
+  // negative ones and the strings of different lengths included
+  std::vector<int64_t> range_oids(10000);
+  std::vector<std::string> range_str_oids(range_oids.size());
+  for (size_t i = 0; i < range_oids.size(); ++i) {
+    range_oids[i] = static_cast<int64_t>(i) * 37 - 50000;
+  }
+  std::shuffle(range_oids.begin(), range_oids.end(), rng);
+  for (size_t i = 0; i < range_oids.size(); ++i) {
+    range_str_oids[i] = std::to_string(range_oids[i]);
+  }
+  test_range_partitioner(range_oids, int64_oids(range_oids));
+  test_range_partitioner(range_str_oids, string_oids(range_str_oids));
+  LOG(INFO) << "Passed range partitioner tests...";
+  return 0;
+}
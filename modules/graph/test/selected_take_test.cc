@@ -0,0 +1,294 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <cstring>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "arrow/api.h"
+#include "glog/logging.h"
+
+#include "graph/utils/selected_take.h"
+
+using namespace vineyard;  // NOLINT(build/namespaces)
+
+static std::mt19937_64 rng(2021);
+
+std::vector<int64_t> random_indices(int64_t length, int64_t num) {
+  std::vector<int64_t> indices(num);
+  for (auto& index : indices) {
+    index = rng() % length;
+  }
+  // the both ends are always taken
+  if (num > 1) {
+    indices[0] = length - 1;
+    indices[num - 1] = 0;
+  }
+  return indices;
+}
+
+// The vectorized gathers of 4 and 8 bytes wide items must match the scalar
+// loop, for the lengths that are and are not multiples of the vector width.
+template <size_t WIDTH>
+void test_simd_take(std::vector<uint8_t> const& values, int64_t length) {
+  for (int64_t num : {0, 1, 3, 4, 5, 8, 1001}) {
+    auto indices = random_indices(length, num);
+    std::vector<uint8_t> out(num * WIDTH, 0xff);
+    int64_t taken = take_impl::simd_take<WIDTH>::take(
+        values.data(), indices.data(), num, out.data());
+    CHECK_LE(taken, num);
+#if defined(__AVX2__)
+    CHECK_EQ(taken, num / 4 * 4);
+#else
+    CHECK_EQ(taken, 0);
+#endif
+    for (int64_t i = 0; i < taken; ++i) {
+      CHECK_EQ(memcmp(out.data() + i * WIDTH,
+                      values.data() + indices[i] * WIDTH, WIDTH),
+               0);
+    }
+  }
+}
+
+void test_take_fixed_width() {
+  const int64_t length = 1 << 16;
+  std::vector<uint8_t> values(length * 16);
+  for (auto& value : values) {
+    value = static_cast<uint8_t>(rng());
+  }
+  test_simd_take<4>(values, length);
+  test_simd_take<8>(values, length);
+
+  for (int byte_width : {1, 2, 3, 4, 8, 16}) {
+    for (int64_t num : {0, 1, 3, 4, 5, 7, 8, 1001, 100000}) {
+      auto indices = random_indices(length, num);
+      // the bytes past the end must not be touched
+      std::vector<uint8_t> out(num * byte_width + 8, 0xa5);
+      TakeFixedWidth(values.data(), byte_width, indices.data(), num,
+                     out.data());
+      for (int64_t i = 0; i < num; ++i) {
+        CHECK_EQ(memcmp(out.data() + i * byte_width,
+                        values.data() + indices[i] * byte_width, byte_width),
+                 0);
+      }
+      for (int k = 0; k < 8; ++k) {
+        CHECK_EQ(out[num * byte_width + k], 0xa5);
+      }
+    }
+  }
+}
+
+void test_take_offsets_and_ranges() {
+  for (int byte_width : {1, 4, 8}) {
+    const int64_t length = 1000;
+    // the offsets of a sliced array don't start from 0
+    std::vector<int64_t> offsets(length + 1);
+    offsets[0] = 5;
+    for (int64_t i = 0; i < length; ++i) {
+      offsets[i + 1] = offsets[i] + (i % 5 == 0 ? 0 : rng() % 17);
+    }
+    std::vector<uint8_t> values(offsets[length] * byte_width);
+    for (auto& value : values) {
+      value = static_cast<uint8_t>(rng());
+    }
+
+    for (int64_t num : {0, 1, 7, 3000}) {
+      auto indices = random_indices(length, num);
+      std::vector<int64_t> out_offsets(num + 1, -1);
+      int64_t total = TakeOffsets(offsets.data(), indices.data(), num,
+                                  out_offsets.data());
+      CHECK_EQ(out_offsets[0], 0);
+      CHECK_EQ(out_offsets[num], total);
+      for (int64_t i = 0; i < num; ++i) {
+        CHECK_EQ(out_offsets[i + 1] - out_offsets[i],
+                 offsets[indices[i] + 1] - offsets[indices[i]]);
+      }
+
+      std::vector<uint8_t> out(total * byte_width + 8, 0xa5);
+      TakeRanges(offsets.data(), values.data(), byte_width, indices.data(),
+                 num, out.data());
+      for (int64_t i = 0; i < num; ++i) {
+        size_t size = (out_offsets[i + 1] - out_offsets[i]) * byte_width;
+        CHECK_EQ(memcmp(out.data() + out_offsets[i] * byte_width,
+                        values.data() + offsets[indices[i]] * byte_width,
+                        size),
+                 0);
+      }
+      for (int k = 0; k < 8; ++k) {
+        CHECK_EQ(out[total * byte_width + k], 0xa5);
+      }
+    }
+  }
+}
+
+void test_take_bitmap() {
+  const int64_t length = 1000;
+  std::vector<uint8_t> bitmap((length + 7) / 8 + 2);
+  for (auto& byte : bitmap) {
+    byte = static_cast<uint8_t>(rng());
+  }
+  auto get_bit = [](const uint8_t* bits, int64_t i) {
+    return (bits[i >> 3] >> (i & 7)) & 1;
+  };
+  for (int64_t bitmap_offset : {0, 3, 13}) {
+    for (int64_t num : {0, 1, 9, 2000}) {
+      auto indices = random_indices(length, num);
+      std::vector<uint8_t> out((num + 7) / 8, 0xff);
+      int64_t null_count = TakeBitmap(bitmap.data(), bitmap_offset,
+                                      indices.data(), num, out.data());
+      int64_t expected_null_count = 0;
+      for (int64_t i = 0; i < num; ++i) {
+        int valid = get_bit(bitmap.data(), bitmap_offset + indices[i]);
+        CHECK_EQ(get_bit(out.data(), i), valid);
+        expected_null_count += valid ? 0 : 1;
+      }
+      CHECK_EQ(null_count, expected_null_count);
+      // the padding bits are cleared
+      for (int64_t i = num; i < static_cast<int64_t>(out.size()) * 8; ++i) {
+        CHECK_EQ(get_bit(out.data(), i), 0);
+      }
+    }
+  }
+}
+
+std::shared_ptr<arrow::Array> finish(arrow::ArrayBuilder& builder) {
+  std::shared_ptr<arrow::Array> array;
+  CHECK(builder.Finish(&array).ok());
+  return array;
+}
+
+std::vector<std::shared_ptr<arrow::Array>> generate_arrays(int64_t length) {
+  std::vector<std::shared_ptr<arrow::Array>> arrays;
+  {
+    arrow::Int32Builder builder;
+    for (int64_t i = 0; i < length; ++i) {
+      CHECK(builder.Append(static_cast<int32_t>(rng())).ok());
+    }
+    arrays.emplace_back(finish(builder));
+  }
+  {
+    arrow::Int64Builder builder;
+    for (int64_t i = 0; i < length; ++i) {
+      if (i % 3 == 0) {
+        CHECK(builder.AppendNull().ok());
+      } else {
+        CHECK(builder.Append(static_cast<int64_t>(rng())).ok());
+      }
+    }
+    arrays.emplace_back(finish(builder));
+  }
+  {
+    arrow::DoubleBuilder builder;
+    for (int64_t i = 0; i < length; ++i) {
+      CHECK(builder.Append(i * 0.25).ok());
+    }
+    arrays.emplace_back(finish(builder));
+  }
+  {
+    arrow::UInt8Builder builder;
+    for (int64_t i = 0; i < length; ++i) {
+      CHECK(builder.Append(static_cast<uint8_t>(i)).ok());
+    }
+    arrays.emplace_back(finish(builder));
+  }
+  {
+    arrow::LargeStringBuilder builder;
+    for (int64_t i = 0; i < length; ++i) {
+      if (i % 5 == 0) {
+        CHECK(builder.AppendNull().ok());
+      } else {
+        CHECK(builder.Append(std::string(i % 11, 'a' + i % 26)).ok());
+      }
+    }
+    arrays.emplace_back(finish(builder));
+  }
+  {
+    arrow::LargeBinaryBuilder builder;
+    for (int64_t i = 0; i < length; ++i) {
+      CHECK(builder.Append(std::to_string(rng())).ok());
+    }
+    arrays.emplace_back(finish(builder));
+  }
+  {
+    auto value_builder = std::make_shared<arrow::Int64Builder>();
+    arrow::LargeListBuilder builder(arrow::default_memory_pool(),
+                                    value_builder);
+    for (int64_t i = 0; i < length; ++i) {
+      if (i % 7 == 0) {
+        CHECK(builder.AppendNull().ok());
+        continue;
+      }
+      CHECK(builder.Append().ok());
+      for (int64_t k = 0; k < i % 4; ++k) {
+        CHECK(value_builder->Append(i + k).ok());
+      }
+    }
+    arrays.emplace_back(finish(builder));
+  }
+  arrays.emplace_back(std::make_shared<arrow::NullArray>(length));
+  return arrays;
+}
+
+void check_taken(std::shared_ptr<arrow::Array> const& array,
+                 std::vector<int64_t> const& indices,
+                 std::shared_ptr<arrow::Array> const& out) {
+  CHECK(out->type()->Equals(array->type()));
+  CHECK_EQ(out->length(), static_cast<int64_t>(indices.size()));
+  CHECK(out->Validate().ok());
+  int64_t null_count = 0;
+  for (size_t i = 0; i < indices.size(); ++i) {
+    CHECK_EQ(out->IsNull(i), array->IsNull(indices[i]));
+    CHECK(out->RangeEquals(i, i + 1, indices[i], array));
+    null_count += array->IsNull(indices[i]) ? 1 : 0;
+  }
+  CHECK_EQ(out->null_count(), null_count);
+}
+
+void test_take_array() {
+  const int64_t length = 1000;
+  for (auto const& array : generate_arrays(length)) {
+    // the sliced arrays have non-zero offsets in the buffers and bitmaps
+    for (auto const& sliced : {array, array->Slice(3, length - 10)}) {
+      for (int64_t num : {0, 1, 5, 2000}) {
+        auto indices = random_indices(sliced->length(), num);
+        std::shared_ptr<arrow::Array> out;
+        CHECK(TakeArray(sliced, indices, out).ok());
+        check_taken(sliced, indices, out);
+      }
+    }
+  }
+
+  // the items that are not byte-aligned are not supported
+  arrow::BooleanBuilder builder;
+  CHECK(builder.Append(true).ok());
+  std::shared_ptr<arrow::Array> out;
+  CHECK(!TakeArray(finish(builder), {0}, out).ok());
+}
+
+int main(int argc, char** argv) {
+#if defined(__AVX2__)
+  LOG(INFO) << "Testing the take kernels with AVX2...";
+#else
+  LOG(INFO) << "Testing the take kernels without AVX2...";
+#endif
+  test_take_fixed_width();
+  test_take_offsets_and_ranges();
+  test_take_bitmap();
+  test_take_array();
+  LOG(INFO) << "Passed selected take tests...";
+  return 0;
+}
@@ -0,0 +1,323 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "arrow/api.h"
+#include "glog/logging.h"
+#include "grape/worker/comm_spec.h"
+
+#include "graph/fragment/property_graph_types.h"
+#include "graph/fragment/property_graph_utils.h"
+#include "graph/utils/table_shuffler_beta.h"
+
+using namespace vineyard;  // NOLINT(build/namespaces)
+
+using vid_t = property_graph_types::VID_TYPE;
+
+// Every worker generates the rows with ids in
+// [worker_id * kRowNum, (worker_id + 1) * kRowNum), and the other columns are
+// derived from the id, thus every worker knows all the rows.
+static constexpr int64_t kRowNum = 20000;
+
+std::shared_ptr<arrow::Schema> edge_schema() {
+  auto vid_type = ConvertToArrowType<vid_t>::TypeValue();
+  return arrow::schema(
+      {arrow::field("src", vid_type), arrow::field("dst", vid_type),
+       arrow::field("id", arrow::int64()),
+       arrow::field("name", arrow::large_utf8()),
+       arrow::field("value", arrow::float64()),
+       arrow::field("nothing", arrow::null()),
+       arrow::field("list", arrow::large_list(arrow::int64()))});
+}
+
+grape::fid_t src_fid_of(int64_t id, grape::fid_t fnum) { return id % fnum; }
+
+grape::fid_t dst_fid_of(int64_t id, grape::fid_t fnum) {
+  return (id / 3) % fnum;
+}
+
+std::string name_of(int64_t id) {
+  return "row-" + std::string(id % 13, 'x') + std::to_string(id);
+}
+
+std::shared_ptr<arrow::RecordBatch> generate_batch(
+    IdParser<vid_t> const& parser, grape::fid_t fnum, int64_t begin,
+    int64_t end) {
+  typename ConvertToArrowType<vid_t>::BuilderType src_builder, dst_builder;
+  arrow::Int64Builder id_builder;
+  arrow::LargeStringBuilder name_builder;
+  arrow::DoubleBuilder value_builder;
+  auto list_value_builder = std::make_shared<arrow::Int64Builder>();
+  arrow::LargeListBuilder list_builder(arrow::default_memory_pool(),
+                                       list_value_builder);
+  for (int64_t id = begin; id < end; ++id) {
+    CHECK(src_builder.Append(parser.GenerateId(src_fid_of(id, fnum), 0, id))
+              .ok());
+    CHECK(dst_builder
+              .Append(parser.GenerateId(dst_fid_of(id, fnum), 0, id / 3))
+              .ok());
+    CHECK(id_builder.Append(id).ok());
+    if (id % 7 == 0) {
+      CHECK(name_builder.AppendNull().ok());
+    } else {
+      CHECK(name_builder.Append(name_of(id)).ok());
+    }
+    CHECK(value_builder.Append(id * 0.5).ok());
+    CHECK(list_builder.Append().ok());
+    for (int64_t k = 0; k < id % 4; ++k) {
+      CHECK(list_value_builder->Append(id + k).ok());
+    }
+  }
+  std::vector<std::shared_ptr<arrow::Array>> columns(7);
+  CHECK(src_builder.Finish(&columns[0]).ok());
+  CHECK(dst_builder.Finish(&columns[1]).ok());
+  CHECK(id_builder.Finish(&columns[2]).ok());
+  CHECK(name_builder.Finish(&columns[3]).ok());
+  CHECK(value_builder.Finish(&columns[4]).ok());
+  columns[5] = std::make_shared<arrow::NullArray>(end - begin);
+  CHECK(list_builder.Finish(&columns[6]).ok());
+  return arrow::RecordBatch::Make(edge_schema(), end - begin, columns);
+}
+
+// The local rows are split into batches of uneven sizes, including an empty
+// one.
+std::vector<std::shared_ptr<arrow::RecordBatch>> generate_batches(
+    IdParser<vid_t> const& parser, const grape::CommSpec& comm_spec) {
+  int64_t base = comm_spec.worker_id() * kRowNum;
+  std::vector<int64_t> splits = {0, kRowNum / 3, kRowNum / 3, kRowNum};
+  std::vector<std::shared_ptr<arrow::RecordBatch>> batches;
+  for (size_t i = 0; i + 1 < splits.size(); ++i) {
+    batches.emplace_back(generate_batch(
+        parser, comm_spec.fnum(), base + splits[i], base + splits[i + 1]));
+  }
+  return batches;
+}
+
+// The rows of an edge go to the fragments of both endpoints.
+std::vector<int64_t> expected_ids(const grape::CommSpec& comm_spec) {
+  grape::fid_t fnum = comm_spec.fnum();
+  std::vector<int64_t> ids;
+  for (int64_t id = 0; id < comm_spec.worker_num() * kRowNum; ++id) {
+    if (src_fid_of(id, fnum) == comm_spec.fid() ||
+        dst_fid_of(id, fnum) == comm_spec.fid()) {
+      ids.push_back(id);
+    }
+  }
+  return ids;
+}
+
+// Checks that the received rows are exactly the expected ones, and that every
+// column of them survives the shuffle.
+void check_rows(
+    IdParser<vid_t> const& parser, const grape::CommSpec& comm_spec,
+    std::vector<std::shared_ptr<arrow::RecordBatch>> const& batches) {
+  grape::fid_t fnum = comm_spec.fnum();
+  std::vector<int64_t> ids;
+  for (auto const& batch : batches) {
+    CHECK(batch->schema()->Equals(*edge_schema()));
+    auto src = std::dynamic_pointer_cast<
+        typename ConvertToArrowType<vid_t>::ArrayType>(batch->column(0));
+    auto dst = std::dynamic_pointer_cast<
+        typename ConvertToArrowType<vid_t>::ArrayType>(batch->column(1));
+    auto id = std::dynamic_pointer_cast<arrow::Int64Array>(batch->column(2));
+    auto name =
+        std::dynamic_pointer_cast<arrow::LargeStringArray>(batch->column(3));
+    auto value =
+        std::dynamic_pointer_cast<arrow::DoubleArray>(batch->column(4));
+    auto list =
+        std::dynamic_pointer_cast<arrow::LargeListArray>(batch->column(6));
+    auto list_values =
+        std::dynamic_pointer_cast<arrow::Int64Array>(list->values());
+    CHECK_EQ(batch->column(5)->null_count(), batch->num_rows());
+    for (int64_t i = 0; i < batch->num_rows(); ++i) {
+      int64_t row_id = id->Value(i);
+      CHECK_EQ(src->Value(i),
+               parser.GenerateId(src_fid_of(row_id, fnum), 0, row_id));
+      CHECK_EQ(dst->Value(i),
+               parser.GenerateId(dst_fid_of(row_id, fnum), 0, row_id / 3));
+      if (row_id % 7 == 0) {
+        CHECK(name->IsNull(i));
+      } else {
+        CHECK(!name->IsNull(i));
+        CHECK_EQ(name->GetString(i), name_of(row_id));
+      }
+      CHECK_EQ(value->Value(i), row_id * 0.5);
+      CHECK_EQ(list->value_length(i), row_id % 4);
+      for (int64_t k = 0; k < row_id % 4; ++k) {
+        CHECK_EQ(list_values->Value(list->value_offset(i) + k), row_id + k);
+      }
+      ids.push_back(row_id);
+    }
+  }
+  std::sort(ids.begin(), ids.end());
+  CHECK(ids == expected_ids(comm_spec));
+}
+
+void check_same_rows(std::shared_ptr<arrow::RecordBatch> const& expected,
+                     std::shared_ptr<arrow::RecordBatch> const& batch,
+                     int64_t offset) {
+  for (int col_id = 0; col_id < batch->num_columns(); ++col_id) {
+    CHECK(batch->column(col_id)->RangeEquals(
+        offset, offset + expected->num_rows(), 0, expected->column(col_id)));
+  }
+}
+
+// The chunks are serialized locally and appended to a SelectedRowsBuilder.
+// The rows without nulls come first, and the validity bitmap is started by
+// a later chunk.
+void test_selected_rows_builder(IdParser<vid_t> const& parser,
+                                const grape::CommSpec& comm_spec) {
+  auto without_nulls = generate_batch(parser, comm_spec.fnum(), 1, 7);
+  auto with_nulls = generate_batch(parser, comm_spec.fnum(), 7, 1000);
+  std::vector<std::pair<std::shared_ptr<arrow::RecordBatch>,
+                        std::vector<int64_t>>>
+      chunks;
+  chunks.emplace_back(without_nulls, std::vector<int64_t>{5, 0, 3});
+  chunks.emplace_back(with_nulls, std::vector<int64_t>{});
+  std::vector<int64_t> offsets;
+  for (int64_t row = 0; row < with_nulls->num_rows(); row += 3) {
+    offsets.push_back(with_nulls->num_rows() - 1 - row);
+  }
+  chunks.emplace_back(with_nulls, offsets);
+  chunks.emplace_back(without_nulls, std::vector<int64_t>{1, 1, 2});
+
+  int64_t row_num = 0;
+  for (auto const& chunk : chunks) {
+    row_num += chunk.second.size();
+  }
+  beta::SelectedRowsBuilder builder(edge_schema(), row_num);
+  std::vector<std::shared_ptr<arrow::RecordBatch>> expected_batches;
+  for (auto const& chunk : chunks) {
+    grape::InArchive in_archive;
+    beta::SerializeSelectedRows(in_archive, chunk.first, chunk.second);
+    std::shared_ptr<arrow::RecordBatch> expected;
+    beta::SelectRows(chunk.first, chunk.second, expected);
+    expected_batches.emplace_back(expected);
+
+    // each chunk is deserialized on its own, ...
+    grape::OutArchive arc;
+    arc.Allocate(in_archive.GetSize());
+    memcpy(arc.GetBuffer(), in_archive.GetBuffer(), in_archive.GetSize());
+    std::shared_ptr<arrow::RecordBatch> batch;
+    beta::DeserializeSelectedRows(arc, edge_schema(), batch);
+    CHECK(arc.Empty());
+    CHECK_EQ(batch->num_rows(), expected->num_rows());
+    check_same_rows(expected, batch, 0);
+
+    // ... and appended to the builder.
+    grape::OutArchive builder_arc;
+    builder_arc.Allocate(in_archive.GetSize());
+    memcpy(builder_arc.GetBuffer(), in_archive.GetBuffer(),
+           in_archive.GetSize());
+    builder.Append(builder_arc);
+    CHECK(builder_arc.Empty());
+  }
+
+  auto batch = builder.Finish();
+  CHECK_EQ(batch->num_rows(), row_num);
+  CHECK(batch->Validate().ok());
+  int64_t offset = 0;
+  for (auto const& expected : expected_batches) {
+    check_same_rows(expected, batch, offset);
+    offset += expected->num_rows();
+  }
+}
+
+// Shuffles in tiny chunks, so that many chunks from every source are in
+// flight and deserialized concurrently.
+void test_pipelined_shuffle(IdParser<vid_t> const& parser,
+                            const grape::CommSpec& comm_spec) {
+  grape::fid_t fnum = comm_spec.fnum();
+  auto batches = generate_batches(parser, comm_spec);
+  std::vector<std::vector<std::vector<int64_t>>> offset_lists(batches.size());
+  for (size_t rb_i = 0; rb_i < batches.size(); ++rb_i) {
+    offset_lists[rb_i].resize(fnum);
+    auto id = std::dynamic_pointer_cast<arrow::Int64Array>(
+        batches[rb_i]->column(2));
+    for (int64_t row = 0; row < batches[rb_i]->num_rows(); ++row) {
+      grape::fid_t src_fid = src_fid_of(id->Value(row), fnum);
+      grape::fid_t dst_fid = dst_fid_of(id->Value(row), fnum);
+      offset_lists[rb_i][src_fid].push_back(row);
+      if (dst_fid != src_fid) {
+        offset_lists[rb_i][dst_fid].push_back(row);
+      }
+    }
+  }
+
+  std::vector<std::shared_ptr<arrow::RecordBatch>> batches_in;
+  beta::ShuffleStats stats;
+  beta::PipelinedShuffleTableByOffsetLists(edge_schema(), batches,
+                                           offset_lists, batches_in,
+                                           comm_spec, &stats, 1024);
+  check_rows(parser, comm_spec, batches_in);
+
+  // the bytes and chunks are conserved as well.
+  uint64_t sent[2] = {stats.sent_bytes, stats.sent_chunks};
+  uint64_t recv[2] = {stats.recv_bytes, stats.recv_chunks};
+  uint64_t total_sent[2], total_recv[2];
+  MPI_Allreduce(sent, total_sent, 2, MPI_UINT64_T, MPI_SUM, comm_spec.comm());
+  MPI_Allreduce(recv, total_recv, 2, MPI_UINT64_T, MPI_SUM, comm_spec.comm());
+  CHECK_EQ(total_sent[0], total_recv[0]);
+  CHECK_EQ(total_sent[1], total_recv[1]);
+  if (comm_spec.worker_num() > 1) {
+    CHECK_GT(stats.recv_chunks,
+             static_cast<size_t>(comm_spec.worker_num() - 1));
+  }
+  LOG(INFO) << "[worker-" << comm_spec.worker_id()
+            << "] pipelined shuffle: " << stats.ToString();
+}
+
+void test_shuffle_edge_table(IdParser<vid_t>& parser,
+                             const grape::CommSpec& comm_spec) {
+  auto batches = generate_batches(parser, comm_spec);
+  std::shared_ptr<arrow::Table> table_in;
+  CHECK(RecordBatchesToTable(batches, &table_in).ok());
+
+  auto result =
+      beta::ShufflePropertyEdgeTable<vid_t>(comm_spec, parser, 0, 1, table_in);
+  CHECK(result);
+  std::shared_ptr<arrow::Table> table_out = result.value();
+  std::vector<std::shared_ptr<arrow::RecordBatch>> batches_out;
+  CHECK(TableToRecordBatches(table_out, &batches_out).ok());
+  check_rows(parser, comm_spec, batches_out);
+}
+
+int main(int argc, char** argv) {
+  grape::InitMPIComm();
+  {
+    grape::CommSpec comm_spec;
+    comm_spec.Init(MPI_COMM_WORLD);
+
+    IdParser<vid_t> parser;
+    parser.Init(comm_spec.fnum(), 1);
+
+    test_selected_rows_builder(parser, comm_spec);
+    test_pipelined_shuffle(parser, comm_spec);
+    MPI_Barrier(comm_spec.comm());
+    test_shuffle_edge_table(parser, comm_spec);
+    MPI_Barrier(comm_spec.comm());
+
+    LOG(INFO) << "[worker-" << comm_spec.worker_id()
+              << "] Passed table shuffle tests...";
+  }
+  grape::FinalizeMPIComm();
+  return 0;
+}
@@ -0,0 +1,111 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "glog/logging.h"
+
+#include "graph/fragment/property_graph_utils.h"
+#include "graph/utils/thread_group.h"
+
+using namespace vineyard;  // NOLINT(build/namespaces)
+
+// Every index is visited exactly once.
+void test_parallel_for(ThreadPool& pool) {
+  for (size_t num : {0, 1, 7, 1000, 100003}) {
+    for (size_t concurrency : {0, 1, 2, 64}) {
+      for (size_t chunk : {0, 1, 13}) {
+        std::vector<std::atomic<int>> visited(num);
+        for (auto& count : visited) {
+          count.store(0);
+        }
+        pool.ParallelFor(
+            num, [&visited](size_t i) { visited[i].fetch_add(1); },
+            concurrency, chunk);
+        for (size_t i = 0; i < num; ++i) {
+          CHECK_EQ(visited[i].load(), 1);
+        }
+      }
+    }
+  }
+}
+
+// The loops that are nested in the tasks of the pool must not wait for the
+// tasks queued behind themselves, even if every worker is busy.
+void test_nested_parallel_for(ThreadPool& pool) {
+  const size_t outer = 16, inner = 1000;
+  std::atomic<size_t> sum(0);
+  pool.ParallelFor(
+      outer,
+      [&](size_t i) {
+        pool.ParallelFor(
+            inner, [&](size_t j) { sum.fetch_add(i * inner + j); }, 0, 7);
+      },
+      0, 1);
+  size_t total = outer * inner;
+  CHECK_EQ(sum.load(), total * (total - 1) / 2);
+}
+
+void test_submit(ThreadPool& pool) {
+  const int num = 100;
+  std::atomic<int> finished(0);
+  for (int i = 0; i < num; ++i) {
+    pool.Submit([&finished]() { finished.fetch_add(1); });
+  }
+  while (finished.load() < num) {
+    std::this_thread::yield();
+  }
+}
+
+// The blocks of `parallel_prefix_sum` are at least 1024 elements, the
+// lengths around the block size and the concurrency beyond the number of
+// blocks are the edge cases.
+void test_parallel_prefix_sum() {
+  for (size_t length : {0, 1, 1023, 1024, 1025, 2048, 4097, 100001}) {
+    std::vector<int> input(length);
+    for (size_t i = 0; i < length; ++i) {
+      input[i] = static_cast<int>(i % 7);
+    }
+    std::vector<int64_t> expected(length + 1, -1);
+    for (size_t i = 0; i < length; ++i) {
+      expected[i] = (i == 0 ? 0 : expected[i - 1]) + input[i];
+    }
+    for (int concurrency : {0, 1, 2, 7, 64, 1000000}) {
+      // the one past the end must not be touched
+      std::vector<int64_t> output(length + 1, -1);
+      parallel_prefix_sum(input.data(), output.data(), length, concurrency);
+      CHECK(output == expected);
+    }
+  }
+}
+
+int main(int argc, char** argv) {
+  {
+    ThreadPool pool(2);
+    test_parallel_for(pool);
+    test_nested_parallel_for(pool);
+    test_submit(pool);
+  }
+  test_parallel_for(ThreadPool::Default());
+  test_nested_parallel_for(ThreadPool::Default());
+  LOG(INFO) << "Passed thread pool tests...";
+
+  test_parallel_prefix_sum();
+  LOG(INFO) << "Passed parallel prefix sum tests...";
+  return 0;
+}
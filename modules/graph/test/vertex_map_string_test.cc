@@ -145,6 +145,10 @@ int main(int argc, char** argv) {
         arrow::util::string_view oid;
         CHECK(vm_ptr->GetOid(gid, oid));
 
+        uint64_t indexed_gid;
+        CHECK(vm_ptr->GetGid(i, j, oid, indexed_gid));
+        CHECK_EQ(indexed_gid, gid);
+
         fout << oid << std::endl;
       }
 
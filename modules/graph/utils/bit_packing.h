@@ -0,0 +1,250 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef MODULES_GRAPH_UTILS_BIT_PACKING_H_
+#define MODULES_GRAPH_UTILS_BIT_PACKING_H_
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+
+namespace vineyard {
+
+/**
+ * The codec of the compressed adjacent lists.
+ *
+ * An adjacent list, sorted by the neighbor ids, is encoded as blocks of at
+ * most kBlockSize neighbors. Each block consists of
+ *
+ *   - the bit widths of the neighbor id deltas and of the edge id offsets,
+ *     one byte each,
+ *   - the varint of the first neighbor id, as the delta to the last neighbor
+ *     id of the previous block (or to zero, for the first block),
+ *   - the varint of the minimum edge id in the block,
+ *   - the bit-packed deltas of the rest neighbor ids,
+ *   - the bit-packed offsets of the edge ids to the minimum one.
+ *
+ * The number of neighbors in a list is not encoded, it is known from the
+ * offsets of the CSR. The unpacking reads 8 bytes at a time, thus the
+ * encoded buffer must be followed by kPadding readable bytes.
+ */
+namespace bit_packing {
+
+static constexpr int kBlockSize = 64;
+static constexpr int kPadding = 8;
+
+inline int BitWidth(uint64_t value) {
+  return value == 0 ? 0 : 64 - __builtin_clzll(value);
+}
+
+inline size_t VarintSize(uint64_t value) {
+  size_t size = 1;
+  while (value >= 0x80) {
+    value >>= 7;
+    ++size;
+  }
+  return size;
+}
+
+inline uint8_t* PutVarint(uint64_t value, uint8_t* out) {
+  while (value >= 0x80) {
+    *out++ = static_cast<uint8_t>(value | 0x80);
+    value >>= 7;
+  }
+  *out++ = static_cast<uint8_t>(value);
+  return out;
+}
+
+inline const uint8_t* GetVarint(const uint8_t* in, uint64_t& value) {
+  value = 0;
+  for (int shift = 0;; shift += 7) {
+    uint8_t byte = *in++;
+    value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+    if (byte < 0x80) {
+      return in;
+    }
+  }
+}
+
+inline size_t PackedSize(int num, int width) {
+  return (static_cast<size_t>(num) * width + 7) / 8;
+}
+
+/**
+ * @brief Packs the lowest `width` bits of the `num` values to `out`, returns
+ * the end of the packed bytes.
+ */
+inline uint8_t* Pack(const uint64_t* values, int num, int width,
+                     uint8_t* out) {
+  if (width == 0) {
+    return out;
+  }
+  uint64_t mask = width == 64 ? ~0ULL : (1ULL << width) - 1;
+  // a 128 bits window, as `bits + width` may exceed 64.
+  uint64_t buffer = 0, overflow = 0;
+  int bits = 0;
+  for (int i = 0; i < num; ++i) {
+    uint64_t value = values[i] & mask;
+    buffer |= value << bits;
+    overflow = bits == 0 ? 0 : value >> (64 - bits);
+    bits += width;
+    if (bits >= 64) {
+      memcpy(out, &buffer, sizeof(buffer));
+      out += sizeof(buffer);
+      bits -= 64;
+      buffer = overflow;
+    }
+  }
+  for (; bits > 0; bits -= 8) {
+    *out++ = static_cast<uint8_t>(buffer);
+    buffer >>= 8;
+  }
+  return out;
+}
+
+/**
+ * @brief Unpacks `num` values of `width` bits from `in`, returns the end of
+ * the packed bytes.
+ *
+ * Each value is extracted from an unaligned 8 bytes word by a shift and a
+ * mask.
+ */
+inline const uint8_t* Unpack(const uint8_t* in, int num, int width,
+                             uint64_t* values) {
+  if (width == 0) {
+    std::fill_n(values, num, 0);
+    return in;
+  }
+  uint64_t mask = width == 64 ? ~0ULL : (1ULL << width) - 1;
+  if (width <= 57) {
+    for (int i = 0; i < num; ++i) {
+      size_t bit = static_cast<size_t>(i) * width;
+      uint64_t word;
+      memcpy(&word, in + (bit >> 3), sizeof(word));
+      values[i] = (word >> (bit & 7)) & mask;
+    }
+  } else {
+    for (int i = 0; i < num; ++i) {
+      size_t bit = static_cast<size_t>(i) * width;
+      int shift = bit & 7;
+      uint64_t word;
+      memcpy(&word, in + (bit >> 3), sizeof(word));
+      uint64_t value = word >> shift;
+      if (shift + width > 64) {
+        value |= static_cast<uint64_t>(in[(bit >> 3) + 8]) << (64 - shift);
+      }
+      values[i] = value & mask;
+    }
+  }
+  return in + PackedSize(num, width);
+}
+
+/**
+ * @brief The size of the encoded adjacent list of `num` neighbors, exclusive
+ * of the padding.
+ */
+template <typename NBR_T>
+size_t EncodedSize(const NBR_T* nbrs, int64_t num) {
+  size_t size = 0;
+  uint64_t prev = 0;
+  for (int64_t begin = 0; begin < num; begin += kBlockSize) {
+    int count = static_cast<int>(std::min<int64_t>(kBlockSize, num - begin));
+    const NBR_T* block = nbrs + begin;
+    uint64_t max_delta = 0;
+    uint64_t min_eid = block[0].eid, max_eid = block[0].eid;
+    for (int k = 0; k < count; ++k) {
+      if (k > 0) {
+        max_delta = std::max<uint64_t>(max_delta,
+                                       block[k].vid - block[k - 1].vid);
+      }
+      min_eid = std::min<uint64_t>(min_eid, block[k].eid);
+      max_eid = std::max<uint64_t>(max_eid, block[k].eid);
+    }
+    size += 2 + VarintSize(block[0].vid - prev) + VarintSize(min_eid) +
+            PackedSize(count - 1, BitWidth(max_delta)) +
+            PackedSize(count, BitWidth(max_eid - min_eid));
+    prev = block[count - 1].vid;
+  }
+  return size;
+}
+
+/**
+ * @brief Encodes the adjacent list of `num` neighbors to `out`, returns the
+ * end of the encoded bytes.
+ */
+template <typename NBR_T>
+uint8_t* Encode(const NBR_T* nbrs, int64_t num, uint8_t* out) {
+  uint64_t deltas[kBlockSize], eids[kBlockSize];
+  uint64_t prev = 0;
+  for (int64_t begin = 0; begin < num; begin += kBlockSize) {
+    int count = static_cast<int>(std::min<int64_t>(kBlockSize, num - begin));
+    const NBR_T* block = nbrs + begin;
+    uint64_t max_delta = 0;
+    uint64_t min_eid = block[0].eid, max_eid = block[0].eid;
+    for (int k = 0; k < count; ++k) {
+      if (k > 0) {
+        deltas[k - 1] = block[k].vid - block[k - 1].vid;
+        max_delta = std::max(max_delta, deltas[k - 1]);
+      }
+      min_eid = std::min<uint64_t>(min_eid, block[k].eid);
+      max_eid = std::max<uint64_t>(max_eid, block[k].eid);
+    }
+    for (int k = 0; k < count; ++k) {
+      eids[k] = block[k].eid - min_eid;
+    }
+    int delta_width = BitWidth(max_delta);
+    int eid_width = BitWidth(max_eid - min_eid);
+    *out++ = static_cast<uint8_t>(delta_width);
+    *out++ = static_cast<uint8_t>(eid_width);
+    out = PutVarint(block[0].vid - prev, out);
+    out = PutVarint(min_eid, out);
+    out = Pack(deltas, count - 1, delta_width, out);
+    out = Pack(eids, count, eid_width, out);
+    prev = block[count - 1].vid;
+  }
+  return out;
+}
+
+/**
+ * @brief Decodes a block of `count` neighbors from `in`, `prev` is the last
+ * neighbor id of the previous block, returns the start of the next block.
+ */
+template <typename NBR_T>
+const uint8_t* DecodeBlock(const uint8_t* in, int count, uint64_t prev,
+                           NBR_T* nbrs) {
+  uint64_t deltas[kBlockSize], eids[kBlockSize];
+  int delta_width = in[0], eid_width = in[1];
+  uint64_t first, min_eid;
+  in = GetVarint(in + 2, first);
+  in = GetVarint(in, min_eid);
+  in = Unpack(in, count - 1, delta_width, deltas);
+  in = Unpack(in, count, eid_width, eids);
+  uint64_t vid = prev + first;
+  nbrs[0].vid = vid;
+  for (int k = 1; k < count; ++k) {
+    vid += deltas[k - 1];
+    nbrs[k].vid = vid;
+  }
+  for (int k = 0; k < count; ++k) {
+    nbrs[k].eid = min_eid + eids[k];
+  }
+  return in;
+}
+
+}  // namespace bit_packing
+
+}  // namespace vineyard
+
+#endif  // MODULES_GRAPH_UTILS_BIT_PACKING_H_
@@ -16,7 +16,10 @@ limitations under the License.
 #ifndef MODULES_GRAPH_UTILS_PARTITIONER_H_
 #define MODULES_GRAPH_UTILS_PARTITIONER_H_
 
+#include <algorithm>
 #include <cstdint>
+#include <cstring>
+#include <memory>
 #include <string>
 #include <utility>
 #include <vector>
@@ -30,54 +33,101 @@ limitations under the License.
 
 namespace vineyard {
 
-// TODO(lxj): check if identical to the file in libgrape-lite
+/**
+ * @brief The mixing hash of the partitioners, the finalizer of MurmurHash3. It
+ * spreads the sequential ids, which are common in real-world graphs, over the
+ * whole 64 bits space.
+ */
+inline uint64_t PartitionMix64(uint64_t value) {
+  value ^= value >> 33;
+  value *= 0xff51afd7ed558ccdULL;
+  value ^= value >> 33;
+  value *= 0xc4ceb9fe1a85ec53ULL;
+  value ^= value >> 33;
+  return value;
+}
+
+/**
+ * @brief Hashes the bytes 8 at a time, which is much faster than
+ * `std::hash<std::string>` on long keys. The hash must be stable across
+ * processes as every worker partitions the same vertices.
+ */
+inline uint64_t PartitionHashBytes(const char* data, size_t size) {
+  uint64_t hash = 0x9e3779b97f4a7c15ULL ^ size;
+  uint64_t word;
+  for (; size >= sizeof(word); data += sizeof(word), size -= sizeof(word)) {
+    memcpy(&word, data, sizeof(word));
+    word *= 0x87c37b91114253d5ULL;
+    hash ^= (word << 31) | (word >> 33);
+    hash = ((hash << 27) | (hash >> 37)) * 5 + 0x52dce729;
+  }
+  word = 0;
+  memcpy(&word, data, size);
+  return PartitionMix64(hash ^ word);
+}
+
+/**
+ * @brief The default hash of the `HashPartitioner`, it accepts both the oid
+ * and the internal oid (i.e., the view of the item in the arrow arrays).
+ */
 template <typename OID_T>
-class HashPartitioner {
- public:
-  using oid_t = OID_T;
-
-  HashPartitioner() : fnum_(1) {}
-
-  void Init(fid_t fnum) { fnum_ = fnum; }
-
-  inline fid_t GetPartitionId(const OID_T& oid) const {
-    return static_cast<fid_t>(static_cast<uint64_t>(oid) % fnum_);
+struct PartitionHash {
+  inline uint64_t operator()(const OID_T& oid) const {
+    return PartitionMix64(static_cast<uint64_t>(oid));
   }
+};
 
-  HashPartitioner& operator=(const HashPartitioner& other) {
-    if (this == &other) {
-      return *this;
-    }
-    fnum_ = other.fnum_;
-    return *this;
+template <>
+struct PartitionHash<std::string> {
+  inline uint64_t operator()(const std::string& oid) const {
+    return PartitionHashBytes(oid.data(), oid.size());
   }
 
-  HashPartitioner(const HashPartitioner& other) { fnum_ = other.fnum_; }
-
-  HashPartitioner& operator=(HashPartitioner&& other) {
-    if (this == &other) {
-      return *this;
-    }
-    fnum_ = other.fnum_;
-    return *this;
+  inline uint64_t operator()(const arrow::util::string_view& oid) const {
+    return PartitionHashBytes(oid.data(), oid.size());
   }
-
- private:
-  fid_t fnum_;
 };
 
-template <>
-class HashPartitioner<std::string> {
+/**
+ * @brief Maps the 64 bits hash value to [0, fnum) by a multiplication rather
+ * than the (much slower) modulo, which takes the high bits of the hash.
+ */
+inline fid_t ReducePartitionHash(uint64_t hash, fid_t fnum) {
+  return static_cast<fid_t>(
+      (static_cast<unsigned __int128>(hash) * fnum) >> 64);
+}
+
+/**
+ * @brief HashPartitioner assigns the vertices to the fragments by the hash of
+ * their oids, the hash function `HASH_T` is pluggable.
+ */
+template <typename OID_T, typename HASH_T = PartitionHash<OID_T>>
+class HashPartitioner {
  public:
-  using oid_t = std::string;
+  using oid_t = OID_T;
+  using internal_oid_t = typename InternalType<oid_t>::type;
+  using oid_array_t = typename ConvertToArrowType<oid_t>::ArrayType;
 
   HashPartitioner() : fnum_(1) {}
 
   void Init(fid_t fnum) { fnum_ = fnum; }
 
-  inline fid_t GetPartitionId(const oid_t& oid) const {
-    return static_cast<fid_t>(
-        static_cast<uint64_t>(std::hash<std::string>()(oid)) % fnum_);
+  inline fid_t GetPartitionId(const OID_T& oid) const {
+    return ReducePartitionHash(hash_(oid), fnum_);
+  }
+
+  /**
+   * @brief Partitions a whole column of oids, the items are hashed in place
+   * without being converted to `oid_t`.
+   */
+  void GetPartitionIds(const std::shared_ptr<arrow::Array>& oids,
+                       std::vector<fid_t>& fids) const {
+    auto array = std::dynamic_pointer_cast<oid_array_t>(oids);
+    int64_t length = array->length();
+    fids.resize(length);
+    for (int64_t i = 0; i < length; ++i) {
+      fids[i] = ReducePartitionHash(hash_(array->GetView(i)), fnum_);
+    }
   }
 
   HashPartitioner& operator=(const HashPartitioner& other) {
@@ -100,6 +150,7 @@ class HashPartitioner<std::string> {
 
  private:
   fid_t fnum_;
+  HASH_T hash_;
 };
 
 #if defined(EXPERIMENTAL_ON) || defined(NETWORKX)
@@ -156,6 +207,7 @@ template <typename OID_T>
 class SegmentedPartitioner {
  public:
   using oid_t = OID_T;
+  using oid_array_t = typename ConvertToArrowType<oid_t>::ArrayType;
 
   SegmentedPartitioner() : fnum_(1) {}
 
@@ -172,6 +224,16 @@ class SegmentedPartitioner {
 
   inline fid_t GetPartitionId(const OID_T& oid) const { return o2f_.at(oid); }
 
+  void GetPartitionIds(const std::shared_ptr<arrow::Array>& oids,
+                       std::vector<fid_t>& fids) const {
+    auto array = std::dynamic_pointer_cast<oid_array_t>(oids);
+    int64_t length = array->length();
+    fids.resize(length);
+    for (int64_t i = 0; i < length; ++i) {
+      fids[i] = o2f_.at(oid_t(array->GetView(i)));
+    }
+  }
+
   SegmentedPartitioner& operator=(const SegmentedPartitioner& other) {
     if (this == &other) {
       return *this;
@@ -195,6 +257,103 @@ class SegmentedPartitioner {
   ska::flat_hash_map<OID_T, fid_t> o2f_;
 };
 
+/**
+ * @brief RangePartitioner assigns the vertices to the fragments by the ranges
+ * of their oids, which keeps the vertices with nearby oids (that are usually
+ * adjacent in real-world graphs, e.g., crawled web pages) in the same
+ * fragment.
+ *
+ * The `fnum - 1` splitters are selected from the sampled oids, the vertices in
+ * [splitters[i - 1], splitters[i]) belong to the fragment `i`.
+ */
+template <typename OID_T>
+class RangePartitioner {
+ public:
+  using oid_t = OID_T;
+  using internal_oid_t = typename InternalType<oid_t>::type;
+  using oid_array_t = typename ConvertToArrowType<oid_t>::ArrayType;
+
+  RangePartitioner() : fnum_(1) {}
+
+  void Init(fid_t fnum, const std::vector<OID_T>& splitters) {
+    fnum_ = fnum;
+    splitters_ = splitters;
+    initViews();
+  }
+
+  /**
+   * @brief Selects the `fnum - 1` splitters that divide the samples evenly.
+   */
+  static std::vector<OID_T> SelectSplitters(std::vector<OID_T>& samples,
+                                            fid_t fnum) {
+    std::vector<OID_T> splitters;
+    std::sort(samples.begin(), samples.end());
+    if (samples.empty()) {
+      return splitters;
+    }
+    for (fid_t i = 1; i < fnum; ++i) {
+      splitters.emplace_back(samples[samples.size() * i / fnum]);
+    }
+    return splitters;
+  }
+
+  inline fid_t GetPartitionId(const OID_T& oid) const {
+    return locate(internal_oid_t(oid));
+  }
+
+  void GetPartitionIds(const std::shared_ptr<arrow::Array>& oids,
+                       std::vector<fid_t>& fids) const {
+    auto array = std::dynamic_pointer_cast<oid_array_t>(oids);
+    int64_t length = array->length();
+    fids.resize(length);
+    for (int64_t i = 0; i < length; ++i) {
+      fids[i] = locate(array->GetView(i));
+    }
+  }
+
+  RangePartitioner& operator=(const RangePartitioner& other) {
+    if (this == &other) {
+      return *this;
+    }
+    fnum_ = other.fnum_;
+    splitters_ = other.splitters_;
+    initViews();
+    return *this;
+  }
+
+  RangePartitioner(const RangePartitioner& other) { *this = other; }
+
+  RangePartitioner& operator=(RangePartitioner&& other) {
+    if (this == &other) {
+      return *this;
+    }
+    fnum_ = other.fnum_;
+    splitters_ = std::move(other.splitters_);
+    initViews();
+    return *this;
+  }
+
+ private:
+  // The splitters are searched as the internal oids, to avoid converting the
+  // items of the arrow arrays to `oid_t`.
+  void initViews() {
+    splitter_views_.clear();
+    for (auto const& splitter : splitters_) {
+      splitter_views_.emplace_back(splitter);
+    }
+  }
+
+  inline fid_t locate(const internal_oid_t& oid) const {
+    return static_cast<fid_t>(std::upper_bound(splitter_views_.begin(),
+                                               splitter_views_.end(), oid) -
+                              splitter_views_.begin());
+  }
+
+  fid_t fnum_;
+  std::vector<OID_T> splitters_;
+  std::vector<internal_oid_t> splitter_views_;
+};
+
 }  // namespace vineyard
 
 #endif  // MODULES_GRAPH_UTILS_PARTITIONER_H_
@@ -0,0 +1,284 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef MODULES_GRAPH_UTILS_SELECTED_TAKE_H_
+#define MODULES_GRAPH_UTILS_SELECTED_TAKE_H_
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+#include "arrow/api.h"
+
+namespace vineyard {
+
+/**
+ * The column-at-a-time take kernels: gathering the items at the selected
+ * indices of a column into contiguous value (and offset) buffers, without
+ * appending them one by one through builders or archives.
+ */
+
+namespace take_impl {
+
+template <size_t WIDTH>
+struct simd_take {
+  static int64_t take(const void*, const int64_t*, int64_t, void*) {
+    return 0;
+  }
+};
+
+#if defined(__AVX2__)
+template <>
+struct simd_take<8> {
+  static int64_t take(const void* values, const int64_t* indices, int64_t num,
+                      void* out) {
+    auto base = static_cast<const long long*>(values);  // NOLINT(runtime/int)
+    auto dst = static_cast<__m256i*>(out);
+    int64_t i = 0;
+    for (; i + 4 <= num; i += 4, ++dst) {
+      __m256i index =
+          _mm256_loadu_si256(reinterpret_cast<const __m256i*>(indices + i));
+      _mm256_storeu_si256(dst, _mm256_i64gather_epi64(base, index, 8));
+    }
+    return i;
+  }
+};
+
+template <>
+struct simd_take<4> {
+  static int64_t take(const void* values, const int64_t* indices, int64_t num,
+                      void* out) {
+    auto base = static_cast<const int*>(values);
+    auto dst = static_cast<__m128i*>(out);
+    int64_t i = 0;
+    for (; i + 4 <= num; i += 4, ++dst) {
+      __m256i index =
+          _mm256_loadu_si256(reinterpret_cast<const __m256i*>(indices + i));
+      _mm_storeu_si128(dst, _mm256_i64gather_epi32(base, index, 4));
+    }
+    return i;
+  }
+};
+#endif
+
+template <typename T>
+inline void take_fixed_width(const T* values, const int64_t* indices,
+                             int64_t num, T* out) {
+  int64_t i = simd_take<sizeof(T)>::take(values, indices, num, out);
+  for (; i < num; ++i) {
+    out[i] = values[indices[i]];
+  }
+}
+
+}  // namespace take_impl
+
+/**
+ * @brief Gathers `num` items of `byte_width` bytes at the `indices` of
+ * `values` into `out`. The 4 and 8 bytes wide items are gathered by AVX2
+ * when it is available.
+ */
+inline void TakeFixedWidth(const void* values, int byte_width,
+                           const int64_t* indices, int64_t num, void* out) {
+  switch (byte_width) {
+  case 1:
+    take_impl::take_fixed_width(static_cast<const uint8_t*>(values), indices,
+                                num, static_cast<uint8_t*>(out));
+    break;
+  case 2:
+    take_impl::take_fixed_width(static_cast<const uint16_t*>(values), indices,
+                                num, static_cast<uint16_t*>(out));
+    break;
+  case 4:
+    take_impl::take_fixed_width(static_cast<const uint32_t*>(values), indices,
+                                num, static_cast<uint32_t*>(out));
+    break;
+  case 8:
+    take_impl::take_fixed_width(static_cast<const uint64_t*>(values), indices,
+                                num, static_cast<uint64_t*>(out));
+    break;
+  default: {
+    auto src = static_cast<const uint8_t*>(values);
+    auto dst = static_cast<uint8_t*>(out);
+    for (int64_t i = 0; i < num; ++i) {
+      memcpy(dst + i * byte_width, src + indices[i] * byte_width, byte_width);
+    }
+  }
+  }
+}
+
+/**
+ * @brief Computes the `num + 1` offsets of the variable-length items at the
+ * `indices` when they are packed contiguously, and returns the total length.
+ */
+inline int64_t TakeOffsets(const int64_t* offsets, const int64_t* indices,
+                           int64_t num, int64_t* out_offsets) {
+  int64_t total = 0;
+  for (int64_t i = 0; i < num; ++i) {
+    out_offsets[i] = total;
+    total += offsets[indices[i] + 1] - offsets[indices[i]];
+  }
+  out_offsets[num] = total;
+  return total;
+}
+
+/**
+ * @brief Copies the variable-length items at the `indices`, whose items are
+ * `byte_width` bytes wide, to `out` contiguously.
+ */
+inline void TakeRanges(const int64_t* offsets, const void* values,
+                       int byte_width, const int64_t* indices, int64_t num,
+                       void* out) {
+  auto src = static_cast<const uint8_t*>(values);
+  auto dst = static_cast<uint8_t*>(out);
+  for (int64_t i = 0; i < num; ++i) {
+    int64_t begin = offsets[indices[i]], end = offsets[indices[i] + 1];
+    size_t size = (end - begin) * byte_width;
+    memcpy(dst, src + begin * byte_width, size);
+    dst += size;
+  }
+}
+
+/**
+ * @brief Gathers the validity bits at the `indices` of `bitmap`, which starts
+ * from the `bitmap_offset`-th bit, into the `(num + 7) / 8` bytes of `out`,
+ * and returns the number of nulls among them.
+ */
+inline int64_t TakeBitmap(const uint8_t* bitmap, int64_t bitmap_offset,
+                          const int64_t* indices, int64_t num, uint8_t* out) {
+  std::fill(out, out + (num + 7) / 8, 0);
+  int64_t null_count = 0;
+  for (int64_t i = 0; i < num; ++i) {
+    int64_t bit = bitmap_offset + indices[i];
+    if ((bitmap[bit >> 3] >> (bit & 7)) & 1) {
+      out[i >> 3] |= static_cast<uint8_t>(1 << (i & 7));
+    } else {
+      ++null_count;
+    }
+  }
+  return null_count;
+}
+
+/**
+ * @brief The byte width of the items of the fixed-width type, or -1 if the
+ * type is not fixed-width or is not byte-aligned (e.g., boolean).
+ */
+inline int FixedByteWidth(const std::shared_ptr<arrow::DataType>& type) {
+  auto fixed_width_type =
+      std::dynamic_pointer_cast<arrow::FixedWidthType>(type);
+  if (fixed_width_type == nullptr || fixed_width_type->bit_width() % 8 != 0) {
+    return -1;
+  }
+  return fixed_width_type->bit_width() / 8;
+}
+
+inline arrow::Status AllocateTakeBuffer(int64_t size,
+                                        std::shared_ptr<arrow::Buffer>& out) {
+#if defined(ARROW_VERSION) && ARROW_VERSION < 17000
+  return arrow::AllocateBuffer(arrow::default_memory_pool(), size, &out);
+#else
+  auto result = arrow::AllocateBuffer(size, arrow::default_memory_pool());
+  if (!result.ok()) {
+    return result.status();
+  }
+  out = std::move(result).ValueOrDie();
+  return arrow::Status::OK();
+#endif
+}
+
+/**
+ * @brief Takes the items at the `indices` of the array into a new array.
+ *
+ * Supports the byte-aligned fixed-width types, large string and binary,
+ * large lists of the byte-aligned fixed-width types, and the null type. The
+ * validity bitmap of the array is taken as well, but not the ones of the
+ * items in the lists.
+ */
+inline arrow::Status TakeArray(const std::shared_ptr<arrow::Array>& array,
+                               const std::vector<int64_t>& indices,
+                               std::shared_ptr<arrow::Array>& out) {
+  auto type = array->type();
+  int64_t num = indices.size();
+  std::shared_ptr<arrow::Buffer> validity;
+  int64_t null_count = 0;
+  if (type->id() != arrow::Type::NA && array->null_count() > 0) {
+    ARROW_RETURN_NOT_OK(AllocateTakeBuffer((num + 7) / 8, validity));
+    null_count = TakeBitmap(array->null_bitmap_data(), array->offset(),
+                            indices.data(), num, validity->mutable_data());
+  }
+  int byte_width = FixedByteWidth(type);
+  if (byte_width > 0) {
+    std::shared_ptr<arrow::Buffer> values;
+    ARROW_RETURN_NOT_OK(AllocateTakeBuffer(num * byte_width, values));
+    auto base = array->data()->buffers[1]->data() +
+                array->data()->offset * byte_width;
+    TakeFixedWidth(base, byte_width, indices.data(), num,
+                   values->mutable_data());
+    out = arrow::MakeArray(
+        arrow::ArrayData::Make(type, num, {validity, values}, null_count));
+  } else if (type->id() == arrow::Type::LARGE_STRING ||
+             type->id() == arrow::Type::LARGE_BINARY) {
+    auto binary_array =
+        std::dynamic_pointer_cast<arrow::LargeBinaryArray>(array);
+    std::shared_ptr<arrow::Buffer> offsets, data;
+    ARROW_RETURN_NOT_OK(
+        AllocateTakeBuffer((num + 1) * sizeof(int64_t), offsets));
+    auto out_offsets = reinterpret_cast<int64_t*>(offsets->mutable_data());
+    int64_t total = TakeOffsets(binary_array->raw_value_offsets(),
+                                indices.data(), num, out_offsets);
+    ARROW_RETURN_NOT_OK(AllocateTakeBuffer(total, data));
+    TakeRanges(binary_array->raw_value_offsets(),
+               binary_array->value_data()->data(), 1, indices.data(), num,
+               data->mutable_data());
+    out = arrow::MakeArray(arrow::ArrayData::Make(
+        type, num, {validity, offsets, data}, null_count));
+  } else if (type->id() == arrow::Type::LARGE_LIST &&
+             FixedByteWidth(type->field(0)->type()) > 0) {
+    auto list_array = std::dynamic_pointer_cast<arrow::LargeListArray>(array);
+    auto value_type = type->field(0)->type();
+    int value_width = FixedByteWidth(value_type);
+    auto value_data = list_array->values()->data();
+    std::shared_ptr<arrow::Buffer> offsets, values;
+    ARROW_RETURN_NOT_OK(
+        AllocateTakeBuffer((num + 1) * sizeof(int64_t), offsets));
+    auto out_offsets = reinterpret_cast<int64_t*>(offsets->mutable_data());
+    int64_t total = TakeOffsets(list_array->raw_value_offsets(),
+                                indices.data(), num, out_offsets);
+    ARROW_RETURN_NOT_OK(AllocateTakeBuffer(total * value_width, values));
+    TakeRanges(list_array->raw_value_offsets(),
+               value_data->buffers[1]->data() +
+                   value_data->offset * value_width,
+               value_width, indices.data(), num, values->mutable_data());
+    auto out_value_data =
+        arrow::ArrayData::Make(value_type, total, {nullptr, values}, 0);
+    out = arrow::MakeArray(arrow::ArrayData::Make(
+        type, num, {validity, offsets}, {out_value_data}, null_count));
+  } else if (type->id() == arrow::Type::NA) {
+    out = std::make_shared<arrow::NullArray>(num);
+  } else {
+    return arrow::Status::NotImplemented("Unsupported data type - " +
+                                         type->ToString());
+  }
+  return arrow::Status::OK();
+}
+
+}  // namespace vineyard
+
+#endif  // MODULES_GRAPH_UTILS_SELECTED_TAKE_H_
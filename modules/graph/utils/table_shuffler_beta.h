@@ -20,7 +20,11 @@ limitations under the License.
 
 #include <algorithm>
 #include <atomic>
+#include <cstring>
+#include <limits>
 #include <memory>
+#include <mutex>
+#include <string>
 #include <thread>
 #include <utility>
 #include <vector>
@@ -28,6 +32,7 @@ limitations under the License.
 #include <boost/leaf/all.hpp>
 
 #include "arrow/buffer.h"
+#include "arrow/buffer_builder.h"
 #include "arrow/io/memory.h"
 #include "arrow/ipc/dictionary.h"
 #include "arrow/ipc/reader.h"
@@ -40,7 +45,11 @@ limitations under the License.
 #include "grape/worker/comm_spec.h"
 
 #include "basic/ds/arrow_utils.h"
+#include "common/util/env.h"
+#include "common/util/functions.h"
 #include "graph/utils/error.h"
+#include "graph/utils/selected_take.h"
+#include "graph/utils/thread_group.h"
 
 namespace grape {
 
@@ -170,92 +179,82 @@ inline boost::leaf::result<void> SchemaConsistent(
   return {};
 }
 
-template <typename T>
-inline void serialize_selected_typed_items(
-    grape::InArchive& arc, std::shared_ptr<arrow::Array> array) {
-  auto ptr =
-      std::dynamic_pointer_cast<typename ConvertToArrowType<T>::ArrayType>(
-          array)
-          ->raw_values();
-  for (int64_t x = 0; x < array->length(); ++x) {
-    arc << ptr[x];
-  }
+// The archive grows in multiples of 8 bytes, thus the buffers in it stay
+// aligned for the take kernels.
+inline char* grow_archive(grape::InArchive& arc, size_t size) {
+  size_t pos = arc.GetSize();
+  arc.Resize(pos + ((size + 7) & ~static_cast<size_t>(7)));
+  return arc.GetBuffer() + pos;
 }
 
-template <typename T>
-inline void serialize_selected_typed_items(grape::InArchive& arc,
-                                           std::shared_ptr<arrow::Array> array,
-                                           const std::vector<int64_t>& offset) {
-  auto ptr =
-      std::dynamic_pointer_cast<typename ConvertToArrowType<T>::ArrayType>(
-          array)
-          ->raw_values();
-  for (auto x : offset) {
-    arc << ptr[x];
-  }
+inline const char* consume_archive(grape::OutArchive& arc, size_t size) {
+  return static_cast<const char*>(
+      arc.GetBytes((size + 7) & ~static_cast<size_t>(7)));
 }
 
-void serialize_string_items(grape::InArchive& arc,
-                            std::shared_ptr<arrow::Array> array,
-                            const std::vector<int64_t>& offset) {
-  auto* ptr = std::dynamic_pointer_cast<arrow::LargeStringArray>(array).get();
-  for (auto x : offset) {
-    arc << ptr->GetView(x);
+inline std::shared_ptr<arrow::Buffer> copy_archive_buffer(
+    grape::OutArchive& arc, size_t size) {
+  std::shared_ptr<arrow::Buffer> buffer;
+  ARROW_CHECK_OK(AllocateTakeBuffer(size, buffer));
+  if (size != 0) {
+    memcpy(buffer->mutable_data(), consume_archive(arc, size), size);
   }
+  return buffer;
 }
 
-void serialize_null_items(grape::InArchive& arc,
-                          std::shared_ptr<arrow::Array> array,
-                          const std::vector<int64_t>& offset) {
-  return;
-}
-
-template <typename T>
-void serialize_list_items(grape::InArchive& arc,
-                          std::shared_ptr<arrow::Array> array,
-                          const std::vector<int64_t>& offset) {
-  auto* ptr = std::dynamic_pointer_cast<arrow::LargeListArray>(array).get();
-  for (auto x : offset) {
-    arrow::LargeListArray::offset_type length = ptr->value_length(x);
-    arc << length;
-    auto value = ptr->value_slice(x);
-    serialize_selected_typed_items<T>(arc, value);
+/**
+ * @brief Serializes the selected items of the column as contiguous buffers:
+ * a flag of whether the validity bitmap follows, then the values for
+ * fixed-width types, or the offsets followed by the values for strings and
+ * lists.
+ */
+inline void SerializeSelectedItems(grape::InArchive& arc,
+                                   std::shared_ptr<arrow::Array> array,
+                                   const std::vector<int64_t>& offset) {
+  auto type = array->type();
+  int64_t num = offset.size();
+  if (type->id() != arrow::Type::NA) {
+    int64_t has_nulls = array->null_count() > 0 ? 1 : 0;
+    arc << has_nulls;
+    if (has_nulls) {
+      auto bitmap = grow_archive(arc, (num + 7) / 8);
+      TakeBitmap(array->null_bitmap_data(), array->offset(), offset.data(),
+                 num, reinterpret_cast<uint8_t*>(bitmap));
+    }
   }
-}
-
-void SerializeSelectedItems(grape::InArchive& arc,
-                            std::shared_ptr<arrow::Array> array,
-                            const std::vector<int64_t>& offset) {
-  if (array->type()->Equals(arrow::float64())) {
-    serialize_selected_typed_items<double>(arc, array, offset);
-  } else if (array->type()->Equals(arrow::float32())) {
-    serialize_selected_typed_items<float>(arc, array, offset);
-  } else if (array->type()->Equals(arrow::int64())) {
-    serialize_selected_typed_items<int64_t>(arc, array, offset);
-  } else if (array->type()->Equals(arrow::int32())) {
-    serialize_selected_typed_items<int32_t>(arc, array, offset);
-  } else if (array->type()->Equals(arrow::uint64())) {
-    serialize_selected_typed_items<uint64_t>(arc, array, offset);
-  } else if (array->type()->Equals(arrow::uint32())) {
-    serialize_selected_typed_items<uint32_t>(arc, array, offset);
-  } else if (array->type()->Equals(arrow::large_utf8())) {
-    serialize_string_items(arc, array, offset);
-  } else if (array->type()->Equals(arrow::null())) {
-    serialize_null_items(arc, array, offset);
-  } else if (array->type()->Equals(arrow::large_list(arrow::float64()))) {
-    serialize_list_items<double>(arc, array, offset);
-  } else if (array->type()->Equals(arrow::large_list(arrow::float32()))) {
-    serialize_list_items<float>(arc, array, offset);
-  } else if (array->type()->Equals(arrow::large_list(arrow::int64()))) {
-    serialize_list_items<int64_t>(arc, array, offset);
-  } else if (array->type()->Equals(arrow::large_list(arrow::int32()))) {
-    serialize_list_items<int32_t>(arc, array, offset);
-  } else if (array->type()->Equals(arrow::large_list(arrow::uint64()))) {
-    serialize_list_items<uint64_t>(arc, array, offset);
-  } else if (array->type()->Equals(arrow::large_list(arrow::uint32()))) {
-    serialize_list_items<uint32_t>(arc, array, offset);
-  } else {
-    LOG(FATAL) << "Unsupported data type - " << array->type()->ToString();
+  int byte_width = FixedByteWidth(type);
+  if (byte_width > 0) {
+    auto base = array->data()->buffers[1]->data() +
+                array->data()->offset * byte_width;
+    char* out = grow_archive(arc, num * byte_width);
+    TakeFixedWidth(base, byte_width, offset.data(), num, out);
+  } else if (type->id() == arrow::Type::LARGE_STRING ||
+             type->id() == arrow::Type::LARGE_BINARY) {
+    auto binary_array =
+        std::dynamic_pointer_cast<arrow::LargeBinaryArray>(array);
+    auto out_offsets = reinterpret_cast<int64_t*>(
+        grow_archive(arc, (num + 1) * sizeof(int64_t)));
+    int64_t total = TakeOffsets(binary_array->raw_value_offsets(),
+                                offset.data(), num, out_offsets);
+    char* out = grow_archive(arc, total);
+    TakeRanges(binary_array->raw_value_offsets(),
+               binary_array->value_data()->data(), 1, offset.data(), num, out);
+  } else if (type->id() == arrow::Type::LARGE_LIST &&
+             FixedByteWidth(type->field(0)->type()) > 0) {
+    auto list_array = std::dynamic_pointer_cast<arrow::LargeListArray>(array);
+    int value_width = FixedByteWidth(type->field(0)->type());
+    auto value_data = list_array->values()->data();
+    auto out_offsets = reinterpret_cast<int64_t*>(
+        grow_archive(arc, (num + 1) * sizeof(int64_t)));
+    int64_t total = TakeOffsets(list_array->raw_value_offsets(),
+                                offset.data(), num, out_offsets);
+    char* out = grow_archive(arc, total * value_width);
+    TakeRanges(list_array->raw_value_offsets(),
+               value_data->buffers[1]->data() +
+                   value_data->offset * value_width,
+               value_width, offset.data(), num, out);
+  } else if (type->id() != arrow::Type::NA) {
+    LOG(FATAL) << "Unsupported data type - " << type->ToString();
   }
 }
 
@@ -269,81 +268,50 @@ void SerializeSelectedRows(grape::InArchive& arc,
   }
 }
 
-template <typename T>
-inline void deserialize_selected_typed_items(grape::OutArchive& arc,
-                                             int64_t num,
-                                             arrow::ArrayBuilder* builder) {
-  auto casted_builder =
-      dynamic_cast<typename ConvertToArrowType<T>::BuilderType*>(builder);
-  T val;
-  for (int64_t i = 0; i != num; ++i) {
-    arc >> val;
-    casted_builder->Append(val);
-  }
-}
-
-inline void deserialize_string_items(grape::OutArchive& arc, int64_t num,
-                                     arrow::ArrayBuilder* builder) {
-  auto casted_builder = dynamic_cast<arrow::LargeStringBuilder*>(builder);
-  arrow::util::string_view val;
-  for (int64_t i = 0; i != num; ++i) {
-    arc >> val;
-    casted_builder->Append(val);
-  }
-}
-
-inline void deserialize_null_items(grape::OutArchive& arc, int64_t num,
-                                   arrow::ArrayBuilder* builder) {
-  auto casted_builder = dynamic_cast<arrow::NullBuilder*>(builder);
-  casted_builder->AppendNulls(num);
-}
-
-template <typename T>
-inline void deserialize_list_items(grape::OutArchive& arc, int64_t num,
-                                   arrow::ArrayBuilder* builder) {
-  auto casted_builder = dynamic_cast<arrow::LargeListBuilder*>(builder);
-  auto value_builder = casted_builder->value_builder();
-  arrow::LargeListArray::offset_type length;
-  for (int64_t i = 0; i != num; ++i) {
-    arc >> length;
-    deserialize_selected_typed_items<T>(arc, length, value_builder);
-    casted_builder->Append(true);
+/**
+ * @brief Rebuilds the column from the buffers in the archive that are
+ * serialized by SerializeSelectedItems.
+ */
+inline std::shared_ptr<arrow::Array> DeserializeSelectedItems(
+    grape::OutArchive& arc, int64_t num,
+    const std::shared_ptr<arrow::DataType>& type) {
+  std::shared_ptr<arrow::Buffer> validity;
+  int64_t null_count = 0;
+  if (type->id() != arrow::Type::NA) {
+    int64_t has_nulls;
+    arc >> has_nulls;
+    if (has_nulls) {
+      validity = copy_archive_buffer(arc, (num + 7) / 8);
+      null_count = arrow::kUnknownNullCount;
+    }
   }
-}
-
-void DeserializeSelectedItems(grape::OutArchive& arc, int64_t num,
-                              arrow::ArrayBuilder* builder) {
-  if (builder->type()->Equals(arrow::float64())) {
-    deserialize_selected_typed_items<double>(arc, num, builder);
-  } else if (builder->type()->Equals(arrow::float32())) {
-    deserialize_selected_typed_items<float>(arc, num, builder);
-  } else if (builder->type()->Equals(arrow::int64())) {
-    deserialize_selected_typed_items<int64_t>(arc, num, builder);
-  } else if (builder->type()->Equals(arrow::int32())) {
-    deserialize_selected_typed_items<int32_t>(arc, num, builder);
-  } else if (builder->type()->Equals(arrow::uint64())) {
-    deserialize_selected_typed_items<uint64_t>(arc, num, builder);
-  } else if (builder->type()->Equals(arrow::uint32())) {
-    deserialize_selected_typed_items<uint32_t>(arc, num, builder);
-  } else if (builder->type()->Equals(arrow::large_utf8())) {
-    deserialize_string_items(arc, num, builder);
-  } else if (builder->type()->Equals(arrow::null())) {
-    deserialize_null_items(arc, num, builder);
-  } else if (builder->type()->Equals(arrow::large_list(arrow::float64()))) {
-    deserialize_list_items<double>(arc, num, builder);
-  } else if (builder->type()->Equals(arrow::large_list(arrow::float32()))) {
-    deserialize_list_items<float>(arc, num, builder);
-  } else if (builder->type()->Equals(arrow::large_list(arrow::int64()))) {
-    deserialize_list_items<int64_t>(arc, num, builder);
-  } else if (builder->type()->Equals(arrow::large_list(arrow::int32()))) {
-    deserialize_list_items<int32_t>(arc, num, builder);
-  } else if (builder->type()->Equals(arrow::large_list(arrow::uint64()))) {
-    deserialize_list_items<uint64_t>(arc, num, builder);
-  } else if (builder->type()->Equals(arrow::large_list(arrow::uint32()))) {
-    deserialize_list_items<uint32_t>(arc, num, builder);
-  } else {
-    LOG(FATAL) << "Unsupported data type - " << builder->type()->ToString();
+  int byte_width = FixedByteWidth(type);
+  if (byte_width > 0) {
+    auto values = copy_archive_buffer(arc, num * byte_width);
+    return arrow::MakeArray(
+        arrow::ArrayData::Make(type, num, {validity, values}, null_count));
+  } else if (type->id() == arrow::Type::LARGE_STRING ||
+             type->id() == arrow::Type::LARGE_BINARY) {
+    auto offsets = copy_archive_buffer(arc, (num + 1) * sizeof(int64_t));
+    int64_t total = reinterpret_cast<const int64_t*>(offsets->data())[num];
+    auto data = copy_archive_buffer(arc, total);
+    return arrow::MakeArray(arrow::ArrayData::Make(
+        type, num, {validity, offsets, data}, null_count));
+  } else if (type->id() == arrow::Type::LARGE_LIST &&
+             FixedByteWidth(type->field(0)->type()) > 0) {
+    auto value_type = type->field(0)->type();
+    auto offsets = copy_archive_buffer(arc, (num + 1) * sizeof(int64_t));
+    int64_t total = reinterpret_cast<const int64_t*>(offsets->data())[num];
+    auto values = copy_archive_buffer(arc, total * FixedByteWidth(value_type));
+    auto value_data =
+        arrow::ArrayData::Make(value_type, total, {nullptr, values}, 0);
+    return arrow::MakeArray(arrow::ArrayData::Make(
+        type, num, {validity, offsets}, {value_data}, null_count));
+  } else if (type->id() == arrow::Type::NA) {
+    return std::make_shared<arrow::NullArray>(num);
   }
+  LOG(FATAL) << "Unsupported data type - " << type->ToString();
+  return nullptr;
 }
 
 void DeserializeSelectedRows(grape::OutArchive& arc,
@@ -351,125 +319,175 @@ void DeserializeSelectedRows(grape::OutArchive& arc,
                              std::shared_ptr<arrow::RecordBatch>& batch_out) {
   int64_t row_num;
   arc >> row_num;
-  std::unique_ptr<arrow::RecordBatchBuilder> builder;
-  ARROW_CHECK_OK(arrow::RecordBatchBuilder::Make(
-      schema, arrow::default_memory_pool(), row_num, &builder));
-  int col_num = builder->num_fields();
+  int col_num = schema->num_fields();
+  std::vector<std::shared_ptr<arrow::Array>> columns(col_num);
   for (int col_id = 0; col_id != col_num; ++col_id) {
-    DeserializeSelectedItems(arc, row_num, builder->GetField(col_id));
+    columns[col_id] =
+        DeserializeSelectedItems(arc, row_num, schema->field(col_id)->type());
   }
-  ARROW_CHECK_OK(builder->Flush(&batch_out));
-}
-
-template <typename T>
-inline void select_typed_items(std::shared_ptr<arrow::Array> array,
-                               arrow::ArrayBuilder* builder) {
-  auto ptr =
-      std::dynamic_pointer_cast<typename ConvertToArrowType<T>::ArrayType>(
-          array)
-          ->raw_values();
-  auto casted_builder =
-      dynamic_cast<typename ConvertToArrowType<T>::BuilderType*>(builder);
-  casted_builder->AppendValues(ptr, array->length());
+  batch_out = arrow::RecordBatch::Make(schema, row_num, columns);
 }
 
-template <typename T>
-inline void select_typed_items(std::shared_ptr<arrow::Array> array,
-                               const std::vector<int64_t>& offset,
-                               arrow::ArrayBuilder* builder) {
-  auto ptr =
-      std::dynamic_pointer_cast<typename ConvertToArrowType<T>::ArrayType>(
-          array)
-          ->raw_values();
-  auto casted_builder =
-      dynamic_cast<typename ConvertToArrowType<T>::BuilderType*>(builder);
-  for (auto x : offset) {
-    casted_builder->Append(ptr[x]);
+/**
+ * @brief Accumulates the chunks of rows from a source, that are serialized by
+ * SerializeSelectedRows, into one buffer per column.
+ *
+ * The offsets and the fixed-width values are pre-sized for all the rows from
+ * the source, the chunks are appended in the order they arrive, and the
+ * offsets of the variable-length items are rebased onto the values that have
+ * been appended before. The validity bitmap of a column is started once a
+ * chunk with nulls arrives, with the rows before marked as valid.
+ */
+class SelectedRowsBuilder {
+ public:
+  SelectedRowsBuilder(std::shared_ptr<arrow::Schema> schema, int64_t capacity)
+      : schema_(schema),
+        capacity_(capacity),
+        row_num_(0),
+        columns_(schema->num_fields()) {
+    for (int col_id = 0; col_id != schema->num_fields(); ++col_id) {
+      auto type = schema->field(col_id)->type();
+      auto& column = columns_[col_id];
+      column.item_num = 0;
+      column.nullable = false;
+      if (FixedByteWidth(type) > 0) {
+        column.value_width = FixedByteWidth(type);
+        column.var_length = false;
+        ARROW_CHECK_OK(column.values.Reserve(capacity * column.value_width));
+      } else if (type->id() == arrow::Type::LARGE_STRING ||
+                 type->id() == arrow::Type::LARGE_BINARY) {
+        column.value_width = 1;
+        column.var_length = true;
+        ARROW_CHECK_OK(column.offsets.Reserve(capacity + 1));
+      } else if (type->id() == arrow::Type::LARGE_LIST &&
+                 FixedByteWidth(type->field(0)->type()) > 0) {
+        column.value_width = FixedByteWidth(type->field(0)->type());
+        column.var_length = true;
+        ARROW_CHECK_OK(column.offsets.Reserve(capacity + 1));
+      } else if (type->id() == arrow::Type::NA) {
+        column.value_width = 0;
+        column.var_length = false;
+      } else {
+        LOG(FATAL) << "Unsupported data type - " << type->ToString();
+      }
+    }
   }
-}
 
-inline void select_string_items(std::shared_ptr<arrow::Array> array,
-                                const std::vector<int64_t>& offset,
-                                arrow::ArrayBuilder* builder) {
-  auto* ptr = std::dynamic_pointer_cast<arrow::LargeStringArray>(array).get();
-  auto casted_builder = dynamic_cast<arrow::LargeStringBuilder*>(builder);
-  for (auto x : offset) {
-    casted_builder->Append(ptr->GetView(x));
+  void Append(grape::OutArchive& arc) {
+    int64_t num;
+    arc >> num;
+    for (auto& column : columns_) {
+      if (column.value_width == 0) {
+        continue;
+      }
+      appendValidity(arc, num, column);
+      if (!column.var_length) {
+        ARROW_CHECK_OK(column.values.Append(
+            consume_archive(arc, num * column.value_width),
+            num * column.value_width));
+        continue;
+      }
+      auto offsets = reinterpret_cast<const int64_t*>(
+          consume_archive(arc, (num + 1) * sizeof(int64_t)));
+      ARROW_CHECK_OK(column.offsets.Reserve(num));
+      for (int64_t i = 0; i < num; ++i) {
+        column.offsets.UnsafeAppend(column.item_num + offsets[i]);
+      }
+      int64_t size = offsets[num] * column.value_width;
+      ARROW_CHECK_OK(column.values.Append(consume_archive(arc, size), size));
+      column.item_num += offsets[num];
+    }
+    row_num_ += num;
   }
-}
-
-inline void select_null_items(std::shared_ptr<arrow::Array> array,
-                              const std::vector<int64_t>& offset,
-                              arrow::ArrayBuilder* builder) {
-  arrow::NullBuilder* casted_builder =
-      dynamic_cast<arrow::NullBuilder*>(builder);
-  casted_builder->AppendNulls(offset.size());
-}
-
-template <typename T>
-inline void select_list_items(std::shared_ptr<arrow::Array> array,
-                              const std::vector<int64_t>& offset,
-                              arrow::ArrayBuilder* builder) {
-  auto ptr = std::dynamic_pointer_cast<arrow::LargeListArray>(array).get();
 
-  auto casted_builder = dynamic_cast<arrow::LargeListBuilder*>(builder);
-  auto value_builder = casted_builder->value_builder();
-  for (auto x : offset) {
-    select_typed_items<T>(ptr->value_slice(x), value_builder);
-    casted_builder->Append(true);
+  std::shared_ptr<arrow::RecordBatch> Finish() {
+    std::vector<std::shared_ptr<arrow::Array>> arrays;
+    for (int col_id = 0; col_id != schema_->num_fields(); ++col_id) {
+      auto type = schema_->field(col_id)->type();
+      auto& column = columns_[col_id];
+      std::shared_ptr<arrow::Buffer> validity, offsets, values;
+      if (column.value_width == 0) {
+        arrays.emplace_back(std::make_shared<arrow::NullArray>(row_num_));
+        continue;
+      }
+      int64_t null_count = 0;
+      if (column.nullable) {
+        null_count = column.validity.false_count();
+        ARROW_CHECK_OK(column.validity.Finish(&validity));
+      }
+      ARROW_CHECK_OK(column.values.Finish(&values));
+      if (!column.var_length) {
+        arrays.emplace_back(arrow::MakeArray(arrow::ArrayData::Make(
+            type, row_num_, {validity, values}, null_count)));
+        continue;
+      }
+      ARROW_CHECK_OK(column.offsets.Append(column.item_num));
+      ARROW_CHECK_OK(column.offsets.Finish(&offsets));
+      if (type->id() == arrow::Type::LARGE_LIST) {
+        auto value_data = arrow::ArrayData::Make(
+            type->field(0)->type(), column.item_num, {nullptr, values}, 0);
+        arrays.emplace_back(arrow::MakeArray(arrow::ArrayData::Make(
+            type, row_num_, {validity, offsets}, {value_data}, null_count)));
+      } else {
+        arrays.emplace_back(arrow::MakeArray(arrow::ArrayData::Make(
+            type, row_num_, {validity, offsets, values}, null_count)));
+      }
+    }
+    return arrow::RecordBatch::Make(schema_, row_num_, arrays);
   }
-}
 
-inline void SelectItems(std::shared_ptr<arrow::Array> array,
-                        const std::vector<int64_t> offset,
-                        arrow::ArrayBuilder* builder) {
-  if (array->type()->Equals(arrow::float64())) {
-    select_typed_items<double>(array, offset, builder);
-  } else if (array->type()->Equals(arrow::float32())) {
-    select_typed_items<float>(array, offset, builder);
-  } else if (array->type()->Equals(arrow::int64())) {
-    select_typed_items<int64_t>(array, offset, builder);
-  } else if (array->type()->Equals(arrow::int32())) {
-    select_typed_items<int32_t>(array, offset, builder);
-  } else if (array->type()->Equals(arrow::uint64())) {
-    select_typed_items<uint64_t>(array, offset, builder);
-  } else if (array->type()->Equals(arrow::uint32())) {
-    select_typed_items<uint32_t>(array, offset, builder);
-  } else if (array->type()->Equals(arrow::large_utf8())) {
-    select_string_items(array, offset, builder);
-  } else if (array->type()->Equals(arrow::null())) {
-    select_null_items(array, offset, builder);
-  } else if (array->type()->Equals(arrow::large_list(arrow::float64()))) {
-    select_list_items<double>(array, offset, builder);
-  } else if (array->type()->Equals(arrow::large_list(arrow::float32()))) {
-    select_list_items<float>(array, offset, builder);
-  } else if (array->type()->Equals(arrow::large_list(arrow::int64()))) {
-    select_list_items<int64_t>(array, offset, builder);
-  } else if (array->type()->Equals(arrow::large_list(arrow::int32()))) {
-    select_list_items<int32_t>(array, offset, builder);
-  } else if (array->type()->Equals(arrow::large_list(arrow::uint64()))) {
-    select_list_items<uint64_t>(array, offset, builder);
-  } else if (array->type()->Equals(arrow::large_list(arrow::uint32()))) {
-    select_list_items<uint32_t>(array, offset, builder);
-  } else {
-    LOG(FATAL) << "Unsupported data type - " << builder->type()->ToString();
+ private:
+  struct column_t {
+    // the bytes of a value, or of an item of the lists, 0 for nulls.
+    int value_width;
+    bool var_length;
+    // whether the validity bitmap has been started.
+    bool nullable;
+    // the number of items in the values of the strings and lists.
+    int64_t item_num;
+    arrow::TypedBufferBuilder<bool> validity;
+    arrow::TypedBufferBuilder<int64_t> offsets;
+    arrow::BufferBuilder values;
+  };
+
+  void appendValidity(grape::OutArchive& arc, int64_t num, column_t& column) {
+    int64_t has_nulls;
+    arc >> has_nulls;
+    if (has_nulls && !column.nullable) {
+      column.nullable = true;
+      ARROW_CHECK_OK(column.validity.Reserve(capacity_));
+      ARROW_CHECK_OK(column.validity.Append(row_num_, true));
+    }
+    if (has_nulls) {
+      auto bitmap =
+          reinterpret_cast<const uint8_t*>(consume_archive(arc, (num + 7) / 8));
+      ARROW_CHECK_OK(column.validity.Reserve(num));
+      for (int64_t i = 0; i < num; ++i) {
+        column.validity.UnsafeAppend((bitmap[i >> 3] >> (i & 7)) & 1);
+      }
+    } else if (column.nullable) {
+      ARROW_CHECK_OK(column.validity.Append(num, true));
+    }
   }
-}
+
+  std::shared_ptr<arrow::Schema> schema_;
+  int64_t capacity_;
+  int64_t row_num_;
+  std::vector<column_t> columns_;
+};
 
 inline void SelectRows(std::shared_ptr<arrow::RecordBatch> record_batch_in,
                        const std::vector<int64_t>& offset,
                        std::shared_ptr<arrow::RecordBatch>& record_batch_out) {
   int64_t row_num = offset.size();
-  std::unique_ptr<arrow::RecordBatchBuilder> builder;
-  ARROW_CHECK_OK(arrow::RecordBatchBuilder::Make(record_batch_in->schema(),
-                                                 arrow::default_memory_pool(),
-                                                 row_num, &builder));
-  int col_num = builder->num_fields();
+  int col_num = record_batch_in->num_columns();
+  std::vector<std::shared_ptr<arrow::Array>> columns(col_num);
   for (int col_id = 0; col_id != col_num; ++col_id) {
-    SelectItems(record_batch_in->column(col_id), offset,
-                builder->GetField(col_id));
+    ARROW_CHECK_OK(
+        TakeArray(record_batch_in->column(col_id), offset, columns[col_id]));
   }
-  ARROW_CHECK_OK(builder->Flush(&record_batch_out));
+  record_batch_out =
+      arrow::RecordBatch::Make(record_batch_in->schema(), row_num, columns);
 }
 
 void ShuffleTableByOffsetLists(
@@ -620,10 +638,307 @@ void ShuffleTableByOffsetLists(
   MPI_Barrier(comm_spec.comm());
 }
 
+/**
+ * @brief Statistics of the pipelined shuffle.
+ */
+struct ShuffleStats {
+  // wall time of the shuffle, in seconds.
+  double elapsed = 0;
+  // high-water mark of the serialized chunks that are buffered, i.e., the
+  // ones that wait to be sent, or to be deserialized after received.
+  size_t peak_buffered_bytes = 0;
+  size_t sent_bytes = 0;
+  size_t sent_chunks = 0;
+  size_t recv_bytes = 0;
+  size_t recv_chunks = 0;
+  // peak resident set size of the process when the shuffle finishes.
+  size_t peak_rss = 0;
+
+  std::string ToString() const {
+    return "elapsed: " + std::to_string(elapsed) +
+           " seconds, peak buffered: " + std::to_string(peak_buffered_bytes) +
+           " bytes, sent: " + std::to_string(sent_bytes) + " bytes in " +
+           std::to_string(sent_chunks) +
+           " chunks, received: " + std::to_string(recv_bytes) + " bytes in " +
+           std::to_string(recv_chunks) +
+           " chunks, peak rss: " + std::to_string(peak_rss) + " bytes";
+  }
+};
+
+/// The target size of the chunks that the pipelined shuffle streams.
+static constexpr size_t kShuffleChunkBytes = 4 * 1024 * 1024;
+
+/// The number of non-blocking sends that are in flight at the same time.
+static constexpr size_t kShuffleSendWindow = 8;
+
+/// The MPI tag of the chunks of the pipelined shuffle.
+static constexpr int kShuffleTag = 0x5348;
+
+inline int64_t array_data_bytes(const arrow::ArrayData& data) {
+  int64_t bytes = 0;
+  for (auto const& buffer : data.buffers) {
+    if (buffer != nullptr) {
+      bytes += buffer->size();
+    }
+  }
+  for (auto const& child : data.child_data) {
+    bytes += array_data_bytes(*child);
+  }
+  return bytes;
+}
+
+/**
+ * @brief Estimates the bytes that a row of the record batch takes after
+ * serialized.
+ */
+inline int64_t EstimateRowBytes(
+    const std::shared_ptr<arrow::RecordBatch>& record_batch) {
+  int64_t row_num = record_batch->num_rows();
+  if (row_num == 0) {
+    return 1;
+  }
+  int64_t bytes = 0;
+  for (int col_id = 0; col_id != record_batch->num_columns(); ++col_id) {
+    bytes += array_data_bytes(*record_batch->column(col_id)->data());
+  }
+  return std::max(static_cast<int64_t>(1), bytes / row_num);
+}
+
+/**
+ * @brief The pipelined version of ShuffleTableByOffsetLists.
+ *
+ * The selected rows are streamed to each destination in chunks of about
+ * `chunk_bytes`, using a window of non-blocking sends. The serialized chunks
+ * are buffered by bounded queues on both sides, thus serialization, network
+ * and deserialization overlap, and the peak memory no longer grows with the
+ * whole shuffled table. The chunk and row counts are exchanged in advance,
+ * and the receiver appends the buffers of each chunk column-wise to the
+ * SelectedRowsBuilder of its source, which is pre-sized for all rows from the
+ * source.
+ *
+ * The received rows are returned as one record batch per source worker,
+ * followed by the rows that stay on this worker.
+ */
+inline void PipelinedShuffleTableByOffsetLists(
+    std::shared_ptr<arrow::Schema> schema,
+    std::vector<std::shared_ptr<arrow::RecordBatch>>& record_batches_out,
+    const std::vector<std::vector<std::vector<int64_t>>>& offset_lists,
+    std::vector<std::shared_ptr<arrow::RecordBatch>>& record_batches_in,
+    const grape::CommSpec& comm_spec, ShuffleStats* stats = nullptr,
+    size_t chunk_bytes = kShuffleChunkBytes) {
+  double start_ts = GetCurrentTime();
+  int worker_id = comm_spec.worker_id();
+  int worker_num = comm_spec.worker_num();
+  MPI_Comm comm = comm_spec.comm();
+  size_t record_batches_out_num = record_batches_out.size();
+
+  // the chunking is deterministic, thus the receiver knows how many chunks
+  // and rows to expect from each source.
+  std::vector<int64_t> chunk_rows(record_batches_out_num);
+  std::vector<int64_t> counts_to(worker_num * 2, 0);
+  std::vector<int64_t> counts_from(worker_num * 2, 0);
+  for (size_t rb_i = 0; rb_i != record_batches_out_num; ++rb_i) {
+    chunk_rows[rb_i] = std::max(
+        static_cast<int64_t>(1),
+        static_cast<int64_t>(chunk_bytes) /
+            EstimateRowBytes(record_batches_out[rb_i]));
+    for (int dst_worker_id = 0; dst_worker_id != worker_num;
+         ++dst_worker_id) {
+      if (dst_worker_id == worker_id) {
+        continue;
+      }
+      int64_t rows =
+          offset_lists[rb_i][comm_spec.WorkerToFrag(dst_worker_id)].size();
+      counts_to[dst_worker_id * 2] +=
+          (rows + chunk_rows[rb_i] - 1) / chunk_rows[rb_i];
+      counts_to[dst_worker_id * 2 + 1] += rows;
+    }
+  }
+  MPI_Alltoall(counts_to.data(), 2, MPI_INT64_T, counts_from.data(), 2,
+               MPI_INT64_T, comm);
+  int64_t chunks_to_recv = 0;
+  for (int src_worker_id = 0; src_worker_id != worker_num; ++src_worker_id) {
+    chunks_to_recv += counts_from[src_worker_id * 2];
+  }
+
+  std::vector<std::unique_ptr<SelectedRowsBuilder>> builders(worker_num);
+  std::vector<std::mutex> builder_mutexes(worker_num);
+  for (int src_worker_id = 0; src_worker_id != worker_num; ++src_worker_id) {
+    if (src_worker_id != worker_id) {
+      builders[src_worker_id].reset(new SelectedRowsBuilder(
+          schema, counts_from[src_worker_id * 2 + 1]));
+    }
+  }
+
+  int thread_num =
+      (std::thread::hardware_concurrency() + comm_spec.local_num() - 1) /
+      comm_spec.local_num();
+  int deserialize_thread_num = std::max(1, (thread_num - 2) / 2);
+  int serialize_thread_num =
+      std::max(1, thread_num - 2 - deserialize_thread_num);
+  std::vector<std::thread> serialize_threads(serialize_thread_num);
+  std::vector<std::thread> deserialize_threads(deserialize_thread_num);
+
+  grape::BlockingQueue<std::pair<int, grape::InArchive>> msg_out;
+  grape::BlockingQueue<std::pair<int, grape::OutArchive>> msg_in;
+  msg_out.SetProducerNum(serialize_thread_num);
+  msg_out.SetLimit(std::max(4, serialize_thread_num * 2));
+  msg_in.SetProducerNum(1);
+  msg_in.SetLimit(std::max(4, deserialize_thread_num * 2));
+
+  std::atomic<size_t> buffered_bytes(0), peak_buffered_bytes(0);
+  std::atomic<size_t> sent_bytes(0), recv_bytes(0);
+  auto acquire = [&](size_t bytes) {
+    size_t current = buffered_bytes.fetch_add(bytes) + bytes;
+    size_t peak = peak_buffered_bytes.load();
+    while (current > peak &&
+           !peak_buffered_bytes.compare_exchange_weak(peak, current)) {
+    }
+  };
+  auto release = [&](size_t bytes) { buffered_bytes.fetch_sub(bytes); };
+
+  std::thread send_thread([&]() {
+    std::vector<grape::InArchive> window(kShuffleSendWindow);
+    std::vector<MPI_Request> requests(kShuffleSendWindow, MPI_REQUEST_NULL);
+    size_t slot = 0;
+    std::pair<int, grape::InArchive> item;
+    while (msg_out.Get(item)) {
+      // reuses the slot of the oldest send once it completes.
+      if (requests[slot] != MPI_REQUEST_NULL) {
+        MPI_Wait(&requests[slot], MPI_STATUS_IGNORE);
+        release(window[slot].GetSize());
+      }
+      window[slot] = std::move(item.second);
+      size_t size = window[slot].GetSize();
+      CHECK_LE(size, static_cast<size_t>(std::numeric_limits<int>::max()));
+      MPI_Isend(window[slot].GetBuffer(), static_cast<int>(size), MPI_CHAR,
+                item.first, kShuffleTag, comm, &requests[slot]);
+      sent_bytes += size;
+      slot = (slot + 1) % kShuffleSendWindow;
+    }
+    for (slot = 0; slot != kShuffleSendWindow; ++slot) {
+      if (requests[slot] != MPI_REQUEST_NULL) {
+        MPI_Wait(&requests[slot], MPI_STATUS_IGNORE);
+        release(window[slot].GetSize());
+      }
+    }
+  });
+
+  std::thread recv_thread([&]() {
+    for (int64_t chunk_i = 0; chunk_i != chunks_to_recv; ++chunk_i) {
+      MPI_Status status;
+      MPI_Probe(MPI_ANY_SOURCE, kShuffleTag, comm, &status);
+      int size = 0;
+      MPI_Get_count(&status, MPI_CHAR, &size);
+      std::pair<int, grape::OutArchive> item;
+      item.first = status.MPI_SOURCE;
+      item.second.Allocate(size);
+      MPI_Recv(item.second.GetBuffer(), size, MPI_CHAR, status.MPI_SOURCE,
+               kShuffleTag, comm, MPI_STATUS_IGNORE);
+      acquire(size);
+      recv_bytes += size;
+      msg_in.Put(std::move(item));
+    }
+    msg_in.DecProducerNum();
+  });
+
+  std::atomic<size_t> cur_batch_out(0);
+  for (int i = 0; i != serialize_thread_num; ++i) {
+    serialize_threads[i] = std::thread([&]() {
+      while (true) {
+        size_t got_batch = cur_batch_out.fetch_add(1);
+        if (got_batch >= record_batches_out_num) {
+          break;
+        }
+        auto cur_rb = record_batches_out[got_batch];
+        auto& cur_offset_lists = offset_lists[got_batch];
+        int64_t cur_chunk_rows = chunk_rows[got_batch];
+
+        for (int i = 1; i != worker_num; ++i) {
+          int dst_worker_id = (worker_id + i) % worker_num;
+          auto& offset =
+              cur_offset_lists[comm_spec.WorkerToFrag(dst_worker_id)];
+          int64_t row_num = offset.size();
+          for (int64_t begin = 0; begin < row_num; begin += cur_chunk_rows) {
+            int64_t end = std::min(begin + cur_chunk_rows, row_num);
+            std::vector<int64_t> chunk_offset(offset.begin() + begin,
+                                              offset.begin() + end);
+            std::pair<int, grape::InArchive> item;
+            item.first = dst_worker_id;
+            SerializeSelectedRows(item.second, cur_rb, chunk_offset);
+            acquire(item.second.GetSize());
+            msg_out.Put(std::move(item));
+          }
+        }
+      }
+      msg_out.DecProducerNum();
+    });
+  }
+
+  for (int i = 0; i != deserialize_thread_num; ++i) {
+    deserialize_threads[i] = std::thread([&]() {
+      std::pair<int, grape::OutArchive> item;
+      while (msg_in.Get(item)) {
+        size_t size = item.second.GetSize();
+        {
+          std::lock_guard<std::mutex> lock(builder_mutexes[item.first]);
+          builders[item.first]->Append(item.second);
+        }
+        release(size);
+      }
+    });
+  }
+
+  // the rows that stay on this worker are selected meanwhile.
+  std::vector<std::shared_ptr<arrow::RecordBatch>> local_batches;
+  for (size_t rb_i = 0; rb_i != record_batches_out_num; ++rb_i) {
+    std::shared_ptr<arrow::RecordBatch> rb;
+    SelectRows(record_batches_out[rb_i], offset_lists[rb_i][comm_spec.fid()],
+               rb);
+    local_batches.emplace_back(std::move(rb));
+  }
+
+  send_thread.join();
+  recv_thread.join();
+  for (auto& thrd : serialize_threads) {
+    thrd.join();
+  }
+  for (auto& thrd : deserialize_threads) {
+    thrd.join();
+  }
+
+  record_batches_in.clear();
+  for (int src_worker_id = 0; src_worker_id != worker_num; ++src_worker_id) {
+    if (src_worker_id != worker_id) {
+      record_batches_in.emplace_back(builders[src_worker_id]->Finish());
+    }
+  }
+  for (auto& rb : local_batches) {
+    record_batches_in.emplace_back(std::move(rb));
+  }
+
+  MPI_Barrier(comm);
+
+  if (stats != nullptr) {
+    stats->elapsed = GetCurrentTime() - start_ts;
+    stats->peak_buffered_bytes = peak_buffered_bytes.load();
+    stats->sent_bytes = sent_bytes.load();
+    stats->recv_bytes = recv_bytes.load();
+    stats->recv_chunks = static_cast<size_t>(chunks_to_recv);
+    stats->sent_chunks = 0;
+    for (int dst_worker_id = 0; dst_worker_id != worker_num;
+         ++dst_worker_id) {
+      stats->sent_chunks += static_cast<size_t>(counts_to[dst_worker_id * 2]);
+    }
+    stats->peak_rss = get_peek_rss();
+  }
+}
+
 template <typename VID_TYPE>
 boost::leaf::result<std::shared_ptr<arrow::Table>> ShufflePropertyEdgeTable(
     const grape::CommSpec& comm_spec, IdParser<VID_TYPE>& id_parser,
-    int src_col_id, int dst_col_id, std::shared_ptr<arrow::Table>& table_in) {
+    int src_col_id, int dst_col_id, std::shared_ptr<arrow::Table>& table_in,
+    ShuffleStats* stats = nullptr) {
   BOOST_LEAF_CHECK(SchemaConsistent(*table_in->schema(), comm_spec));
 
   std::vector<std::shared_ptr<arrow::RecordBatch>> record_batches;
@@ -636,17 +951,9 @@ boost::leaf::result<std::shared_ptr<arrow::Table>> ShufflePropertyEdgeTable(
   int thread_num =
       (std::thread::hardware_concurrency() + comm_spec.local_num() - 1) /
       comm_spec.local_num();
-  std::vector<std::thread> scan_threads(thread_num);
-  std::atomic<size_t> cur(0);
-
-  for (int i = 0; i < thread_num; ++i) {
-    scan_threads[i] = std::thread([&]() {
-      while (true) {
-        size_t got = cur.fetch_add(1);
-        if (got >= record_batch_num) {
-          break;
-        }
-
+  ThreadPool::Default().ParallelFor(
+      record_batch_num,
+      [&](size_t got) {
         auto& offset_list = offset_lists[got];
         offset_list.resize(comm_spec.fnum());
         auto cur_batch = record_batches[got];
@@ -675,17 +982,22 @@ boost::leaf::result<std::shared_ptr<arrow::Table>> ShufflePropertyEdgeTable(
             offset_list[dst_fid].push_back(row_id);
           }
         }
-      }
-    });
-  }
-  for (auto& thrd : scan_threads) {
-    thrd.join();
-  }
+      },
+      thread_num, 1);
 
   std::vector<std::shared_ptr<arrow::RecordBatch>> batches_in;
 
-  ShuffleTableByOffsetLists(table_in->schema(), record_batches, offset_lists,
-                            batches_in, comm_spec);
+  ShuffleStats shuffle_stats;
+  PipelinedShuffleTableByOffsetLists(table_in->schema(), record_batches,
+                                     offset_lists, batches_in, comm_spec,
+                                     &shuffle_stats);
+#if defined(WITH_PROFILING)
+  LOG(INFO) << "[worker-" << comm_spec.worker_id()
+            << "] Shuffle edge table: " << shuffle_stats.ToString();
+#endif
+  if (stats != nullptr) {
+    *stats = shuffle_stats;
+  }
 
   batches_in.erase(std::remove_if(batches_in.begin(), batches_in.end(),
                                   [](std::shared_ptr<arrow::RecordBatch>& e) {
@@ -714,11 +1026,7 @@ boost::leaf::result<std::shared_ptr<arrow::Table>> ShufflePropertyEdgeTable(
 template <typename PARTITIONER_T>
 boost::leaf::result<std::shared_ptr<arrow::Table>> ShufflePropertyVertexTable(
     const grape::CommSpec& comm_spec, const PARTITIONER_T& partitioner,
-    std::shared_ptr<arrow::Table>& table_in) {
-  using oid_t = typename PARTITIONER_T::oid_t;
-  using internal_oid_t = typename InternalType<oid_t>::type;
-  using oid_array_type = typename ConvertToArrowType<oid_t>::ArrayType;
-
+    std::shared_ptr<arrow::Table>& table_in, ShuffleStats* stats = nullptr) {
   BOOST_LEAF_CHECK(SchemaConsistent(*table_in->schema(), comm_spec));
 
   std::vector<std::shared_ptr<arrow::RecordBatch>> record_batches;
@@ -730,41 +1038,35 @@ boost::leaf::result<std::shared_ptr<arrow::Table>> ShufflePropertyVertexTable(
   int thread_num =
       (std::thread::hardware_concurrency() + comm_spec.local_num() - 1) /
       comm_spec.local_num();
-  std::vector<std::thread> scan_threads(thread_num);
-  std::atomic<size_t> cur(0);
-
-  for (int i = 0; i < thread_num; ++i) {
-    scan_threads[i] = std::thread([&]() {
-      while (true) {
-        size_t got = cur.fetch_add(1);
-        if (got >= record_batch_num) {
-          break;
-        }
-
+  ThreadPool::Default().ParallelFor(
+      record_batch_num,
+      [&](size_t got) {
         auto& offset_list = offset_lists[got];
         offset_list.resize(comm_spec.fnum());
         auto cur_batch = record_batches[got];
         int64_t row_num = cur_batch->num_rows();
 
-        std::shared_ptr<oid_array_type> id_col =
-            std::dynamic_pointer_cast<oid_array_type>(cur_batch->column(0));
-
+        std::vector<grape::fid_t> fids;
+        partitioner.GetPartitionIds(cur_batch->column(0), fids);
         for (int64_t row_id = 0; row_id < row_num; ++row_id) {
-          internal_oid_t rs = id_col->GetView(row_id);
-          grape::fid_t fid = partitioner.GetPartitionId(oid_t(rs));
-          offset_list[fid].push_back(row_id);
+          offset_list[fids[row_id]].push_back(row_id);
         }
-      }
-    });
-  }
-  for (auto& thrd : scan_threads) {
-    thrd.join();
-  }
+      },
+      thread_num, 1);
 
   std::vector<std::shared_ptr<arrow::RecordBatch>> batches_in;
 
-  ShuffleTableByOffsetLists(table_in->schema(), record_batches, offset_lists,
-                            batches_in, comm_spec);
+  ShuffleStats shuffle_stats;
+  PipelinedShuffleTableByOffsetLists(table_in->schema(), record_batches,
+                                     offset_lists, batches_in, comm_spec,
+                                     &shuffle_stats);
+#if defined(WITH_PROFILING)
+  LOG(INFO) << "[worker-" << comm_spec.worker_id()
+            << "] Shuffle vertex table: " << shuffle_stats.ToString();
+#endif
+  if (stats != nullptr) {
+    *stats = shuffle_stats;
+  }
 
   batches_in.erase(std::remove_if(batches_in.begin(), batches_in.end(),
                                   [](std::shared_ptr<arrow::RecordBatch>& e) {
@@ -15,8 +15,14 @@ limitations under the License.
 
 #ifndef MODULES_GRAPH_UTILS_THREAD_GROUP_H_
 #define MODULES_GRAPH_UTILS_THREAD_GROUP_H_
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
 #include <future>
 #include <memory>
+#include <mutex>
 #include <queue>
 #include <thread>
 #include <unordered_map>
@@ -124,5 +130,186 @@ class ThreadGroup {
   std::queue<std::thread> finished_threads_;
   std::mutex mutex_;
 };
+
+/**
+ * @brief ThreadPool is a work-stealing thread pool that is shared by the
+ * parallel loops of the graph utilities, rather than spawning fresh threads
+ * for each of the loops.
+ *
+ * Each worker owns a deque of tasks: it takes tasks from the back of its own
+ * deque, and steals from the front of others' when it runs out of tasks.
+ *
+ * `ParallelFor` is safe to be nested, since the caller always executes the
+ * loop as well and never waits for the tasks that haven't been started.
+ */
+class ThreadPool {
+ public:
+  using task_t = std::function<void()>;
+
+  explicit ThreadPool(size_t parallelism = std::thread::hardware_concurrency())
+      : stopped_(false), pending_(0), next_(0) {
+    parallelism = std::max(parallelism, static_cast<size_t>(1));
+    for (size_t i = 0; i < parallelism; ++i) {
+      queues_.emplace_back(new queue_t());
+    }
+    for (size_t i = 0; i < parallelism; ++i) {
+      workers_.emplace_back([this, i]() { workerLoop(i); });
+    }
+  }
+
+  ~ThreadPool() {
+    {
+      std::lock_guard<std::mutex> lg(mutex_);
+      stopped_ = true;
+    }
+    cv_.notify_all();
+    for (auto& worker : workers_) {
+      worker.join();
+    }
+  }
+
+  /**
+   * @brief The pool that is shared in the process.
+   */
+  static ThreadPool& Default() {
+    static ThreadPool pool;
+    return pool;
+  }
+
+  size_t Parallelism() const { return workers_.size(); }
+
+  /**
+   * @brief Submits a task, the tasks that are submitted from the workers are
+   * pushed to their own deques.
+   */
+  void Submit(task_t task) {
+    size_t index = current_pool() == this
+                       ? current_index()
+                       : next_.fetch_add(1) % queues_.size();
+    {
+      std::lock_guard<std::mutex> lg(queues_[index]->mutex);
+      queues_[index]->tasks.emplace_back(std::move(task));
+    }
+    pending_.fetch_add(1);
+    {
+      std::lock_guard<std::mutex> lg(mutex_);
+    }
+    cv_.notify_one();
+  }
+
+  /**
+   * @brief Invokes `func(i)` for i in [0, num), with at most `concurrency`
+   * threads (including the caller) and dynamically scheduled `chunk`s.
+   *
+   * Returns after all the invocations finish.
+   */
+  template <typename FUNC_T>
+  void ParallelFor(size_t num, const FUNC_T& func, size_t concurrency = 0,
+                   size_t chunk = 0) {
+    if (num == 0) {
+      return;
+    }
+    if (concurrency == 0) {
+      concurrency = Parallelism() + 1;
+    }
+    size_t task_num = std::min({concurrency, Parallelism() + 1, num});
+    if (chunk == 0) {
+      chunk = (num + task_num - 1) / task_num;
+    }
+
+    // The helpers that start after the cursor is exhausted do nothing, so the
+    // caller only waits for the active ones.
+    struct loop_t {
+      std::atomic<size_t> cursor{0};
+      std::atomic<size_t> active{0};
+    };
+    auto loop = std::make_shared<loop_t>();
+    auto run = [loop, num, chunk, &func]() {
+      for (size_t begin = loop->cursor.fetch_add(chunk); begin < num;
+           begin = loop->cursor.fetch_add(chunk)) {
+        size_t end = std::min(begin + chunk, num);
+        for (size_t i = begin; i < end; ++i) {
+          func(i);
+        }
+      }
+    };
+    for (size_t i = 1; i < task_num; ++i) {
+      Submit([loop, run]() {
+        loop->active.fetch_add(1);
+        run();
+        loop->active.fetch_sub(1);
+      });
+    }
+    run();
+    while (loop->active.load() > 0) {
+      std::this_thread::yield();
+    }
+  }
+
+ private:
+  struct queue_t {
+    std::mutex mutex;
+    std::deque<task_t> tasks;
+  };
+
+  static ThreadPool*& current_pool() {
+    static thread_local ThreadPool* pool = nullptr;
+    return pool;
+  }
+
+  static size_t& current_index() {
+    static thread_local size_t index = 0;
+    return index;
+  }
+
+  bool takeTask(size_t index, task_t& task) {
+    {
+      auto& queue = *queues_[index];
+      std::lock_guard<std::mutex> lg(queue.mutex);
+      if (!queue.tasks.empty()) {
+        task = std::move(queue.tasks.back());
+        queue.tasks.pop_back();
+        return true;
+      }
+    }
+    for (size_t k = 1; k < queues_.size(); ++k) {
+      auto& queue = *queues_[(index + k) % queues_.size()];
+      std::lock_guard<std::mutex> lg(queue.mutex);
+      if (!queue.tasks.empty()) {
+        task = std::move(queue.tasks.front());
+        queue.tasks.pop_front();
+        return true;
+      }
+    }
+    return false;
+  }
+
+  void workerLoop(size_t index) {
+    current_pool() = this;
+    current_index() = index;
+    while (true) {
+      task_t task;
+      if (takeTask(index, task)) {
+        pending_.fetch_sub(1);
+        task();
+        continue;
+      }
+      std::unique_lock<std::mutex> lk(mutex_);
+      cv_.wait(lk, [this]() { return stopped_ || pending_.load() > 0; });
+      if (stopped_ && pending_.load() == 0) {
+        return;
+      }
+    }
+  }
+
+  bool stopped_;
+  std::atomic<size_t> pending_;
+  std::atomic<size_t> next_;
+  std::vector<std::unique_ptr<queue_t>> queues_;
+  std::vector<std::thread> workers_;
+  std::mutex mutex_;
+  std::condition_variable cv_;
+};
+
 }  // namespace vineyard
 #endif  // MODULES_GRAPH_UTILS_THREAD_GROUP_H_
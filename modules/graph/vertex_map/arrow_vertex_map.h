@@ -35,6 +35,7 @@ limitations under the License.
 #include "graph/fragment/property_graph_types.h"
 #include "graph/fragment/property_graph_utils.h"
 #include "graph/utils/thread_group.h"
+#include "graph/vertex_map/string_index.h"
 
 namespace gs {
 
@@ -208,31 +209,32 @@ class ArrowVertexMap
 
     int thread_num = std::min(
         static_cast<int>(std::thread::hardware_concurrency()), task_num);
-    std::atomic<int> task_id(0);
-    std::vector<std::thread> threads(thread_num);
-    for (int i = 0; i < thread_num; ++i) {
-      threads[i] = std::thread([&]() {
-        while (true) {
-          int got_task_id = task_id.fetch_add(1);
-          if (got_task_id >= task_num) {
-            break;
-          }
+    // the rest of the cores are used to build each of the hashmaps.
+    size_t concurrency =
+        std::max(1, static_cast<int>(std::thread::hardware_concurrency()) /
+                        std::max(1, thread_num));
+    auto pool_executor = [](size_t num,
+                            const std::function<void(size_t)>& func) {
+      ThreadPool::Default().ParallelFor(num, func, num, 1);
+    };
+    ThreadPool::Default().ParallelFor(
+        task_num,
+        [&](size_t got_task_id) {
           fid_t cur_fid = static_cast<fid_t>(got_task_id) % fnum_;
           auto cur_label =
               static_cast<label_id_t>(static_cast<fid_t>(got_task_id) / fnum_);
 
-          vineyard::HashmapBuilder<oid_t, vid_t> builder(client);
           auto array = oid_arrays[cur_label][cur_fid];
-          {
-            vid_t cur_gid =
-                id_parser_.GenerateId(cur_fid, label_num_ + cur_label, 0);
-            int64_t vnum = array->length();
-            // builder.reserve(static_cast<size_t>(vnum));
-            for (int64_t k = 0; k < vnum; ++k) {
-              builder.emplace(array->GetView(k), cur_gid);
-              ++cur_gid;
-            }
-          }
+          vid_t cur_gid =
+              id_parser_.GenerateId(cur_fid, label_num_ + cur_label, 0);
+          vineyard::ParallelHashmapBuilder<oid_t, vid_t> builder(
+              client, array->length(),
+              [&array, cur_gid](size_t k) {
+                return std::make_pair(array->GetView(k),
+                                      cur_gid + static_cast<vid_t>(k));
+              },
+              concurrency);
+          builder.set_executor(pool_executor);
 
           {
             typename InternalType<oid_t>::vineyard_builder_type array_builder(
@@ -245,12 +247,8 @@ class ArrowVertexMap
                 *std::dynamic_pointer_cast<vineyard::Hashmap<oid_t, vid_t>>(
                     builder.Seal(client));
           }
-        }
-      });
-    }
-    for (auto& thrd : threads) {
-      thrd.join();
-    }
+        },
+        thread_num, 1);
 
     vineyard::ObjectMeta old_meta, new_meta;
     VINEYARD_CHECK_OK(client.GetMetaData(this->id(), old_meta));
@@ -337,18 +335,34 @@ class ArrowVertexMap<arrow::util::string_view, VID_T>
 
     id_parser_.Init(fnum_, label_num_);
 
+    bool indexed = true;
     oid_arrays_.resize(fnum_);
+    o2i_.resize(fnum_);
     for (fid_t i = 0; i < fnum_; ++i) {
       oid_arrays_[i].resize(label_num_);
+      o2i_[i].resize(label_num_);
       for (label_id_t j = 0; j < label_num_; ++j) {
         typename InternalType<oid_t>::vineyard_array_type array;
         array.Construct(meta.GetMemberMeta("oid_arrays_" + std::to_string(i) +
                                            "_" + std::to_string(j)));
         oid_arrays_[i][j] = array.GetArray();
+
+        std::string index_name =
+            "o2i_" + std::to_string(i) + "_" + std::to_string(j);
+        if (meta.Haskey(index_name)) {
+          o2i_[i][j].Construct(meta.GetMemberMeta(index_name));
+        } else {
+          indexed = false;
+        }
       }
     }
 
-    initHashmaps();
+    if (indexed) {
+      initIndices();
+    } else {
+      // the vertex map is sealed without the index
+      initHashmaps();
+    }
   }
 
   bool GetOid(vid_t gid, oid_t& oid) const {
@@ -366,9 +380,17 @@ class ArrowVertexMap<arrow::util::string_view, VID_T>
   }
 
   bool GetGid(fid_t fid, label_id_t label_id, oid_t oid, vid_t& gid) const {
-    auto iter = o2g_[fid][label_id].find(oid);
-    if (iter != o2g_[fid][label_id].end()) {
-      gid = iter->second;
+    if (!o2g_.empty()) {
+      auto iter = o2g_[fid][label_id].find(oid);
+      if (iter != o2g_[fid][label_id].end()) {
+        gid = iter->second;
+        return true;
+      }
+      return false;
+    }
+    int64_t offset = indices_[fid][label_id].Find(oid);
+    if (offset != SealedStringIndex::kEmpty) {
+      gid = id_parser_.GenerateId(fid, label_id, offset);
       return true;
     }
     return false;
@@ -451,14 +473,17 @@ class ArrowVertexMap<arrow::util::string_view, VID_T>
 
     std::vector<std::vector<typename InternalType<oid_t>::vineyard_array_type>>
         vy_oid_arrays;
+    std::vector<std::vector<vineyard::Array<int64_t>>> vy_o2i;
     int total_label_num = label_num_ + extra_label_num;
     vy_oid_arrays.resize(fnum_);
+    vy_o2i.resize(fnum_);
     for (fid_t i = 0; i < fnum_; ++i) {
       vy_oid_arrays[i].resize(extra_label_num);
+      vy_o2i[i].resize(extra_label_num);
     }
 
     ThreadGroup tg;
-    auto builder_fn = [&client, &oid_arrays, &vy_oid_arrays](
+    auto builder_fn = [&client, &oid_arrays, &vy_oid_arrays, &vy_o2i](
                           fid_t const fid,
                           label_id_t const vlabel_id) -> Status {
       auto& array = oid_arrays[vlabel_id][fid];
@@ -467,6 +492,7 @@ class ArrowVertexMap<arrow::util::string_view, VID_T>
       vy_oid_arrays[fid][vlabel_id] = *std::dynamic_pointer_cast<
           typename InternalType<oid_t>::vineyard_array_type>(
           array_builder.Seal(client));
+      vy_o2i[fid][vlabel_id] = *BuildSealedStringIndex(client, *array);
       return Status::OK();
     };
 
@@ -490,14 +516,25 @@ class ArrowVertexMap<arrow::util::string_view, VID_T>
       for (label_id_t j = 0; j < total_label_num; ++j) {
         std::string array_name =
             "oid_arrays_" + std::to_string(i) + "_" + std::to_string(j);
+        std::string index_name =
+            "o2i_" + std::to_string(i) + "_" + std::to_string(j);
         if (j < label_num_) {
           auto array_meta = old_meta.GetMemberMeta(array_name);
           new_meta.AddMember(array_name, array_meta);
           nbytes += array_meta.GetNBytes();
+
+          if (old_meta.Haskey(index_name)) {
+            auto index_meta = old_meta.GetMemberMeta(index_name);
+            new_meta.AddMember(index_name, index_meta);
+            nbytes += index_meta.GetNBytes();
+          }
         } else {
           new_meta.AddMember(array_name,
                              vy_oid_arrays[i][j - label_num_].meta());
           nbytes += vy_oid_arrays[i][j - label_num_].nbytes();
+
+          new_meta.AddMember(index_name, vy_o2i[i][j - label_num_].meta());
+          nbytes += vy_o2i[i][j - label_num_].nbytes();
         }
       }
     }
@@ -508,6 +545,17 @@ class ArrowVertexMap<arrow::util::string_view, VID_T>
   }
 
  private:
+  void initIndices() {
+    indices_.resize(fnum_);
+    for (fid_t i = 0; i < fnum_; ++i) {
+      indices_[i].resize(label_num_);
+      for (label_id_t j = 0; j < label_num_; ++j) {
+        indices_[i][j] = SealedStringIndex(
+            o2i_[i][j].data(), o2i_[i][j].size(), oid_arrays_[i][j].get());
+      }
+    }
+  }
+
   void initHashmaps() {
     o2g_.resize(fnum_);
     for (fid_t i = 0; i < fnum_; ++i) {
@@ -534,6 +582,10 @@ class ArrowVertexMap<arrow::util::string_view, VID_T>
 
   // frag->label->oid
   std::vector<std::vector<std::shared_ptr<oid_array_t>>> oid_arrays_;
+  // frag->label->index of oid_arrays_, shared by all readers
+  std::vector<std::vector<vineyard::Array<int64_t>>> o2i_;
+  std::vector<std::vector<SealedStringIndex>> indices_;
+  // only for the vertex maps that are sealed without the index
   std::vector<std::vector<ska::flat_hash_map<oid_t, vid_t>>> o2g_;
 
   template <typename _OID_T, typename _VID_T>
@@ -649,8 +701,10 @@ class ArrowVertexMapBuilder<arrow::util::string_view, VID_T>
     fnum_ = fnum;
     label_num_ = label_num;
     oid_arrays_.resize(fnum_);
+    o2i_.resize(fnum_);
     for (fid_t i = 0; i < fnum_; ++i) {
       oid_arrays_[i].resize(label_num_);
+      o2i_[i].resize(label_num_);
     }
   }
 
@@ -660,6 +714,11 @@ class ArrowVertexMapBuilder<arrow::util::string_view, VID_T>
     oid_arrays_[fid][label] = array;
   }
 
+  void set_o2i(fid_t fid, label_id_t label,
+               const vineyard::Array<int64_t>& index) {
+    o2i_[fid][label] = index;
+  }
+
   std::shared_ptr<vineyard::Object> _Seal(vineyard::Client& client) {
     // ensure the builder hasn't been sealed yet.
     ENSURE_NOT_SEALED(this);
@@ -681,6 +740,9 @@ class ArrowVertexMapBuilder<arrow::util::string_view, VID_T>
       }
     }
 
+    vertex_map->o2i_ = o2i_;
+    vertex_map->initIndices();
+
     vertex_map->meta_.SetTypeName(type_name<ArrowVertexMap<oid_t, vid_t>>());
 
     vertex_map->meta_.AddKeyValue("fnum", fnum_);
@@ -693,6 +755,11 @@ class ArrowVertexMapBuilder<arrow::util::string_view, VID_T>
             "oid_arrays_" + std::to_string(i) + "_" + std::to_string(j),
             oid_arrays_[i][j].meta());
         nbytes += oid_arrays_[i][j].nbytes();
+
+        vertex_map->meta_.AddMember(
+            "o2i_" + std::to_string(i) + "_" + std::to_string(j),
+            o2i_[i][j].meta());
+        nbytes += o2i_[i][j].nbytes();
       }
     }
 
@@ -711,6 +778,7 @@ class ArrowVertexMapBuilder<arrow::util::string_view, VID_T>
 
   std::vector<std::vector<typename InternalType<oid_t>::vineyard_array_type>>
       oid_arrays_;
+  std::vector<std::vector<vineyard::Array<int64_t>>> o2i_;
 };
 
 template <typename OID_T, typename VID_T>
@@ -768,35 +836,36 @@ class BasicArrowVertexMapBuilder : public ArrowVertexMapBuilder<OID_T, VID_T> {
     int task_num = static_cast<int>(fnum_) * static_cast<int>(label_num_);
     int thread_num = std::min(
         static_cast<int>(std::thread::hardware_concurrency()), task_num);
-    std::atomic<int> task_id(0);
+    // the rest of the cores are used to build each of the hashmaps.
+    size_t concurrency =
+        std::max(1, static_cast<int>(std::thread::hardware_concurrency()) /
+                        std::max(1, thread_num));
+    auto pool_executor = [](size_t num,
+                            const std::function<void(size_t)>& func) {
+      ThreadPool::Default().ParallelFor(num, func, num, 1);
+    };
 
 #if defined(WITH_PROFILING)
     auto start_ts = GetCurrentTime();
 #endif
 
-    std::vector<std::thread> threads(thread_num);
-    for (int i = 0; i < thread_num; ++i) {
-      threads[i] = std::thread([&]() {
-        while (true) {
-          int got_task_id = task_id.fetch_add(1);
-          if (got_task_id >= task_num) {
-            break;
-          }
+    ThreadPool::Default().ParallelFor(
+        task_num,
+        [&](size_t got_task_id) {
           fid_t cur_fid = static_cast<fid_t>(got_task_id) % fnum_;
           label_id_t cur_label =
               static_cast<label_id_t>(static_cast<fid_t>(got_task_id) / fnum_);
 
-          vineyard::HashmapBuilder<oid_t, vid_t> builder(client);
           auto array = oid_arrays_[cur_label][cur_fid];
-          {
-            vid_t cur_gid = id_parser_.GenerateId(cur_fid, cur_label, 0);
-            int64_t vnum = array->length();
-            // builder.reserve(static_cast<size_t>(vnum));
-            for (int64_t k = 0; k < vnum; ++k) {
-              builder.emplace(array->GetView(k), cur_gid);
-              ++cur_gid;
-            }
-          }
+          vid_t cur_gid = id_parser_.GenerateId(cur_fid, cur_label, 0);
+          vineyard::ParallelHashmapBuilder<oid_t, vid_t> builder(
+              client, array->length(),
+              [&array, cur_gid](size_t k) {
+                return std::make_pair(array->GetView(k),
+                                      cur_gid + static_cast<vid_t>(k));
+              },
+              concurrency);
+          builder.set_executor(pool_executor);
 
           {
             typename InternalType<oid_t>::vineyard_builder_type array_builder(
@@ -811,12 +880,8 @@ class BasicArrowVertexMapBuilder : public ArrowVertexMapBuilder<OID_T, VID_T> {
                 *std::dynamic_pointer_cast<vineyard::Hashmap<oid_t, vid_t>>(
                     builder.Seal(client)));
           }
-        }
-      });
-    }
-    for (auto& thrd : threads) {
-      thrd.join();
-    }
+        },
+        thread_num, 1);
 
 #if defined(WITH_PROFILING)
     auto finish_seal_ts = GetCurrentTime();
@@ -873,6 +938,7 @@ class BasicArrowVertexMapBuilder<arrow::util::string_view, VID_T>
           *std::dynamic_pointer_cast<
               typename InternalType<oid_t>::vineyard_array_type>(
               array_builder.Seal(client)));
+      this->set_o2i(fid, vlabel_id, *BuildSealedStringIndex(client, *array));
       return Status::OK();
     };
 
@@ -0,0 +1,142 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef MODULES_GRAPH_VERTEX_MAP_STRING_INDEX_H_
+#define MODULES_GRAPH_VERTEX_MAP_STRING_INDEX_H_
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+
+#include "arrow/api.h"
+
+#include "basic/ds/array.h"
+#include "client/client.h"
+
+namespace vineyard {
+
+/**
+ * @brief SealedStringIndex is an immutable hash index over the strings of an
+ * arrow::LargeStringArray.
+ *
+ * The index is an open-addressing (linear probing) table whose slots hold the
+ * offsets of the strings in the array, or kEmpty. It contains no pointers and
+ * is built once into a vineyard blob when the owner is sealed, thus every
+ * reader can look up the strings in place, without rebuilding any hash table.
+ */
+class SealedStringIndex {
+ public:
+  static constexpr int64_t kEmpty = -1;
+
+  SealedStringIndex() {}
+
+  SealedStringIndex(const int64_t* slots, size_t capacity,
+                    const arrow::LargeStringArray* array)
+      : slots_(slots), mask_(capacity - 1), array_(array) {}
+
+  /**
+   * @brief The number of slots that is required to index `num` strings, a
+   * power of two that keeps the load factor no more than 0.5.
+   */
+  static size_t Capacity(int64_t num) {
+    size_t capacity = 1;
+    while (capacity < static_cast<size_t>(num) * 2) {
+      capacity <<= 1;
+    }
+    return capacity;
+  }
+
+  /**
+   * @brief Fills the `capacity` slots with the offsets of the strings in the
+   * array. The first one wins when there are duplicated strings.
+   */
+  static void Build(const arrow::LargeStringArray& array, int64_t* slots,
+                    size_t capacity) {
+    std::fill_n(slots, capacity, kEmpty);
+    SealedStringIndex index(slots, capacity, &array);
+    for (int64_t k = 0; k < array.length(); ++k) {
+      size_t slot = index.probe(array.GetView(k));
+      if (slots[slot] == kEmpty) {
+        slots[slot] = k;
+      }
+    }
+  }
+
+  /**
+   * @brief Returns the offset of the string in the array, or kEmpty if it
+   * doesn't exist.
+   */
+  int64_t Find(arrow::util::string_view key) const {
+    return slots_ == nullptr ? kEmpty : slots_[probe(key)];
+  }
+
+  /**
+   * @brief The hash function for the strings. It must be stable across
+   * processes as the index is shared by them.
+   */
+  static uint64_t Hash(const char* data, size_t size) {
+    uint64_t hash = 0x9e3779b97f4a7c15ULL ^ size;
+    uint64_t word;
+    for (; size >= sizeof(word); data += sizeof(word), size -= sizeof(word)) {
+      memcpy(&word, data, sizeof(word));
+      hash = (hash ^ mix(word)) * 0xff51afd7ed558ccdULL;
+    }
+    word = 0;
+    memcpy(&word, data, size);
+    return mix(hash ^ word);
+  }
+
+ private:
+  // The slot that either holds the key or is the empty one that ends the
+  // probing sequence.
+  size_t probe(arrow::util::string_view key) const {
+    size_t slot = Hash(key.data(), key.size()) & mask_;
+    while (slots_[slot] != kEmpty && array_->GetView(slots_[slot]) != key) {
+      slot = (slot + 1) & mask_;
+    }
+    return slot;
+  }
+
+  // The finalizer of MurmurHash3.
+  static uint64_t mix(uint64_t value) {
+    value ^= value >> 33;
+    value *= 0xff51afd7ed558ccdULL;
+    value ^= value >> 33;
+    value *= 0xc4ceb9fe1a85ec53ULL;
+    value ^= value >> 33;
+    return value;
+  }
+
+  const int64_t* slots_ = nullptr;
+  size_t mask_ = 0;
+  const arrow::LargeStringArray* array_ = nullptr;
+};
+
+/**
+ * @brief Builds the SealedStringIndex of the array into a vineyard array, the
+ * slots are written into the blob directly.
+ */
+inline std::shared_ptr<Array<int64_t>> BuildSealedStringIndex(
+    Client& client, const arrow::LargeStringArray& array) {
+  ArrayBuilder<int64_t> builder(client,
+                                SealedStringIndex::Capacity(array.length()));
+  SealedStringIndex::Build(array, builder.data(), builder.size());
+  return std::dynamic_pointer_cast<Array<int64_t>>(builder.Seal(client));
+}
+
+}  // namespace vineyard
+
+#endif  // MODULES_GRAPH_VERTEX_MAP_STRING_INDEX_H_
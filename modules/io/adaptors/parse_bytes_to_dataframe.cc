@@ -41,19 +41,13 @@ Status ParseTable(std::shared_ptr<arrow::Table>* table,
                   std::vector<std::string> column_types,
                   std::vector<std::string> original_columns,
                   bool include_all_columns) {
-  // FIXME IF NO NEED TO COPY
-  std::shared_ptr<arrow::Buffer> copied_buffer;
-#if defined(ARROW_VERSION) && ARROW_VERSION < 17000
-  CHECK_ARROW_ERROR(buffer->Copy(0, buffer->size(), &copied_buffer));
-#else
-  CHECK_ARROW_ERROR_AND_ASSIGN(copied_buffer,
-                               buffer->CopySlice(0, buffer->size()));
-#endif
-  auto buffer_reader = std::make_shared<arrow::io::BufferReader>(copied_buffer);
+  // The chunk is parsed in place: the parsed table is written to the output
+  // stream before the next chunk is pulled, i.e., while the chunk is alive.
+  std::shared_ptr<arrow::Buffer> chunk = std::move(buffer);
+  auto buffer_reader = std::make_shared<arrow::io::BufferReader>(chunk);
 
   std::shared_ptr<arrow::io::InputStream> input =
-      arrow::io::RandomAccessFile::GetStream(buffer_reader, 0,
-                                             copied_buffer->size());
+      arrow::io::RandomAccessFile::GetStream(buffer_reader, 0, chunk->size());
 
   arrow::MemoryPool* pool = arrow::default_memory_pool();
 
@@ -58,14 +58,26 @@ int main(int argc, char** argv) {
   CHECK_AND_REPORT(bstream->OpenWriter(client, writer));
   writer->SetBufferSizeLimit(2 * 1024 * 1024);
 
-  std::string line;
+  // gather the messages into blocks of lines
+  constexpr size_t block_size = 2 * 1024 * 1024;
+  std::string line, block;
+  block.reserve(block_size);
   while (kafka_io_adaptor->ReadLine(line).ok()) {
-    auto st = writer->WriteLine(line + "\n");
-    if (!st.ok()) {
-      ReportStatus("error", st.ToString());
-      CHECK_AND_REPORT(st);
+    block.append(line);
+    block.push_back('\n');
+    if (block.size() >= block_size) {
+      auto st = writer->WriteBlock(block.data(), block.size());
+      if (!st.ok()) {
+        ReportStatus("error", st.ToString());
+        CHECK_AND_REPORT(st);
+      }
+      block.clear();
     }
   }
+  {
+    auto st = writer->WriteBlock(block.data(), block.size());
+    CHECK_AND_REPORT(st);
+  }
 
   CHECK_AND_REPORT(writer->Finish());
   ReportStatus("exit", "");
@@ -13,7 +13,9 @@ See the License for the specific language governing permissions and
 limitations under the License.
 */
 
+#include <algorithm>
 #include <string>
+#include <vector>
 
 #include "arrow/table.h"
 #include "basic/stream/byte_stream.h"
@@ -21,6 +23,7 @@ limitations under the License.
 #include "client/client.h"
 #include "io/io/i_io_adaptor.h"
 #include "io/io/io_factory.h"
+#include "io/io/local_io_adaptor.h"
 
 #include "io/io/utils.h"
 
@@ -64,13 +67,28 @@ int main(int argc, const char** argv) {
   CHECK_AND_REPORT(lstream->OpenWriter(client, writer));
   writer->SetBufferSizeLimit(2 * 1024 * 1024);
 
-  std::string line;
-  while (local_io_adaptor->ReadLine(line).ok()) {
-    auto st = writer->WriteLine(line);
+  auto local_file_adaptor =
+      dynamic_cast<LocalIOAdaptor*>(local_io_adaptor.get());
+  if (local_file_adaptor == nullptr) {
+    CHECK_AND_REPORT(Status::Invalid("Not a local file: " + efile));
+  }
+  int64_t offset = 0, nbytes = 0;
+  CHECK_AND_REPORT(local_file_adaptor->GetPartialReadDetail(offset, nbytes));
+
+  // read the part of file block by block, the writer cuts the chunks at line
+  // breaks.
+  std::vector<char> block(2 * 1024 * 1024);
+  while (nbytes > 0) {
+    size_t size = std::min<int64_t>(nbytes, block.size());
+    auto st = local_io_adaptor->Read(block.data(), size);
+    if (st.ok()) {
+      st = writer->WriteBlock(block.data(), size);
+    }
     if (!st.ok()) {
       ReportStatus("error", st.ToString());
       CHECK_AND_REPORT(st);
     }
+    nbytes -= size;
   }
 
   {
@@ -347,6 +347,18 @@ void bind_client(py::module& mod) {
       .def_property_readonly(
           "memory_limit",
           [](InstanceStatus* status) { return status->memory_limit; })
+      .def_property_readonly(
+          "slab_usage",
+          [](InstanceStatus* status) { return status->slab_usage; })
+      .def_property_readonly(
+          "slab_fragmentation",
+          [](InstanceStatus* status) { return status->slab_fragmentation; })
+      .def_property_readonly(
+          "spill_count",
+          [](InstanceStatus* status) { return status->spill_count; })
+      .def_property_readonly(
+          "reload_count",
+          [](InstanceStatus* status) { return status->reload_count; })
       .def_property_readonly(
           "deferred_requests",
           [](InstanceStatus* status) { return status->deferred_requests; })
@@ -356,6 +368,10 @@ void bind_client(py::module& mod) {
       .def_property_readonly(
           "rpc_connections",
           [](InstanceStatus* status) { return status->rpc_connections; })
+      .def_property_readonly("streams",
+                             [](InstanceStatus* status) {
+                               return detail::from_json(status->streams);
+                             })
       .def("__repr__",
            [](InstanceStatus* status) {
              std::stringstream ss;
@@ -367,6 +383,14 @@ void bind_client(py::module& mod) {
                 << std::endl;
              ss << "    memory_limit: " << status->memory_limit << ","
                 << std::endl;
+             ss << "    slab_usage: " << status->slab_usage << ","
+                << std::endl;
+             ss << "    slab_fragmentation: " << status->slab_fragmentation
+                << "," << std::endl;
+             ss << "    spill_count: " << status->spill_count << ","
+                << std::endl;
+             ss << "    reload_count: " << status->reload_count << ","
+                << std::endl;
              ss << "    deferred_requests: " << status->deferred_requests << ","
                 << std::endl;
              ss << "    ipc_connections: " << status->ipc_connections << ","
@@ -383,6 +407,11 @@ void bind_client(py::module& mod) {
         ss << "    deployment: " << status->deployment << std::endl;
         ss << "    memory_usage: " << status->memory_usage << std::endl;
         ss << "    memory_limit: " << status->memory_limit << std::endl;
+        ss << "    slab_usage: " << status->slab_usage << std::endl;
+        ss << "    slab_fragmentation: " << status->slab_fragmentation
+           << std::endl;
+        ss << "    spill_count: " << status->spill_count << std::endl;
+        ss << "    reload_count: " << status->reload_count << std::endl;
         ss << "    deferred_requests: " << status->deferred_requests
            << std::endl;
         ss << "    ipc_connections: " << status->ipc_connections << std::endl;
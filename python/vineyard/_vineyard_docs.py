@@ -857,6 +857,10 @@ the instance identity, memory statistics and workloads on this instance.
         deployment: local
         memory_usage: 360
         memory_limit: 268435456
+        slab_usage: 0
+        slab_fragmentation: 0
+        spill_count: 0
+        reload_count: 0
         deferred_requests: 0
         ipc_connections: 1
         rpc_connections: 0
@@ -894,6 +898,25 @@ add_doc(InstanceStatus.memory_limit, r'''
 Report memory limit (in bytes) of current vineyardd instance.
 ''')
 
+add_doc(InstanceStatus.slab_usage, r'''
+Report memory (in bytes) held by the slabs of tiny blobs on current vineyardd instance.
+''')
+
+add_doc(InstanceStatus.slab_fragmentation, r'''
+Report the internal fragmentation of the slabs of tiny blobs on current vineyardd
+instance, i.e., the fraction of slab slots that are not requested by blobs.
+''')
+
+add_doc(InstanceStatus.spill_count, r'''
+Report number of blobs that have been spilled to disk under memory pressure on current
+vineyardd instance.
+''')
+
+add_doc(InstanceStatus.reload_count, r'''
+Report number of spilled blobs that have been reloaded into shared memory on current
+vineyardd instance.
+''')
+
 add_doc(InstanceStatus.deferred_requests, r'''
 Report number of waiting requests of current vineyardd instance.
 ''')
@@ -906,6 +929,13 @@ add_doc(InstanceStatus.rpc_connections, r'''
 Report number of alive RPC connections on the current vineyardd instance.
 ''')
 
+add_doc(InstanceStatus.streams, r'''
+Report the buffering of each stream on the current vineyardd instance, as a dict keyed
+by the stream id. Each entry contains the queue depth (the number of sealed chunks that
+the slowest consumer hasn't read), the chunks and bytes held by the stream, and its
+:code:`max_chunks` and :code:`max_bytes` capacity limits.
+''')
+
 add_doc(Blob, r'''
 :class:`Blob` in vineyard is a consecutive readonly shared memory.
 ''')
@@ -174,6 +174,26 @@ def vineyard_argument_parser():
                           action='append_const',
                           const='memory_limit',
                           help='Memory limit (in bytes) of current vineyardd instance')
+    stat_opt.add_argument('--slab_usage',
+                          dest='properties',
+                          action='append_const',
+                          const='slab_usage',
+                          help='Memory (in bytes) held by the slabs of tiny blobs on current vineyardd instance')
+    stat_opt.add_argument('--slab_fragmentation',
+                          dest='properties',
+                          action='append_const',
+                          const='slab_fragmentation',
+                          help='Internal fragmentation of the slabs of tiny blobs on current vineyardd instance')
+    stat_opt.add_argument('--spill_count',
+                          dest='properties',
+                          action='append_const',
+                          const='spill_count',
+                          help='Number of blobs spilled to disk on current vineyardd instance')
+    stat_opt.add_argument('--reload_count',
+                          dest='properties',
+                          action='append_const',
+                          const='reload_count',
+                          help='Number of spilled blobs reloaded into shared memory on current vineyardd instance')
     stat_opt.add_argument('--deferred_requests',
                           dest='properties',
                           action='append_const',
@@ -189,6 +209,11 @@ def vineyard_argument_parser():
                           action='append_const',
                           const='rpc_connections',
                           help='Number of alive RPC connections on the current vineyardd instance')
+    stat_opt.add_argument('--streams',
+                          dest='properties',
+                          action='append_const',
+                          const='streams',
+                          help='Queue depth, held chunks and bytes, and capacity of each stream on the current vineyardd instance')
 
     put_opt = cmd_parser.add_parser('put',
                                     formatter_class=argparse.RawDescriptionHelpFormatter,
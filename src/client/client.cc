@@ -19,6 +19,7 @@ limitations under the License.
 
 #include <limits>
 #include <map>
+#include <future>
 #include <mutex>
 #include <set>
 #include <unordered_map>
@@ -31,6 +32,7 @@ limitations under the License.
 #include "client/utils.h"
 #include "common/memory/fling.h"
 #include "common/util/boost.h"
+#include "common/util/env.h"
 #include "common/util/protocols.h"
 
 namespace vineyard {
@@ -104,17 +106,25 @@ Status Client::Connect(const std::string& ipc_socket) {
   }
   ipc_socket_ = ipc_socket;
   RETURN_ON_ERROR(connect_ipc_socket_retry(ipc_socket, vineyard_conn_));
+  // The binary encoding can be turned off by `VINEYARD_IPC_PROTOCOL=json`.
+  bool binary_protocol = read_env("VINEYARD_IPC_PROTOCOL") != "json";
+  // The pipelining can be turned off by `VINEYARD_IPC_PIPELINE=false`.
+  bool pipelined = read_env("VINEYARD_IPC_PIPELINE") != "false";
   std::string message_out;
-  WriteRegisterRequest(message_out);
+  WriteRegisterRequest(binary_protocol, pipelined, message_out);
   RETURN_ON_ERROR(doWrite(message_out));
   json message_in;
   RETURN_ON_ERROR(doRead(message_in));
   std::string ipc_socket_value, rpc_endpoint_value;
-  RETURN_ON_ERROR(ReadRegisterReply(message_in, ipc_socket_value,
-                                    rpc_endpoint_value, instance_id_,
-                                    server_version_));
+  RETURN_ON_ERROR(ReadRegisterReply(
+      message_in, ipc_socket_value, rpc_endpoint_value, instance_id_,
+      server_version_, binary_protocol, pipelined));
   rpc_endpoint_ = rpc_endpoint_value;
+  binary_protocol_ = binary_protocol;
   connected_ = true;
+  if (pipelined) {
+    startPipeline();
+  }
 
   if (!compatible_server(server_version_)) {
     LOG(ERROR) << "Warning: this version of vineyard client may be "
@@ -159,6 +169,40 @@ Status Client::GetMetaData(const ObjectID id, ObjectMeta& meta,
   return Status::OK();
 }
 
+Status Client::GetMetaDataLazily(const ObjectID id, ObjectMeta& meta,
+                                 const bool sync_remote) {
+  ENSURE_CONNECTED(this);
+  json tree;
+  RETURN_ON_ERROR(GetData(id, tree, sync_remote));
+  meta.Reset();
+  meta.SetMetaData(this, tree);
+  return Status::OK();
+}
+
+Status Client::FetchBuffers(ObjectMeta& meta) {
+  ENSURE_CONNECTED(this);
+  std::set<ObjectID> blob_ids;
+  for (auto const& item : meta.GetBufferSet()->AllBuffers()) {
+    if (item.second == nullptr) {
+      blob_ids.emplace(item.first);
+    }
+  }
+  if (blob_ids.empty()) {
+    return Status::OK();
+  }
+
+  std::map<ObjectID, std::shared_ptr<arrow::Buffer>> buffers;
+  RETURN_ON_ERROR(GetBuffers(blob_ids, buffers));
+
+  for (auto const& id : blob_ids) {
+    const auto& buffer = buffers.find(id);
+    if (buffer != buffers.end()) {
+      meta.SetBuffer(id, buffer->second);
+    }
+  }
+  return Status::OK();
+}
+
 Status Client::GetMetaData(const std::vector<ObjectID>& ids,
                            std::vector<ObjectMeta>& metas,
                            const bool sync_remote) {
@@ -190,6 +234,100 @@ Status Client::GetMetaData(const std::vector<ObjectID>& ids,
   return Status::OK();
 }
 
+std::future<Status> Client::GetMetaDataAsync(const ObjectID id,
+                                             ObjectMeta& meta,
+                                             const bool sync_remote) {
+  auto promise = std::make_shared<std::promise<Status>>();
+  auto future = promise->get_future();
+  if (!connected_) {
+    promise->set_value(Status::ConnectionError("Client is not connected"));
+    return future;
+  }
+  std::string message_out;
+  WriteGetDataRequest(id, sync_remote, false, message_out);
+  doRequestAsync(message_out, [this, promise, &meta](
+                                  const Status& status,
+                                  std::string&& message_in) {
+    json tree;
+    Status s = status;
+    if (s.ok()) {
+      s = CATCH_JSON_ERROR(ReadGetDataReply(json::parse(message_in), tree));
+    }
+    if (!s.ok()) {
+      promise->set_value(s);
+      return Status::OK();
+    }
+    meta.Reset();
+    meta.SetMetaData(this, tree);
+    getBuffersAsync(
+        meta.GetBufferSet()->AllBufferIds(),
+        [promise, &meta](
+            const Status& status,
+            std::map<ObjectID, std::shared_ptr<arrow::Buffer>>&& buffers) {
+          for (auto const& item : buffers) {
+            meta.SetBuffer(item.first, item.second);
+          }
+          promise->set_value(status);
+          return Status::OK();
+        });
+    return Status::OK();
+  });
+  return future;
+}
+
+std::future<Status> Client::GetMetaDataAsync(const std::vector<ObjectID>& ids,
+                                             std::vector<ObjectMeta>& metas,
+                                             const bool sync_remote) {
+  auto promise = std::make_shared<std::promise<Status>>();
+  auto future = promise->get_future();
+  if (!connected_) {
+    promise->set_value(Status::ConnectionError("Client is not connected"));
+    return future;
+  }
+  std::string message_out;
+  WriteGetDataRequest(ids, sync_remote, false, message_out);
+  doRequestAsync(message_out, [this, promise, ids, &metas](
+                                  const Status& status,
+                                  std::string&& message_in) {
+    std::unordered_map<ObjectID, json> trees;
+    Status s = status;
+    if (s.ok()) {
+      s = CATCH_JSON_ERROR(ReadGetDataReply(json::parse(message_in), trees));
+    }
+    if (!s.ok()) {
+      promise->set_value(s);
+      return Status::OK();
+    }
+    std::set<ObjectID> blob_ids;
+    metas.resize(ids.size());
+    for (size_t idx = 0; idx < ids.size(); ++idx) {
+      metas[idx].Reset();
+      metas[idx].SetMetaData(this, trees.at(ids[idx]));
+      for (const auto& id : metas[idx].GetBufferSet()->AllBufferIds()) {
+        blob_ids.emplace(id);
+      }
+    }
+    getBuffersAsync(
+        blob_ids,
+        [promise, &metas](
+            const Status& status,
+            std::map<ObjectID, std::shared_ptr<arrow::Buffer>>&& buffers) {
+          for (auto& meta : metas) {
+            for (auto const id : meta.GetBufferSet()->AllBufferIds()) {
+              const auto& buffer = buffers.find(id);
+              if (buffer != buffers.end()) {
+                meta.SetBuffer(id, buffer->second);
+              }
+            }
+          }
+          promise->set_value(status);
+          return Status::OK();
+        });
+    return Status::OK();
+  });
+  return future;
+}
+
 Status Client::CreateBlob(size_t size, std::unique_ptr<BlobWriter>& blob) {
   ENSURE_CONNECTED(this);
 
@@ -201,10 +339,29 @@ Status Client::CreateBlob(size_t size, std::unique_ptr<BlobWriter>& blob) {
   return Status::OK();
 }
 
+Status Client::CreateBlobs(const std::vector<size_t>& sizes,
+                           std::vector<std::unique_ptr<BlobWriter>>& blobs) {
+  ENSURE_CONNECTED(this);
+
+  std::vector<ObjectID> object_ids;
+  std::vector<Payload> objects;
+  std::vector<std::shared_ptr<arrow::MutableBuffer>> buffers;
+  RETURN_ON_ERROR(CreateBuffers(sizes, object_ids, objects, buffers));
+  for (size_t idx = 0; idx < sizes.size(); ++idx) {
+    blobs.emplace_back(
+        new BlobWriter(object_ids[idx], objects[idx], buffers[idx]));
+  }
+  return Status::OK();
+}
+
 Status Client::CreateStream(const ObjectID& id) {
+  return CreateStream(id, StreamOptions{});
+}
+
+Status Client::CreateStream(const ObjectID& id, const StreamOptions& options) {
   ENSURE_CONNECTED(this);
   std::string message_out;
-  WriteCreateStreamRequest(id, message_out);
+  WriteCreateStreamRequest(id, options, message_out);
   RETURN_ON_ERROR(doWrite(message_out));
   json message_in;
   RETURN_ON_ERROR(doRead(message_in));
@@ -213,9 +370,15 @@ Status Client::CreateStream(const ObjectID& id) {
 }
 
 Status Client::OpenStream(const ObjectID& id, OpenStreamMode mode) {
+  return OpenStream(id, mode, 0);
+}
+
+Status Client::OpenStream(const ObjectID& id, OpenStreamMode mode,
+                          size_t const retain_window) {
   ENSURE_CONNECTED(this);
   std::string message_out;
-  WriteOpenStreamRequest(id, static_cast<int64_t>(mode), message_out);
+  WriteOpenStreamRequest(id, static_cast<int64_t>(mode), retain_window,
+                         message_out);
   RETURN_ON_ERROR(doWrite(message_out));
   json message_in;
   RETURN_ON_ERROR(doRead(message_in));
@@ -227,9 +390,13 @@ Status Client::GetNextStreamChunk(ObjectID const id, size_t const size,
                                   std::unique_ptr<arrow::MutableBuffer>& blob) {
   ENSURE_CONNECTED(this);
   std::string message_out;
-  WriteGetNextStreamChunkRequest(id, size, message_out);
+  if (binary_protocol_) {
+    WriteGetNextStreamChunkRequestBinary(id, size, message_out);
+  } else {
+    WriteGetNextStreamChunkRequest(id, size, message_out);
+  }
   RETURN_ON_ERROR(doWrite(message_out));
-  json message_in;
+  std::string message_in;
   RETURN_ON_ERROR(doRead(message_in));
   Payload object;
   RETURN_ON_ERROR(ReadGetNextStreamChunkReply(message_in, object));
@@ -247,21 +414,99 @@ Status Client::GetNextStreamChunk(ObjectID const id, size_t const size,
 
 Status Client::PullNextStreamChunk(ObjectID const id,
                                    std::unique_ptr<arrow::Buffer>& blob) {
+  Payload object;
+  uint64_t sequence = 0;
+  uint8_t* data = nullptr;
+  RETURN_ON_ERROR(pullNextStreamChunk(id, object, sequence, data));
+  blob.reset(new arrow::Buffer(data, object.data_size));
+  return Status::OK();
+}
+
+Status Client::pullNextStreamChunk(ObjectID const id, Payload& object,
+                                   uint64_t& sequence, uint8_t*& data) {
   ENSURE_CONNECTED(this);
   std::string message_out;
-  WritePullNextStreamChunkRequest(id, message_out);
+  if (binary_protocol_) {
+    WritePullNextStreamChunkRequestBinary(id, message_out);
+  } else {
+    WritePullNextStreamChunkRequest(id, message_out);
+  }
   RETURN_ON_ERROR(doWrite(message_out));
-  json message_in;
+  std::string message_in;
   RETURN_ON_ERROR(doRead(message_in));
-  Payload object;
-  RETURN_ON_ERROR(ReadPullNextStreamChunkReply(message_in, object));
-  uint8_t *mmapped_ptr = nullptr, *dist = nullptr;
+  RETURN_ON_ERROR(ReadPullNextStreamChunkReply(message_in, object, sequence));
+  uint8_t* mmapped_ptr = nullptr;
+  data = nullptr;
   if (object.data_size > 0) {
     RETURN_ON_ERROR(mmapToClient(object.store_fd, object.map_size, true, true,
                                  &mmapped_ptr));
-    dist = mmapped_ptr + object.data_offset;
+    data = mmapped_ptr + object.data_offset;
+  }
+  return Status::OK();
+}
+
+namespace detail {
+
+/**
+ * @brief The chunk of a stream that is consumed in place, the chunk is queued
+ * to be released when the buffer is destroyed.
+ */
+template <typename RELEASED_T>
+class StreamChunkBuffer : public arrow::Buffer {
+ public:
+  StreamChunkBuffer(const uint8_t* data, int64_t size,
+                    std::shared_ptr<RELEASED_T> const& released,
+                    ObjectID const stream_id, ObjectID const chunk_id,
+                    uint64_t const sequence)
+      : arrow::Buffer(data, size),
+        released_(released),
+        stream_id_(stream_id),
+        chunk_id_(chunk_id),
+        sequence_(sequence) {}
+
+  ~StreamChunkBuffer() override {
+    std::lock_guard<std::mutex> guard(released_->mutex);
+    released_->chunks.emplace_back(stream_id_, chunk_id_, sequence_);
+  }
+
+ private:
+  std::shared_ptr<RELEASED_T> released_;
+  ObjectID stream_id_, chunk_id_;
+  // tells the handouts of the same chunk apart, as the chunks are reused.
+  uint64_t sequence_;
+};
+
+}  // namespace detail
+
+Status Client::PullNextStreamChunk(ObjectID const id,
+                                   std::shared_ptr<arrow::Buffer>& blob) {
+  RETURN_ON_ERROR(ReleaseStreamChunks());
+  Payload object;
+  uint64_t sequence = 0;
+  uint8_t* data = nullptr;
+  RETURN_ON_ERROR(pullNextStreamChunk(id, object, sequence, data));
+  blob = std::make_shared<detail::StreamChunkBuffer<ReleasedStreamChunks>>(
+      data, object.data_size, released_stream_chunks_, id, object.object_id,
+      sequence);
+  return Status::OK();
+}
+
+Status Client::ReleaseStreamChunks() {
+  std::vector<std::tuple<ObjectID, ObjectID, uint64_t>> chunks;
+  {
+    std::lock_guard<std::mutex> guard(released_stream_chunks_->mutex);
+    std::swap(chunks, released_stream_chunks_->chunks);
+  }
+  if (chunks.empty()) {
+    return Status::OK();
   }
-  blob.reset(new arrow::Buffer(dist, object.data_size));
+  ENSURE_CONNECTED(this);
+  std::string message_out;
+  WriteReleaseStreamChunksRequest(chunks, message_out);
+  RETURN_ON_ERROR(doWrite(message_out));
+  json message_in;
+  RETURN_ON_ERROR(doRead(message_in));
+  RETURN_ON_ERROR(ReadReleaseStreamChunksReply(message_in));
   return Status::OK();
 }
 
@@ -416,9 +661,13 @@ Status Client::CreateBuffer(const size_t size, ObjectID& id, Payload& payload,
                             std::shared_ptr<arrow::MutableBuffer>& buffer) {
   ENSURE_CONNECTED(this);
   std::string message_out;
-  WriteCreateBufferRequest(size, message_out);
+  if (binary_protocol_) {
+    WriteCreateBufferRequestBinary(size, message_out);
+  } else {
+    WriteCreateBufferRequest(size, message_out);
+  }
   RETURN_ON_ERROR(doWrite(message_out));
-  json message_in;
+  std::string message_in;
   RETURN_ON_ERROR(doRead(message_in));
   RETURN_ON_ERROR(ReadCreateBufferReply(message_in, id, payload));
   RETURN_ON_ASSERT(static_cast<size_t>(payload.data_size) == size);
@@ -433,6 +682,45 @@ Status Client::CreateBuffer(const size_t size, ObjectID& id, Payload& payload,
   return Status::OK();
 }
 
+Status Client::CreateBuffers(
+    const std::vector<size_t>& sizes, std::vector<ObjectID>& ids,
+    std::vector<Payload>& payloads,
+    std::vector<std::shared_ptr<arrow::MutableBuffer>>& buffers) {
+  if (sizes.empty()) {
+    return Status::OK();
+  }
+  ENSURE_CONNECTED(this);
+  std::string message_out;
+  if (binary_protocol_) {
+    WriteCreateBuffersRequestBinary(sizes, message_out);
+  } else {
+    WriteCreateBuffersRequest(sizes, message_out);
+  }
+  RETURN_ON_ERROR(doWrite(message_out));
+  std::string message_in;
+  RETURN_ON_ERROR(doRead(message_in));
+  std::vector<Payload> created;
+  RETURN_ON_ERROR(ReadCreateBuffersReply(message_in, created));
+  RETURN_ON_ASSERT(created.size() == sizes.size());
+
+  // the fds are received in the order of payloads, see also `GetBuffers`.
+  for (size_t idx = 0; idx < created.size(); ++idx) {
+    auto const& payload = created[idx];
+    RETURN_ON_ASSERT(static_cast<size_t>(payload.data_size) == sizes[idx]);
+    uint8_t *shared = nullptr, *dist = nullptr;
+    if (payload.data_size > 0) {
+      RETURN_ON_ERROR(mmapToClient(payload.store_fd, payload.map_size, false,
+                                   true, &shared));
+      dist = shared + payload.data_offset;
+    }
+    ids.emplace_back(payload.object_id);
+    buffers.emplace_back(
+        std::make_shared<arrow::MutableBuffer>(dist, payload.data_size));
+    payloads.emplace_back(payload);
+  }
+  return Status::OK();
+}
+
 Status Client::GetBuffer(const ObjectID id,
                          std::shared_ptr<arrow::Buffer>& buffer) {
   std::map<ObjectID, std::shared_ptr<arrow::Buffer>> buffers;
@@ -453,9 +741,13 @@ Status Client::GetBuffers(
   }
   ENSURE_CONNECTED(this);
   std::string message_out;
-  WriteGetBuffersRequest(ids, message_out);
+  if (binary_protocol_) {
+    WriteGetBuffersRequestBinary(ids, message_out);
+  } else {
+    WriteGetBuffersRequest(ids, message_out);
+  }
   RETURN_ON_ERROR(doWrite(message_out));
-  json message_in;
+  std::string message_in;
   RETURN_ON_ERROR(doRead(message_in));
   std::vector<Payload> payloads;
   RETURN_ON_ERROR(ReadGetBuffersReply(message_in, payloads));
@@ -473,6 +765,44 @@ Status Client::GetBuffers(
   return Status::OK();
 }
 
+void Client::getBuffersAsync(
+    const std::set<ObjectID>& ids,
+    callback_t<std::map<ObjectID, std::shared_ptr<arrow::Buffer>>&&>
+        callback) {
+  if (ids.empty()) {
+    VINEYARD_DISCARD(callback(Status::OK(), {}));
+    return;
+  }
+  std::string message_out;
+  if (binary_protocol_) {
+    WriteGetBuffersRequestBinary(ids, message_out);
+  } else {
+    WriteGetBuffersRequest(ids, message_out);
+  }
+  doRequestAsync(message_out, [this, callback](const Status& status,
+                                               std::string&& message_in) {
+    std::map<ObjectID, std::shared_ptr<arrow::Buffer>> buffers;
+    std::vector<Payload> payloads;
+    Status s = status;
+    if (s.ok()) {
+      s = ReadGetBuffersReply(message_in, payloads);
+    }
+    for (auto const& item : payloads) {
+      uint8_t *shared = nullptr, *dist = nullptr;
+      if (s.ok() && item.data_size > 0) {
+        s = mmapToClient(item.store_fd, item.map_size, true, true, &shared);
+        dist = shared + item.data_offset;
+      }
+      if (!s.ok()) {
+        break;
+      }
+      buffers.emplace(item.object_id,
+                      std::make_shared<arrow::Buffer>(dist, item.data_size));
+    }
+    return callback(s, std::move(buffers));
+  });
+}
+
 Status Client::GetBufferSizes(const std::set<ObjectID>& ids,
                               std::map<ObjectID, size_t>& sizes) {
   if (ids.empty()) {
@@ -480,9 +810,13 @@ Status Client::GetBufferSizes(const std::set<ObjectID>& ids,
   }
   ENSURE_CONNECTED(this);
   std::string message_out;
-  WriteGetBuffersRequest(ids, message_out);
+  if (binary_protocol_) {
+    WriteGetBuffersRequestBinary(ids, message_out);
+  } else {
+    WriteGetBuffersRequest(ids, message_out);
+  }
   RETURN_ON_ERROR(doWrite(message_out));
-  json message_in;
+  std::string message_in;
   RETURN_ON_ERROR(doRead(message_in));
   std::vector<Payload> payloads;
   RETURN_ON_ERROR(ReadGetBuffersReply(message_in, payloads));
@@ -501,9 +835,12 @@ Status Client::DropBuffer(const ObjectID id, const int fd) {
   ENSURE_CONNECTED(this);
 
   // unmap from client
-  auto entry = mmap_table_.find(fd);
-  if (entry != mmap_table_.end()) {
-    mmap_table_.erase(entry);
+  {
+    std::lock_guard<std::mutex> guard(mmap_mutex_);
+    auto entry = mmap_table_.find(fd);
+    if (entry != mmap_table_.end()) {
+      mmap_table_.erase(entry);
+    }
   }
 
   // free on server
@@ -518,10 +855,21 @@ Status Client::DropBuffer(const ObjectID id, const int fd) {
 
 Status Client::mmapToClient(int fd, int64_t map_size, bool readonly,
                             bool realign, uint8_t** ptr) {
+  // replies of a pipelined connection may be consumed by multiple threads.
+  std::lock_guard<std::mutex> guard(mmap_mutex_);
   auto entry = mmap_table_.find(fd);
   if (entry == mmap_table_.end()) {
-    int client_fd = recv_fd(vineyard_conn_);
-    if (fd <= 0) {
+    int client_fd = -1;
+    if (pipelined_) {
+      // the fds have been received by the reader thread along with the reply.
+      if (!takeReceivedFd(fd, client_fd)) {
+        return Status::IOError("The file descriptor " + std::to_string(fd) +
+                               " has not been received from the socket");
+      }
+    } else {
+      client_fd = recv_fd(vineyard_conn_);
+    }
+    if (client_fd < 0) {
       return Status::IOError(
           "Failed to receieve file descriptor from the socket");
     }
@@ -16,11 +16,15 @@ limitations under the License.
 #ifndef SRC_CLIENT_CLIENT_H_
 #define SRC_CLIENT_CLIENT_H_
 
+#include <future>
 #include <map>
 #include <memory>
+#include <mutex>
 #include <set>
 #include <string>
+#include <tuple>
 #include <unordered_map>
+#include <utility>
 #include <vector>
 
 #include "arrow/buffer.h"
@@ -30,6 +34,7 @@ limitations under the License.
 #include "client/ds/i_object.h"
 #include "client/ds/object_meta.h"
 #include "common/memory/payload.h"
+#include "common/util/callback.h"
 #include "common/util/status.h"
 #include "common/util/uuid.h"
 
@@ -141,6 +146,56 @@ class Client : public ClientBase {
   Status GetMetaData(const std::vector<ObjectID>& id, std::vector<ObjectMeta>&,
                      const bool sync_remote = false);
 
+  /**
+   * @brief Obtain metadata from vineyard server, but leave the buffers of the
+   * blobs unfetched. The buffers can be fetched later by `FetchBuffers`, for
+   * the members that are actually accessed.
+   *
+   * Objects that support lazy construction (e.g., `ArrowFragment`) resolve
+   * their members on the first access when constructed from such metadata.
+   *
+   * @param id The object id to get.
+   * @param meta_data The result metadata will be store in `meta_data` as return
+   * value.
+   * @param sync_remote Whether to trigger an immediate remote metadata
+   *        synchronization before get specific metadata. Default is false.
+   *
+   * @return Status that indicates whether the get action has succeeded.
+   */
+  Status GetMetaDataLazily(const ObjectID id, ObjectMeta& meta_data,
+                           const bool sync_remote = false);
+
+  /**
+   * @brief Fetch the buffers of the local blobs in the metadata that haven't
+   * been fetched yet, see also `GetMetaDataLazily`.
+   *
+   * @param meta_data The metadata whose buffers will be filled.
+   *
+   * @return Status that indicates whether the fetch action has succeeded.
+   */
+  Status FetchBuffers(ObjectMeta& meta_data);
+
+  /**
+   * @brief Obtain metadata and the buffers from vineyard server without
+   * blocking the caller. On a pipelined connection the metadata request and
+   * the following buffers request won't block other requests of this client.
+   *
+   * The `meta_data` must outlive the returned future.
+   */
+  std::future<Status> GetMetaDataAsync(const ObjectID id,
+                                       ObjectMeta& meta_data,
+                                       const bool sync_remote = false);
+
+  /**
+   * @brief Obtain multiple metadatas from vineyard server without blocking the
+   * caller.
+   *
+   * The `meta_datas` must outlive the returned future.
+   */
+  std::future<Status> GetMetaDataAsync(const std::vector<ObjectID>& ids,
+                                       std::vector<ObjectMeta>& meta_datas,
+                                       const bool sync_remote = false);
+
   /**
    * @brief Create a blob in vineyard server. When creating a blob, vineyard
    * server's bulk allocator will prepare a block of memory of the requested
@@ -153,6 +208,19 @@ class Client : public ClientBase {
    */
   Status CreateBlob(size_t size, std::unique_ptr<BlobWriter>& blob);
 
+  /**
+   * @brief Create a batch of blobs in vineyard server, in a single round trip.
+   * Either all the blobs are created or none of them is.
+   *
+   * @param sizes The sizes of requested blobs.
+   * @param blobs The result mutable blobs will be appended to `blobs`, in the
+   * same order as `sizes`.
+   *
+   * @return Status that indicates whether the create action has succeeded.
+   */
+  Status CreateBlobs(const std::vector<size_t>& sizes,
+                     std::vector<std::unique_ptr<BlobWriter>>& blobs);
+
   /**
    * @brief Get a blob from vineyard server. When obtaining blobs from vineyard
    * server, the memory address in the server process will be mmapped to the
@@ -187,6 +255,18 @@ class Client : public ClientBase {
    */
   Status CreateStream(const ObjectID& id);
 
+  /**
+   * @brief Allocate a stream on vineyard with the given options, e.g., a
+   * broadcast stream that is read by many consumers, each of them reads
+   * every chunk of the stream.
+   *
+   * @param id The id of metadata that will be used to create stream.
+   * @param options The options of the stream.
+   *
+   * @return Status that indicates whether the create action has succeeded.
+   */
+  Status CreateStream(const ObjectID& id, const StreamOptions& options);
+
   /**
    * @brief open a stream on vineyard. Failed if the stream is already opened on
    * the given mode.
@@ -198,6 +278,24 @@ class Client : public ClientBase {
    */
   Status OpenStream(const ObjectID& id, OpenStreamMode mode);
 
+  /**
+   * @brief open a stream for reading on vineyard, where the chunks that have
+   * been pulled by `PullNextStreamChunk(id, std::shared_ptr<arrow::Buffer>&)`
+   * are kept alive until the returned buffers are destroyed, rather than being
+   * dropped on the next pull. Thus the chunks can be consumed in place without
+   * copying.
+   *
+   * @param id The id of stream to mark.
+   * @param mode The mode, OpenStreamMode::read or OpenStreamMode::write.
+   * @param retain_window The maximum number of the outstanding chunks, the
+   *        oldest ones will be released by the server once exceeded, even if
+   *        their buffers are still alive.
+   *
+   * @return Status that indicates whether the open action has succeeded.
+   */
+  Status OpenStream(const ObjectID& id, OpenStreamMode mode,
+                    size_t const retain_window);
+
   /**
    * @brief Allocate a chunk of given size in vineyard for a stream. When the
    * request cannot be statisfied immediately, e.g., vineyard doesn't have
@@ -227,6 +325,28 @@ class Client : public ClientBase {
   Status PullNextStreamChunk(ObjectID const id,
                              std::unique_ptr<arrow::Buffer>& blob);
 
+  /**
+   * @brief Poll a chunk from a stream that is opened with a positive
+   * `retain_window`. The chunk is released once the returned buffer, and the
+   * buffers that are sliced from it, are destroyed. The releases are sent to
+   * the server in batch on the next pull, or by `ReleaseStreamChunks`.
+   *
+   * @param id The id of the stream.
+   * @param blob The immutable chunk generated by the writer of the stream.
+   *
+   * @return Status that indicates whether the polling has succeeded.
+   */
+  Status PullNextStreamChunk(ObjectID const id,
+                             std::shared_ptr<arrow::Buffer>& blob);
+
+  /**
+   * @brief Release the stream chunks whose buffers have been destroyed, see
+   * also `PullNextStreamChunk`.
+   *
+   * @return Status that indicates whether the request has succeeded.
+   */
+  Status ReleaseStreamChunks();
+
   /**
    * @brief Stop a stream, mark it as finished or aborted.
    *
@@ -349,6 +469,11 @@ class Client : public ClientBase {
   Status CreateBuffer(const size_t size, ObjectID& id, Payload& payload,
                       std::shared_ptr<arrow::MutableBuffer>& buffer);
 
+  Status CreateBuffers(
+      const std::vector<size_t>& sizes, std::vector<ObjectID>& ids,
+      std::vector<Payload>& payloads,
+      std::vector<std::shared_ptr<arrow::MutableBuffer>>& buffers);
+
   Status GetBuffer(const ObjectID id, std::shared_ptr<arrow::Buffer>& buffer);
 
   Status GetBuffers(
@@ -368,11 +493,30 @@ class Client : public ClientBase {
   Status DropBuffer(const ObjectID id, const int fd);
 
  private:
+  void getBuffersAsync(
+      const std::set<ObjectID>& ids,
+      callback_t<std::map<ObjectID, std::shared_ptr<arrow::Buffer>>&&>
+          callback);
+
   Status mmapToClient(int fd, int64_t map_size, bool readonly, bool realign,
                       uint8_t** ptr);
 
+  Status pullNextStreamChunk(ObjectID const id, Payload& object,
+                             uint64_t& sequence, uint8_t*& data);
+
+  std::mutex mmap_mutex_;  // protects mmap_table_
   std::unordered_map<int, std::unique_ptr<MmapEntry>> mmap_table_;
 
+  // The (stream, chunk, sequence) of the chunks whose buffers have been
+  // destroyed, they are shared with the buffers as the buffers may outlive
+  // the client.
+  struct ReleasedStreamChunks {
+    std::mutex mutex;
+    std::vector<std::tuple<ObjectID, ObjectID, uint64_t>> chunks;
+  };
+  std::shared_ptr<ReleasedStreamChunks> released_stream_chunks_ =
+      std::make_shared<ReleasedStreamChunks>();
+
  private:
   friend class Blob;
   friend class BlobWriter;
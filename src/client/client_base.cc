@@ -15,6 +15,7 @@ limitations under the License.
 
 #include "client/client_base.h"
 
+#include <cstring>
 #include <future>
 #include <utility>
 
@@ -24,11 +25,17 @@ limitations under the License.
 #include "client/io.h"
 #include "client/rpc_client.h"
 #include "client/utils.h"
+#include "common/memory/fling.h"
 #include "common/util/protocols.h"
 
 namespace vineyard {
 
-ClientBase::ClientBase() : connected_(false), vineyard_conn_(0) {}
+ClientBase::ClientBase()
+    : connected_(false),
+      vineyard_conn_(0),
+      binary_protocol_(false),
+      pipelined_(false),
+      next_request_id_(1) {}
 
 Status ClientBase::GetData(const ObjectID id, json& tree,
                            const bool sync_remote, const bool wait) {
@@ -60,6 +67,33 @@ Status ClientBase::GetData(const std::vector<ObjectID>& ids,
   return Status::OK();
 }
 
+std::future<Status> ClientBase::GetDataAsync(const ObjectID id, json& tree,
+                                             const bool sync_remote,
+                                             const bool wait) {
+  std::string message_out;
+  WriteGetDataRequest(id, sync_remote, wait, message_out);
+  return requestAsync(message_out, [&tree](const json& message_in) {
+    return ReadGetDataReply(message_in, tree);
+  });
+}
+
+std::future<Status> ClientBase::GetDataAsync(const std::vector<ObjectID>& ids,
+                                             std::vector<json>& trees,
+                                             const bool sync_remote,
+                                             const bool wait) {
+  std::string message_out;
+  WriteGetDataRequest(ids, sync_remote, wait, message_out);
+  return requestAsync(message_out, [ids, &trees](const json& message_in) {
+    std::unordered_map<ObjectID, json> meta_trees;
+    RETURN_ON_ERROR(ReadGetDataReply(message_in, meta_trees));
+    trees.reserve(ids.size());
+    for (auto const& id : ids) {
+      trees.emplace_back(meta_trees.at(id));
+    }
+    return Status::OK();
+  });
+}
+
 Status ClientBase::CreateData(const json& tree, ObjectID& id,
                               Signature& signature, InstanceID& instance_id) {
   ENSURE_CONNECTED(this);
@@ -72,6 +106,17 @@ Status ClientBase::CreateData(const json& tree, ObjectID& id,
   return Status::OK();
 }
 
+std::future<Status> ClientBase::CreateDataAsync(const json& tree, ObjectID& id,
+                                                Signature& signature,
+                                                InstanceID& instance_id) {
+  std::string message_out;
+  WriteCreateDataRequest(tree, message_out);
+  return requestAsync(message_out, [&id, &signature,
+                                    &instance_id](const json& message_in) {
+    return ReadCreateDataReply(message_in, id, signature, instance_id);
+  });
+}
+
 Status ClientBase::CreateMetaData(ObjectMeta& meta_data, ObjectID& id) {
   InstanceID instance_id = this->instance_id_;
   meta_data.SetInstanceId(instance_id);
@@ -131,6 +176,16 @@ Status ClientBase::DelData(const std::vector<ObjectID>& ids, const bool force,
   return Status::OK();
 }
 
+std::future<Status> ClientBase::DelDataAsync(const std::vector<ObjectID>& ids,
+                                             const bool force,
+                                             const bool deep) {
+  std::string message_out;
+  WriteDelDataRequest(ids, force, deep, false, message_out);
+  return requestAsync(message_out, [](const json& message_in) {
+    return ReadDelDataReply(message_in);
+  });
+}
+
 Status ClientBase::ListData(std::string const& pattern, bool const regex,
                             size_t const limit,
                             std::unordered_map<ObjectID, json>& meta_trees) {
@@ -177,6 +232,14 @@ Status ClientBase::Exists(const ObjectID id, bool& exists) {
   return Status::OK();
 }
 
+std::future<Status> ClientBase::ExistsAsync(const ObjectID id, bool& exists) {
+  std::string message_out;
+  WriteExistsRequest(id, message_out);
+  return requestAsync(message_out, [&exists](const json& message_in) {
+    return ReadExistsReply(message_in, exists);
+  });
+}
+
 Status ClientBase::ShallowCopy(const ObjectID id, ObjectID& target_id) {
   ENSURE_CONNECTED(this);
   std::string message_out;
@@ -246,6 +309,15 @@ Status ClientBase::PutName(const ObjectID id, std::string const& name) {
   return Status::OK();
 }
 
+std::future<Status> ClientBase::PutNameAsync(const ObjectID id,
+                                             std::string const& name) {
+  std::string message_out;
+  WritePutNameRequest(id, name, message_out);
+  return requestAsync(message_out, [](const json& message_in) {
+    return ReadPutNameReply(message_in);
+  });
+}
+
 Status ClientBase::GetName(const std::string& name, ObjectID& id,
                            const bool wait) {
   ENSURE_CONNECTED(this);
@@ -258,6 +330,15 @@ Status ClientBase::GetName(const std::string& name, ObjectID& id,
   return Status::OK();
 }
 
+std::future<Status> ClientBase::GetNameAsync(const std::string& name,
+                                             ObjectID& id, const bool wait) {
+  std::string message_out;
+  WriteGetNameRequest(name, wait, message_out);
+  return requestAsync(message_out, [&id](const json& message_in) {
+    return ReadGetNameReply(message_in, id);
+  });
+}
+
 Status ClientBase::DropName(const std::string& name) {
   ENSURE_CONNECTED(this);
   std::string message_out;
@@ -336,7 +417,9 @@ Status ClientBase::migrateObjectImpl(const ObjectID object_id,
 }
 
 bool ClientBase::Connected() const {
-  if (connected_ &&
+  // on a pipelined connection, the reader thread watches the connection, and
+  // the pending replies are not a sign of disconnection.
+  if (connected_ && !pipelined_ &&
       recv(vineyard_conn_, NULL, 1, MSG_PEEK | MSG_DONTWAIT) != -1) {
     connected_ = false;
   }
@@ -345,17 +428,37 @@ bool ClientBase::Connected() const {
 
 void ClientBase::Disconnect() {
   std::lock_guard<std::recursive_mutex> __guard(this->client_mutex_);
-  if (!this->connected_) {
+  if (!this->connected_ && !reader_.joinable()) {
     return;
   }
-  std::string message_out;
-  WriteExitRequest(message_out);
-  VINEYARD_SUPPRESS(doWrite(message_out));
+  if (this->connected_) {
+    std::string message_out;
+    WriteExitRequest(message_out);
+    VINEYARD_SUPPRESS(doWrite(message_out));
+  }
+  if (reader_.joinable()) {
+    // wake up the reader thread, the pending requests will be failed.
+    shutdown(vineyard_conn_, SHUT_RDWR);
+    reader_.join();
+  }
   close(vineyard_conn_);
   connected_ = false;
+  pipelined_ = false;
 }
 
 Status ClientBase::doWrite(const std::string& message_out) {
+  if (pipelined_) {
+    // the caller holds the client_mutex_ until the reply is read by `doRead`.
+    auto reply =
+        std::make_shared<std::promise<std::pair<Status, std::string>>>();
+    sync_reply_ = reply->get_future();
+    doRequestAsync(message_out, [reply](const Status& status,
+                                        std::string&& message_in) {
+      reply->set_value(std::make_pair(status, std::move(message_in)));
+      return Status::OK();
+    });
+    return Status::OK();
+  }
   auto status = send_message(vineyard_conn_, message_out);
   if (!status.ok()) {
     connected_ = false;
@@ -364,17 +467,23 @@ Status ClientBase::doWrite(const std::string& message_out) {
 }
 
 Status ClientBase::doRead(std::string& message_in) {
-  return recv_message(vineyard_conn_, message_in);
-}
-
-Status ClientBase::doRead(json& root) {
-  std::string message_in;
+  if (pipelined_) {
+    RETURN_ON_ASSERT(sync_reply_.valid(), "No request is in flight");
+    auto reply = sync_reply_.get();
+    message_in = std::move(reply.second);
+    return reply.first;
+  }
   auto status = recv_message(vineyard_conn_, message_in);
   if (!status.ok()) {
     connected_ = false;
-    return status;
   }
-  status = CATCH_JSON_ERROR([&]() -> Status {
+  return status;
+}
+
+Status ClientBase::doRead(json& root) {
+  std::string message_in;
+  RETURN_ON_ERROR(doRead(message_in));
+  auto status = CATCH_JSON_ERROR([&]() -> Status {
     root = json::parse(message_in);
     return Status::OK();
   }());
@@ -384,6 +493,172 @@ Status ClientBase::doRead(json& root) {
   return status;
 }
 
+void ClientBase::doRequestAsync(const std::string& message_out,
+                                callback_t<std::string&&> callback) {
+  if (!pipelined_) {
+    std::lock_guard<std::recursive_mutex> __guard(this->client_mutex_);
+    std::string message_in;
+    auto status = doWrite(message_out);
+    if (status.ok()) {
+      status = doRead(message_in);
+    }
+    VINEYARD_DISCARD(callback(status, std::move(message_in)));
+    return;
+  }
+
+  uint64_t request_id = next_request_id_.fetch_add(1);
+  {
+    std::lock_guard<std::mutex> guard(pipeline_mutex_);
+    if (!pipeline_status_.ok()) {
+      VINEYARD_DISCARD(callback(pipeline_status_, std::string()));
+      return;
+    }
+    pending_requests_.emplace(request_id, callback);
+  }
+  Status status;
+  {
+    std::lock_guard<std::mutex> guard(write_mutex_);
+    size_t length = message_out.size();
+    char header[kPipelinedRequestHeaderSize];
+    memcpy(header, &length, sizeof(size_t));
+    memcpy(header + sizeof(size_t), &request_id, sizeof(uint64_t));
+    status = send_bytes(vineyard_conn_, header, kPipelinedRequestHeaderSize);
+    if (status.ok()) {
+      status = send_bytes(vineyard_conn_, message_out.data(), length);
+    }
+  }
+  if (!status.ok()) {
+    connected_ = false;
+    callback_t<std::string&&> pending = nullptr;
+    {
+      std::lock_guard<std::mutex> guard(pipeline_mutex_);
+      auto iter = pending_requests_.find(request_id);
+      if (iter != pending_requests_.end()) {
+        pending = std::move(iter->second);
+        pending_requests_.erase(iter);
+      }
+    }
+    // the reader thread may have already failed the request.
+    if (pending) {
+      VINEYARD_DISCARD(pending(status, std::string()));
+    }
+  }
+}
+
+std::future<Status> ClientBase::requestAsync(
+    const std::string& message_out,
+    std::function<Status(const json&)> read_reply) {
+  auto promise = std::make_shared<std::promise<Status>>();
+  auto future = promise->get_future();
+  if (!connected_) {
+    promise->set_value(Status::ConnectionError("Client is not connected"));
+    return future;
+  }
+  doRequestAsync(message_out, [promise, read_reply](const Status& status,
+                                                    std::string&& message_in) {
+    if (!status.ok()) {
+      promise->set_value(status);
+      return Status::OK();
+    }
+    promise->set_value(CATCH_JSON_ERROR([&]() -> Status {
+      json root = json::parse(message_in);
+      return read_reply(root);
+    }()));
+    return Status::OK();
+  });
+  return future;
+}
+
+void ClientBase::startPipeline() {
+  pipeline_status_ = Status::OK();
+  pipelined_ = true;
+  reader_ = std::thread(&ClientBase::readReplies, this);
+}
+
+bool ClientBase::takeReceivedFd(const int fd, int& client_fd) {
+  std::lock_guard<std::mutex> guard(pipeline_mutex_);
+  auto iter = received_fds_.find(fd);
+  if (iter == received_fds_.end()) {
+    return false;
+  }
+  client_fd = iter->second;
+  received_fds_.erase(iter);
+  return true;
+}
+
+void ClientBase::readReplies() {
+  Status status;
+  while (status.ok()) {
+    char header[kPipelinedReplyHeaderSize];
+    status = recv_bytes(vineyard_conn_, header, kPipelinedReplyHeaderSize);
+    if (!status.ok()) {
+      break;
+    }
+    size_t length = 0;
+    uint64_t request_id = 0;
+    uint32_t fd_count = 0;
+    memcpy(&length, header, sizeof(size_t));
+    memcpy(&request_id, header + sizeof(size_t), sizeof(uint64_t));
+    memcpy(&fd_count, header + sizeof(size_t) + sizeof(uint64_t),
+           sizeof(uint32_t));
+    std::vector<int32_t> fds(fd_count);
+    if (fd_count > 0) {
+      status = recv_bytes(vineyard_conn_, fds.data(),
+                          fd_count * sizeof(int32_t));
+    }
+    std::string message_in;
+    if (status.ok()) {
+      message_in.resize(length + 1);
+      message_in[length] = '\0';
+      status = recv_bytes(vineyard_conn_, &message_in[0], length);
+    }
+    // the fds follow the reply and must be received before the next reply.
+    for (size_t idx = 0; status.ok() && idx < fds.size(); ++idx) {
+      int client_fd = recv_fd(vineyard_conn_);
+      if (client_fd < 0) {
+        status = Status::IOError(
+            "Failed to receieve file descriptor from the socket");
+      } else {
+        std::lock_guard<std::mutex> guard(pipeline_mutex_);
+        received_fds_[fds[idx]] = client_fd;
+      }
+    }
+    if (!status.ok()) {
+      break;
+    }
+    callback_t<std::string&&> callback = nullptr;
+    {
+      std::lock_guard<std::mutex> guard(pipeline_mutex_);
+      auto iter = pending_requests_.find(request_id);
+      if (iter != pending_requests_.end()) {
+        callback = std::move(iter->second);
+        pending_requests_.erase(iter);
+      }
+    }
+    if (callback) {
+      VINEYARD_DISCARD(callback(Status::OK(), std::move(message_in)));
+    } else {
+      LOG(ERROR) << "Received a reply for unknown request: " << request_id;
+    }
+  }
+
+  // fail all the pending requests, as well as the following ones.
+  connected_ = false;
+  std::unordered_map<uint64_t, callback_t<std::string&&>> pending_requests;
+  {
+    std::lock_guard<std::mutex> guard(pipeline_mutex_);
+    pipeline_status_ = status;
+    pending_requests.swap(pending_requests_);
+    for (auto const& item : received_fds_) {
+      close(item.second);
+    }
+    received_fds_.clear();
+  }
+  for (auto& item : pending_requests) {
+    VINEYARD_DISCARD(item.second(status, std::string()));
+  }
+}
+
 Status ClientBase::ClusterInfo(std::map<InstanceID, json>& meta) {
   ENSURE_CONNECTED(this);
   std::string message_out;
@@ -448,8 +723,13 @@ InstanceStatus::InstanceStatus(const json& tree)
       deployment(tree["deployment"].get_ref<const std::string&>()),
       memory_usage(tree["memory_usage"].get<size_t>()),
       memory_limit(tree["memory_limit"].get<size_t>()),
+      slab_usage(tree.value("slab_usage", static_cast<size_t>(0))),
+      slab_fragmentation(tree.value("slab_fragmentation", 0.0)),
+      spill_count(tree.value("spill_count", static_cast<size_t>(0))),
+      reload_count(tree.value("reload_count", static_cast<size_t>(0))),
       deferred_requests(tree["deferred_requests"].get<size_t>()),
       ipc_connections(tree["ipc_connections"].get<size_t>()),
-      rpc_connections(tree["rpc_connections"].get<size_t>()) {}
+      rpc_connections(tree["rpc_connections"].get<size_t>()),
+      streams(tree.value("streams", json::object())) {}
 
 }  // namespace vineyard
@@ -17,15 +17,20 @@ limitations under the License.
 #define SRC_CLIENT_CLIENT_BASE_H_
 
 #include <sys/mman.h>
+#include <atomic>
+#include <future>
 #include <map>
 #include <memory>
 #include <mutex>
 #include <string>
+#include <thread>
 #include <unordered_map>
+#include <utility>
 #include <vector>
 
 #include "client/ds/object_meta.h"
 #include "common/util/boost.h"
+#include "common/util/callback.h"
 #include "common/util/status.h"
 #include "common/util/uuid.h"
 #include "common/util/version.h"
@@ -82,6 +87,30 @@ class ClientBase {
   Status GetData(const std::vector<ObjectID>& ids, std::vector<json>& trees,
                  const bool sync_remote = false, const bool wait = false);
 
+  /**
+   * @brief The asynchronous variant of `GetData`. The request is pipelined
+   * when the connection supports that, i.e., many requests can be in flight
+   * on the same connection, see also `Pipelined()`.
+   *
+   * Note that the `tree` must be kept alive until the returned future is
+   * ready, and the same holds for the output parameters of other asynchronous
+   * methods.
+   *
+   * @return A future of the status that indicates whether the get action
+   * succeeds.
+   */
+  std::future<Status> GetDataAsync(const ObjectID id, json& tree,
+                                   const bool sync_remote = false,
+                                   const bool wait = false);
+
+  /**
+   * @brief The asynchronous variant of `GetData` for a set of objects.
+   */
+  std::future<Status> GetDataAsync(const std::vector<ObjectID>& ids,
+                                   std::vector<json>& trees,
+                                   const bool sync_remote = false,
+                                   const bool wait = false);
+
   /**
    * @brief Create the metadata in the vineyard server.
    *
@@ -95,6 +124,13 @@ class ClientBase {
   Status CreateData(const json& tree, ObjectID& id, Signature& signature,
                     InstanceID& instance_id);
 
+  /**
+   * @brief The asynchronous variant of `CreateData`.
+   */
+  std::future<Status> CreateDataAsync(const json& tree, ObjectID& id,
+                                      Signature& signature,
+                                      InstanceID& instance_id);
+
   /**
    * @brief Create the metadata in the vineyard server, after created, the
    * resulted object id in the `meta_data` will be filled.
@@ -157,6 +193,13 @@ class ClientBase {
   Status DelData(const std::vector<ObjectID>& ids, const bool force = false,
                  const bool deep = true);
 
+  /**
+   * @brief The asynchronous variant of `DelData`.
+   */
+  std::future<Status> DelDataAsync(const std::vector<ObjectID>& ids,
+                                   const bool force = false,
+                                   const bool deep = true);
+
   /**
    * @brief List objectmetas in vineyard, using the given typename patterns.
    *
@@ -208,6 +251,11 @@ class ClientBase {
    */
   Status Exists(const ObjectID id, bool& exists);
 
+  /**
+   * @brief The asynchronous variant of `Exists`.
+   */
+  std::future<Status> ExistsAsync(const ObjectID id, bool& exists);
+
   /**
    * @brief Make a shallow copy on the given object. A "shallow copy" means the
    * result object has the same type with the source object and they shares all
@@ -260,6 +308,11 @@ class ClientBase {
    */
   Status PutName(const ObjectID id, std::string const& name);
 
+  /**
+   * @brief The asynchronous variant of `PutName`.
+   */
+  std::future<Status> PutNameAsync(const ObjectID id, std::string const& name);
+
   /**
    * @brief Retrieve the object ID by assoicated name.
    *
@@ -273,6 +326,13 @@ class ClientBase {
   Status GetName(const std::string& name, ObjectID& id,
                  const bool wait = false);
 
+  /**
+   * @brief The asynchronous variant of `GetName`. With `wait`, the request
+   * won't block other requests on the same connection when pipelined.
+   */
+  std::future<Status> GetNameAsync(const std::string& name, ObjectID& id,
+                                   const bool wait = false);
+
   /**
    * @brief Deregister a name entry. The assoicated object will be kept and
    * won't be deleted.
@@ -382,6 +442,23 @@ class ClientBase {
    */
   const std::string& Version() const { return server_version_; }
 
+  /**
+   * @brief Whether the compact binary encoding has been negotiated with the
+   * connected vineyard server for the buffer and stream requests.
+   *
+   * @return True if the binary encoding is used, otherwise JSON is used.
+   */
+  bool BinaryProtocol() const { return binary_protocol_; }
+
+  /**
+   * @brief Whether the requests are tagged with request ids on this
+   * connection, in which case the asynchronous requests are pipelined and
+   * their replies can arrive out of order.
+   *
+   * @return True if the requests are pipelined.
+   */
+  bool Pipelined() const { return pipelined_; }
+
   /**
    * @brief Issue a debug request.
    *
@@ -399,6 +476,37 @@ class ClientBase {
 
   Status doRead(json& root);
 
+  /**
+   * @brief Send the request and invoke `callback` with its reply. On a
+   * pipelined connection the callback is invoked by the reader thread, thus
+   * it shouldn't block, otherwise the request is completed synchronously.
+   *
+   * The callback will be invoked exactly once, with an error status if the
+   * request cannot be completed.
+   */
+  void doRequestAsync(const std::string& message_out,
+                      callback_t<std::string&&> callback);
+
+  /**
+   * @brief Issue the request via `doRequestAsync`, the returned future will be
+   * resolved with the status of `read_reply` on the JSON reply.
+   */
+  std::future<Status> requestAsync(
+      const std::string& message_out,
+      std::function<Status(const json&)> read_reply);
+
+  /**
+   * @brief Start the reader thread that dispatches replies to the pending
+   * requests, after pipelining has been negotiated.
+   */
+  void startPipeline();
+
+  /**
+   * @brief Take the file descriptor that has been received by the reader
+   * thread for the given server-side file descriptor.
+   */
+  bool takeReceivedFd(const int fd, int& client_fd);
+
   /**
    * @brief Implementation for migrate remote object to local.
    *
@@ -413,15 +521,32 @@ class ClientBase {
                       std::string const& peer,
                       std::string const& peer_rpc_endpoint);
 
-  mutable bool connected_;
+  mutable std::atomic_bool connected_;
   std::string ipc_socket_;
   std::string rpc_endpoint_;
   int vineyard_conn_;
   InstanceID instance_id_;
   std::string server_version_;
+  bool binary_protocol_;
+  bool pipelined_;
 
   // A mutex which protects the client.
   std::recursive_mutex client_mutex_;
+
+ private:
+  void readReplies();
+
+  std::atomic<uint64_t> next_request_id_;
+  // serializes the writes of pipelined requests
+  std::mutex write_mutex_;
+  // protects the pending requests and the received fds
+  std::mutex pipeline_mutex_;
+  std::unordered_map<uint64_t, callback_t<std::string&&>> pending_requests_;
+  std::unordered_map<int, int> received_fds_;
+  Status pipeline_status_;
+  std::thread reader_;
+  // the reply of the in-flight synchronous request, protected by client_mutex_
+  std::future<std::pair<Status, std::string>> sync_reply_;
 };
 
 struct InstanceStatus {
@@ -433,12 +558,24 @@ struct InstanceStatus {
   const size_t memory_usage;
   /// The memory upper bound of this vineyard server, in bytes.
   const size_t memory_limit;
+  /// The memory held by the slabs of tiny blobs, in bytes.
+  const size_t slab_usage;
+  /// The internal fragmentation of the slabs, i.e., the fraction of slots that
+  /// are not requested by the blobs.
+  const double slab_fragmentation;
+  /// How many blobs have been spilled to disk under memory pressure.
+  const size_t spill_count;
+  /// How many spilled blobs have been reloaded into the shared memory.
+  const size_t reload_count;
   /// How many requests are deferred in the queue.
   const size_t deferred_requests;
   /// How many Client connects to this vineyard server.
   const size_t ipc_connections;
   /// How many RPCClient connects to this vineyard server.
   const size_t rpc_connections;
+  /// The buffering of each stream, keyed by the stream id, including its
+  /// queue depth, the chunks and bytes it holds and its capacity limits.
+  const json streams;
 
   /**
    * @brief Initialize the status value using a json returned from the vineyard
@@ -13,7 +13,9 @@ limitations under the License.
 #if defined(WITH_JEMALLOC)
 
 #include <algorithm>
+#include <atomic>
 #include <string>
+#include <utility>
 
 #define JEMALLOC_NO_DEMANGLE
 #include "jemalloc/include/jemalloc/jemalloc.h"
@@ -40,7 +42,108 @@ Jemalloc::~Jemalloc() {
   }
 }
 
-void* Jemalloc::Init(void* space, const size_t size) {
+namespace {
+
+// Binds the calling thread to a slot on its first allocation, threads are
+// spread over the arenas in a round-robin way.
+size_t thread_slot() {
+  static std::atomic<size_t> next_slot{0};
+  thread_local size_t slot = next_slot.fetch_add(1);
+  return slot;
+}
+
+}  // namespace
+
+void* Jemalloc::Init(void* space, const size_t size, const size_t num_arenas) {
+  arena_indices_.clear();
+  flags_.clear();
+
+  // prepare the custom hook
+  *extent_hooks_ = je_ehooks_default_extent_hooks;
+  extent_hooks_->alloc = &theAllocHook;
+
+  int space_index = createArena(space, size, -1);
+  if (space_index == -1) {
+    return nullptr;
+  }
+  for (size_t index = 1; index < num_arenas; ++index) {
+    if (createArena(space, size, space_index) == -1) {
+      LOG(WARNING) << "Only " << arena_indices_.size() << " out of "
+                   << num_arenas << " arenas are created";
+      break;
+    }
+  }
+  return space;
+}
+
+void* Jemalloc::Allocate(const size_t bytes, const size_t alignment) {
+  const size_t size = std::max(bytes, alignment);
+  const size_t slot = this->slot();
+  void* pointer = vineyard_je_mallocx(size, flags_[slot]);
+  // the extents freed by an arena are retained by itself rather than given
+  // back to the shared space, thus an arena may run out after uneven churn
+  // between threads while the others still have free extents.
+  for (size_t index = 1; pointer == nullptr && index < flags_.size();
+       ++index) {
+    pointer =
+        vineyard_je_mallocx(size, flags_[(slot + index) % flags_.size()]);
+  }
+  return pointer;
+}
+
+void* Jemalloc::Reallocate(void* pointer, size_t size) {
+  const size_t slot = this->slot();
+  void* reallocated = vineyard_je_rallocx(pointer, size, flags_[slot]);
+  // when it must be moved, the allocation is moved to the given arena.
+  for (size_t index = 1; reallocated == nullptr && index < flags_.size();
+       ++index) {
+    reallocated = vineyard_je_rallocx(pointer, size,
+                                      flags_[(slot + index) % flags_.size()]);
+  }
+  return reallocated;
+}
+
+void Jemalloc::Free(void* pointer, size_t) {
+  if (pointer) {
+    vineyard_je_dallocx(pointer, flags());
+  }
+}
+
+void Jemalloc::Recycle(const bool /* unused currently */) {
+  for (auto const arena_index : arena_indices_) {
+    std::string decay_key = "arena." + std::to_string(arena_index) + ".decay";
+    if (auto ret = vineyard_je_mallctl(decay_key.c_str(), nullptr, nullptr,
+                                       nullptr, 0)) {
+      int err = std::exchange(errno, ret);
+      PLOG(ERROR) << "Failed to recycle arena " << arena_index;
+      errno = err;
+    }
+  }
+}
+
+size_t Jemalloc::GetAllocatedSize(void* pointer) {
+  return vineyard_je_sallocx(pointer, flags());
+}
+
+size_t Jemalloc::EstimateAllocatedSize(const size_t size) {
+  return vineyard_je_nallocx(size, flags());
+}
+
+void Jemalloc::Traverse() {
+  for (auto const arena_index : arena_indices_) {
+    std::string traverse_key =
+        "arena." + std::to_string(arena_index) + ".traverse";
+    if (auto ret = vineyard_je_mallctl(traverse_key.c_str(), nullptr, nullptr,
+                                       nullptr, 0)) {
+      int err = std::exchange(errno, ret);
+      PLOG(ERROR) << "Failed to traverse arena";
+      errno = err;
+    }
+  }
+}
+
+int Jemalloc::createArena(void* space, const size_t size,
+                          const int space_index) {
   // obtain the current arena numbers
   unsigned narenas = -1;
   size_t size_of_narenas = sizeof(unsigned);
@@ -49,42 +152,45 @@ void* Jemalloc::Init(void* space, const size_t size) {
     int err = std::exchange(errno, ret);
     PLOG(ERROR) << "Failed to get narenas";
     errno = err;
-    return nullptr;
+    return -1;
   }
 
-  arena_index_ = narenas;  // starts from 0
-  if (arena_index_ >= MAXIMUM_ARENAS) {
+  unsigned arena_index = narenas;  // starts from 0
+  if (arena_index >= MAXIMUM_ARENAS) {
     LOG(ERROR) << "There can be " << MAXIMUM_ARENAS << " arenas at most";
-    return nullptr;
+    return -1;
   }
 
-  arena_t& arena = arenas_[arena_index_];
+  // the hook will be invoked during creating the arena, thus the arena must
+  // be ready before that.
+  arena_t& arena = arenas_[arena_index];
   arena.base_pointer_ = reinterpret_cast<uintptr_t>(space);
   arena.base_end_pointer_ = arena.base_pointer_ + size;
-  arena.pre_alloc_ = arena.base_pointer_;
-
-  // prepare the custom hook
-  *extent_hooks_ = je_ehooks_default_extent_hooks;
-  extent_hooks_->alloc = &theAllocHook;
+  if (space_index == -1) {
+    arena.pre_alloc_.store(arena.base_pointer_);
+    arena.space_index_ = arena_index;
+  } else {
+    arena.space_index_ = space_index;
+  }
 
   // create arenas
-  size_t arena_index_size = sizeof(arena_index_);
+  size_t arena_index_size = sizeof(arena_index);
   if (auto ret =
-          vineyard_je_mallctl("arenas.create", &arena_index_, &arena_index_size,
+          vineyard_je_mallctl("arenas.create", &arena_index, &arena_index_size,
                               &extent_hooks_, sizeof(extent_hooks_))) {
     int err = std::exchange(errno, ret);
     PLOG(ERROR) << "Failed to create arena";
     errno = err;
-    return nullptr;
+    return -1;
   }
-  LOG(INFO) << "arena index = " << arena_index_;
+  LOG(INFO) << "arena index = " << arena_index;
 
   // set muzzy decay time to -1 to prevent jemalloc freeing the memory to the
   // pool, but leave dirty decay time untouched to still give the memory back
   // to the os kernel.
   // ssize_t decay_ms = 1;
   // std::string dirty_decay_key =
-  //     "arena." + std::to_string(arena_index_) + ".dirty_decay_ms";
+  //     "arena." + std::to_string(arena_index) + ".dirty_decay_ms";
   // if (auto ret = vineyard_je_mallctl(dirty_decay_key.c_str(), nullptr,
   // nullptr,
   //                           &decay_ms, sizeof(decay_ms))) {
@@ -95,72 +201,42 @@ void* Jemalloc::Init(void* space, const size_t size) {
   // }
   ssize_t decay_ms = -1;
   std::string muzzy_decay_key =
-      "arena." + std::to_string(arena_index_) + ".muzzy_decay_ms";
+      "arena." + std::to_string(arena_index) + ".muzzy_decay_ms";
   if (auto ret = vineyard_je_mallctl(muzzy_decay_key.c_str(), nullptr, nullptr,
                                      &decay_ms, sizeof(decay_ms))) {
     int err = std::exchange(errno, ret);
     PLOG(ERROR) << "Failed to set the muzzy decay time";
     errno = err;
-    return nullptr;
+    return -1;
   }
 
-  flags_ = MALLOCX_ARENA(arena_index_) | MALLOCX_TCACHE_NONE;
-  return space;
-}
-
-void* Jemalloc::Allocate(const size_t bytes, const size_t alignment) {
-  return vineyard_je_mallocx(std::max(bytes, alignment), flags_);
-}
-
-void* Jemalloc::Reallocate(void* pointer, size_t size) {
-  return vineyard_je_rallocx(pointer, size, flags_);
-}
-
-void Jemalloc::Free(void* pointer, size_t) {
-  if (pointer) {
-    vineyard_je_dallocx(pointer, flags_);
-  }
+  arena_indices_.emplace_back(arena_index);
+  flags_.emplace_back(MALLOCX_ARENA(arena_index) | MALLOCX_TCACHE_NONE);
+  return static_cast<int>(arena_index);
 }
 
-void Jemalloc::Recycle(const bool /* unused currently */) {
-  std::string decay_key = "arena." + std::to_string(arena_index_) + ".decay";
-  if (auto ret = vineyard_je_mallctl(decay_key.c_str(), nullptr, nullptr,
-                                     nullptr, 0)) {
-    int err = std::exchange(errno, ret);
-    PLOG(ERROR) << "Failed to recycle arena " << arena_index_;
-    errno = err;
+size_t Jemalloc::slot() const {
+  if (flags_.size() == 1) {
+    return 0;
   }
+  return thread_slot() % flags_.size();
 }
 
-size_t Jemalloc::GetAllocatedSize(void* pointer) {
-  return vineyard_je_sallocx(pointer, flags_);
-}
-
-size_t Jemalloc::EstimateAllocatedSize(const size_t size) {
-  return vineyard_je_nallocx(size, flags_);
-}
-
-void Jemalloc::Traverse() {
-  std::string traverse_key =
-      "arena." + std::to_string(arena_index_) + ".traverse";
-  if (auto ret = vineyard_je_mallctl(traverse_key.c_str(), nullptr, nullptr,
-                                     nullptr, 0)) {
-    int err = std::exchange(errno, ret);
-    PLOG(ERROR) << "Failed to traverse arena";
-    errno = err;
-  }
-}
+int Jemalloc::flags() const { return flags_[slot()]; }
 
 void* Jemalloc::theAllocHook(extent_hooks_t* extent_hooks, void* new_addr,
                              size_t size, size_t alignment, bool* zero,
                              bool* commit, unsigned arena_index) {
-  // align
-  arena_t& arena = arenas_[arena_index];
-  uintptr_t ret = (arena.pre_alloc_ + alignment - 1) & ~(alignment - 1);
-  if (ret + size > arena.base_end_pointer_) {
-    return nullptr;
-  }
-  arena.pre_alloc_ = ret + size;
+  // align, the arenas that share the space bump the pointer concurrently.
+  arena_t& arena = arenas_[arenas_[arena_index].space_index_];
+  uintptr_t pre_alloc = arena.pre_alloc_.load();
+  uintptr_t ret = 0;
+  do {
+    ret = (pre_alloc + alignment - 1) & ~(alignment - 1);
+    if (ret + size > arena.base_end_pointer_) {
+      return nullptr;
+    }
+  } while (!arena.pre_alloc_.compare_exchange_weak(pre_alloc, ret + size));
   // N.B. the shared memory is not pre-committed.
   *commit = false;
   return reinterpret_cast<void*>(ret);
@@ -18,6 +18,9 @@ limitations under the License.
 
 #if defined(WITH_JEMALLOC)
 
+#include <atomic>
+#include <vector>
+
 #include "server/memory/malloc.h"
 
 // forward declarations, to avoid include jemalloc/jemalloc.h.
@@ -33,7 +36,14 @@ class Jemalloc {
   Jemalloc();
   ~Jemalloc();
 
-  void* Init(void* space, const size_t size);
+  /**
+   * Creates `num_arenas` jemalloc arenas that carve extents from the same
+   * `space`. Each thread is bound to one of the arenas on its first
+   * allocation, so that allocations from different threads don't contend on
+   * a single arena lock. When the bound arena fails, the allocation falls
+   * back to the other arenas.
+   */
+  void* Init(void* space, const size_t size, const size_t num_arenas = 1);
 
   void* Allocate(const size_t bytes, const size_t alignment = Alignment);
 
@@ -51,15 +61,27 @@ class Jemalloc {
 
   static constexpr size_t Alignment = 1 * 1024 * 1024;  // 1MB
 
+  size_t Arenas() const { return arena_indices_.size(); }
+
   struct arena_t {
     uintptr_t base_pointer_ = reinterpret_cast<uintptr_t>(nullptr);
     uintptr_t base_end_pointer_ = reinterpret_cast<uintptr_t>(nullptr);
-    uintptr_t pre_alloc_ = reinterpret_cast<uintptr_t>(nullptr);
+    std::atomic<uintptr_t> pre_alloc_{reinterpret_cast<uintptr_t>(nullptr)};
+    // arenas created from the same space share the bump pointer of the
+    // first one.
+    unsigned space_index_ = 0;
   };
 
  private:
-  unsigned arena_index_;
-  int flags_ = 0;
+  int createArena(void* space, const size_t size, const int space_index);
+
+  // the index of the arena that the calling thread is bound to.
+  size_t slot() const;
+
+  int flags() const;
+
+  std::vector<unsigned> arena_indices_;
+  std::vector<int> flags_;
   extent_hooks_t* extent_hooks_ = nullptr;
 
   static void* theAllocHook(extent_hooks_t* extent_hooks, void* new_addr,
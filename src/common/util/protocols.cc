@@ -15,6 +15,7 @@ limitations under the License.
 
 #include "common/util/protocols.h"
 
+#include <cstring>
 #include <sstream>
 #include <unordered_set>
 
@@ -64,6 +65,8 @@ CommandType ParseCommandType(const std::string& str_type) {
     return CommandType::ListDataRequest;
   } else if (str_type == "create_buffer_request") {
     return CommandType::CreateBufferRequest;
+  } else if (str_type == "create_buffers_request") {
+    return CommandType::CreateBuffersRequest;
   } else if (str_type == "get_buffers_request") {
     return CommandType::GetBuffersRequest;
   } else if (str_type == "create_stream_request") {
@@ -74,6 +77,8 @@ CommandType ParseCommandType(const std::string& str_type) {
     return CommandType::PullNextStreamChunkRequest;
   } else if (str_type == "stop_stream_request") {
     return CommandType::StopStreamRequest;
+  } else if (str_type == "release_stream_chunks_request") {
+    return CommandType::ReleaseStreamChunksRequest;
   } else if (str_type == "put_name_request") {
     return CommandType::PutNameRequest;
   } else if (str_type == "get_name_request") {
@@ -113,42 +118,195 @@ static inline void encode_msg(const json& root, std::string& msg) {
   msg = json_to_string(root);
 }
 
+namespace detail {
+
+/**
+ * @brief Appends fixed-width fields to a binary message, see also
+ * `kBinaryMessageMagic`.
+ */
+class BinaryEncoder {
+ public:
+  BinaryEncoder(const CommandType type, std::string& msg) : msg_(msg) {
+    msg_.clear();
+    msg_.push_back(kBinaryMessageMagic);
+    put(static_cast<int32_t>(type));
+  }
+
+  void reserve(const size_t size) {
+    msg_.reserve(sizeof(char) + sizeof(int32_t) + size);
+  }
+
+  template <typename T>
+  void put(const T& value) {
+    msg_.append(reinterpret_cast<const char*>(&value), sizeof(T));
+  }
+
+  void put(const Payload& object) {
+    put(object.object_id);
+    put(static_cast<int32_t>(object.store_fd));
+    put(static_cast<int64_t>(object.data_offset));
+    put(object.data_size);
+    put(object.map_size);
+  }
+
+ private:
+  std::string& msg_;
+};
+
+/**
+ * @brief Reads fixed-width fields from a binary message and verifies the
+ * command type in the message header.
+ */
+class BinaryDecoder {
+ public:
+  explicit BinaryDecoder(const std::string& msg)
+      : msg_(msg), offset_(sizeof(char)) {}
+
+  Status expect(const CommandType type) {
+    RETURN_ON_ASSERT(IsBinaryMessage(msg_), "Not a binary message");
+    int32_t value = 0;
+    RETURN_ON_ERROR(get(value));
+    RETURN_ON_ASSERT(value == static_cast<int32_t>(type),
+                     "Unexpected binary message type");
+    return Status::OK();
+  }
+
+  template <typename T>
+  Status get(T& value) {
+    if (offset_ + sizeof(T) > msg_.size()) {
+      return Status::Invalid("Truncated binary message");
+    }
+    memcpy(&value, msg_.data() + offset_, sizeof(T));
+    offset_ += sizeof(T);
+    return Status::OK();
+  }
+
+  Status get(Payload& object) {
+    int32_t store_fd = -1;
+    int64_t data_offset = 0;
+    RETURN_ON_ERROR(get(object.object_id));
+    RETURN_ON_ERROR(get(store_fd));
+    RETURN_ON_ERROR(get(data_offset));
+    RETURN_ON_ERROR(get(object.data_size));
+    RETURN_ON_ERROR(get(object.map_size));
+    object.store_fd = store_fd;
+    object.data_offset = data_offset;
+    object.pointer = nullptr;
+    return Status::OK();
+  }
+
+  Status finish() const {
+    // the receivers (`recv_message` and `SocketConnection::doReadBody`)
+    // append a '\0' after the message body.
+    bool terminated = offset_ + 1 == msg_.size() && msg_[offset_] == '\0';
+    RETURN_ON_ASSERT(offset_ == msg_.size() || terminated,
+                     "Trailing bytes in message");
+    return Status::OK();
+  }
+
+ private:
+  const std::string& msg_;
+  size_t offset_;
+};
+
+// The sender guarantees the first byte of a JSON message is always '{'.
+static inline Status decode_json_msg(const std::string& msg, json& root) {
+  return CATCH_JSON_ERROR([&]() -> Status {
+    root = json::parse(msg);
+    return Status::OK();
+  }());
+}
+
+}  // namespace detail
+
+bool IsBinaryMessage(const std::string& msg) {
+  return !msg.empty() && msg[0] == kBinaryMessageMagic;
+}
+
+Status ReadBinaryCommandType(const std::string& msg, CommandType& type) {
+  RETURN_ON_ASSERT(IsBinaryMessage(msg), "Not a binary message");
+  int32_t value = 0;
+  detail::BinaryDecoder decoder(msg);
+  RETURN_ON_ERROR(decoder.get(value));
+  type = static_cast<CommandType>(value);
+  return Status::OK();
+}
+
 void WriteErrorReply(Status const& status, std::string& msg) {
   encode_msg(status.ToJSON(), msg);
 }
 
 void WriteRegisterRequest(std::string& msg) {
+  WriteRegisterRequest(false, false, msg);
+}
+
+void WriteRegisterRequest(const bool binary_protocol, const bool pipelined,
+                          std::string& msg) {
   json root;
   root["type"] = "register_request";
   root["version"] = vineyard_version();
+  if (binary_protocol) {
+    root["binary_protocol"] = true;
+  }
+  if (pipelined) {
+    root["pipelined"] = true;
+  }
 
   encode_msg(root, msg);
 }
 
 Status ReadRegisterRequest(const json& root, std::string& version) {
+  bool binary_protocol = false, pipelined = false;
+  return ReadRegisterRequest(root, version, binary_protocol, pipelined);
+}
+
+Status ReadRegisterRequest(const json& root, std::string& version,
+                           bool& binary_protocol, bool& pipelined) {
   RETURN_ON_ASSERT(root["type"] == "register_request");
 
   // When the "version" field is missing from the client, we treat it
   // as default unknown version number: 0.0.0.
   version = root.value<std::string>("version", "0.0.0");
+  binary_protocol = root.value("binary_protocol", false);
+  pipelined = root.value("pipelined", false);
   return Status::OK();
 }
 
 void WriteRegisterReply(const std::string& ipc_socket,
                         const std::string& rpc_endpoint,
                         const InstanceID instance_id, std::string& msg) {
+  WriteRegisterReply(ipc_socket, rpc_endpoint, instance_id, false, false,
+                     msg);
+}
+
+void WriteRegisterReply(const std::string& ipc_socket,
+                        const std::string& rpc_endpoint,
+                        const InstanceID instance_id,
+                        const bool binary_protocol, const bool pipelined,
+                        std::string& msg) {
   json root;
   root["type"] = "register_reply";
   root["ipc_socket"] = ipc_socket;
   root["rpc_endpoint"] = rpc_endpoint;
   root["instance_id"] = instance_id;
   root["version"] = vineyard_version();
+  root["binary_protocol"] = binary_protocol;
+  root["pipelined"] = pipelined;
   encode_msg(root, msg);
 }
 
 Status ReadRegisterReply(const json& root, std::string& ipc_socket,
                          std::string& rpc_endpoint, InstanceID& instance_id,
                          std::string& version) {
+  bool binary_protocol = false, pipelined = false;
+  return ReadRegisterReply(root, ipc_socket, rpc_endpoint, instance_id,
+                           version, binary_protocol, pipelined);
+}
+
+Status ReadRegisterReply(const json& root, std::string& ipc_socket,
+                         std::string& rpc_endpoint, InstanceID& instance_id,
+                         std::string& version, bool& binary_protocol,
+                         bool& pipelined) {
   CHECK_IPC_ERROR(root, "register_reply");
   ipc_socket = root["ipc_socket"].get_ref<std::string const&>();
   rpc_endpoint = root["rpc_endpoint"].get_ref<std::string const&>();
@@ -157,6 +315,10 @@ Status ReadRegisterReply(const json& root, std::string& ipc_socket,
   // When the "version" field is missing from the server, we treat it
   // as default unknown version number: 0.0.0.
   version = root.value<std::string>("version", "0.0.0");
+  // Servers that don't understand the binary protocol or pipelining won't set
+  // these fields.
+  binary_protocol = root.value("binary_protocol", false);
+  pipelined = root.value("pipelined", false);
   return Status::OK();
 }
 
@@ -283,6 +445,142 @@ Status ReadCreateBufferReply(const json& root, ObjectID& id, Payload& object) {
   return Status::OK();
 }
 
+void WriteCreateBufferRequestBinary(const size_t size, std::string& msg) {
+  detail::BinaryEncoder encoder(CommandType::CreateBufferRequest, msg);
+  encoder.put(static_cast<uint64_t>(size));
+}
+
+Status ReadCreateBufferRequestBinary(const std::string& msg, size_t& size) {
+  detail::BinaryDecoder decoder(msg);
+  RETURN_ON_ERROR(decoder.expect(CommandType::CreateBufferRequest));
+  uint64_t value = 0;
+  RETURN_ON_ERROR(decoder.get(value));
+  size = static_cast<size_t>(value);
+  return decoder.finish();
+}
+
+void WriteCreateBufferReplyBinary(const ObjectID id,
+                                  const std::shared_ptr<Payload>& object,
+                                  std::string& msg) {
+  detail::BinaryEncoder encoder(CommandType::CreateBufferRequest, msg);
+  encoder.put(id);
+  encoder.put(*object);
+}
+
+Status ReadCreateBufferReply(const std::string& msg, ObjectID& id,
+                             Payload& object) {
+  if (!IsBinaryMessage(msg)) {
+    json root;
+    RETURN_ON_ERROR(detail::decode_json_msg(msg, root));
+    return ReadCreateBufferReply(root, id, object);
+  }
+  detail::BinaryDecoder decoder(msg);
+  RETURN_ON_ERROR(decoder.expect(CommandType::CreateBufferRequest));
+  RETURN_ON_ERROR(decoder.get(id));
+  RETURN_ON_ERROR(decoder.get(object));
+  return decoder.finish();
+}
+
+void WriteCreateBuffersRequest(const std::vector<size_t>& sizes,
+                               std::string& msg) {
+  json root;
+  root["type"] = "create_buffers_request";
+  root["sizes"] = sizes;
+  root["num"] = sizes.size();
+
+  encode_msg(root, msg);
+}
+
+Status ReadCreateBuffersRequest(const json& root, std::vector<size_t>& sizes) {
+  RETURN_ON_ASSERT(root["type"] == "create_buffers_request");
+  sizes = root["sizes"].get<std::vector<size_t>>();
+  RETURN_ON_ASSERT(sizes.size() == root["num"].get<size_t>());
+  return Status::OK();
+}
+
+void WriteCreateBuffersReply(
+    const std::vector<std::shared_ptr<Payload>>& objects, std::string& msg) {
+  json root;
+  root["type"] = "create_buffers_reply";
+  for (size_t i = 0; i < objects.size(); ++i) {
+    json tree;
+    objects[i]->ToJSON(tree);
+    root[std::to_string(i)] = tree;
+  }
+  root["num"] = objects.size();
+
+  encode_msg(root, msg);
+}
+
+Status ReadCreateBuffersReply(const json& root, std::vector<Payload>& objects) {
+  CHECK_IPC_ERROR(root, "create_buffers_reply");
+  for (size_t i = 0; i < root["num"]; ++i) {
+    json tree = root[std::to_string(i)];
+    Payload object;
+    object.FromJSON(tree);
+    objects.emplace_back(object);
+  }
+  return Status::OK();
+}
+
+void WriteCreateBuffersRequestBinary(const std::vector<size_t>& sizes,
+                                     std::string& msg) {
+  detail::BinaryEncoder encoder(CommandType::CreateBuffersRequest, msg);
+  encoder.reserve(sizeof(uint64_t) * (sizes.size() + 1));
+  encoder.put(static_cast<uint64_t>(sizes.size()));
+  for (auto const size : sizes) {
+    encoder.put(static_cast<uint64_t>(size));
+  }
+}
+
+Status ReadCreateBuffersRequestBinary(const std::string& msg,
+                                      std::vector<size_t>& sizes) {
+  detail::BinaryDecoder decoder(msg);
+  RETURN_ON_ERROR(decoder.expect(CommandType::CreateBuffersRequest));
+  uint64_t num = 0;
+  RETURN_ON_ERROR(decoder.get(num));
+  RETURN_ON_ASSERT(num <= msg.size() / sizeof(uint64_t),
+                   "Invalid number of buffers in binary message");
+  sizes.reserve(sizes.size() + num);
+  for (uint64_t i = 0; i < num; ++i) {
+    uint64_t size = 0;
+    RETURN_ON_ERROR(decoder.get(size));
+    sizes.push_back(static_cast<size_t>(size));
+  }
+  return decoder.finish();
+}
+
+void WriteCreateBuffersReplyBinary(
+    const std::vector<std::shared_ptr<Payload>>& objects, std::string& msg) {
+  detail::BinaryEncoder encoder(CommandType::CreateBuffersRequest, msg);
+  encoder.put(static_cast<uint64_t>(objects.size()));
+  for (auto const& object : objects) {
+    encoder.put(*object);
+  }
+}
+
+Status ReadCreateBuffersReply(const std::string& msg,
+                              std::vector<Payload>& objects) {
+  if (!IsBinaryMessage(msg)) {
+    json root;
+    RETURN_ON_ERROR(detail::decode_json_msg(msg, root));
+    return ReadCreateBuffersReply(root, objects);
+  }
+  detail::BinaryDecoder decoder(msg);
+  RETURN_ON_ERROR(decoder.expect(CommandType::CreateBuffersRequest));
+  uint64_t num = 0;
+  RETURN_ON_ERROR(decoder.get(num));
+  RETURN_ON_ASSERT(num <= msg.size() / sizeof(ObjectID),
+                   "Invalid number of buffers in binary message");
+  objects.reserve(objects.size() + num);
+  for (uint64_t i = 0; i < num; ++i) {
+    Payload object;
+    RETURN_ON_ERROR(decoder.get(object));
+    objects.emplace_back(object);
+  }
+  return decoder.finish();
+}
+
 void WriteCreateRemoteBufferRequest(const size_t size, std::string& msg) {
   json root;
   root["type"] = "create_remote_buffer_request";
@@ -343,6 +641,64 @@ Status ReadGetBuffersReply(const json& root, std::vector<Payload>& objects) {
   return Status::OK();
 }
 
+void WriteGetBuffersRequestBinary(const std::set<ObjectID>& ids,
+                                  std::string& msg) {
+  detail::BinaryEncoder encoder(CommandType::GetBuffersRequest, msg);
+  encoder.reserve(sizeof(uint64_t) + ids.size() * sizeof(ObjectID));
+  encoder.put(static_cast<uint64_t>(ids.size()));
+  for (auto const& id : ids) {
+    encoder.put(id);
+  }
+}
+
+Status ReadGetBuffersRequestBinary(const std::string& msg,
+                                   std::vector<ObjectID>& ids) {
+  detail::BinaryDecoder decoder(msg);
+  RETURN_ON_ERROR(decoder.expect(CommandType::GetBuffersRequest));
+  uint64_t num = 0;
+  RETURN_ON_ERROR(decoder.get(num));
+  RETURN_ON_ASSERT(num <= msg.size() / sizeof(ObjectID),
+                   "Invalid number of buffers in binary message");
+  ids.reserve(ids.size() + num);
+  for (uint64_t i = 0; i < num; ++i) {
+    ObjectID id = InvalidObjectID();
+    RETURN_ON_ERROR(decoder.get(id));
+    ids.push_back(id);
+  }
+  return decoder.finish();
+}
+
+void WriteGetBuffersReplyBinary(
+    const std::vector<std::shared_ptr<Payload>>& objects, std::string& msg) {
+  detail::BinaryEncoder encoder(CommandType::GetBuffersRequest, msg);
+  encoder.put(static_cast<uint64_t>(objects.size()));
+  for (auto const& object : objects) {
+    encoder.put(*object);
+  }
+}
+
+Status ReadGetBuffersReply(const std::string& msg,
+                           std::vector<Payload>& objects) {
+  if (!IsBinaryMessage(msg)) {
+    json root;
+    RETURN_ON_ERROR(detail::decode_json_msg(msg, root));
+    return ReadGetBuffersReply(root, objects);
+  }
+  detail::BinaryDecoder decoder(msg);
+  RETURN_ON_ERROR(decoder.expect(CommandType::GetBuffersRequest));
+  uint64_t num = 0;
+  RETURN_ON_ERROR(decoder.get(num));
+  RETURN_ON_ASSERT(num <= msg.size() / sizeof(ObjectID),
+                   "Invalid number of buffers in binary message");
+  objects.reserve(objects.size() + num);
+  for (uint64_t i = 0; i < num; ++i) {
+    Payload object;
+    RETURN_ON_ERROR(decoder.get(object));
+    objects.emplace_back(object);
+  }
+  return decoder.finish();
+}
+
 void WriteGetRemoteBuffersRequest(const std::unordered_set<ObjectID>& ids,
                                   std::string& msg) {
   json root;
@@ -736,17 +1092,28 @@ Status ReadMigrateObjectReply(const json& root, ObjectID& object_id) {
   return Status::OK();
 }
 
-void WriteCreateStreamRequest(const ObjectID& object_id, std::string& msg) {
+void WriteCreateStreamRequest(const ObjectID& object_id,
+                              const StreamOptions& options, std::string& msg) {
   json root;
   root["type"] = "create_stream_request";
   root["object_id"] = object_id;
+  root["consumers"] = options.consumers;
+  root["max_chunks"] = options.max_chunks;
+  root["max_bytes"] = options.max_bytes;
+  root["pooled_chunks"] = options.pooled_chunks;
 
   encode_msg(root, msg);
 }
 
-Status ReadCreateStreamRequest(const json& root, ObjectID& object_id) {
+Status ReadCreateStreamRequest(const json& root, ObjectID& object_id,
+                               StreamOptions& options) {
   RETURN_ON_ASSERT(root["type"] == "create_stream_request");
   object_id = root["object_id"].get<ObjectID>();
+  options.consumers = root.value("consumers", static_cast<size_t>(1));
+  options.max_chunks = root.value("max_chunks", static_cast<size_t>(0));
+  options.max_bytes = root.value("max_bytes", static_cast<size_t>(0));
+  options.pooled_chunks =
+      root.value("pooled_chunks", StreamOptions{}.pooled_chunks);
   return Status::OK();
 }
 
@@ -763,20 +1130,22 @@ Status ReadCreateStreamReply(const json& root) {
 }
 
 void WriteOpenStreamRequest(const ObjectID& object_id, const int64_t& mode,
-                            std::string& msg) {
+                            const size_t retain_window, std::string& msg) {
   json root;
   root["type"] = "open_stream_request";
   root["object_id"] = object_id;
   root["mode"] = mode;
+  root["retain_window"] = retain_window;
 
   encode_msg(root, msg);
 }
 
 Status ReadOpenStreamRequest(const json& root, ObjectID& object_id,
-                             int64_t& mode) {
+                             int64_t& mode, size_t& retain_window) {
   RETURN_ON_ASSERT(root["type"] == "open_stream_request");
   object_id = root["object_id"].get<ObjectID>();
   mode = root["mode"].get<int64_t>();
+  retain_window = root.value("retain_window", static_cast<size_t>(0));
   return Status::OK();
 }
 
@@ -827,6 +1196,42 @@ Status ReadGetNextStreamChunkReply(const json& root, Payload& object) {
   return Status::OK();
 }
 
+void WriteGetNextStreamChunkRequestBinary(const ObjectID stream_id,
+                                          const size_t size, std::string& msg) {
+  detail::BinaryEncoder encoder(CommandType::GetNextStreamChunkRequest, msg);
+  encoder.put(stream_id);
+  encoder.put(static_cast<uint64_t>(size));
+}
+
+Status ReadGetNextStreamChunkRequestBinary(const std::string& msg,
+                                           ObjectID& stream_id, size_t& size) {
+  detail::BinaryDecoder decoder(msg);
+  RETURN_ON_ERROR(decoder.expect(CommandType::GetNextStreamChunkRequest));
+  uint64_t value = 0;
+  RETURN_ON_ERROR(decoder.get(stream_id));
+  RETURN_ON_ERROR(decoder.get(value));
+  size = static_cast<size_t>(value);
+  return decoder.finish();
+}
+
+void WriteGetNextStreamChunkReplyBinary(std::shared_ptr<Payload>& object,
+                                        std::string& msg) {
+  detail::BinaryEncoder encoder(CommandType::GetNextStreamChunkRequest, msg);
+  encoder.put(*object);
+}
+
+Status ReadGetNextStreamChunkReply(const std::string& msg, Payload& object) {
+  if (!IsBinaryMessage(msg)) {
+    json root;
+    RETURN_ON_ERROR(detail::decode_json_msg(msg, root));
+    return ReadGetNextStreamChunkReply(root, object);
+  }
+  detail::BinaryDecoder decoder(msg);
+  RETURN_ON_ERROR(decoder.expect(CommandType::GetNextStreamChunkRequest));
+  RETURN_ON_ERROR(decoder.get(object));
+  return decoder.finish();
+}
+
 void WritePullNextStreamChunkRequest(const ObjectID stream_id,
                                      std::string& msg) {
   json root;
@@ -843,22 +1248,61 @@ Status ReadPullNextStreamChunkRequest(const json& root, ObjectID& stream_id) {
 }
 
 void WritePullNextStreamChunkReply(std::shared_ptr<Payload>& object,
-                                   std::string& msg) {
+                                   const uint64_t sequence, std::string& msg) {
   json root;
   root["type"] = "pull_next_stream_chunk_reply";
   json buffer_meta;
   object->ToJSON(buffer_meta);
   root["buffer"] = buffer_meta;
+  root["sequence"] = sequence;
 
   encode_msg(root, msg);
 }
 
-Status ReadPullNextStreamChunkReply(const json& root, Payload& object) {
+Status ReadPullNextStreamChunkReply(const json& root, Payload& object,
+                                    uint64_t& sequence) {
   CHECK_IPC_ERROR(root, "pull_next_stream_chunk_reply");
   object.FromJSON(root["buffer"]);
+  sequence = root["sequence"].get<uint64_t>();
   return Status::OK();
 }
 
+void WritePullNextStreamChunkRequestBinary(const ObjectID stream_id,
+                                           std::string& msg) {
+  detail::BinaryEncoder encoder(CommandType::PullNextStreamChunkRequest, msg);
+  encoder.put(stream_id);
+}
+
+Status ReadPullNextStreamChunkRequestBinary(const std::string& msg,
+                                            ObjectID& stream_id) {
+  detail::BinaryDecoder decoder(msg);
+  RETURN_ON_ERROR(decoder.expect(CommandType::PullNextStreamChunkRequest));
+  RETURN_ON_ERROR(decoder.get(stream_id));
+  return decoder.finish();
+}
+
+void WritePullNextStreamChunkReplyBinary(std::shared_ptr<Payload>& object,
+                                         const uint64_t sequence,
+                                         std::string& msg) {
+  detail::BinaryEncoder encoder(CommandType::PullNextStreamChunkRequest, msg);
+  encoder.put(*object);
+  encoder.put(sequence);
+}
+
+Status ReadPullNextStreamChunkReply(const std::string& msg, Payload& object,
+                                    uint64_t& sequence) {
+  if (!IsBinaryMessage(msg)) {
+    json root;
+    RETURN_ON_ERROR(detail::decode_json_msg(msg, root));
+    return ReadPullNextStreamChunkReply(root, object, sequence);
+  }
+  detail::BinaryDecoder decoder(msg);
+  RETURN_ON_ERROR(decoder.expect(CommandType::PullNextStreamChunkRequest));
+  RETURN_ON_ERROR(decoder.get(object));
+  RETURN_ON_ERROR(decoder.get(sequence));
+  return decoder.finish();
+}
+
 void WriteStopStreamRequest(const ObjectID stream_id, const bool failed,
                             std::string& msg) {
   json root;
@@ -889,6 +1333,53 @@ Status ReadStopStreamReply(const json& root) {
   return Status::OK();
 }
 
+void WriteReleaseStreamChunksRequest(
+    const std::vector<std::tuple<ObjectID, ObjectID, uint64_t>>& chunks,
+    std::string& msg) {
+  json root;
+  root["type"] = "release_stream_chunks_request";
+  std::vector<ObjectID> stream_ids, chunk_ids;
+  std::vector<uint64_t> sequences;
+  for (auto const& chunk : chunks) {
+    stream_ids.emplace_back(std::get<0>(chunk));
+    chunk_ids.emplace_back(std::get<1>(chunk));
+    sequences.emplace_back(std::get<2>(chunk));
+  }
+  root["streams"] = stream_ids;
+  root["chunks"] = chunk_ids;
+  root["sequences"] = sequences;
+
+  encode_msg(root, msg);
+}
+
+Status ReadReleaseStreamChunksRequest(
+    const json& root,
+    std::vector<std::tuple<ObjectID, ObjectID, uint64_t>>& chunks) {
+  RETURN_ON_ASSERT(root["type"] == "release_stream_chunks_request");
+  auto stream_ids = root["streams"].get<std::vector<ObjectID>>();
+  auto chunk_ids = root["chunks"].get<std::vector<ObjectID>>();
+  auto sequences = root["sequences"].get<std::vector<uint64_t>>();
+  RETURN_ON_ASSERT(stream_ids.size() == chunk_ids.size() &&
+                   stream_ids.size() == sequences.size());
+  chunks.clear();
+  for (size_t i = 0; i < stream_ids.size(); ++i) {
+    chunks.emplace_back(stream_ids[i], chunk_ids[i], sequences[i]);
+  }
+  return Status::OK();
+}
+
+void WriteReleaseStreamChunksReply(std::string& msg) {
+  json root;
+  root["type"] = "release_stream_chunks_reply";
+
+  encode_msg(root, msg);
+}
+
+Status ReadReleaseStreamChunksReply(const json& root) {
+  CHECK_IPC_ERROR(root, "release_stream_chunks_reply");
+  return Status::OK();
+}
+
 void WriteShallowCopyRequest(const ObjectID id, std::string& msg) {
   json root;
   root["type"] = "shallow_copy_request";
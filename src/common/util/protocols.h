@@ -20,10 +20,13 @@ limitations under the License.
 #include <memory>
 #include <set>
 #include <string>
+#include <tuple>
 #include <unordered_map>
 #include <unordered_set>
+#include <utility>
 #include <vector>
 
+#include "basic/stream/stream_utils.h"
 #include "common/memory/payload.h"
 #include "common/util/boost.h"
 #include "common/util/json.h"
@@ -67,24 +70,78 @@ enum class CommandType {
   MakeArenaRequest = 33,
   FinalizeArenaRequest = 34,
   DeepCopyRequest = 35,
+  CreateBuffersRequest = 36,
+  ReleaseStreamChunksRequest = 37,
 };
 
 CommandType ParseCommandType(const std::string& str_type);
 
+/**
+ * @brief Besides JSON, the IPC protocol supports a compact binary encoding for
+ * the hot-path buffer and stream commands, which is negotiated during
+ * registration.
+ *
+ * Binary messages share the same length-prefixed framing with JSON messages
+ * and are distinguished by the leading magic byte, which never starts a valid
+ * JSON document. The fields are laid out in native byte order, as the binary
+ * encoding is only used over the UNIX domain socket. Errors are always
+ * replied in JSON.
+ */
+constexpr char kBinaryMessageMagic = '\x01';
+
+bool IsBinaryMessage(const std::string& msg);
+
+Status ReadBinaryCommandType(const std::string& msg, CommandType& type);
+
+/**
+ * @brief Pipelining is negotiated during registration as well. Once enabled,
+ * the messages after the register reply are tagged with request ids, so that
+ * many requests can be in flight on a single connection, and the replies can
+ * be matched out of order.
+ *
+ * A request is framed as `[size_t length][uint64_t request_id][body]`, and a
+ * reply as `[size_t length][uint64_t request_id][uint32_t fd_count]
+ * [int32_t fd]...[body]`, where `length` is the size of body, and the fds
+ * are the server-side file descriptors that will be sent right after the
+ * reply, in order.
+ */
+constexpr size_t kPipelinedRequestHeaderSize =
+    sizeof(size_t) + sizeof(uint64_t);
+
+constexpr size_t kPipelinedReplyHeaderSize =
+    sizeof(size_t) + sizeof(uint64_t) + sizeof(uint32_t);
+
 void WriteErrorReply(Status const& status, std::string& msg);
 
 void WriteRegisterRequest(std::string& msg);
 
+void WriteRegisterRequest(const bool binary_protocol, const bool pipelined,
+                          std::string& msg);
+
 Status ReadRegisterRequest(const json& msg, std::string& version);
 
+Status ReadRegisterRequest(const json& msg, std::string& version,
+                           bool& binary_protocol, bool& pipelined);
+
 void WriteRegisterReply(const std::string& ipc_socket,
                         const std::string& rpc_endpoint,
                         const InstanceID instance_id, std::string& msg);
 
+void WriteRegisterReply(const std::string& ipc_socket,
+                        const std::string& rpc_endpoint,
+                        const InstanceID instance_id,
+                        const bool binary_protocol, const bool pipelined,
+                        std::string& msg);
+
 Status ReadRegisterReply(const json& msg, std::string& ipc_socket,
                          std::string& rpc_endpoint, InstanceID& instance_id,
                          std::string& version);
 
+Status ReadRegisterReply(const json& msg, std::string& ipc_socket,
+                         std::string& rpc_endpoint, InstanceID& instance_id,
+                         std::string& version, bool& binary_protocol,
+                         bool& pipelined);
+
 void WriteExitRequest(std::string& msg);
 
 void WriteGetDataRequest(const ObjectID id, const bool sync_remote,
@@ -184,6 +241,51 @@ void WriteCreateBufferReply(const ObjectID id,
 
 Status ReadCreateBufferReply(const json& root, ObjectID& id, Payload& object);
 
+void WriteCreateBufferRequestBinary(const size_t size, std::string& msg);
+
+Status ReadCreateBufferRequestBinary(const std::string& msg, size_t& size);
+
+void WriteCreateBufferReplyBinary(const ObjectID id,
+                                  const std::shared_ptr<Payload>& object,
+                                  std::string& msg);
+
+/**
+ * @brief Read the reply of create buffer request, in either JSON or binary
+ * encoding.
+ */
+Status ReadCreateBufferReply(const std::string& msg, ObjectID& id,
+                             Payload& object);
+
+/**
+ * @brief Allocate a batch of buffers in a single request, the reply carries
+ * the payloads in the same order with the given sizes.
+ */
+void WriteCreateBuffersRequest(const std::vector<size_t>& sizes,
+                               std::string& msg);
+
+Status ReadCreateBuffersRequest(const json& root, std::vector<size_t>& sizes);
+
+void WriteCreateBuffersReply(
+    const std::vector<std::shared_ptr<Payload>>& objects, std::string& msg);
+
+Status ReadCreateBuffersReply(const json& root, std::vector<Payload>& objects);
+
+void WriteCreateBuffersRequestBinary(const std::vector<size_t>& sizes,
+                                     std::string& msg);
+
+Status ReadCreateBuffersRequestBinary(const std::string& msg,
+                                      std::vector<size_t>& sizes);
+
+void WriteCreateBuffersReplyBinary(
+    const std::vector<std::shared_ptr<Payload>>& objects, std::string& msg);
+
+/**
+ * @brief Read the reply of create buffers request, in either JSON or binary
+ * encoding.
+ */
+Status ReadCreateBuffersReply(const std::string& msg,
+                              std::vector<Payload>& objects);
+
 void WriteCreateRemoteBufferRequest(const size_t size, std::string& msg);
 
 Status ReadCreateRemoteBufferRequest(const json& root, size_t& size);
@@ -197,6 +299,22 @@ void WriteGetBuffersReply(const std::vector<std::shared_ptr<Payload>>& objects,
 
 Status ReadGetBuffersReply(const json& root, std::vector<Payload>& objects);
 
+void WriteGetBuffersRequestBinary(const std::set<ObjectID>& ids,
+                                  std::string& msg);
+
+Status ReadGetBuffersRequestBinary(const std::string& msg,
+                                   std::vector<ObjectID>& ids);
+
+void WriteGetBuffersReplyBinary(
+    const std::vector<std::shared_ptr<Payload>>& objects, std::string& msg);
+
+/**
+ * @brief Read the reply of get buffers request, in either JSON or binary
+ * encoding.
+ */
+Status ReadGetBuffersReply(const std::string& msg,
+                           std::vector<Payload>& objects);
+
 void WriteGetRemoteBuffersRequest(const std::unordered_set<ObjectID>& ids,
                                   std::string& msg);
 
@@ -251,19 +369,27 @@ void WriteMigrateObjectReply(const ObjectID& object_id, std::string& msg);
 
 Status ReadMigrateObjectReply(const json& root, ObjectID& object_id);
 
-void WriteCreateStreamRequest(const ObjectID& object_id, std::string& msg);
+void WriteCreateStreamRequest(const ObjectID& object_id,
+                              const StreamOptions& options, std::string& msg);
 
-Status ReadCreateStreamRequest(const json& root, ObjectID& object_id);
+Status ReadCreateStreamRequest(const json& root, ObjectID& object_id,
+                               StreamOptions& options);
 
 void WriteCreateStreamReply(std::string& msg);
 
 Status ReadCreateStreamReply(const json& root);
 
+/**
+ * @brief The `retain_window` of the reader, if positive, asks the server to
+ * keep the chunks that have been pulled until they are released by
+ * `ReleaseStreamChunksRequest`, or until more than `retain_window` chunks
+ * are outstanding.
+ */
 void WriteOpenStreamRequest(const ObjectID& object_id, const int64_t& mode,
-                            std::string& msg);
+                            const size_t retain_window, std::string& msg);
 
 Status ReadOpenStreamRequest(const json& root, ObjectID& object_id,
-                             int64_t& mode);
+                             int64_t& mode, size_t& retain_window);
 
 void WriteOpenStreamReply(std::string& msg);
 
@@ -280,15 +406,53 @@ void WriteGetNextStreamChunkReply(std::shared_ptr<Payload>& object,
 
 Status ReadGetNextStreamChunkReply(const json& root, Payload& object);
 
+void WriteGetNextStreamChunkRequestBinary(const ObjectID stream_id,
+                                          const size_t size, std::string& msg);
+
+Status ReadGetNextStreamChunkRequestBinary(const std::string& msg,
+                                           ObjectID& stream_id, size_t& size);
+
+void WriteGetNextStreamChunkReplyBinary(std::shared_ptr<Payload>& object,
+                                        std::string& msg);
+
+/**
+ * @brief Read the reply of get next stream chunk request, in either JSON or
+ * binary encoding.
+ */
+Status ReadGetNextStreamChunkReply(const std::string& msg, Payload& object);
+
 void WritePullNextStreamChunkRequest(const ObjectID stream_id,
                                      std::string& msg);
 
 Status ReadPullNextStreamChunkRequest(const json& root, ObjectID& stream_id);
 
+/**
+ * @brief The reply carries the sequence number of the chunk in the stream
+ * besides the chunk, which tags the release of the chunk, as the same chunk
+ * may be handed out again once it has been released and reused.
+ */
 void WritePullNextStreamChunkReply(std::shared_ptr<Payload>& object,
-                                   std::string& msg);
+                                   const uint64_t sequence, std::string& msg);
+
+Status ReadPullNextStreamChunkReply(const json& root, Payload& object,
+                                    uint64_t& sequence);
+
+void WritePullNextStreamChunkRequestBinary(const ObjectID stream_id,
+                                           std::string& msg);
+
+Status ReadPullNextStreamChunkRequestBinary(const std::string& msg,
+                                            ObjectID& stream_id);
 
-Status ReadPullNextStreamChunkReply(const json& root, Payload& object);
+void WritePullNextStreamChunkReplyBinary(std::shared_ptr<Payload>& object,
+                                         const uint64_t sequence,
+                                         std::string& msg);
+
+/**
+ * @brief Read the reply of pull next stream chunk request, in either JSON or
+ * binary encoding.
+ */
+Status ReadPullNextStreamChunkReply(const std::string& msg, Payload& object,
+                                    uint64_t& sequence);
 
 void WriteStopStreamRequest(const ObjectID stream_id, const bool failed,
                             std::string& msg);
@@ -300,6 +464,22 @@ void WriteStopStreamReply(std::string& msg);
 
 Status ReadStopStreamReply(const json& root);
 
+/**
+ * @brief The chunks to release are the (stream, chunk, sequence) tuples, see
+ * also `WritePullNextStreamChunkReply`.
+ */
+void WriteReleaseStreamChunksRequest(
+    const std::vector<std::tuple<ObjectID, ObjectID, uint64_t>>& chunks,
+    std::string& msg);
+
+Status ReadReleaseStreamChunksRequest(
+    const json& root,
+    std::vector<std::tuple<ObjectID, ObjectID, uint64_t>>& chunks);
+
+void WriteReleaseStreamChunksReply(std::string& msg);
+
+Status ReadReleaseStreamChunksReply(const json& root);
+
 void WriteShallowCopyRequest(const ObjectID id, std::string& msg);
 
 void WriteShallowCopyRequest(const ObjectID id, json const& extra_metadata,
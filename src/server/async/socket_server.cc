@@ -15,6 +15,7 @@ limitations under the License.
 
 #include "server/async/socket_server.h"
 
+#include <array>
 #include <limits>
 #include <memory>
 #include <string>
@@ -35,7 +36,10 @@ SocketConnection::SocketConnection(stream_protocol::socket socket,
     : socket_(std::move(socket)),
       server_ptr_(server_ptr),
       socket_server_ptr_(socket_server_ptr),
-      conn_id_(conn_id) {}
+      conn_id_(conn_id),
+      writing_(false),
+      pipelined_(false),
+      request_id_(0) {}
 
 bool SocketConnection::Start() {
   running_.store(true);
@@ -52,7 +56,13 @@ bool SocketConnection::Stop() {
 
   // do cleanup: clean up streams associated with this client
   for (auto stream_id : associated_streams_) {
-    VINEYARD_SUPPRESS(server_ptr_->GetStreamStore()->Drop(stream_id));
+    VINEYARD_SUPPRESS(server_ptr_->GetStreamStore()->Drop(stream_id, conn_id_));
+  }
+  {
+    std::lock_guard<std::mutex> lock(pinned_objects_mutex_);
+    server_ptr_->GetBulkStore()->Unpin(std::vector<ObjectID>(
+        pinned_objects_.begin(), pinned_objects_.end()));
+    pinned_objects_.clear();
   }
 
   // On Mac the state of socket may be "not connected" after the client has
@@ -67,14 +77,22 @@ bool SocketConnection::Stop() {
 
 void SocketConnection::doReadHeader() {
   auto self(this->shared_from_this());
-  asio::async_read(socket_, asio::buffer(&read_msg_header_, sizeof(size_t)),
-                   [this, self](boost::system::error_code ec, std::size_t) {
-                     if (!ec && running_.load()) {
-                       doReadBody();
-                     } else {
-                       doStop();
-                     }
-                   });
+  auto on_header = [this, self](boost::system::error_code ec, std::size_t) {
+    if (!ec && running_.load()) {
+      doReadBody();
+    } else {
+      doStop();
+    }
+  };
+  if (pipelined_) {
+    std::array<asio::mutable_buffer, 2> header = {
+        asio::buffer(&read_msg_header_, sizeof(size_t)),
+        asio::buffer(&request_id_, sizeof(uint64_t))};
+    asio::async_read(socket_, header, on_header);
+  } else {
+    asio::async_read(socket_, asio::buffer(&read_msg_header_, sizeof(size_t)),
+                     on_header);
+  }
 }
 
 void SocketConnection::doReadBody() {
@@ -166,6 +184,10 @@ void SocketConnection::doReadBody() {
 #endif  // RESPONSE_ON_ERROR
 
 bool SocketConnection::processMessage(const std::string& message_in) {
+  if (IsBinaryMessage(message_in)) {
+    return processBinaryMessage(message_in);
+  }
+
   json root;
   std::istringstream is(message_in);
 
@@ -187,6 +209,9 @@ bool SocketConnection::processMessage(const std::string& message_in) {
   case CommandType::CreateBufferRequest: {
     return doCreateBuffer(root);
   }
+  case CommandType::CreateBuffersRequest: {
+    return doCreateBuffers(root);
+  }
   case CommandType::CreateRemoteBufferRequest: {
     return doCreateRemoteBuffer(root);
   }
@@ -235,6 +260,9 @@ bool SocketConnection::processMessage(const std::string& message_in) {
   case CommandType::StopStreamRequest: {
     return doStopStream(root);
   }
+  case CommandType::ReleaseStreamChunksRequest: {
+    return doReleaseStreamChunks(root);
+  }
   case CommandType::PutNameRequest: {
     return doPutName(root);
   }
@@ -272,25 +300,83 @@ bool SocketConnection::processMessage(const std::string& message_in) {
   }
 }
 
+bool SocketConnection::processBinaryMessage(const std::string& message_in) {
+  CommandType cmd = CommandType::NullCommand;
+  auto status = ReadBinaryCommandType(message_in, cmd);
+  if (!status.ok()) {
+    std::string message_out;
+    WriteErrorReply(status, message_out);
+    this->doWrite(message_out);
+    return false;
+  }
+  switch (cmd) {
+  case CommandType::GetBuffersRequest: {
+    return doGetBuffersBinary(message_in);
+  }
+  case CommandType::CreateBufferRequest: {
+    return doCreateBufferBinary(message_in);
+  }
+  case CommandType::CreateBuffersRequest: {
+    return doCreateBuffersBinary(message_in);
+  }
+  case CommandType::GetNextStreamChunkRequest: {
+    return doGetNextStreamChunkBinary(message_in);
+  }
+  case CommandType::PullNextStreamChunkRequest: {
+    return doPullNextStreamChunkBinary(message_in);
+  }
+  default: {
+    LOG(ERROR) << "Got unexpected binary command: " << static_cast<int>(cmd);
+    std::string message_out;
+    WriteErrorReply(Status::Invalid("Unsupported binary command"), message_out);
+    this->doWrite(message_out);
+    return false;
+  }
+  }
+}
+
 bool SocketConnection::doRegister(const json& root) {
   auto self(shared_from_this());
   std::string client_version, message_out;
-  TRY_READ_REQUEST(ReadRegisterRequest, root, client_version);
+  bool binary_protocol = false, pipelined = false;
+  TRY_READ_REQUEST(ReadRegisterRequest, root, client_version, binary_protocol,
+                   pipelined);
   WriteRegisterReply(server_ptr_->IPCSocket(), server_ptr_->RPCEndpoint(),
-                     server_ptr_->instance_id(), message_out);
+                     server_ptr_->instance_id(), binary_protocol, pipelined,
+                     message_out);
   doWrite(message_out);
+  // the messages after the register reply are tagged with request ids.
+  pipelined_ = pipelined;
   return false;
 }
 
 bool SocketConnection::doGetBuffers(const json& root) {
   auto self(shared_from_this());
   std::vector<ObjectID> ids;
+  TRY_READ_REQUEST(ReadGetBuffersRequest, root, ids);
+  return getBuffersImpl(ids, false);
+}
+
+bool SocketConnection::doGetBuffersBinary(const std::string& message_in) {
+  auto self(shared_from_this());
+  std::vector<ObjectID> ids;
+  TRY_READ_REQUEST(ReadGetBuffersRequestBinary, message_in, ids);
+  return getBuffersImpl(ids, true);
+}
+
+bool SocketConnection::getBuffersImpl(std::vector<ObjectID> const& ids,
+                                      const bool binary) {
+  auto self(shared_from_this());
   std::vector<std::shared_ptr<Payload>> objects;
   std::string message_out;
 
-  TRY_READ_REQUEST(ReadGetBuffersRequest, root, ids);
+  pinObjects(ids);
   RESPONSE_ON_ERROR(server_ptr_->GetBulkStore()->Get(ids, objects));
-  WriteGetBuffersReply(objects, message_out);
+  if (binary) {
+    WriteGetBuffersReplyBinary(objects, message_out);
+  } else {
+    WriteGetBuffersReply(objects, message_out);
+  }
 
   /* NOTE: Here we send the file descriptor after the objects.
    *       We are using sendmsg to send the file descriptor
@@ -303,18 +389,7 @@ bool SocketConnection::doGetBuffers(const json& root) {
    *       We will examine other methods later, such as using
    *       explicit file descritors.
    */
-  this->doWrite(message_out, [self, objects](const Status& status) {
-    for (auto object : objects) {
-      int store_fd = object->store_fd;
-      int data_size = object->data_size;
-      if (data_size > 0 &&
-          self->used_fds_.find(store_fd) == self->used_fds_.end()) {
-        self->used_fds_.emplace(store_fd);
-        send_fd(self->nativeHandle(), store_fd);
-      }
-    }
-    return Status::OK();
-  });
+  this->doWrite(request_id_, message_out, payloadFds(objects));
   return false;
 }
 
@@ -347,6 +422,7 @@ bool SocketConnection::doGetRemoteBuffers(const json& root) {
   std::string message_out;
 
   TRY_READ_REQUEST(ReadGetBuffersRequest, root, ids);
+  pinObjects(ids);
   RESPONSE_ON_ERROR(server_ptr_->GetBulkStore()->Get(ids, objects));
   WriteGetBuffersReply(objects, message_out);
 
@@ -367,33 +443,85 @@ bool SocketConnection::doGetRemoteBuffers(const json& root) {
 bool SocketConnection::doCreateBuffer(const json& root) {
   auto self(shared_from_this());
   size_t size;
+  TRY_READ_REQUEST(ReadCreateBufferRequest, root, size);
+  return createBufferImpl(size, false);
+}
+
+bool SocketConnection::doCreateBufferBinary(const std::string& message_in) {
+  auto self(shared_from_this());
+  size_t size;
+  TRY_READ_REQUEST(ReadCreateBufferRequestBinary, message_in, size);
+  return createBufferImpl(size, true);
+}
+
+bool SocketConnection::createBufferImpl(const size_t size, const bool binary) {
+  auto self(shared_from_this());
   std::shared_ptr<Payload> object;
   std::string message_out;
 
-  TRY_READ_REQUEST(ReadCreateBufferRequest, root, size);
   ObjectID object_id;
   RESPONSE_ON_ERROR(
       server_ptr_->GetBulkStore()->Create(size, object_id, object));
-  WriteCreateBufferReply(object_id, object, message_out);
-
-  int store_fd = object->store_fd;
-  int data_size = object->data_size;
-  this->doWrite(
-      message_out, [this, self, store_fd, data_size](const Status& status) {
-        if (data_size > 0 &&
-            self->used_fds_.find(store_fd) == self->used_fds_.end()) {
-          self->used_fds_.emplace(store_fd);
-          send_fd(self->nativeHandle(), store_fd);
-        }
-        LOG_SUMMARY("instances_memory_usage_bytes", server_ptr_->instance_id(),
-                    server_ptr_->GetBulkStore()->Footprint());
-        return Status::OK();
-      });
+  pinObjects({object_id});
+  if (binary) {
+    WriteCreateBufferReplyBinary(object_id, object, message_out);
+  } else {
+    WriteCreateBufferReply(object_id, object, message_out);
+  }
+
+  this->doWrite(request_id_, message_out, payloadFds({object}),
+                [this, self](const Status& status) {
+                  LOG_SUMMARY("instances_memory_usage_bytes",
+                              server_ptr_->instance_id(),
+                              server_ptr_->GetBulkStore()->Footprint());
+                  return Status::OK();
+                });
+  return false;
+}
+
+bool SocketConnection::doCreateBuffers(const json& root) {
+  auto self(shared_from_this());
+  std::vector<size_t> sizes;
+  TRY_READ_REQUEST(ReadCreateBuffersRequest, root, sizes);
+  return createBuffersImpl(sizes, false);
+}
+
+bool SocketConnection::doCreateBuffersBinary(const std::string& message_in) {
+  auto self(shared_from_this());
+  std::vector<size_t> sizes;
+  TRY_READ_REQUEST(ReadCreateBuffersRequestBinary, message_in, sizes);
+  return createBuffersImpl(sizes, true);
+}
+
+bool SocketConnection::createBuffersImpl(std::vector<size_t> const& sizes,
+                                         const bool binary) {
+  auto self(shared_from_this());
+  std::vector<ObjectID> object_ids;
+  std::vector<std::shared_ptr<Payload>> objects;
+  std::string message_out;
+
+  RESPONSE_ON_ERROR(
+      server_ptr_->GetBulkStore()->Create(sizes, object_ids, objects));
+  pinObjects(object_ids);
+  if (binary) {
+    WriteCreateBuffersReplyBinary(objects, message_out);
+  } else {
+    WriteCreateBuffersReply(objects, message_out);
+  }
+
+  this->doWrite(request_id_, message_out, payloadFds(objects),
+                [this, self](const Status& status) {
+                  LOG_SUMMARY("instances_memory_usage_bytes",
+                              server_ptr_->instance_id(),
+                              server_ptr_->GetBulkStore()->Footprint());
+                  return Status::OK();
+                });
   return false;
 }
 
 bool SocketConnection::doCreateRemoteBuffer(const json& root) {
   auto self(shared_from_this());
+  const uint64_t request_id = request_id_;
   size_t size;
   std::shared_ptr<Payload> object;
 
@@ -404,7 +532,8 @@ bool SocketConnection::doCreateRemoteBuffer(const json& root) {
 
   asio::async_read(
       socket_, asio::buffer(object->pointer, size),
-      [this, self, &object](boost::system::error_code ec, std::size_t size) {
+      [this, self, request_id, object](boost::system::error_code ec,
+                                       std::size_t size) {
         std::string message_out;
         if (static_cast<size_t>(object->data_size) == size &&
             (!ec || ec == asio::error::eof)) {
@@ -420,7 +549,7 @@ bool SocketConnection::doCreateRemoteBuffer(const json& root) {
             WriteErrorReply(Status::IOError(ec.message()), message_out);
           }
         }
-        self->doWrite(message_out);
+        self->doWrite(request_id, message_out);
         LOG_SUMMARY("instances_memory_usage_bytes", server_ptr_->instance_id(),
                     server_ptr_->GetBulkStore()->Footprint());
       });
@@ -431,6 +560,7 @@ bool SocketConnection::doDropBuffer(const json& root) {
   auto self(shared_from_this());
   ObjectID object_id = InvalidObjectID();
   TRY_READ_REQUEST(ReadDropBufferRequest, root, object_id);
+  unpinObject(object_id);
   auto status = server_ptr_->GetBulkStore()->Delete(object_id);
   std::string message_out;
   if (status.ok()) {
@@ -446,6 +576,7 @@ bool SocketConnection::doDropBuffer(const json& root) {
 
 bool SocketConnection::doGetData(const json& root) {
   auto self(shared_from_this());
+  const uint64_t request_id = request_id_;
   std::vector<ObjectID> ids;
   bool sync_remote = false, wait = false;
   double startTime = GetCurrentTime();
@@ -453,7 +584,7 @@ bool SocketConnection::doGetData(const json& root) {
   json tree;
   RESPONSE_ON_ERROR(server_ptr_->GetData(
       ids, sync_remote, wait, [self]() { return self->running_.load(); },
-      [self, startTime](const Status& status, const json& tree) {
+      [self, request_id, startTime](const Status& status, const json& tree) {
         std::string message_out;
         if (status.ok()) {
           WriteGetDataReply(tree, message_out);
@@ -461,7 +592,7 @@ bool SocketConnection::doGetData(const json& root) {
           LOG(ERROR) << status.ToString();
           WriteErrorReply(status, message_out);
         }
-        self->doWrite(message_out);
+        self->doWrite(request_id, message_out);
         double endTime = GetCurrentTime();
         LOG_SUMMARY("data_request_duration_microseconds", "get",
                     (endTime - startTime) * 1000000);
@@ -473,12 +604,14 @@ bool SocketConnection::doGetData(const json& root) {
 
 bool SocketConnection::doListData(const json& root) {
   auto self(shared_from_this());
+  const uint64_t request_id = request_id_;
   std::string pattern;
   bool regex;
   size_t limit;
   TRY_READ_REQUEST(ReadListDataRequest, root, pattern, regex, limit);
   RESPONSE_ON_ERROR(server_ptr_->ListData(
-      pattern, regex, limit, [self](const Status& status, const json& tree) {
+      pattern, regex, limit,
+      [self, request_id](const Status& status, const json& tree) {
         std::string message_out;
         if (status.ok()) {
           WriteGetDataReply(tree, message_out);
@@ -486,7 +619,7 @@ bool SocketConnection::doListData(const json& root) {
           LOG(ERROR) << status.ToString();
           WriteErrorReply(status, message_out);
         }
-        self->doWrite(message_out);
+        self->doWrite(request_id, message_out);
         return Status::OK();
       }));
   return false;
@@ -494,13 +627,14 @@ bool SocketConnection::doListData(const json& root) {
 
 bool SocketConnection::doCreateData(const json& root) {
   auto self(shared_from_this());
+  const uint64_t request_id = request_id_;
   json tree;
   double startTime = GetCurrentTime();
   TRY_READ_REQUEST(ReadCreateDataRequest, root, tree);
   RESPONSE_ON_ERROR(server_ptr_->CreateData(
-      tree, [tree, self, startTime](const Status& status, const ObjectID id,
-                                    const Signature signature,
-                                    const InstanceID instance_id) {
+      tree, [tree, self, request_id, startTime](
+                const Status& status, const ObjectID id,
+                const Signature signature, const InstanceID instance_id) {
         std::string message_out;
         if (status.ok()) {
           WriteCreateDataReply(id, signature, instance_id, message_out);
@@ -508,7 +642,7 @@ bool SocketConnection::doCreateData(const json& root) {
           LOG(ERROR) << status.ToString();
           WriteErrorReply(status, message_out);
         }
-        self->doWrite(message_out);
+        self->doWrite(request_id, message_out);
         double endTime = GetCurrentTime();
         LOG_SUMMARY("data_request_duration_microseconds", "create",
                     (endTime - startTime) * 1000000);
@@ -524,28 +658,31 @@ bool SocketConnection::doCreateData(const json& root) {
 
 bool SocketConnection::doPersist(const json& root) {
   auto self(shared_from_this());
+  const uint64_t request_id = request_id_;
   ObjectID id;
   TRY_READ_REQUEST(ReadPersistRequest, root, id);
-  RESPONSE_ON_ERROR(server_ptr_->Persist(id, [self](const Status& status) {
-    std::string message_out;
-    if (status.ok()) {
-      WritePersistReply(message_out);
-    } else {
-      LOG(ERROR) << status.ToString();
-      WriteErrorReply(status, message_out);
-    }
-    self->doWrite(message_out);
-    return Status::OK();
-  }));
+  RESPONSE_ON_ERROR(server_ptr_->Persist(
+      id, [self, request_id](const Status& status) {
+        std::string message_out;
+        if (status.ok()) {
+          WritePersistReply(message_out);
+        } else {
+          LOG(ERROR) << status.ToString();
+          WriteErrorReply(status, message_out);
+        }
+        self->doWrite(request_id, message_out);
+        return Status::OK();
+      }));
   return false;
 }
 
 bool SocketConnection::doIfPersist(const json& root) {
   auto self(shared_from_this());
+  const uint64_t request_id = request_id_;
   ObjectID id;
   TRY_READ_REQUEST(ReadIfPersistRequest, root, id);
   RESPONSE_ON_ERROR(server_ptr_->IfPersist(
-      id, [self](const Status& status, bool const persist) {
+      id, [self, request_id](const Status& status, bool const persist) {
         std::string message_out;
         if (status.ok()) {
           WriteIfPersistReply(persist, message_out);
@@ -553,7 +690,7 @@ bool SocketConnection::doIfPersist(const json& root) {
           LOG(ERROR) << status.ToString();
           WriteErrorReply(status, message_out);
         }
-        self->doWrite(message_out);
+        self->doWrite(request_id, message_out);
         return Status::OK();
       }));
   return false;
@@ -561,10 +698,12 @@ bool SocketConnection::doIfPersist(const json& root) {
 
 bool SocketConnection::doExists(const json& root) {
   auto self(shared_from_this());
+  const uint64_t request_id = request_id_;
   ObjectID id;
   TRY_READ_REQUEST(ReadExistsRequest, root, id);
   RESPONSE_ON_ERROR(
-      server_ptr_->Exists(id, [self](const Status& status, bool const exists) {
+      server_ptr_->Exists(id, [self, request_id](const Status& status,
+                                                 bool const exists) {
         std::string message_out;
         if (status.ok()) {
           WriteExistsReply(exists, message_out);
@@ -572,7 +711,7 @@ bool SocketConnection::doExists(const json& root) {
           LOG(ERROR) << status.ToString();
           WriteErrorReply(status, message_out);
         }
-        self->doWrite(message_out);
+        self->doWrite(request_id, message_out);
         return Status::OK();
       }));
   return false;
@@ -580,11 +719,13 @@ bool SocketConnection::doExists(const json& root) {
 
 bool SocketConnection::doShallowCopy(const json& root) {
   auto self(shared_from_this());
+  const uint64_t request_id = request_id_;
   ObjectID id;
   json extra_metadata;
   TRY_READ_REQUEST(ReadShallowCopyRequest, root, id, extra_metadata);
   RESPONSE_ON_ERROR(server_ptr_->ShallowCopy(
-      id, extra_metadata, [self](const Status& status, const ObjectID target) {
+      id, extra_metadata,
+      [self, request_id](const Status& status, const ObjectID target) {
         std::string message_out;
         if (status.ok()) {
           WriteShallowCopyReply(target, message_out);
@@ -592,7 +733,7 @@ bool SocketConnection::doShallowCopy(const json& root) {
           LOG(ERROR) << status.ToString();
           WriteErrorReply(status, message_out);
         }
-        self->doWrite(message_out);
+        self->doWrite(request_id, message_out);
         return Status::OK();
       }));
   return false;
@@ -600,13 +741,14 @@ bool SocketConnection::doShallowCopy(const json& root) {
 
 bool SocketConnection::doDeepCopy(const json& root) {
   auto self(shared_from_this());
+  const uint64_t request_id = request_id_;
   ObjectID object_id;
   std::string peer, peer_rpc_endpoint;
   TRY_READ_REQUEST(ReadDeepCopyRequest, root, object_id, peer,
                    peer_rpc_endpoint);
   RESPONSE_ON_ERROR(server_ptr_->DeepCopy(
       object_id, peer, peer_rpc_endpoint,
-      [self](const Status& status, const ObjectID& target) {
+      [self, request_id](const Status& status, const ObjectID& target) {
         std::string message_out;
         if (status.ok()) {
           WriteDeepCopyReply(target, message_out);
@@ -614,7 +756,7 @@ bool SocketConnection::doDeepCopy(const json& root) {
           LOG(ERROR) << "Failed to Deep Copy object: " << status.ToString();
           WriteErrorReply(status, message_out);
         }
-        self->doWrite(message_out);
+        self->doWrite(request_id, message_out);
         return Status::OK();
       }));
   return false;
@@ -622,12 +764,14 @@ bool SocketConnection::doDeepCopy(const json& root) {
 
 bool SocketConnection::doDelData(const json& root) {
   auto self(shared_from_this());
+  const uint64_t request_id = request_id_;
   std::vector<ObjectID> ids;
   bool force, deep, fastpath;
   double startTime = GetCurrentTime();
   TRY_READ_REQUEST(ReadDelDataRequest, root, ids, force, deep, fastpath);
   RESPONSE_ON_ERROR(server_ptr_->DelData(
-      ids, force, deep, fastpath, [self, startTime](const Status& status) {
+      ids, force, deep, fastpath,
+      [self, request_id, startTime](const Status& status) {
         std::string message_out;
         if (status.ok()) {
           WriteDelDataReply(message_out);
@@ -635,7 +779,7 @@ bool SocketConnection::doDelData(const json& root) {
           LOG(ERROR) << status.ToString();
           WriteErrorReply(status, message_out);
         }
-        self->doWrite(message_out);
+        self->doWrite(request_id, message_out);
         double endTime = GetCurrentTime();
         LOG_SUMMARY("data_request_duration_microseconds", "delete",
                     (endTime - startTime) * 1000000);
@@ -648,8 +792,9 @@ bool SocketConnection::doDelData(const json& root) {
 bool SocketConnection::doCreateStream(const json& root) {
   auto self(shared_from_this());
   ObjectID stream_id;
-  TRY_READ_REQUEST(ReadCreateStreamRequest, root, stream_id);
-  auto status = server_ptr_->GetStreamStore()->Create(stream_id);
+  StreamOptions options;
+  TRY_READ_REQUEST(ReadCreateStreamRequest, root, stream_id, options);
+  auto status = server_ptr_->GetStreamStore()->Create(stream_id, options);
   std::string message_out;
   if (status.ok()) {
     WriteCreateStreamReply(message_out);
@@ -665,8 +810,14 @@ bool SocketConnection::doOpenStream(const json& root) {
   auto self(shared_from_this());
   ObjectID stream_id;
   int64_t mode;
-  TRY_READ_REQUEST(ReadOpenStreamRequest, root, stream_id, mode);
-  auto status = server_ptr_->GetStreamStore()->Open(stream_id, mode);
+  size_t retain_window;
+  TRY_READ_REQUEST(ReadOpenStreamRequest, root, stream_id, mode,
+                   retain_window);
+  if (mode & static_cast<int64_t>(OpenStreamMode::read)) {
+    this->associated_streams_.emplace(stream_id);
+  }
+  auto status = server_ptr_->GetStreamStore()->Open(stream_id, mode,
+                                                    retain_window, conn_id_);
   std::string message_out;
   if (status.ok()) {
     WriteOpenStreamReply(message_out);
@@ -683,29 +834,44 @@ bool SocketConnection::doGetNextStreamChunk(const json& root) {
   ObjectID stream_id;
   size_t size;
   TRY_READ_REQUEST(ReadGetNextStreamChunkRequest, root, stream_id, size);
+  return getNextStreamChunkImpl(stream_id, size, false);
+}
+
+bool SocketConnection::doGetNextStreamChunkBinary(
+    const std::string& message_in) {
+  auto self(shared_from_this());
+  ObjectID stream_id;
+  size_t size;
+  TRY_READ_REQUEST(ReadGetNextStreamChunkRequestBinary, message_in, stream_id,
+                   size);
+  return getNextStreamChunkImpl(stream_id, size, true);
+}
+
+bool SocketConnection::getNextStreamChunkImpl(const ObjectID stream_id,
+                                              const size_t size,
+                                              const bool binary) {
+  auto self(shared_from_this());
+  const uint64_t request_id = request_id_;
   RESPONSE_ON_ERROR(server_ptr_->GetStreamStore()->Get(
-      stream_id, size, [self](const Status& status, const ObjectID chunk) {
+      stream_id, size,
+      [self, request_id, binary](const Status& status, const ObjectID chunk) {
         std::string message_out;
-        if (status.ok()) {
-          std::shared_ptr<Payload> object;
-          RETURN_ON_ERROR(
-              self->server_ptr_->GetBulkStore()->Get(chunk, object));
-          WriteGetNextStreamChunkReply(object, message_out);
-          int store_fd = object->store_fd;
-          int data_size = object->data_size;
-          self->doWrite(
-              message_out, [self, store_fd, data_size](const Status& status) {
-                if (data_size > 0 &&
-                    self->used_fds_.find(store_fd) == self->used_fds_.end()) {
-                  self->used_fds_.emplace(store_fd);
-                  send_fd(self->nativeHandle(), store_fd);
-                }
-                return Status::OK();
-              });
+        std::shared_ptr<Payload> object;
+        Status s = status;
+        if (s.ok()) {
+          s = self->server_ptr_->GetBulkStore()->Get(chunk, object);
+        }
+        if (s.ok()) {
+          if (binary) {
+            WriteGetNextStreamChunkReplyBinary(object, message_out);
+          } else {
+            WriteGetNextStreamChunkReply(object, message_out);
+          }
+          self->doWrite(request_id, message_out, payloadFds({object}));
         } else {
-          LOG(ERROR) << status.ToString();
-          WriteErrorReply(status, message_out);
-          self->doWrite(message_out);
+          LOG(ERROR) << s.ToString();
+          WriteErrorReply(s, message_out);
+          self->doWrite(request_id, message_out);
         }
         return Status::OK();
       }));
@@ -716,32 +882,46 @@ bool SocketConnection::doPullNextStreamChunk(const json& root) {
   auto self(shared_from_this());
   ObjectID stream_id;
   TRY_READ_REQUEST(ReadPullNextStreamChunkRequest, root, stream_id);
+  return pullNextStreamChunkImpl(stream_id, false);
+}
+
+bool SocketConnection::doPullNextStreamChunkBinary(
+    const std::string& message_in) {
+  auto self(shared_from_this());
+  ObjectID stream_id;
+  TRY_READ_REQUEST(ReadPullNextStreamChunkRequestBinary, message_in, stream_id);
+  return pullNextStreamChunkImpl(stream_id, true);
+}
+
+bool SocketConnection::pullNextStreamChunkImpl(const ObjectID stream_id,
+                                               const bool binary) {
+  auto self(shared_from_this());
+  const uint64_t request_id = request_id_;
   this->associated_streams_.emplace(stream_id);
   RESPONSE_ON_ERROR(server_ptr_->GetStreamStore()->Pull(
-      stream_id, [self](const Status& status, const ObjectID chunk) {
+      stream_id, conn_id_,
+      [self, request_id, binary](const Status& status, const ObjectID chunk,
+                                 const uint64_t sequence) {
         std::string message_out;
-        if (status.ok()) {
-          std::shared_ptr<Payload> object;
-          RETURN_ON_ERROR(
-              self->server_ptr_->GetBulkStore()->Get(chunk, object));
-          WritePullNextStreamChunkReply(object, message_out);
-          int store_fd = object->store_fd;
-          int data_size = object->data_size;
-          self->doWrite(
-              message_out, [self, store_fd, data_size](const Status& status) {
-                if (data_size > 0 &&
-                    self->used_fds_.find(store_fd) == self->used_fds_.end()) {
-                  self->used_fds_.emplace(store_fd);
-                  send_fd(self->nativeHandle(), store_fd);
-                }
-                return Status::OK();
-              });
+        std::shared_ptr<Payload> object;
+        Status s = status;
+        if (s.ok()) {
+          s = self->server_ptr_->GetBulkStore()->Get(chunk, object);
+        }
+        if (s.ok()) {
+          if (binary) {
+            WritePullNextStreamChunkReplyBinary(object, sequence,
+                                                message_out);
+          } else {
+            WritePullNextStreamChunkReply(object, sequence, message_out);
+          }
+          self->doWrite(request_id, message_out, payloadFds({object}));
         } else {
-          if (!status.IsStreamDrained()) {
-            LOG(ERROR) << status.ToString();
+          if (!s.IsStreamDrained()) {
+            LOG(ERROR) << s.ToString();
           }
-          WriteErrorReply(status, message_out);
-          self->doWrite(message_out);
+          WriteErrorReply(s, message_out);
+          self->doWrite(request_id, message_out);
         }
         return Status::OK();
       }));
@@ -762,13 +942,28 @@ bool SocketConnection::doStopStream(const json& root) {
   return false;
 }
 
+bool SocketConnection::doReleaseStreamChunks(const json& root) {
+  auto self(shared_from_this());
+  std::vector<std::tuple<ObjectID, ObjectID, uint64_t>> chunks;
+  TRY_READ_REQUEST(ReadReleaseStreamChunksRequest, root, chunks);
+  for (auto const& chunk : chunks) {
+    RESPONSE_ON_ERROR(server_ptr_->GetStreamStore()->Release(
+        std::get<0>(chunk), conn_id_, std::get<1>(chunk), std::get<2>(chunk)));
+  }
+  std::string message_out;
+  WriteReleaseStreamChunksReply(message_out);
+  this->doWrite(message_out);
+  return false;
+}
+
 bool SocketConnection::doPutName(const json& root) {
   auto self(shared_from_this());
+  const uint64_t request_id = request_id_;
   ObjectID object_id;
   std::string name;
   TRY_READ_REQUEST(ReadPutNameRequest, root, object_id, name);
-  RESPONSE_ON_ERROR(
-      server_ptr_->PutName(object_id, name, [self](const Status& status) {
+  RESPONSE_ON_ERROR(server_ptr_->PutName(
+      object_id, name, [self, request_id](const Status& status) {
         std::string message_out;
         if (status.ok()) {
           WritePutNameReply(message_out);
@@ -776,7 +971,7 @@ bool SocketConnection::doPutName(const json& root) {
           LOG(ERROR) << "Failed to put name: " << status.ToString();
           WriteErrorReply(status, message_out);
         }
-        self->doWrite(message_out);
+        self->doWrite(request_id, message_out);
         return Status::OK();
       }));
   return false;
@@ -784,12 +979,13 @@ bool SocketConnection::doPutName(const json& root) {
 
 bool SocketConnection::doGetName(const json& root) {
   auto self(shared_from_this());
+  const uint64_t request_id = request_id_;
   std::string name;
   bool wait;
   TRY_READ_REQUEST(ReadGetNameRequest, root, name, wait);
   RESPONSE_ON_ERROR(server_ptr_->GetName(
       name, wait, [self]() { return self->running_.load(); },
-      [self](const Status& status, const ObjectID& object_id) {
+      [self, request_id](const Status& status, const ObjectID& object_id) {
         std::string message_out;
         if (status.ok()) {
           WriteGetNameReply(object_id, message_out);
@@ -797,7 +993,7 @@ bool SocketConnection::doGetName(const json& root) {
           LOG(ERROR) << "Failed to get name: " << status.ToString();
           WriteErrorReply(status, message_out);
         }
-        self->doWrite(message_out);
+        self->doWrite(request_id, message_out);
         return Status::OK();
       }));
   return false;
@@ -805,25 +1001,28 @@ bool SocketConnection::doGetName(const json& root) {
 
 bool SocketConnection::doDropName(const json& root) {
   auto self(shared_from_this());
+  const uint64_t request_id = request_id_;
   std::string name;
   TRY_READ_REQUEST(ReadDropNameRequest, root, name);
-  RESPONSE_ON_ERROR(server_ptr_->DropName(name, [self](const Status& status) {
-    std::string message_out;
-    LOG(INFO) << "drop name callback: " << status;
-    if (status.ok()) {
-      WriteDropNameReply(message_out);
-    } else {
-      LOG(ERROR) << "Failed to drop name: " << status.ToString();
-      WriteErrorReply(status, message_out);
-    }
-    self->doWrite(message_out);
-    return Status::OK();
-  }));
+  RESPONSE_ON_ERROR(server_ptr_->DropName(
+      name, [self, request_id](const Status& status) {
+        std::string message_out;
+        LOG(INFO) << "drop name callback: " << status;
+        if (status.ok()) {
+          WriteDropNameReply(message_out);
+        } else {
+          LOG(ERROR) << "Failed to drop name: " << status.ToString();
+          WriteErrorReply(status, message_out);
+        }
+        self->doWrite(request_id, message_out);
+        return Status::OK();
+      }));
   return false;
 }
 
 bool SocketConnection::doMigrateObject(const json& root) {
   auto self(shared_from_this());
+  const uint64_t request_id = request_id_;
   ObjectID object_id;
   bool local;
   bool is_stream;
@@ -833,7 +1032,7 @@ bool SocketConnection::doMigrateObject(const json& root) {
   if (is_stream) {
     RESPONSE_ON_ERROR(server_ptr_->MigrateStream(
         object_id, local, peer, peer_rpc_endpoint,
-        [self](const Status& status, const ObjectID& target) {
+        [self, request_id](const Status& status, const ObjectID& target) {
           std::string message_out;
           if (status.ok()) {
             WriteMigrateObjectReply(target, message_out);
@@ -842,13 +1041,13 @@ bool SocketConnection::doMigrateObject(const json& root) {
                        << status.ToString();
             WriteErrorReply(status, message_out);
           }
-          self->doWrite(message_out);
+          self->doWrite(request_id, message_out);
           return Status::OK();
         }));
   } else {
     RESPONSE_ON_ERROR(server_ptr_->MigrateObject(
         object_id, local, peer, peer_rpc_endpoint,
-        [self](const Status& status, const ObjectID& target) {
+        [self, request_id](const Status& status, const ObjectID& target) {
           std::string message_out;
           if (status.ok()) {
             WriteMigrateObjectReply(target, message_out);
@@ -856,7 +1055,7 @@ bool SocketConnection::doMigrateObject(const json& root) {
             LOG(ERROR) << "Failed to migrate object: " << status.ToString();
             WriteErrorReply(status, message_out);
           }
-          self->doWrite(message_out);
+          self->doWrite(request_id, message_out);
           return Status::OK();
         }));
   }
@@ -865,9 +1064,11 @@ bool SocketConnection::doMigrateObject(const json& root) {
 
 bool SocketConnection::doClusterMeta(const json& root) {
   auto self(shared_from_this());
+  const uint64_t request_id = request_id_;
   TRY_READ_REQUEST(ReadClusterMetaRequest, root);
   RESPONSE_ON_ERROR(
-      server_ptr_->ClusterInfo([self](const Status& status, const json& tree) {
+      server_ptr_->ClusterInfo([self, request_id](const Status& status,
+                                                  const json& tree) {
         std::string message_out;
         if (status.ok()) {
           WriteClusterMetaReply(tree, message_out);
@@ -875,7 +1076,7 @@ bool SocketConnection::doClusterMeta(const json& root) {
           LOG(ERROR) << "Check cluster meta: " << status.ToString();
           WriteErrorReply(status, message_out);
         }
-        self->doWrite(message_out);
+        self->doWrite(request_id, message_out);
         return Status::OK();
       }));
   return false;
@@ -883,9 +1084,10 @@ bool SocketConnection::doClusterMeta(const json& root) {
 
 bool SocketConnection::doInstanceStatus(const json& root) {
   auto self(shared_from_this());
+  const uint64_t request_id = request_id_;
   TRY_READ_REQUEST(ReadInstanceStatusRequest, root);
   RESPONSE_ON_ERROR(server_ptr_->InstanceStatus(
-      [self](const Status& status, const json& tree) {
+      [self, request_id](const Status& status, const json& tree) {
         std::string message_out;
         if (status.ok()) {
           WriteInstanceStatusReply(tree, message_out);
@@ -893,7 +1095,7 @@ bool SocketConnection::doInstanceStatus(const json& root) {
           LOG(ERROR) << "Check instance status: " << status.ToString();
           WriteErrorReply(status, message_out);
         }
-        self->doWrite(message_out);
+        self->doWrite(request_id, message_out);
         return Status::OK();
       }));
   return false;
@@ -914,13 +1116,7 @@ bool SocketConnection::doMakeArena(const json& root) {
       server_ptr_->GetBulkStore()->MakeArena(size, store_fd, base));
   WriteMakeArenaReply(store_fd, size, base, message_out);
 
-  this->doWrite(message_out, [self, store_fd](const Status& status) {
-    if (self->used_fds_.find(store_fd) == self->used_fds_.end()) {
-      self->used_fds_.emplace(store_fd);
-      send_fd(self->nativeHandle(), store_fd);
-    }
-    return Status::OK();
-  });
+  this->doWrite(request_id_, message_out, {store_fd});
   return false;
 }
 
@@ -948,43 +1144,98 @@ bool SocketConnection::doDebug(const json& root) {
 }
 
 void SocketConnection::doWrite(const std::string& buf) {
-  std::string to_send;
-  size_t length = buf.size();
-  to_send.resize(length + sizeof(size_t));
-  char* ptr = &to_send[0];
-  memcpy(ptr, &length, sizeof(size_t));
-  ptr += sizeof(size_t);
-  memcpy(ptr, buf.data(), length);
-  {
-    std::lock_guard<std::recursive_mutex> scoped_lock(write_msgs_mutex_);
-    write_msgs_.push_back(std::move(to_send));
-  }
-  doAsyncWrite();
+  doWrite(request_id_, buf);
 }
 
 void SocketConnection::doWrite(const std::string& buf, callback_t<> callback) {
-  std::string to_send;
-  size_t length = buf.size();
-  to_send.resize(length + sizeof(size_t));
-  char* ptr = &to_send[0];
-  memcpy(ptr, &length, sizeof(size_t));
-  ptr += sizeof(size_t);
-  memcpy(ptr, buf.data(), length);
+  doWrite(request_id_, buf, {}, callback);
+}
+
+void SocketConnection::doWrite(std::string&& buf) {
   {
     std::lock_guard<std::recursive_mutex> scoped_lock(write_msgs_mutex_);
-    write_msgs_.push_back(std::move(to_send));
+    write_msgs_.push_back(socket_message_t{std::move(buf), {}, nullptr});
   }
-  doAsyncWrite(callback);
+  doAsyncWrite();
 }
 
-void SocketConnection::doWrite(std::string&& buf) {
+void SocketConnection::doWrite(const uint64_t request_id,
+                               const std::string& buf,
+                               std::vector<int> const& fds,
+                               callback_t<> callback) {
+  socket_message_t message{std::string(), {}, callback};
   {
     std::lock_guard<std::recursive_mutex> scoped_lock(write_msgs_mutex_);
-    write_msgs_.push_back(std::move(buf));
+    // The messages are written in the order of the queue, thus the fds that
+    // need to be sent can be decided here.
+    for (int fd : fds) {
+      if (used_fds_.find(fd) == used_fds_.end()) {
+        used_fds_.emplace(fd);
+        message.fds.emplace_back(fd);
+      }
+    }
+    size_t length = buf.size();
+    if (pipelined_) {
+      uint32_t fd_count = message.fds.size();
+      message.message.resize(kPipelinedReplyHeaderSize +
+                             fd_count * sizeof(int32_t) + length);
+      char* ptr = &message.message[0];
+      memcpy(ptr, &length, sizeof(size_t));
+      ptr += sizeof(size_t);
+      memcpy(ptr, &request_id, sizeof(uint64_t));
+      ptr += sizeof(uint64_t);
+      memcpy(ptr, &fd_count, sizeof(uint32_t));
+      ptr += sizeof(uint32_t);
+      for (int fd : message.fds) {
+        int32_t value = fd;
+        memcpy(ptr, &value, sizeof(int32_t));
+        ptr += sizeof(int32_t);
+      }
+      memcpy(ptr, buf.data(), length);
+    } else {
+      message.message.resize(length + sizeof(size_t));
+      char* ptr = &message.message[0];
+      memcpy(ptr, &length, sizeof(size_t));
+      ptr += sizeof(size_t);
+      memcpy(ptr, buf.data(), length);
+    }
+    write_msgs_.push_back(std::move(message));
   }
   doAsyncWrite();
 }
 
+void SocketConnection::pinObjects(std::vector<ObjectID> const& ids) {
+  if (!server_ptr_->GetBulkStore()->SpillEnabled()) {
+    return;
+  }
+  std::vector<ObjectID> pins;
+  std::lock_guard<std::mutex> lock(pinned_objects_mutex_);
+  for (auto const& id : ids) {
+    if (pinned_objects_.emplace(id).second) {
+      pins.emplace_back(id);
+    }
+  }
+  server_ptr_->GetBulkStore()->Pin(pins);
+}
+
+void SocketConnection::unpinObject(const ObjectID id) {
+  std::lock_guard<std::mutex> lock(pinned_objects_mutex_);
+  if (pinned_objects_.erase(id)) {
+    server_ptr_->GetBulkStore()->Unpin({id});
+  }
+}
+
+std::vector<int> SocketConnection::payloadFds(
+    std::vector<std::shared_ptr<Payload>> const& objects) {
+  std::vector<int> fds;
+  for (auto const& object : objects) {
+    if (object->data_size > 0) {
+      fds.emplace_back(object->store_fd);
+    }
+  }
+  return fds;
+}
+
 void SocketConnection::doStop() {
   if (this->Stop()) {
     // drop connection
@@ -993,60 +1244,42 @@ void SocketConnection::doStop() {
 }
 
 void SocketConnection::doAsyncWrite() {
-  std::shared_ptr<std::string> payload = nullptr;
+  std::shared_ptr<socket_message_t> message = nullptr;
   {
     std::lock_guard<std::recursive_mutex> scoped_lock(write_msgs_mutex_);
-    if (!write_msgs_.empty()) {
-      payload.reset(new std::string());
-      payload->swap(write_msgs_.front());
-      write_msgs_.pop_front();
+    // only one write is in flight, to keep the messages and their fds in order.
+    if (writing_ || write_msgs_.empty()) {
+      return;
     }
-  }
-  if (payload == nullptr) {
-    return;
+    writing_ = true;
+    message =
+        std::make_shared<socket_message_t>(std::move(write_msgs_.front()));
+    write_msgs_.pop_front();
   }
   auto self(shared_from_this());
   asio::async_write(
-      socket_, boost::asio::buffer(payload->data(), payload->length()),
-      [this, self, payload](boost::system::error_code ec, std::size_t) {
-        if (!ec) {
-          doAsyncWrite();
-        } else {
+      socket_, boost::asio::buffer(message->message.data(),
+                                   message->message.length()),
+      [this, self, message](boost::system::error_code ec, std::size_t) {
+        if (ec) {
+          doStop();
+          return;
+        }
+        for (int fd : message->fds) {
+          send_fd(nativeHandle(), fd);
+        }
+        if (message->callback && !message->callback(Status::OK()).ok()) {
           doStop();
+          return;
         }
+        {
+          std::lock_guard<std::recursive_mutex> scoped_lock(write_msgs_mutex_);
+          writing_ = false;
+        }
+        doAsyncWrite();
       });
 }
 
-void SocketConnection::doAsyncWrite(callback_t<> callback) {
-  std::shared_ptr<std::string> payload = nullptr;
-  {
-    std::lock_guard<std::recursive_mutex> scoped_lock(write_msgs_mutex_);
-    if (!write_msgs_.empty()) {
-      payload.reset(new std::string());
-      payload->swap(write_msgs_.front());
-      write_msgs_.pop_front();
-    }
-  }
-  if (payload == nullptr) {
-    auto status = callback(Status::OK());
-    if (!status.ok()) {
-      doStop();
-    }
-    return;
-  }
-  auto self(shared_from_this());
-  asio::async_write(socket_,
-                    boost::asio::buffer(payload->data(), payload->length()),
-                    [this, self, payload, callback](
-                        boost::system::error_code ec, std::size_t) {
-                      if (!ec) {
-                        doAsyncWrite(callback);
-                      } else {
-                        doStop();
-                      }
-                    });
-}
-
 SocketServer::SocketServer(vs_ptr_t vs_ptr)
     : vs_ptr_(vs_ptr), next_conn_id_(0) {}
 
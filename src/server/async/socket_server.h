@@ -27,6 +27,7 @@ limitations under the License.
 
 #include "boost/asio.hpp"
 
+#include "common/util/callback.h"
 #include "common/util/protocols.h"
 #include "server/async/socket_server.h"
 #include "server/server/vineyard_server.h"
@@ -38,7 +39,17 @@ using boost::asio::generic::stream_protocol;
 
 class SocketServer;
 
-using socket_message_queue_t = std::deque<std::string>;
+/**
+ * @brief A message in the write queue. The file descriptors are sent right
+ * after the message has been written, and then the callback is invoked.
+ */
+struct socket_message_t {
+  std::string message;
+  std::vector<int> fds;
+  callback_t<> callback;
+};
+
+using socket_message_queue_t = std::deque<socket_message_t>;
 
 /**
  * @brief SocketConnection handles the socket connection in vineyard
@@ -69,6 +80,8 @@ class SocketConnection : public std::enable_shared_from_this<SocketConnection> {
 
   bool doCreateBuffer(const json& root);
 
+  bool doCreateBuffers(const json& root);
+
   /**
    * @brief doCreateBuffer differs from doCreateRemoteBuffer, that the content
    * of blob is in the request body, rather than via memory sharing.
@@ -105,6 +118,8 @@ class SocketConnection : public std::enable_shared_from_this<SocketConnection> {
 
   bool doStopStream(const json& root);
 
+  bool doReleaseStreamChunks(const json& root);
+
   bool doPutName(const json& root);
 
   bool doGetName(const json& root);
@@ -123,6 +138,20 @@ class SocketConnection : public std::enable_shared_from_this<SocketConnection> {
 
   bool doDebug(const json& root);
 
+  /**
+   * @brief Handlers for requests in the compact binary encoding, see also
+   * `kBinaryMessageMagic`. The replies are encoded in binary as well.
+   */
+  bool doGetBuffersBinary(const std::string& message_in);
+
+  bool doCreateBufferBinary(const std::string& message_in);
+
+  bool doCreateBuffersBinary(const std::string& message_in);
+
+  bool doGetNextStreamChunkBinary(const std::string& message_in);
+
+  bool doPullNextStreamChunkBinary(const std::string& message_in);
+
  private:
   int nativeHandle() { return socket_.native_handle(); }
 
@@ -134,16 +163,53 @@ class SocketConnection : public std::enable_shared_from_this<SocketConnection> {
    */
   bool processMessage(const std::string& message_in);
 
+  bool processBinaryMessage(const std::string& message_in);
+
+  bool getBuffersImpl(std::vector<ObjectID> const& ids, const bool binary);
+
+  bool createBufferImpl(const size_t size, const bool binary);
+
+  bool createBuffersImpl(std::vector<size_t> const& sizes, const bool binary);
+
+  bool getNextStreamChunkImpl(const ObjectID stream_id, const size_t size,
+                              const bool binary);
+
+  bool pullNextStreamChunkImpl(const ObjectID stream_id, const bool binary);
+
   void doReadHeader();
 
   void doReadBody();
 
+  /**
+   * @brief Reply to the request that is being processed. Handlers that reply
+   * asynchronously must use the overload that accepts a request id, as the
+   * connection may have moved on to next requests in the meantime.
+   */
   void doWrite(const std::string& buf);
 
   void doWrite(std::string&& buf);
 
   void doWrite(const std::string& buf, callback_t<> callback);
 
+  /**
+   * @brief Reply to the request `request_id`. The file descriptors in `fds`
+   * that haven't been sent over this connection will follow the reply.
+   */
+  void doWrite(const uint64_t request_id, const std::string& buf,
+               std::vector<int> const& fds = {},
+               callback_t<> callback = nullptr);
+
+  /**
+   * Pins the blobs that are (going to be) mapped by the client, they are
+   * unpinned when the connection is closed, see also `BulkStore::Pin`.
+   */
+  void pinObjects(std::vector<ObjectID> const& ids);
+
+  void unpinObject(const ObjectID id);
+
+  static std::vector<int> payloadFds(
+      std::vector<std::shared_ptr<Payload>> const& objects);
+
   /**
    * Being called when the encounter a socket error (in read/write), or by
    * external "conn->Stop()".
@@ -154,8 +220,6 @@ class SocketConnection : public std::enable_shared_from_this<SocketConnection> {
 
   void doAsyncWrite();
 
-  void doAsyncWrite(callback_t<> callback);
-
   void sendBufferHelper(std::vector<std::shared_ptr<Payload>> const objects,
                         size_t index, boost::system::error_code const ec,
                         callback_t<> callback_after_finish);
@@ -169,13 +233,24 @@ class SocketConnection : public std::enable_shared_from_this<SocketConnection> {
   asio::streambuf buf_;
   socket_message_queue_t write_msgs_;
   std::recursive_mutex write_msgs_mutex_;  // protect the write_msgs
+  bool writing_;  // whether there's an in-flight write, protected as well
 
+  // fds that have been sent, protected by the write_msgs_mutex_
   std::unordered_set<int> used_fds_;
   // the associated reader of the stream
   std::unordered_set<ObjectID> associated_streams_;
+  // blobs that mapped by the client, which cannot be spilled
+  std::unordered_set<ObjectID> pinned_objects_;
+  std::mutex pinned_objects_mutex_;
 
   size_t read_msg_header_;
   std::string read_msg_body_;
+
+  // whether the messages are tagged with request ids, see also
+  // `kPipelinedRequestHeaderSize`.
+  bool pipelined_;
+  // the id of request that is being processed.
+  uint64_t request_id_;
 };
 
 /**
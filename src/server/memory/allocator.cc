@@ -31,6 +31,9 @@ https://github.com/apache/arrow/blob/master/cpp/src/plasma/plasma_allocator.cc
 
 #include <stdio.h>
 
+#include <algorithm>
+#include <thread>
+
 #include "common/util/env.h"
 #include "common/util/logging.h"
 #include "server/memory/malloc.h"
@@ -45,14 +48,22 @@ https://github.com/apache/arrow/blob/master/cpp/src/plasma/plasma_allocator.cc
 
 namespace vineyard {
 
-int64_t BulkAllocator::footprint_limit_ = 0;
-int64_t BulkAllocator::allocated_ = 0;
+std::atomic<int64_t> BulkAllocator::footprint_limit_{0};
+std::atomic<int64_t> BulkAllocator::allocated_{0};
 
 #if defined(WITH_JEMALLOC)
 BulkAllocator::Allocator BulkAllocator::allocator_{};
 #endif
 
-void* BulkAllocator::Init(const size_t size) {
+#if defined(WITH_JEMALLOC)
+// each arena retains at least a huge page for its own metadata, and extents
+// freed in one arena are only reused by the same arena, thus the number of
+// arenas is bounded by the size of the shared memory.
+static constexpr size_t kMinimumArenaSize = 64 * 1024 * 1024;  // 64MB
+static constexpr size_t kMaximumArenas = 16;
+#endif
+
+void* BulkAllocator::Init(const size_t size, const size_t num_arenas) {
   int64_t shmmax = get_maximum_shared_memory();
   if (shmmax < static_cast<float>(size)) {
     LOG(WARNING) << "'size' is greater than the maximum shared memory size ("
@@ -62,12 +73,21 @@ void* BulkAllocator::Init(const size_t size) {
   return Allocator::Init(size);
 #endif
 #if defined(WITH_JEMALLOC)
-  return allocator_.Init(size);
+  size_t arenas = num_arenas;
+  if (arenas == 0) {
+    arenas = std::min({static_cast<size_t>(std::thread::hardware_concurrency()),
+                       size / kMinimumArenaSize, kMaximumArenas});
+  }
+  return allocator_.Init(size, std::max(arenas, static_cast<size_t>(1)));
 #endif
 }
 
 void* BulkAllocator::Memalign(const size_t bytes, const size_t alignment) {
-  if (allocated_ + static_cast<int64_t>(bytes) > footprint_limit_) {
+  // reserve the footprint first, then concurrent allocations never exceed
+  // the limit together.
+  int64_t size = static_cast<int64_t>(bytes);
+  if (allocated_.fetch_add(size) + size > footprint_limit_.load()) {
+    allocated_.fetch_sub(size);
     return nullptr;
   }
 
@@ -77,7 +97,9 @@ void* BulkAllocator::Memalign(const size_t bytes, const size_t alignment) {
 #if defined(WITH_JEMALLOC)
   void* mem = allocator_.Allocate(bytes, alignment);
 #endif
-  allocated_ += bytes;
+  if (mem == nullptr) {
+    allocated_.fetch_sub(size);
+  }
   return mem;
 }
 
@@ -88,15 +110,15 @@ void BulkAllocator::Free(void* mem, size_t bytes) {
 #if defined(WITH_JEMALLOC)
   allocator_.Free(mem);
 #endif
-  allocated_ -= bytes;
+  allocated_.fetch_sub(static_cast<int64_t>(bytes));
 }
 
 void BulkAllocator::SetFootprintLimit(size_t bytes) {
-  footprint_limit_ = static_cast<int64_t>(bytes);
+  footprint_limit_.store(static_cast<int64_t>(bytes));
 }
 
-int64_t BulkAllocator::GetFootprintLimit() { return footprint_limit_; }
+int64_t BulkAllocator::GetFootprintLimit() { return footprint_limit_.load(); }
 
-int64_t BulkAllocator::Allocated() { return allocated_; }
+int64_t BulkAllocator::Allocated() { return allocated_.load(); }
 
 }  // namespace vineyard
@@ -29,6 +29,7 @@
 #ifndef SRC_SERVER_MEMORY_ALLOCATOR_H_
 #define SRC_SERVER_MEMORY_ALLOCATOR_H_
 
+#include <atomic>
 #include <cstddef>
 #include <cstdint>
 
@@ -41,7 +42,13 @@ class JemallocAllocator;
 
 class BulkAllocator {
  public:
-  static void* Init(const size_t size);
+  /// Maps the shared memory of the given size.
+  ///
+  /// \param size Size of the shared memory.
+  /// \param num_arenas Number of arenas that serve the allocations from
+  /// different threads concurrently, zero means decided by the number of
+  /// cores and the size. Only the jemalloc allocator has multiple arenas.
+  static void* Init(const size_t size, const size_t num_arenas = 0);
 
   /// Allocates size bytes and returns a pointer to the allocated memory. The
   /// memory address will be a multiple of alignment, which must be a power of
@@ -82,8 +89,8 @@ class BulkAllocator {
 #endif
 
  private:
-  static int64_t allocated_;
-  static int64_t footprint_limit_;
+  static std::atomic<int64_t> allocated_;
+  static std::atomic<int64_t> footprint_limit_;
 
 #if defined(WITH_JEMALLOC)
   static Allocator allocator_;
@@ -24,7 +24,7 @@ namespace vineyard {
 
 namespace memory {
 
-void* JemallocAllocator::Init(const size_t size) {
+void* JemallocAllocator::Init(const size_t size, const size_t num_arenas) {
   // create memory using mmap
   int fd = create_buffer(size);
   void* space = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
@@ -36,7 +36,7 @@ void* JemallocAllocator::Init(const size_t size) {
   record.fd = fd;
   record.size = size;
 
-  return Jemalloc::Init(space, size);
+  return Jemalloc::Init(space, size, num_arenas);
 }
 
 }  // namespace memory
@@ -26,7 +26,7 @@ namespace memory {
 
 class JemallocAllocator : public Jemalloc {
  public:
-  void* Init(const size_t size);
+  void* Init(const size_t size, const size_t num_arenas = 1);
 };
 
 }  // namespace memory
@@ -28,7 +28,9 @@
 
 #include "server/memory/memory.h"
 
+#include <fcntl.h>
 #include <sys/mman.h>
+#include <unistd.h>
 
 #include <algorithm>
 #include <limits>
@@ -37,6 +39,9 @@
 #include <string>
 #include <vector>
 
+#include "boost/filesystem/operations.hpp"
+#include "boost/filesystem/path.hpp"
+
 #include "server/memory/allocator.h"
 #include "server/memory/malloc.h"
 
@@ -124,6 +129,50 @@ static void recycle_arena(const uintptr_t base, const size_t size,
     head = next;
   }
 }
+
+static Status write_spill_file(const std::string& path, const uint8_t* data,
+                               const size_t size) {
+  int fd = open(path.c_str(), O_CREAT | O_TRUNC | O_WRONLY, 0600);
+  if (fd == -1) {
+    return Status::IOError("Failed to open spill file '" + path +
+                           "': " + strerror(errno));
+  }
+  size_t offset = 0;
+  while (offset < size) {
+    ssize_t written = write(fd, data + offset, size - offset);
+    if (written < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      std::string error = strerror(errno);
+      close(fd);
+      unlink(path.c_str());
+      return Status::IOError("Failed to write spill file '" + path +
+                             "': " + error);
+    }
+    offset += written;
+  }
+  close(fd);
+  return Status::OK();
+}
+
+static Status read_spill_file(const std::string& path, uint8_t* data,
+                              const size_t size) {
+  int fd = open(path.c_str(), O_RDONLY);
+  if (fd == -1) {
+    return Status::IOError("Failed to open spill file '" + path +
+                           "': " + strerror(errno));
+  }
+  void* mapped = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (mapped == MAP_FAILED) {
+    return Status::IOError("Failed to mmap spill file '" + path +
+                           "': " + strerror(errno));
+  }
+  memcpy(data, mapped, size);
+  munmap(mapped, size);
+  return Status::OK();
+}
 }  // namespace memory
 
 std::set<ObjectID> BulkStore::Arena::spans{};
@@ -137,11 +186,15 @@ BulkStore::~BulkStore() {
   for (auto const& item : object_ids) {
     VINEYARD_DISCARD(Delete(item));
   }
+  if (!spill_path_.empty()) {
+    boost::system::error_code ec;
+    boost::filesystem::remove_all(spill_path_, ec);
+  }
 }
 
-Status BulkStore::PreAllocate(const size_t size) {
+Status BulkStore::PreAllocate(const size_t size, const size_t num_arenas) {
   BulkAllocator::SetFootprintLimit(size);
-  void* pointer = BulkAllocator::Init(size);
+  void* pointer = BulkAllocator::Init(size, num_arenas);
 
   if (pointer == nullptr) {
     return Status::NotEnoughMemory("mmap failed, size = " +
@@ -155,6 +208,7 @@ Status BulkStore::PreAllocate(const size_t size) {
   int64_t map_size = 0;
   ptrdiff_t offset = 0;
   GetMallocMapinfo(pointer, &fd, &map_size, &offset);
+  store_fd_ = fd;
   objects_.emplace(
       object_id,
       std::make_shared<Payload>(object_id, size, static_cast<uint8_t*>(pointer),
@@ -165,16 +219,51 @@ Status BulkStore::PreAllocate(const size_t size) {
 // Allocate memory
 uint8_t* BulkStore::AllocateMemory(size_t size, int* fd, int64_t* map_size,
                                    ptrdiff_t* offset) {
-  // Try to evict objects until there is enough space.
-  uint8_t* pointer = nullptr;
-  pointer =
-      reinterpret_cast<uint8_t*>(BulkAllocator::Memalign(size, kBlockSize));
+  auto allocate = [this](const size_t size) -> uint8_t* {
+    if (size <= memory::SlabAllocator::kThreshold) {
+      return reinterpret_cast<uint8_t*>(slab_.Allocate(size));
+    } else {
+      return reinterpret_cast<uint8_t*>(
+          BulkAllocator::Memalign(size, kBlockSize));
+    }
+  };
+  uint8_t* pointer = allocate(size);
+  if (pointer == nullptr && !spill_path_.empty()) {
+    // Try to spill objects until there is enough space, tiny blobs requires
+    // a new slab.
+    std::lock_guard<std::recursive_mutex> lock(spill_mutex_);
+    size_t required = std::max(size, memory::SlabAllocator::kSlabSize);
+    while (pointer == nullptr && SpillColdObjects(required).ok()) {
+      pointer = allocate(size);
+    }
+  }
   if (pointer) {
     GetMallocMapinfo(pointer, fd, map_size, offset);
   }
   return pointer;
 }
 
+ObjectID BulkStore::NewBlobID(const uint8_t* pointer) {
+  ObjectID object_id = GenerateBlobID(pointer);
+  if (spill_path_.empty()) {
+    return object_id;
+  }
+  // a spilled (or reloaded) blob keeps its id, while the address may have
+  // been reused by new blobs, use the unused high bits to tell them apart.
+  uint64_t generation = 0;
+  while (objects_.count(object_id)) {
+    generation += 1;
+    object_id = GenerateBlobID(pointer) | (generation << 48);
+  }
+  return object_id;
+}
+
+void BulkStore::FreeMemory(uint8_t* pointer, size_t size) {
+  if (!slab_.Free(pointer, size)) {
+    BulkAllocator::Free(pointer, size);
+  }
+}
+
 Status BulkStore::Create(const size_t data_size, ObjectID& object_id,
                          std::shared_ptr<Payload>& object) {
   if (data_size == 0) {
@@ -185,12 +274,11 @@ Status BulkStore::Create(const size_t data_size, ObjectID& object_id,
   int fd = -1;
   int64_t map_size = 0;
   ptrdiff_t offset = 0;
-  uint8_t* pointer = nullptr;
-  pointer = AllocateMemory(data_size, &fd, &map_size, &offset);
+  uint8_t* pointer = AllocateMemory(data_size, &fd, &map_size, &offset);
   if (pointer == nullptr) {
     return Status::NotEnoughMemory("size = " + std::to_string(data_size));
   }
-  object_id = GenerateBlobID(pointer);
+  object_id = NewBlobID(pointer);
   object = std::make_shared<Payload>(object_id, data_size, pointer, fd,
                                      map_size, offset);
   objects_.emplace(object_id, object);
@@ -201,18 +289,75 @@ Status BulkStore::Create(const size_t data_size, ObjectID& object_id,
   return Status::OK();
 }
 
-Status BulkStore::Get(const ObjectID id, std::shared_ptr<Payload>& object) {
+Status BulkStore::Create(const std::vector<size_t>& sizes,
+                         std::vector<ObjectID>& object_ids,
+                         std::vector<std::shared_ptr<Payload>>& objects) {
+  std::vector<std::shared_ptr<Payload>> created;
+  created.reserve(sizes.size());
+  size_t total_size = 0;
+  for (auto const size : sizes) {
+    total_size += size;
+  }
+  if (spill_path_.empty() && Footprint() + total_size > FootprintLimit()) {
+    return Status::NotEnoughMemory("size = " + std::to_string(total_size) +
+                                   " for " + std::to_string(sizes.size()) +
+                                   " blobs");
+  }
+  for (auto const size : sizes) {
+    if (size == 0) {
+      created.emplace_back(Payload::MakeEmpty());
+      continue;
+    }
+    int fd = -1;
+    int64_t map_size = 0;
+    ptrdiff_t offset = 0;
+    uint8_t* pointer = AllocateMemory(size, &fd, &map_size, &offset);
+    if (pointer == nullptr) {
+      // roll back, the footprint check above doesn't take the alignment
+      // overhead into account.
+      for (auto const& object : created) {
+        if (object->data_size > 0) {
+          FreeMemory(object->pointer, object->data_size);
+        }
+      }
+      return Status::NotEnoughMemory("size = " + std::to_string(size));
+    }
+    ObjectID object_id = NewBlobID(pointer);
+    created.emplace_back(std::make_shared<Payload>(object_id, size, pointer, fd,
+                                                   map_size, offset));
+  }
+  for (auto const& object : created) {
+    if (object->data_size > 0) {
+      objects_.emplace(object->object_id, object);
+    }
+    object_ids.emplace_back(object->object_id);
+    objects.emplace_back(object);
+  }
+#ifndef NDEBUG
+  VLOG(10) << "after allocate " << sizes.size() << " blobs: " << Footprint()
+           << "(" << FootprintLimit() << ")";
+#endif
+  return Status::OK();
+}
+
+Status BulkStore::Get(const ObjectID id, std::shared_ptr<Payload>& object,
+                      const bool reload) {
   if (id == EmptyBlobID()) {
     object = Payload::MakeEmpty();
     return Status::OK();
   } else {
-    object_map_t::const_accessor accessor;
-    if (objects_.find(accessor, id)) {
+    {
+      object_map_t::const_accessor accessor;
+      if (!objects_.find(accessor, id)) {
+        return Status::ObjectNotExists("get: id = " + ObjectIDToString(id));
+      }
       object = accessor->second;
-      return Status::OK();
-    } else {
-      return Status::ObjectNotExists("get: id = " + ObjectIDToString(id));
     }
+    if (reload && object->pointer == nullptr && object->data_size > 0) {
+      std::lock_guard<std::recursive_mutex> lock(spill_mutex_);
+      return Reload(id, object);
+    }
+    return Status::OK();
   }
 }
 
@@ -222,10 +367,19 @@ Status BulkStore::Get(const std::vector<ObjectID>& ids,
     if (object_id == EmptyBlobID()) {
       objects.push_back(Payload::MakeEmpty());
     } else {
-      object_map_t::const_accessor accessor;
-      if (objects_.find(accessor, object_id)) {
-        objects.push_back(accessor->second);
+      std::shared_ptr<Payload> object;
+      {
+        object_map_t::const_accessor accessor;
+        if (!objects_.find(accessor, object_id)) {
+          continue;
+        }
+        object = accessor->second;
       }
+      if (object->pointer == nullptr && object->data_size > 0) {
+        std::lock_guard<std::recursive_mutex> lock(spill_mutex_);
+        RETURN_ON_ERROR(Reload(object_id, object));
+      }
+      objects.push_back(object);
     }
   }
   return Status::OK();
@@ -238,6 +392,24 @@ Status BulkStore::Delete(const ObjectID& object_id) {
                        std::numeric_limits<uintptr_t>::max()))) {
     return Status::OK();
   }
+  std::unique_lock<std::recursive_mutex> spill_lock(spill_mutex_,
+                                                    std::defer_lock);
+  if (!spill_path_.empty()) {
+    // n.b.: the pins are kept, as the connections will unpin them later.
+    spill_lock.lock();
+    auto spilled = spilled_.find(object_id);
+    if (spilled != spilled_.end()) {
+      unlink(SpillFile(object_id).c_str());
+      spilled_.erase(spilled);
+      objects_.erase(object_id);
+      return Status::OK();
+    }
+    auto lru = lru_index_.find(object_id);
+    if (lru != lru_index_.end()) {
+      lru_.erase(lru->second);
+      lru_index_.erase(lru);
+    }
+  }
   object_map_t::const_accessor accessor;
   if (!objects_.find(accessor, object_id)) {
     return Status::ObjectNotExists("delete: id = " +
@@ -246,7 +418,7 @@ Status BulkStore::Delete(const ObjectID& object_id) {
   auto& object = accessor->second;
   if (object->arena_fd == -1) {
     auto buff_size = object->data_size;
-    BulkAllocator::Free(object->pointer, buff_size);
+    FreeMemory(object->pointer, buff_size);
 #ifndef NDEBUG
     VLOG(10) << "after free: " << ObjectIDToString(object_id) << ": "
              << Footprint() << "(" << FootprintLimit() << ")";
@@ -308,6 +480,178 @@ size_t BulkStore::FootprintLimit() const {
   return BulkAllocator::GetFootprintLimit();
 }
 
+json BulkStore::SlabStats() const { return slab_.Stats(); }
+
+Status BulkStore::EnableSpill(const std::string& path) {
+  if (path.empty()) {
+    return Status::OK();
+  }
+  // a directory per process, the spilled blobs are useless after restart.
+  auto spill_path = boost::filesystem::path(path) /
+                    ("vineyard-spill." + std::to_string(getpid()));
+  boost::system::error_code ec;
+  boost::filesystem::create_directories(spill_path, ec);
+  if (ec) {
+    return Status::IOError("Failed to create the spill directory '" +
+                           spill_path.string() + "': " + ec.message());
+  }
+  spill_path_ = spill_path.string();
+  LOG(INFO) << "Spilling blobs to " << spill_path_
+            << " when the shared memory is exhausted";
+  return Status::OK();
+}
+
+void BulkStore::Pin(const std::vector<ObjectID>& ids) {
+  if (spill_path_.empty()) {
+    return;
+  }
+  std::lock_guard<std::recursive_mutex> lock(spill_mutex_);
+  for (auto const& id : ids) {
+    if (++pins_[id] == 1) {
+      auto lru = lru_index_.find(id);
+      if (lru != lru_index_.end()) {
+        lru_.erase(lru->second);
+        lru_index_.erase(lru);
+      }
+    }
+  }
+}
+
+void BulkStore::Unpin(const std::vector<ObjectID>& ids) {
+  if (spill_path_.empty()) {
+    return;
+  }
+  std::lock_guard<std::recursive_mutex> lock(spill_mutex_);
+  for (auto const& id : ids) {
+    auto pin = pins_.find(id);
+    if (pin == pins_.end() || --pin->second > 0) {
+      continue;
+    }
+    pins_.erase(pin);
+    object_map_t::const_accessor accessor;
+    if (objects_.find(accessor, id) && Spillable(accessor->second) &&
+        lru_index_.find(id) == lru_index_.end()) {
+      lru_index_.emplace(id, lru_.insert(lru_.end(), id));
+    }
+  }
+}
+
+json BulkStore::SpillStats() {
+  json stats;
+  std::lock_guard<std::recursive_mutex> lock(spill_mutex_);
+  stats["enabled"] = !spill_path_.empty();
+  stats["spills"] = spill_count_;
+  stats["reloads"] = reload_count_;
+  stats["spilled_bytes"] = spilled_bytes_;
+  stats["reloaded_bytes"] = reloaded_bytes_;
+  stats["spilled_objects"] = spilled_.size();
+  return stats;
+}
+
+bool BulkStore::Spillable(const std::shared_ptr<Payload>& object) const {
+  // blobs in slabs and arenas, and the marker of the whole shared memory, are
+  // never spilled.
+  static const ObjectID marker = GenerateBlobID(
+      reinterpret_cast<void*>(std::numeric_limits<uintptr_t>::max()));
+  return object->pointer != nullptr && object->store_fd == store_fd_ &&
+         object->data_size >
+             static_cast<int64_t>(memory::SlabAllocator::kThreshold) &&
+         object->object_id != marker;
+}
+
+Status BulkStore::SpillColdObjects(const size_t size) {
+  if (lru_.empty()) {
+    return Status::NotEnoughMemory("no blobs can be spilled");
+  }
+  size_t spilled = 0;
+  while (spilled < size && !lru_.empty()) {
+    ObjectID id = lru_.front();
+    lru_.pop_front();
+    lru_index_.erase(id);
+
+    std::shared_ptr<Payload> object;
+    {
+      object_map_t::const_accessor accessor;
+      if (!objects_.find(accessor, id)) {
+        continue;
+      }
+      object = accessor->second;
+    }
+    auto status = memory::write_spill_file(SpillFile(id), object->pointer,
+                                           object->data_size);
+    if (!status.ok()) {
+      LOG(ERROR) << "Failed to spill blob " << ObjectIDToString(id) << ": "
+                 << status.ToString();
+      lru_index_.emplace(id, lru_.insert(lru_.begin(), id));
+      return status;
+    }
+    // the placeholder tells the size of the spilled blob only.
+    {
+      object_map_t::accessor accessor;
+      if (objects_.find(accessor, id)) {
+        accessor->second = std::make_shared<Payload>(id, object->data_size,
+                                                     nullptr, -1, 0, 0);
+      }
+    }
+    FreeMemory(object->pointer, object->data_size);
+    spilled_.emplace(id, object->data_size);
+    spill_count_ += 1;
+    spilled_bytes_ += object->data_size;
+    spilled += object->data_size;
+  }
+  return Status::OK();
+}
+
+Status BulkStore::Reload(const ObjectID id, std::shared_ptr<Payload>& object) {
+  auto spilled = spilled_.find(id);
+  if (spilled == spilled_.end()) {
+    // has been reloaded by others
+    object_map_t::const_accessor accessor;
+    if (!objects_.find(accessor, id)) {
+      return Status::ObjectNotExists("get: id = " + ObjectIDToString(id));
+    }
+    object = accessor->second;
+    return Status::OK();
+  }
+  int64_t data_size = spilled->second;
+  int fd = -1;
+  int64_t map_size = 0;
+  ptrdiff_t offset = 0;
+  uint8_t* pointer = AllocateMemory(data_size, &fd, &map_size, &offset);
+  if (pointer == nullptr) {
+    return Status::NotEnoughMemory("reload: id = " + ObjectIDToString(id) +
+                                   ", size = " + std::to_string(data_size));
+  }
+  std::string spill_file = SpillFile(id);
+  auto status = memory::read_spill_file(spill_file, pointer, data_size);
+  if (!status.ok()) {
+    FreeMemory(pointer, data_size);
+    return status;
+  }
+  unlink(spill_file.c_str());
+  // spilled_ may be rehashed during allocating
+  spilled_.erase(id);
+
+  object = std::make_shared<Payload>(id, data_size, pointer, fd, map_size,
+                                     offset);
+  {
+    object_map_t::accessor accessor;
+    if (objects_.find(accessor, id)) {
+      accessor->second = object;
+    }
+  }
+  if (pins_.find(id) == pins_.end()) {
+    lru_index_.emplace(id, lru_.insert(lru_.end(), id));
+  }
+  reload_count_ += 1;
+  reloaded_bytes_ += data_size;
+  return Status::OK();
+}
+
+std::string BulkStore::SpillFile(const ObjectID id) const {
+  return spill_path_ + "/" + ObjectIDToString(id);
+}
+
 Status BulkStore::MakeArena(size_t const size, int& fd, uintptr_t& base) {
   fd = memory::create_buffer(size);
   if (fd == -1) {
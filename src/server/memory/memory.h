@@ -29,15 +29,20 @@
 #ifndef SRC_SERVER_MEMORY_MEMORY_H_
 #define SRC_SERVER_MEMORY_MEMORY_H_
 
+#include <list>
 #include <memory>
+#include <mutex>
 #include <set>
+#include <string>
 #include <unordered_map>
 #include <vector>
 
 #include "oneapi/tbb/concurrent_hash_map.h"
 
 #include "common/memory/payload.h"
+#include "common/util/json.h"
 #include "common/util/status.h"
+#include "server/memory/slab.h"
 
 namespace vineyard {
 
@@ -45,12 +50,30 @@ class BulkStore {
  public:
   ~BulkStore();
 
-  Status PreAllocate(const size_t size);
+  /**
+   * Maps the shared memory, `num_arenas` arenas serve the concurrent
+   * allocations, zero means decided by the allocator.
+   */
+  Status PreAllocate(const size_t size, const size_t num_arenas = 0);
 
   Status Create(const size_t size, ObjectID& object_id,
                 std::shared_ptr<Payload>& object);
 
-  Status Get(const ObjectID id, std::shared_ptr<Payload>& object);
+  /**
+   * Allocates a batch of blobs. Either all blobs are created, or none of them
+   * is and the memory that has been allocated will be released.
+   */
+  Status Create(const std::vector<size_t>& sizes,
+                std::vector<ObjectID>& object_ids,
+                std::vector<std::shared_ptr<Payload>>& objects);
+
+  /**
+   * A spilled blob is faulted back into the shared memory first, unless
+   * `reload` is false, in which case the returned payload only tells the
+   * size of the blob.
+   */
+  Status Get(const ObjectID id, std::shared_ptr<Payload>& object,
+             const bool reload = true);
 
   /**
    * This methods only return available objects, and doesn't fail when object
@@ -66,6 +89,29 @@ class BulkStore {
   size_t Footprint() const;
   size_t FootprintLimit() const;
 
+  /// Statistics of the slabs that serve the tiny blobs.
+  json SlabStats() const;
+
+  /**
+   * Enables spilling blobs to files under `path` when the shared memory is
+   * exhausted. Only the blobs that are not pinned by any client are spilled,
+   * in the least-recently-released order.
+   */
+  Status EnableSpill(const std::string& path);
+
+  bool SpillEnabled() const { return !spill_path_.empty(); }
+
+  /**
+   * Pins the blobs that are mapped by a client, the pinned blobs are never
+   * spilled. Pin before `Get`, so that the blobs cannot be spilled between.
+   */
+  void Pin(const std::vector<ObjectID>& ids);
+
+  void Unpin(const std::vector<ObjectID>& ids);
+
+  /// Counters of spilling and reloading.
+  json SpillStats();
+
   Status MakeArena(const size_t size, int& fd, uintptr_t& base);
 
   Status FinalizeArena(const int fd, std::vector<size_t> const& offsets,
@@ -74,6 +120,20 @@ class BulkStore {
  private:
   uint8_t* AllocateMemory(size_t size, int* fd, int64_t* map_size,
                           ptrdiff_t* offset);
+
+  void FreeMemory(uint8_t* pointer, size_t size);
+
+  ObjectID NewBlobID(const uint8_t* pointer);
+
+  // the following methods require the spill_mutex_ being held.
+  bool Spillable(const std::shared_ptr<Payload>& object) const;
+
+  Status SpillColdObjects(const size_t size);
+
+  Status Reload(const ObjectID id, std::shared_ptr<Payload>& object);
+
+  std::string SpillFile(const ObjectID id) const;
+
   struct Arena {
     int fd;
     size_t size;
@@ -86,6 +146,24 @@ class BulkStore {
   using object_map_t =
       tbb::concurrent_hash_map<ObjectID, std::shared_ptr<Payload>>;
   object_map_t objects_;
+
+  // tiny blobs are packed into slabs, rather than being aligned one by one.
+  memory::SlabAllocator slab_;
+
+  // fd of the pre-allocated shared memory, blobs in arenas are not spilled.
+  int store_fd_ = -1;
+
+  // spilling is enabled when the path is not empty.
+  std::string spill_path_;
+  std::recursive_mutex spill_mutex_;
+  // unpinned blobs in shared memory, the front is the coldest.
+  std::list<ObjectID> lru_;
+  std::unordered_map<ObjectID, std::list<ObjectID>::iterator> lru_index_;
+  std::unordered_map<ObjectID, size_t> pins_;
+  // spilled blobs and their sizes.
+  std::unordered_map<ObjectID, int64_t> spilled_;
+  size_t spill_count_ = 0, reload_count_ = 0;
+  size_t spilled_bytes_ = 0, reloaded_bytes_ = 0;
 };
 
 }  // namespace vineyard
@@ -0,0 +1,195 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "server/memory/slab.h"
+
+#include <algorithm>
+#include <iterator>
+
+#include "server/memory/allocator.h"
+#include "server/memory/malloc.h"
+
+namespace vineyard {
+
+namespace memory {
+
+namespace {
+
+// Four size classes for every power of two, all of them are multiples of
+// kBlockSize thus the slots keep the alignment of blobs.
+std::vector<size_t> make_size_classes() {
+  std::vector<size_t> sizes;
+  for (size_t size = kBlockSize; size <= 512; size += kBlockSize) {
+    sizes.emplace_back(size);
+  }
+  for (size_t base = 512; base < SlabAllocator::kThreshold; base *= 2) {
+    for (size_t step = 1; step <= 4; ++step) {
+      sizes.emplace_back(base + base / 4 * step);
+    }
+  }
+  return sizes;
+}
+
+const std::vector<size_t>& size_classes() {
+  static const std::vector<size_t> sizes = make_size_classes();
+  return sizes;
+}
+
+}  // namespace
+
+SlabAllocator::SlabAllocator() : classes_(size_classes().size()) {
+  for (size_t index = 0; index < classes_.size(); ++index) {
+    classes_[index].size = size_classes()[index];
+    classes_[index].slots = kSlabSize / classes_[index].size;
+  }
+}
+
+SlabAllocator::~SlabAllocator() {
+  for (auto& size_class : classes_) {
+    for (auto const& slab : size_class.slabs) {
+      BulkAllocator::Free(reinterpret_cast<void*>(slab.first), kSlabSize);
+    }
+  }
+}
+
+void* SlabAllocator::Allocate(const size_t bytes) {
+  if (bytes == 0 || bytes > kThreshold) {
+    return nullptr;
+  }
+  size_class_t& size_class = classes_[sizeClassIndex(bytes)];
+  std::lock_guard<std::mutex> lock(size_class.mutex);
+  if (size_class.available.empty()) {
+    void* base = BulkAllocator::Memalign(kSlabSize, kBlockSize);
+    if (base == nullptr) {
+      return nullptr;
+    }
+    slab_t slab;
+    slab.base = reinterpret_cast<uintptr_t>(base);
+    // allocates from the lower address first.
+    slab.free_slots.resize(size_class.slots);
+    for (size_t slot = 0; slot < size_class.slots; ++slot) {
+      slab.free_slots[slot] =
+          static_cast<uint16_t>(size_class.slots - 1 - slot);
+    }
+    size_class.slabs.emplace(slab.base, std::move(slab));
+    size_class.available.emplace(reinterpret_cast<uintptr_t>(base));
+  }
+
+  slab_t& slab = size_class.slabs.at(*size_class.available.begin());
+  uint16_t slot = slab.free_slots.back();
+  slab.free_slots.pop_back();
+  slab.used += 1;
+  if (slab.free_slots.empty()) {
+    size_class.available.erase(slab.base);
+  }
+  size_class.used += 1;
+  size_class.requested += bytes;
+  return reinterpret_cast<void*>(slab.base + slot * size_class.size);
+}
+
+bool SlabAllocator::Free(void* pointer, const size_t bytes) {
+  if (bytes == 0 || bytes > kThreshold) {
+    return false;
+  }
+  size_class_t& size_class = classes_[sizeClassIndex(bytes)];
+  uintptr_t address = reinterpret_cast<uintptr_t>(pointer);
+  std::lock_guard<std::mutex> lock(size_class.mutex);
+  auto iter = size_class.slabs.upper_bound(address);
+  if (iter == size_class.slabs.begin()) {
+    return false;
+  }
+  iter = std::prev(iter);
+  slab_t& slab = iter->second;
+  if (address >= slab.base + kSlabSize) {
+    return false;
+  }
+  slab.free_slots.emplace_back(
+      static_cast<uint16_t>((address - slab.base) / size_class.size));
+  slab.used -= 1;
+  size_class.used -= 1;
+  size_class.requested -= bytes;
+  if (slab.used == 0 && size_class.slabs.size() > 1) {
+    // keep one slab for each size class, and give the others back.
+    size_class.available.erase(slab.base);
+    BulkAllocator::Free(reinterpret_cast<void*>(slab.base), kSlabSize);
+    size_class.slabs.erase(iter);
+  } else {
+    size_class.available.emplace(slab.base);
+  }
+  return true;
+}
+
+size_t SlabAllocator::Reserved() const {
+  size_t reserved = 0;
+  for (auto const& size_class : classes_) {
+    std::lock_guard<std::mutex> lock(size_class.mutex);
+    reserved += size_class.slabs.size() * kSlabSize;
+  }
+  return reserved;
+}
+
+json SlabAllocator::Stats() const {
+  json classes = json::array();
+  size_t reserved = 0, occupied = 0, requested = 0;
+  for (auto const& size_class : classes_) {
+    std::lock_guard<std::mutex> lock(size_class.mutex);
+    if (size_class.slabs.empty()) {
+      continue;
+    }
+    size_t class_occupied = size_class.used * size_class.size;
+    json stat;
+    stat["size"] = size_class.size;
+    stat["slabs"] = size_class.slabs.size();
+    stat["count"] = size_class.used;
+    stat["requested"] = size_class.requested;
+    stat["fragmentation"] =
+        class_occupied == 0
+            ? 0.0
+            : 1.0 - static_cast<double>(size_class.requested) / class_occupied;
+    classes.push_back(stat);
+    reserved += size_class.slabs.size() * kSlabSize;
+    occupied += class_occupied;
+    requested += size_class.requested;
+  }
+  json stats;
+  stats["classes"] = classes;
+  stats["reserved"] = reserved;
+  stats["occupied"] = occupied;
+  stats["requested"] = requested;
+  stats["fragmentation"] =
+      occupied == 0 ? 0.0 : 1.0 - static_cast<double>(requested) / occupied;
+  stats["utilization"] =
+      reserved == 0 ? 0.0 : static_cast<double>(requested) / reserved;
+  return stats;
+}
+
+double SlabAllocator::Fragmentation() const {
+  size_t occupied = 0, requested = 0;
+  for (auto const& size_class : classes_) {
+    std::lock_guard<std::mutex> lock(size_class.mutex);
+    occupied += size_class.used * size_class.size;
+    requested += size_class.requested;
+  }
+  return occupied == 0 ? 0.0 : 1.0 - static_cast<double>(requested) / occupied;
+}
+
+size_t SlabAllocator::sizeClassIndex(const size_t bytes) const {
+  auto const& sizes = size_classes();
+  return std::lower_bound(sizes.begin(), sizes.end(), bytes) - sizes.begin();
+}
+
+}  // namespace memory
+
+}  // namespace vineyard
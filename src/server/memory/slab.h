@@ -0,0 +1,101 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef SRC_SERVER_MEMORY_SLAB_H_
+#define SRC_SERVER_MEMORY_SLAB_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <set>
+#include <vector>
+
+#include "common/util/json.h"
+
+namespace vineyard {
+
+namespace memory {
+
+/**
+ * Serves the tiny blobs from slabs of the shared memory. Each slab is carved
+ * into slots of the same size class and the blobs are packed contiguously in
+ * it, rather than being allocated (and aligned) by the bulk allocator one by
+ * one.
+ *
+ * The slab metadata lives in the server only, so that a misbehaving client
+ * cannot corrupt it.
+ */
+class SlabAllocator {
+ public:
+  /// Blobs that are larger than the threshold bypass the slabs.
+  static constexpr size_t kThreshold = 4096;
+
+  /// Size of each slab, the slabs are obtained from the bulk allocator.
+  static constexpr size_t kSlabSize = 64 * 1024;
+
+  SlabAllocator();
+
+  ~SlabAllocator();
+
+  /// Allocates from the slab of the size class of `bytes`, returns nullptr
+  /// when `bytes` exceeds the threshold or there's no enough memory.
+  void* Allocate(const size_t bytes);
+
+  /// Returns false if the pointer is not allocated from the slabs.
+  bool Free(void* pointer, const size_t bytes);
+
+  /// Bytes of shared memory that held by the slabs.
+  size_t Reserved() const;
+
+  /**
+   * Statistics of the slabs: the bytes that are reserved, occupied by slots
+   * and requested by the blobs, both in total and for each size class, as
+   * well as the internal fragmentation.
+   */
+  json Stats() const;
+
+  /// The internal fragmentation, i.e., the fraction of the occupied slots
+  /// that are not requested by the blobs.
+  double Fragmentation() const;
+
+ private:
+  struct slab_t {
+    uintptr_t base;
+    size_t used = 0;
+    std::vector<uint16_t> free_slots;
+  };
+
+  struct size_class_t {
+    size_t size = 0;
+    size_t slots = 0;
+    size_t used = 0;
+    size_t requested = 0;
+    // slabs keyed by the base address, and the ones that have free slots.
+    std::map<uintptr_t, slab_t> slabs;
+    std::set<uintptr_t> available;
+    mutable std::mutex mutex;
+  };
+
+  size_t sizeClassIndex(const size_t bytes) const;
+
+  std::vector<size_class_t> classes_;
+};
+
+}  // namespace memory
+
+}  // namespace vineyard
+
+#endif  // SRC_SERVER_MEMORY_SLAB_H_
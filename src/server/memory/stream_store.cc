@@ -15,9 +15,11 @@ limitations under the License.
 
 #include "server/memory/stream_store.h"
 
+#include <algorithm>
 #include <memory>
 #include <utility>
 
+#include "basic/stream/stream_utils.h"
 #include "common/util/callback.h"
 #include "common/util/logging.h"
 #include "server/memory/memory.h"
@@ -25,35 +27,64 @@ limitations under the License.
 namespace vineyard {
 
 #ifndef CHECK_STREAM_STATE
-#define CHECK_STREAM_STATE(condition)                                  \
+#define CHECK_STREAM_STATE(condition, ...)                             \
   do {                                                                 \
     if (!(condition)) {                                                \
       LOG(ERROR) << "Stream state error(" __FILE__                     \
                     ":" VINEYARD_TO_STRING(__LINE__) "): " #condition; \
       return callback(Status::InvalidStreamState(#condition),          \
-                      InvalidObjectID());                              \
+                      __VA_ARGS__);                                    \
     }                                                                  \
   } while (0)
 #endif  // CHECK_STREAM_STATE
 
 // manage a pool of streams.
-Status StreamStore::Create(ObjectID const stream_id) {
+Status StreamStore::Create(ObjectID const stream_id,
+                           StreamOptions const& options) {
   if (streams_.find(stream_id) != streams_.end()) {
     return Status::ObjectExists();
   }
-  streams_.emplace(stream_id, std::make_shared<StreamHolder>());
+  if (options.consumers == 0) {
+    return Status::Invalid("a stream requires at least one consumer");
+  }
+  auto stream = std::make_shared<StreamHolder>();
+  stream->consumers_.resize(options.consumers);
+  stream->max_chunks = options.max_chunks;
+  stream->max_bytes = options.max_bytes;
+  stream->max_pooled_chunks = options.pooled_chunks;
+  streams_.emplace(stream_id, stream);
   return Status::OK();
 }
 
-Status StreamStore::Open(ObjectID const stream_id, int64_t const mode) {
+Status StreamStore::Open(ObjectID const stream_id, int64_t const mode,
+                         size_t const retain_window, int const conn_id) {
   if (streams_.find(stream_id) == streams_.end()) {
     return Status::ObjectNotExists("stream cannot be open: " +
                                    ObjectIDToString(stream_id));
   }
-  if (streams_[stream_id]->open_mark & mode) {
+  auto stream = streams_.at(stream_id);
+  int64_t const read = static_cast<int64_t>(OpenStreamMode::read);
+  // a broadcast stream can be opened for reading by many connections, once
+  // for each.
+  bool read_opened = false;
+  if (stream->broadcast()) {
+    for (auto const& consumer : stream->consumers_) {
+      read_opened |= consumer.conn_id != -1 && consumer.conn_id == conn_id;
+    }
+  } else {
+    read_opened = stream->open_mark & read;
+  }
+  if ((stream->open_mark & mode & ~read) || ((mode & read) && read_opened)) {
     return Status::StreamOpened();
   }
-  streams_[stream_id]->open_mark |= mode;
+  if (mode & read) {
+    auto consumer = this->consumer(stream, conn_id);
+    if (consumer == nullptr) {
+      return Status::StreamOpened();
+    }
+    consumer->retain_window = retain_window;
+  }
+  stream->open_mark |= mode;
   return Status::OK();
 }
 
@@ -68,32 +99,30 @@ Status StreamStore::Get(ObjectID const stream_id, size_t const size,
   auto stream = streams_.at(stream_id);
 
   // precondition: there's no unsatistified writer, and still running
-  CHECK_STREAM_STATE(!stream->writer_);
-  CHECK_STREAM_STATE(!stream->drained && !stream->failed);
+  CHECK_STREAM_STATE(!stream->writer_, InvalidObjectID());
+  CHECK_STREAM_STATE(!stream->drained && !stream->failed, InvalidObjectID());
 
   // seal current chunk
   if (stream->current_writing_) {
-    stream->ready_chunks_.push(stream->current_writing_.get());
+    auto status = seal(stream, stream->current_writing_.get());
     stream->current_writing_ = boost::none;
+    if (!status.ok()) {
+      return callback(status, InvalidObjectID());
+    }
   }
-  // weak up the pending reader
-  if (stream->reader_) {
-    // should be no reading chunk
-    CHECK_STREAM_STATE(!stream->current_reading_);
-    if (!stream->ready_chunks_.empty()) {
-      stream->current_reading_ = stream->ready_chunks_.front();
-      stream->ready_chunks_.pop();
-      VINEYARD_SUPPRESS(
-          stream->reader_.get()(Status::OK(), stream->current_reading_.get()));
-      stream->reader_ = boost::none;
+  // weak up the pending readers
+  for (auto& consumer : stream->consumers_) {
+    if (consumer.reader_) {
+      // should be no reading chunk
+      CHECK_STREAM_STATE(!consumer.current_reading_, InvalidObjectID());
+      resumeReader(stream, consumer);
     }
   }
 
-  if (allocatable(stream, size)) {
+  if (writable(stream, size)) {
     // do allocation
     ObjectID chunk;
-    std::shared_ptr<Payload> object;
-    auto status = store_->Create(size, chunk, object);
+    auto status = allocate(stream, size, chunk);
     if (!status.ok()) {
       return callback(status, InvalidObjectID());
     } else {
@@ -108,61 +137,101 @@ Status StreamStore::Get(ObjectID const stream_id, size_t const size,
 }
 
 // for consumer: read current chunk
-Status StreamStore::Pull(ObjectID const stream_id,
-                         callback_t<const ObjectID> callback) {
+Status StreamStore::Pull(ObjectID const stream_id, int const conn_id,
+                         callback_t<const ObjectID, const uint64_t> callback) {
   if (streams_.find(stream_id) == streams_.end()) {
     return callback(Status::ObjectNotExists("failed to put to stream"),
-                    InvalidObjectID());
+                    InvalidObjectID(), 0);
   }
   auto stream = streams_.at(stream_id);
+  auto consumer = this->consumer(stream, conn_id);
 
-  // precondition: there's no unsatistified reader
-  CHECK_STREAM_STATE(!stream->reader_);
+  // precondition: there's a consumer for the connection, and no unsatistified
+  // reader
+  CHECK_STREAM_STATE(consumer != nullptr, InvalidObjectID(), 0);
+  CHECK_STREAM_STATE(!consumer->reader_, InvalidObjectID(), 0);
 
-  // drop current reading
-  if (stream->current_reading_) {
-    auto status = store_->Delete(stream->current_reading_.get());
+  // drop current reading, or retain it until the reader releases it
+  if (consumer->current_reading_) {
+    if (consumer->retain_window > 0) {
+      consumer->retained_chunks_.emplace_back(consumer->current_reading_.get(),
+                                              consumer->cursor - 1);
+    } else {
+      auto status = unref(stream, consumer->current_reading_.get());
+      if (!status.ok()) {
+        return callback(status, InvalidObjectID(), 0);
+      }
+    }
+    consumer->current_reading_ = boost::none;
+  }
+  // the chunk to pull counts in the window as well
+  while (consumer->retain_window > 0 &&
+         consumer->retained_chunks_.size() >= consumer->retain_window) {
+    auto status = unref(stream, consumer->retained_chunks_.front().first);
     if (!status.ok()) {
-      return callback(status, InvalidObjectID());
+      return callback(status, InvalidObjectID(), 0);
     }
-    stream->current_reading_ = boost::none;
+    consumer->retained_chunks_.pop_front();
+  }
+
+  boost::optional<ObjectID> chunk;
+  if (stream->backlog(*consumer) > 0) {
+    chunk = handOut(stream, *consumer);
   }
   // wake up the pending writer
   if (stream->writer_) {
     // should be no writing chunk
-    CHECK_STREAM_STATE(!stream->current_writing_);
-    auto writer = stream->writer_.get();
-    if (allocatable(stream, writer.first)) {
-      ObjectID chunk;
-      std::shared_ptr<Payload> object;
-      auto status = store_->Create(writer.first, chunk, object);
-      if (!status.ok()) {
-        VINEYARD_SUPPRESS(writer.second(status, InvalidObjectID()));
-      } else {
-        stream->current_writing_ = chunk;
-        VINEYARD_SUPPRESS(
-            writer.second(Status::OK(), stream->current_writing_.get()));
-        stream->writer_ = boost::none;
-      }
-    }
+    CHECK_STREAM_STATE(!stream->current_writing_, InvalidObjectID(), 0);
+    resumeWriter(stream);
   }
 
-  if (!stream->ready_chunks_.empty()) {
-    stream->current_reading_ = stream->ready_chunks_.front();
-    stream->ready_chunks_.pop();
-    return callback(Status::OK(), stream->current_reading_.get());
+  if (chunk) {
+    return callback(Status::OK(), chunk.get(), consumer->cursor - 1);
   } else {
     // if stream has been stoped, return a proper status.
     if (stream->drained) {
-      return callback(Status::StreamDrained(), InvalidObjectID());
+      return callback(Status::StreamDrained(), InvalidObjectID(), 0);
     } else if (stream->failed) {
-      return callback(Status::StreamFailed(), InvalidObjectID());
+      return callback(Status::StreamFailed(), InvalidObjectID(), 0);
     } else {
       // pending the reader
-      stream->reader_ = callback;
+      consumer->reader_ = callback;
+      return Status::OK();
+    }
+  }
+}
+
+Status StreamStore::Release(ObjectID const stream_id, int const conn_id,
+                            ObjectID const chunk, uint64_t const sequence) {
+  if (streams_.find(stream_id) == streams_.end()) {
+    return Status::ObjectNotExists("failed to release stream chunk: " +
+                                   ObjectIDToString(stream_id));
+  }
+  auto stream = streams_.at(stream_id);
+  auto consumer = this->consumer(stream, conn_id);
+  if (consumer == nullptr) {
+    return Status::InvalidStreamState("No consumer for the connection");
+  }
+  // the chunk may have been released as the retain window is exceeded, and
+  // then reused and handed out again, the sequence number tells the late
+  // release of the former handout apart.
+  if (consumer->current_reading_ && consumer->current_reading_.get() == chunk &&
+      consumer->cursor - 1 == sequence) {
+    consumer->current_reading_ = boost::none;
+  } else {
+    auto iter = std::find(consumer->retained_chunks_.begin(),
+                          consumer->retained_chunks_.end(),
+                          std::make_pair(chunk, sequence));
+    if (iter == consumer->retained_chunks_.end()) {
       return Status::OK();
     }
+    consumer->retained_chunks_.erase(iter);
+  }
+  RETURN_ON_ERROR(unref(stream, chunk));
+  if (stream->writer_ && !stream->current_writing_) {
+    resumeWriter(stream);
   }
+  return Status::OK();
 }
 
 Status StreamStore::Stop(ObjectID const stream_id, bool failed) {
@@ -181,8 +250,9 @@ Status StreamStore::Stop(ObjectID const stream_id, bool failed) {
   }
   // seal current writing chunk
   if (stream->current_writing_) {
-    stream->ready_chunks_.push(stream->current_writing_.get());
+    auto status = seal(stream, stream->current_writing_.get());
     stream->current_writing_ = boost::none;
+    RETURN_ON_ERROR(status);
   }
   // stop
   if (failed) {
@@ -190,63 +260,105 @@ Status StreamStore::Stop(ObjectID const stream_id, bool failed) {
   } else {
     stream->drained = true;
   }
-  // weak up the pending reader
-  if (stream->reader_) {
+  // the chunks to come will be deleted rather than pooled
+  Status status = releasePool(stream);
+  // weak up the pending readers
+  for (auto& consumer : stream->consumers_) {
+    if (!consumer.reader_) {
+      continue;
+    }
     // should be no reading chunk
-    if (stream->current_reading_) {
+    if (consumer.current_reading_) {
       auto err =
           Status::InvalidStreamState("Shouldn't exists a being read chunk");
-      VINEYARD_SUPPRESS(stream->reader_.get()(err, InvalidObjectID()));
-      stream->reader_ = boost::none;
-      return err;
-    }
-    if (stream->failed) {
-      VINEYARD_SUPPRESS(
-          stream->reader_.get()(Status::StreamFailed(), InvalidObjectID()));
-      stream->reader_ = boost::none;
-    } else if (!stream->ready_chunks_.empty()) {
-      stream->current_reading_ = stream->ready_chunks_.front();
-      stream->ready_chunks_.pop();
-      VINEYARD_SUPPRESS(
-          stream->reader_.get()(Status::OK(), stream->current_reading_.get()));
-      stream->reader_ = boost::none;
-    } else if (stream->drained) {
-      VINEYARD_SUPPRESS(
-          stream->reader_.get()(Status::StreamFailed(), InvalidObjectID()));
-      stream->reader_ = boost::none;
-    } else {
-      RETURN_ON_ASSERT(false, "Impossible!");
+      VINEYARD_SUPPRESS(consumer.reader_.get()(err, InvalidObjectID(), 0));
+      consumer.reader_ = boost::none;
+      status = err;
+      continue;
     }
+    resumeReader(stream, consumer);
   }
-  return Status::OK();
+  return status;
 }
 
-Status StreamStore::Drop(ObjectID const stream_id) {
+Status StreamStore::Drop(ObjectID const stream_id, int const conn_id) {
   if (streams_.find(stream_id) == streams_.end()) {
     return Status::ObjectNotExists("failed to drop stream: " +
                                    ObjectIDToString(stream_id));
   }
   auto stream = streams_.at(stream_id);
-  stream->failed = true;
+  StreamConsumer* consumer = nullptr;
+  for (auto& candidate : stream->consumers_) {
+    if (!stream->broadcast() || candidate.conn_id == conn_id) {
+      consumer = &candidate;
+      break;
+    }
+  }
+  if (consumer == nullptr || consumer->detached) {
+    return Status::OK();
+  }
   // weakup pending reader
-  if (stream->reader_) {
+  if (consumer->reader_) {
     // should be no reading chunk
-    if (stream->current_reading_) {
+    if (consumer->current_reading_) {
       return Status::InvalidStreamState("Shouldn't exists a being read chunk");
     }
     VINEYARD_SUPPRESS(
-        stream->reader_.get()(Status::StreamFailed(), InvalidObjectID()));
-    stream->reader_ = boost::none;
+        consumer->reader_.get()(Status::StreamFailed(), InvalidObjectID(), 0));
+    consumer->reader_ = boost::none;
+  }
+  // drop the chunks that the consumer hasn't read, as well as the chunks
+  // being read and retained, as the reader has gone with the connection
+  for (uint64_t seq = consumer->cursor;
+       seq < stream->head_ + stream->chunks_.size(); ++seq) {
+    RETURN_ON_ERROR(unref(stream, stream->chunks_[seq - stream->head_]));
+  }
+  if (consumer->current_reading_) {
+    RETURN_ON_ERROR(unref(stream, consumer->current_reading_.get()));
+    consumer->current_reading_ = boost::none;
+  }
+  for (auto const& retained : consumer->retained_chunks_) {
+    RETURN_ON_ERROR(unref(stream, retained.first));
+  }
+  consumer->retained_chunks_.clear();
+  consumer->detached = true;
+  trim(stream);
+  // the stream fails when all of its consumers are gone
+  bool detached = true;
+  for (auto const& candidate : stream->consumers_) {
+    detached &= candidate.detached;
+  }
+  if (detached) {
+    stream->failed = true;
+    RETURN_ON_ERROR(releasePool(stream));
   }
-  // drop all memory chunks in ready queue, but still keep the reading chunk
-  // to avoid crash the reader
-  while (!stream->ready_chunks_.empty()) {
-    RETURN_ON_ERROR(store_->Delete(stream->ready_chunks_.front()));
-    stream->ready_chunks_.pop();
+  // a lagging consumer may have gone
+  if (stream->writer_ && !stream->current_writing_) {
+    resumeWriter(stream);
   }
   return Status::OK();
 }
 
+json StreamStore::Stats() const {
+  json stats = json::object();
+  for (auto const& item : streams_) {
+    auto const& stream = item.second;
+    json entry;
+    entry["consumers"] = stream->consumers_.size();
+    entry["queue_depth"] = stream->queue_depth();
+    entry["chunks"] = stream->chunk_sizes_.size();
+    entry["bytes"] = stream->held_bytes_;
+    entry["pooled_chunks"] = stream->pooled_chunks_.size();
+    entry["max_chunks"] = stream->max_chunks;
+    entry["max_bytes"] = stream->max_bytes;
+    entry["pending_writer"] = static_cast<bool>(stream->writer_);
+    entry["drained"] = stream->drained;
+    entry["failed"] = stream->failed;
+    stats[ObjectIDToString(item.first)] = entry;
+  }
+  return stats;
+}
+
 bool StreamStore::allocatable(std::shared_ptr<StreamHolder> stream,
                               size_t size) {
   if (store_->Footprint() + size <
@@ -257,4 +369,190 @@ bool StreamStore::allocatable(std::shared_ptr<StreamHolder> stream,
   }
 }
 
+bool StreamStore::writable(std::shared_ptr<StreamHolder> stream,
+                           size_t size) {
+  // a pooled chunk requires no more memory
+  if (pooled(stream, size) == stream->pooled_chunks_.end() &&
+      !allocatable(stream, size)) {
+    return false;
+  }
+  // a single chunk is always allowed, even if it exceeds `max_bytes`.
+  if (stream->max_bytes > 0 && stream->held_bytes_ > 0 &&
+      stream->held_bytes_ + size > stream->max_bytes) {
+    return false;
+  }
+  size_t max_chunks = stream->max_chunks;
+  if (max_chunks == 0 && stream->broadcast()) {
+    max_chunks = kMaxConsumerBacklog;
+  }
+  if (max_chunks > 0 && stream->queue_depth() >= max_chunks) {
+    return false;
+  }
+  return true;
+}
+
+std::vector<std::pair<ObjectID, size_t>>::iterator StreamStore::pooled(
+    std::shared_ptr<StreamHolder> stream, size_t size) {
+  auto& pool = stream->pooled_chunks_;
+  return std::find_if(pool.begin(), pool.end(),
+                      [size](std::pair<ObjectID, size_t> const& item) {
+                        return item.second == size;
+                      });
+}
+
+Status StreamStore::allocate(std::shared_ptr<StreamHolder> stream,
+                             size_t size, ObjectID& chunk) {
+  auto iter = pooled(stream, size);
+  if (iter != stream->pooled_chunks_.end()) {
+    chunk = iter->first;
+    stream->pooled_chunks_.erase(iter);
+  } else {
+    std::shared_ptr<Payload> object;
+    RETURN_ON_ERROR(store_->Create(size, chunk, object));
+    // the chunk is mapped by the producer and the consumers until it is
+    // deleted, thus it must never be spilled.
+    store_->Pin({chunk});
+  }
+  stream->chunk_sizes_.emplace(chunk, size);
+  stream->held_bytes_ += size;
+  return Status::OK();
+}
+
+Status StreamStore::reclaim(std::shared_ptr<StreamHolder> stream,
+                            ObjectID const chunk) {
+  auto iter = stream->chunk_sizes_.find(chunk);
+  if (iter == stream->chunk_sizes_.end()) {
+    return remove(chunk);
+  }
+  size_t size = iter->second;
+  stream->held_bytes_ -= size;
+  stream->chunk_sizes_.erase(iter);
+  // empty chunks are not backed by memory
+  if (size > 0 && !stream->drained && !stream->failed &&
+      stream->pooled_chunks_.size() < stream->max_pooled_chunks) {
+    stream->pooled_chunks_.emplace_back(chunk, size);
+    return Status::OK();
+  }
+  return remove(chunk);
+}
+
+Status StreamStore::remove(ObjectID const chunk) {
+  store_->Unpin({chunk});
+  return store_->Delete(chunk);
+}
+
+Status StreamStore::releasePool(std::shared_ptr<StreamHolder> stream) {
+  Status status = Status::OK();
+  for (auto const& item : stream->pooled_chunks_) {
+    auto s = remove(item.first);
+    if (!s.ok()) {
+      status = s;
+    }
+  }
+  stream->pooled_chunks_.clear();
+  return status;
+}
+
+void StreamStore::resumeWriter(std::shared_ptr<StreamHolder> stream) {
+  auto writer = stream->writer_.get();
+  if (writable(stream, writer.first)) {
+    ObjectID chunk;
+    auto status = allocate(stream, writer.first, chunk);
+    if (!status.ok()) {
+      VINEYARD_SUPPRESS(writer.second(status, InvalidObjectID()));
+    } else {
+      stream->current_writing_ = chunk;
+      VINEYARD_SUPPRESS(
+          writer.second(Status::OK(), stream->current_writing_.get()));
+      stream->writer_ = boost::none;
+    }
+  }
+}
+
+StreamConsumer* StreamStore::consumer(std::shared_ptr<StreamHolder> stream,
+                                      int const conn_id) {
+  if (!stream->broadcast()) {
+    return &stream->consumers_[0];
+  }
+  for (auto& consumer : stream->consumers_) {
+    if (consumer.conn_id != -1 && consumer.conn_id == conn_id) {
+      return &consumer;
+    }
+  }
+  for (auto& consumer : stream->consumers_) {
+    if (consumer.conn_id == -1) {
+      consumer.conn_id = conn_id;
+      return &consumer;
+    }
+  }
+  return nullptr;
+}
+
+Status StreamStore::seal(std::shared_ptr<StreamHolder> stream,
+                         ObjectID const chunk) {
+  size_t references = 0;
+  for (auto const& consumer : stream->consumers_) {
+    references += consumer.detached ? 0 : 1;
+  }
+  if (references == 0) {
+    // nobody will read it
+    return reclaim(stream, chunk);
+  }
+  stream->chunks_.push_back(chunk);
+  stream->references_.emplace(chunk, references);
+  return Status::OK();
+}
+
+ObjectID StreamStore::handOut(std::shared_ptr<StreamHolder> stream,
+                              StreamConsumer& consumer) {
+  ObjectID chunk = stream->chunks_[consumer.cursor - stream->head_];
+  consumer.cursor += 1;
+  consumer.current_reading_ = chunk;
+  trim(stream);
+  return chunk;
+}
+
+void StreamStore::trim(std::shared_ptr<StreamHolder> stream) {
+  uint64_t cursor = stream->head_ + stream->chunks_.size();
+  for (auto const& consumer : stream->consumers_) {
+    if (!consumer.detached) {
+      cursor = std::min(cursor, consumer.cursor);
+    }
+  }
+  while (stream->head_ < cursor) {
+    stream->chunks_.pop_front();
+    stream->head_ += 1;
+  }
+}
+
+Status StreamStore::unref(std::shared_ptr<StreamHolder> stream,
+                          ObjectID const chunk) {
+  auto iter = stream->references_.find(chunk);
+  if (iter == stream->references_.end()) {
+    return Status::OK();
+  }
+  if (--iter->second > 0) {
+    return Status::OK();
+  }
+  stream->references_.erase(iter);
+  return reclaim(stream, chunk);
+}
+
+void StreamStore::resumeReader(std::shared_ptr<StreamHolder> stream,
+                               StreamConsumer& consumer) {
+  auto reader = consumer.reader_.get();
+  if (stream->failed) {
+    consumer.reader_ = boost::none;
+    VINEYARD_SUPPRESS(reader(Status::StreamFailed(), InvalidObjectID(), 0));
+  } else if (stream->backlog(consumer) > 0) {
+    consumer.reader_ = boost::none;
+    ObjectID chunk = handOut(stream, consumer);
+    VINEYARD_SUPPRESS(reader(Status::OK(), chunk, consumer.cursor - 1));
+  } else if (stream->drained) {
+    // a pending reader sees the same end as a reader that pulls later
+    consumer.reader_ = boost::none;
+    VINEYARD_SUPPRESS(reader(Status::StreamDrained(), InvalidObjectID(), 0));
+  }
+}
+
 }  // namespace vineyard
@@ -16,16 +16,41 @@ limitations under the License.
 #ifndef SRC_SERVER_MEMORY_STREAM_STORE_H_
 #define SRC_SERVER_MEMORY_STREAM_STORE_H_
 
+#include <algorithm>
+#include <deque>
 #include <memory>
-#include <queue>
 #include <unordered_map>
 #include <utility>
+#include <vector>
 
+#include "basic/stream/stream_utils.h"
 #include "common/util/callback.h"
+#include "common/util/json.h"
 #include "server/memory/memory.h"
 
 namespace vineyard {
 
+/**
+ * @brief StreamConsumer is the state of a consumer of a stream, each consumer
+ * reads the sealed chunks of the stream with its own cursor.
+ *
+ */
+struct StreamConsumer {
+  // the connection that the consumer is bound to, for broadcast streams.
+  int conn_id{-1};
+  bool detached{false};
+  // the sequence number of the next chunk to read.
+  uint64_t cursor{0};
+  // the chunk being read, whose sequence number is `cursor - 1`.
+  boost::optional<ObjectID> current_reading_;
+  // The chunks that have been pulled but not released yet by a reader that
+  // retains chunks, i.e., `retain_window` is positive, with their sequence
+  // numbers.
+  std::deque<std::pair<ObjectID, uint64_t>> retained_chunks_;
+  size_t retain_window{0};
+  boost::optional<callback_t<ObjectID, uint64_t>> reader_;
+};
+
 /**
  * @brief StreamHolder aims to maintain all chunks for a single stream.
  * "Stream" is a special kind of "Object" in vineyard, which represents
@@ -34,26 +59,80 @@ namespace vineyard {
  *
  */
 struct StreamHolder {
-  boost::optional<ObjectID> current_writing_, current_reading_;
-  std::queue<ObjectID> ready_chunks_;
-  boost::optional<callback_t<ObjectID>> reader_;
+  boost::optional<ObjectID> current_writing_;
+  // The sealed chunks that haven't been read by every consumer, the first one
+  // is the `head_`-th chunk of the stream.
+  std::deque<ObjectID> chunks_;
+  uint64_t head_{0};
+  // The number of the consumers that haven't released the chunk, the chunk
+  // is reclaimed once it drops to zero.
+  std::unordered_map<ObjectID, size_t> references_;
+  // The sizes of the chunks that haven't been reclaimed, and the total of
+  // them.
+  std::unordered_map<ObjectID, size_t> chunk_sizes_;
+  size_t held_bytes_{0};
+  size_t max_chunks{0}, max_bytes{0};
+  // The consumed chunks that are kept to be reused by the producer, with
+  // their sizes, they are not counted in `held_bytes_`.
+  std::vector<std::pair<ObjectID, size_t>> pooled_chunks_;
+  size_t max_pooled_chunks{0};
+  std::vector<StreamConsumer> consumers_;
   boost::optional<std::pair<size_t, callback_t<ObjectID>>> writer_;
   bool drained{false}, failed{false};
   int64_t open_mark{0};
+
+  bool broadcast() const { return consumers_.size() > 1; }
+
+  // The number of the sealed chunks that the consumer hasn't read.
+  size_t backlog(const StreamConsumer& consumer) const {
+    return head_ + chunks_.size() - consumer.cursor;
+  }
+
+  // The backlog of the slowest consumer that is still attached.
+  size_t queue_depth() const {
+    size_t depth = 0;
+    for (auto const& consumer : consumers_) {
+      if (!consumer.detached) {
+        depth = std::max(depth, backlog(consumer));
+      }
+    }
+    return depth;
+  }
 };
 
 /**
  * @brief StreamStore manages a pool of streams.
  *
+ * The consumers of a broadcast stream are identified by their connections:
+ * a connection is bound to a free consumer when it opens the stream for
+ * reading (or pulls from it for the first time), and the consumer is detached
+ * when the connection is closed.
+ *
+ * Besides the global footprint threshold, the buffering of each stream is
+ * bounded by its `max_chunks` and `max_bytes` options, thus a fast producer
+ * cannot starve the other streams and blobs.
  */
 class StreamStore {
  public:
+  // The default maximum number of the unread chunks of a consumer of a
+  // broadcast stream, beyond which the producer is blocked.
+  static constexpr size_t kMaxConsumerBacklog = 16;
+
   StreamStore(std::shared_ptr<BulkStore> store, size_t const stream_threshold)
       : store_(store), threshold_(stream_threshold) {}
 
-  Status Create(ObjectID const stream_id);
+  Status Create(ObjectID const stream_id,
+                StreamOptions const& options = StreamOptions{});
 
-  Status Open(ObjectID const stream_id, int64_t const mode);
+  /**
+   * @brief Open the stream for reading or writing. A reader with a positive
+   * `retain_window` keeps the pulled chunks alive until they are released
+   * explicitly, rather than dropping the current chunk on the next pull, so
+   * that the chunks can be consumed in place. When more than `retain_window`
+   * chunks are outstanding the oldest ones are released anyway.
+   */
+  Status Open(ObjectID const stream_id, int64_t const mode,
+              size_t const retain_window = 0, int const conn_id = -1);
 
   /**
    * @brief This is called by the producer of the steram and it makes current
@@ -65,10 +144,23 @@ class StreamStore {
              callback_t<const ObjectID> callback);
 
   /**
-   * @brief The consumer invokes this function to read current chunk
+   * @brief The consumer invokes this function to read current chunk, the
+   * chunk is passed to the callback along with its sequence number in the
+   * stream.
+   *
+   */
+  Status Pull(ObjectID const stream_id, int const conn_id,
+              callback_t<const ObjectID, const uint64_t> callback);
+
+  /**
+   * @brief The consumer that retains chunks invokes this function to release
+   * a chunk that has been pulled. The chunks are reused once released, thus
+   * the release is matched by both the chunk and the sequence number it is
+   * pulled with.
    *
    */
-  Status Pull(ObjectID const stream_id, callback_t<const ObjectID> callback);
+  Status Release(ObjectID const stream_id, int const conn_id,
+                 ObjectID const chunk, uint64_t const sequence);
 
   /**
    * @brief Function stop is called by the vineyard clients.
@@ -81,11 +173,67 @@ class StreamStore {
    * connections
    *
    */
-  Status Drop(ObjectID const stream_id);
+  Status Drop(ObjectID const stream_id, int const conn_id);
+
+  /**
+   * @brief The buffering of each stream, i.e., its queue depth and the chunks
+   * and bytes it holds, keyed by the stream id.
+   *
+   */
+  json Stats() const;
 
  private:
   bool allocatable(std::shared_ptr<StreamHolder> stream, size_t size);
 
+  // Whether the producer can go on, i.e., there's enough memory and the
+  // stream is within its capacity.
+  bool writable(std::shared_ptr<StreamHolder> stream, size_t size);
+
+  // The pooled chunk of the given size, or pooled_chunks_.end().
+  std::vector<std::pair<ObjectID, size_t>>::iterator pooled(
+      std::shared_ptr<StreamHolder> stream, size_t size);
+
+  // Allocates a chunk for the producer, reuses a pooled one if possible.
+  Status allocate(std::shared_ptr<StreamHolder> stream, size_t size,
+                  ObjectID& chunk);
+
+  // Returns the chunk to the pool if the stream is still running, otherwise
+  // deletes it from the bulk store.
+  Status reclaim(std::shared_ptr<StreamHolder> stream, ObjectID const chunk);
+
+  // Unpins the chunk and deletes it from the bulk store.
+  Status remove(ObjectID const chunk);
+
+  // Deletes the pooled chunks from the bulk store.
+  Status releasePool(std::shared_ptr<StreamHolder> stream);
+
+  // Allocates the chunk for the pending writer if the stream is writable.
+  void resumeWriter(std::shared_ptr<StreamHolder> stream);
+
+  // The consumer of the connection, or nullptr if all consumers have been
+  // bound to other connections.
+  StreamConsumer* consumer(std::shared_ptr<StreamHolder> stream,
+                           int const conn_id);
+
+  // Makes the chunk available to the consumers.
+  Status seal(std::shared_ptr<StreamHolder> stream, ObjectID const chunk);
+
+  // Hands the next chunk to the consumer.
+  ObjectID handOut(std::shared_ptr<StreamHolder> stream,
+                   StreamConsumer& consumer);
+
+  // Trims the chunks that have been read by every consumer.
+  void trim(std::shared_ptr<StreamHolder> stream);
+
+  // Drops a reference of the chunk, the chunk is deleted once all consumers
+  // have released it.
+  Status unref(std::shared_ptr<StreamHolder> stream, ObjectID const chunk);
+
+  // Wakes up the pending reader of the consumer if there's a chunk to read or
+  // the stream has been stopped.
+  void resumeReader(std::shared_ptr<StreamHolder> stream,
+                    StreamConsumer& consumer);
+
   std::shared_ptr<BulkStore> store_;
   size_t threshold_;
   std::unordered_map<ObjectID, std::shared_ptr<StreamHolder>> streams_;
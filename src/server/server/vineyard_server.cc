@@ -15,7 +15,9 @@ limitations under the License.
 
 #include "server/server/vineyard_server.h"
 
+#include <algorithm>
 #include <iostream>
+#include <iterator>
 #include <memory>
 #include <set>
 #include <string>
@@ -52,12 +54,17 @@ namespace vineyard {
 
 bool DeferredReq::Alive() const { return alive_fn_(); }
 
-bool DeferredReq::TestThenCall(const json& meta) const {
-  if (test_fn_(meta)) {
-    VINEYARD_SUPPRESS(call_fn_(meta));
+bool DeferredReq::TestThenCall(const MetaIndex& meta) {
+  if (finished_) {
     return true;
   }
-  return false;
+  if (!Alive()) {
+    finished_ = true;
+  } else if (test_fn_(meta)) {
+    finished_ = true;
+    VINEYARD_SUPPRESS(call_fn_(meta));
+  }
+  return finished_;
 }
 
 VineyardServer::VineyardServer(const json& spec)
@@ -72,6 +79,7 @@ VineyardServer::VineyardServer(const json& spec)
       guard_(new boost::asio::io_service::work(context_)),
       meta_guard_(new boost::asio::io_service::work(context_)),
 #endif
+      deferred_sweep_threshold_(1024),
       ready_(0) {
 }
 
@@ -92,7 +100,10 @@ Status VineyardServer::Serve() {
 
   bulk_store_ = std::make_shared<BulkStore>();
   RETURN_ON_ERROR(bulk_store_->PreAllocate(
-      spec_["bulkstore_spec"]["memory_size"].get<size_t>()));
+      spec_["bulkstore_spec"]["memory_size"].get<size_t>(),
+      spec_["bulkstore_spec"].value("allocator_arenas", 0)));
+  RETURN_ON_ERROR(bulk_store_->EnableSpill(
+      spec_["bulkstore_spec"].value("spill_path", std::string())));
   stream_store_ = std::make_shared<StreamStore>(
       bulk_store_, spec_["bulkstore_spec"]["stream_threshold"].get<size_t>());
   BulkReady();
@@ -194,75 +205,99 @@ Status VineyardServer::GetData(const std::vector<ObjectID>& ids,
                                std::function<bool()> alive,
                                callback_t<const json&> callback) {
   ENSURE_VINEYARDD_READY();
-  meta_service_ptr_->RequestToGetData(
-      sync_remote, [this, ids, wait, alive, callback](const Status& status,
-                                                      const json& meta) {
-        if (status.ok()) {
-      // When object not exists, we return an empty json, rather than
-      // the status to indicate the error.
-#if !defined(NDEBUG)
-          if (VLOG_IS_ON(10)) {
-            VLOG(10) << "Got request from client to get data, dump json:";
-            std::cerr << meta.dump(4) << std::endl;
-            VLOG(10) << "=========================================";
-          }
-#endif
-          auto test_task = [this, ids](const json& meta) -> bool {
-            for (auto const& id : ids) {
-              bool exists = false;
-              if (IsBlob(id)) {
-                exists = this->bulk_store_->Exists(id);
-              } else {
-                VINEYARD_SUPPRESS(
-                    CATCH_JSON_ERROR(meta_tree::Exists(meta, id, exists)));
-              }
-              if (!exists) {
-                return exists;
-              }
-            }
-            return true;
-          };
-          auto eval_task = [this, ids, callback](const json& meta) -> Status {
-            json sub_tree_group;
-            for (auto const& id : ids) {
-              json sub_tree;
-              if (IsBlob(id)) {
-                std::shared_ptr<Payload> object;
-                if (this->bulk_store_->Get(id, object).ok()) {
-                  sub_tree["id"] = VYObjectIDToString(id);
-                  sub_tree["typename"] = "vineyard::Blob";
-                  sub_tree["length"] = object->data_size;
-                  sub_tree["nbytes"] = object->data_size;
-                  sub_tree["transient"] = true;
-                  sub_tree["instance_id"] = this->instance_id();
-                }
-              } else {
-                VINEYARD_SUPPRESS(CATCH_JSON_ERROR(meta_tree::GetData(
-                    meta, this->instance_name(), id, sub_tree, instance_id_)));
+  auto test_task = [this, ids](const MetaIndex& meta) -> bool {
+    for (auto const& id : ids) {
+      bool exists = false;
+      if (IsBlob(id)) {
+        exists = this->bulk_store_->Exists(id);
+      } else {
+        exists = meta.Exists(id);
+      }
+      if (!exists) {
+        return exists;
+      }
+    }
+    return true;
+  };
+  auto eval_task = [this, ids, callback](const MetaIndex& meta) -> Status {
+    json sub_tree_group;
+    for (auto const& id : ids) {
+      json sub_tree;
+      if (IsBlob(id)) {
+        std::shared_ptr<Payload> object;
+        if (this->bulk_store_->Get(id, object, false).ok()) {
+          sub_tree["id"] = VYObjectIDToString(id);
+          sub_tree["typename"] = "vineyard::Blob";
+          sub_tree["length"] = object->data_size;
+          sub_tree["nbytes"] = object->data_size;
+          sub_tree["transient"] = true;
+          sub_tree["instance_id"] = this->instance_id();
+        }
+      } else {
+        VINEYARD_SUPPRESS(CATCH_JSON_ERROR(
+            meta.GetData(this->instance_name(), id, sub_tree)));
 #if !defined(NDEBUG)
-                if (VLOG_IS_ON(10)) {
-                  VLOG(10) << "Got request response:";
-                  std::cerr << sub_tree.dump(4) << std::endl;
-                  VLOG(10) << "=========================================";
-                }
+        if (VLOG_IS_ON(10)) {
+          VLOG(10) << "Got request response:";
+          std::cerr << sub_tree.dump(4) << std::endl;
+          VLOG(10) << "=========================================";
+        }
 #endif
-              }
-              if (sub_tree.is_object() && !sub_tree.empty()) {
-                sub_tree_group[VYObjectIDToString(id)] = sub_tree;
-              }
-            }
-            return callback(Status::OK(), sub_tree_group);
-          };
-          if (!wait || test_task(meta)) {
-            return eval_task(meta);
-          } else {
-            this->deferred_.emplace_back(alive, test_task, eval_task);
-            return Status::OK();
+      }
+      if (sub_tree.is_object() && !sub_tree.empty()) {
+        sub_tree_group[VYObjectIDToString(id)] = sub_tree;
+      }
+    }
+    return callback(Status::OK(), sub_tree_group);
+  };
+  // runs in the meta context, where the waiting request can be deferred.
+  auto process_task = [this, ids, wait, alive, test_task, eval_task](
+                          const Status& status, const MetaIndex& meta) {
+    if (status.ok()) {
+      // When object not exists, we return an empty json, rather than
+      // the status to indicate the error.
+      if (!wait || test_task(meta)) {
+        return eval_task(meta);
+      } else {
+        // wait for the missing objects, and the blobs are not tracked by the
+        // metadata, thus requires polling.
+        std::vector<ObjectID> missing;
+        bool polling = false;
+        for (auto const& id : ids) {
+          if (IsBlob(id)) {
+            polling = polling || !this->bulk_store_->Exists(id);
+          } else if (!meta.Exists(id)) {
+            missing.emplace_back(id);
           }
-        } else {
+        }
+        this->deferRequest(
+            std::make_shared<DeferredReq>(alive, test_task, eval_task),
+            missing, {}, polling);
+        return Status::OK();
+      }
+    } else {
+      LOG(ERROR) << status.ToString();
+      return status;
+    }
+  };
+  if (sync_remote) {
+    meta_service_ptr_->RequestToGetIndex(sync_remote, process_task);
+    return Status::OK();
+  }
+  // Serves from the snapshot on the worker threads, and falls back to the meta
+  // context only if it needs to wait for the objects.
+  meta_service_ptr_->RequestToReadSnapshot(
+      [this, wait, test_task, eval_task, process_task](const Status& status,
+                                                       const MetaIndex& meta) {
+        if (!status.ok()) {
           LOG(ERROR) << status.ToString();
           return status;
         }
+        if (!wait || test_task(meta)) {
+          return eval_task(meta);
+        }
+        meta_service_ptr_->RequestToGetIndex(false, process_task);
+        return Status::OK();
       });
   return Status::OK();
 }
@@ -271,15 +306,13 @@ Status VineyardServer::ListData(std::string const& pattern, bool const regex,
                                 size_t const limit,
                                 callback_t<const json&> callback) {
   ENSURE_VINEYARDD_READY();
-  meta_service_ptr_->RequestToGetData(
-      false,  // no need for sync from etcd
+  meta_service_ptr_->RequestToReadSnapshot(
       [this, pattern, regex, limit, callback](const Status& status,
-                                              const json& meta) {
+                                              const MetaIndex& meta) {
         if (status.ok()) {
           json sub_tree_group;
-          VINEYARD_CHECK_OK(CATCH_JSON_ERROR(
-              meta_tree::ListData(meta, this->instance_name(), pattern, regex,
-                                  limit, sub_tree_group)));
+          VINEYARD_CHECK_OK(CATCH_JSON_ERROR(meta.ListData(
+              this->instance_name(), pattern, regex, limit, sub_tree_group)));
           return callback(status, sub_tree_group);
         } else {
           LOG(ERROR) << status.ToString();
@@ -415,12 +448,13 @@ Status VineyardServer::Exists(const ObjectID id,
     });
     return Status::OK();
   }
-  meta_service_ptr_->RequestToGetData(
-      true, [id, callback](const Status& status, const json& meta) {
+  // the snapshot may miss the objects that haven't been synchronized from
+  // etcd, and may still have the ones deleted by other instances, thus the
+  // existence is always checked after a remote synchronization.
+  meta_service_ptr_->RequestToGetIndex(
+      true, [id, callback](const Status& status, const MetaIndex& meta) {
         if (status.ok()) {
-          bool exists = false;
-          auto s = CATCH_JSON_ERROR(meta_tree::Exists(meta, id, exists));
-          return callback(s, exists);
+          return callback(Status::OK(), meta.Exists(id));
         } else {
           LOG(ERROR) << status.ToString();
           return status;
@@ -608,39 +642,31 @@ Status VineyardServer::GetName(const std::string& name, const bool wait,
                                DeferredReq::alive_t alive,
                                callback_t<const ObjectID&> callback) {
   ENSURE_VINEYARDD_READY();
-  meta_service_ptr_->RequestToGetData(true, [this, name, wait, alive, callback](
-                                                const Status& status,
-                                                const json& meta) {
-    if (status.ok()) {
-      auto test_task = [name](const json& meta) -> bool {
-        auto names = meta.value("names", json(nullptr));
-        if (names.is_object()) {
-          return names.contains(name);
-        }
-        return false;
-      };
-      auto eval_task = [name, callback](const json& meta) -> Status {
-        auto names = meta.value("names", json(nullptr));
-        if (names.is_object() && names.contains(name)) {
-          auto entry = names[name];
-          if (!entry.is_null()) {
-            return callback(Status::OK(), entry.get<ObjectID>());
+  meta_service_ptr_->RequestToGetIndex(
+      true, [this, name, wait, alive, callback](const Status& status,
+                                                const MetaIndex& meta) {
+        if (status.ok()) {
+          auto test_task = [name](const MetaIndex& meta) -> bool {
+            return meta.HasName(name);
+          };
+          auto eval_task = [name, callback](const MetaIndex& meta) -> Status {
+            ObjectID object_id = InvalidObjectID();
+            auto s = meta.GetName(name, object_id);
+            return callback(s, object_id);
+          };
+          if (!wait || test_task(meta)) {
+            return eval_task(meta);
+          } else {
+            this->deferRequest(
+                std::make_shared<DeferredReq>(alive, test_task, eval_task), {},
+                {name}, false);
+            return Status::OK();
           }
+        } else {
+          LOG(ERROR) << status.ToString();
+          return status;
         }
-        return callback(Status::ObjectNotExists("failed to find name: " + name),
-                        InvalidObjectID());
-      };
-      if (!wait || test_task(meta)) {
-        return eval_task(meta);
-      } else {
-        deferred_.emplace_back(alive, test_task, eval_task);
-        return Status::OK();
-      }
-    } else {
-      LOG(ERROR) << status.ToString();
-      return status;
-    }
-  });
+      });
   return Status::OK();
 }
 
@@ -844,7 +870,16 @@ Status VineyardServer::InstanceStatus(callback_t<const json&> callback) {
   status["deployment"] = GetDeployment();
   status["memory_usage"] = bulk_store_->Footprint();
   status["memory_limit"] = bulk_store_->FootprintLimit();
-  status["deferred_requests"] = deferred_.size();
+  json slabs = bulk_store_->SlabStats();
+  status["slab_usage"] = slabs["reserved"];
+  status["slab_fragmentation"] = slabs["fragmentation"];
+  status["slabs"] = slabs;
+  json spill = bulk_store_->SpillStats();
+  status["spill_count"] = spill["spills"];
+  status["reload_count"] = spill["reloads"];
+  status["spill"] = spill;
+  status["deferred_requests"] = deferredSize();
+  status["streams"] = stream_store_->Stats();
   if (ipc_server_ptr_) {
     status["ipc_connections"] = ipc_server_ptr_->AliveConnections();
   } else {
@@ -859,11 +894,41 @@ Status VineyardServer::InstanceStatus(callback_t<const json&> callback) {
   return callback(Status::OK(), status);
 }
 
-Status VineyardServer::ProcessDeferred(const json& meta) {
-  auto iter = deferred_.begin();
-  while (iter != deferred_.end()) {
-    if (!iter->Alive() || iter->TestThenCall(meta)) {
-      deferred_.erase(iter++);
+Status VineyardServer::ProcessDeferred(const MetaIndex& meta,
+                                       const MetaIndex::updated_t& updated) {
+  // wake up the waiters of updated keys, and keep the unsatisfied ones.
+  auto wakeup = [&meta](auto& waiters, auto const& key) {
+    auto range = waiters.equal_range(key);
+    auto iter = range.first;
+    while (iter != range.second) {
+      if (iter->second->TestThenCall(meta)) {
+        iter = waiters.erase(iter);
+      } else {
+        ++iter;
+      }
+    }
+  };
+  if (updated.all) {
+    for (auto iter = object_waiters_.begin(); iter != object_waiters_.end();) {
+      iter = iter->second->TestThenCall(meta) ? object_waiters_.erase(iter)
+                                              : std::next(iter);
+    }
+    for (auto iter = name_waiters_.begin(); iter != name_waiters_.end();) {
+      iter = iter->second->TestThenCall(meta) ? name_waiters_.erase(iter)
+                                              : std::next(iter);
+    }
+  } else {
+    for (auto const& id : updated.objects) {
+      wakeup(object_waiters_, id);
+    }
+    for (auto const& name : updated.names) {
+      wakeup(name_waiters_, name);
+    }
+  }
+  auto iter = polling_waiters_.begin();
+  while (iter != polling_waiters_.end()) {
+    if ((*iter)->TestThenCall(meta)) {
+      polling_waiters_.erase(iter++);
     } else {
       ++iter;
     }
@@ -871,6 +936,46 @@ Status VineyardServer::ProcessDeferred(const json& meta) {
   return Status::OK();
 }
 
+void VineyardServer::deferRequest(std::shared_ptr<DeferredReq> const& request,
+                                  std::vector<ObjectID> const& objects,
+                                  std::vector<std::string> const& names,
+                                  bool const polling) {
+  for (auto const& id : objects) {
+    object_waiters_.emplace(id, request);
+  }
+  for (auto const& name : names) {
+    name_waiters_.emplace(name, request);
+  }
+  if (polling || (objects.empty() && names.empty())) {
+    polling_waiters_.emplace_back(request);
+  }
+  // the waiters of dead connections are only dropped when being woken up,
+  // sweep them once the registry doubles, to keep the amortized cost O(1).
+  if (deferredSize() > deferred_sweep_threshold_) {
+    sweepDeferred();
+    deferred_sweep_threshold_ = std::max<size_t>(1024, deferredSize() * 2);
+  }
+}
+
+size_t VineyardServer::deferredSize() const {
+  return object_waiters_.size() + name_waiters_.size() +
+         polling_waiters_.size();
+}
+
+void VineyardServer::sweepDeferred() {
+  auto finished = [](std::shared_ptr<DeferredReq> const& request) {
+    return request->Finished() || !request->Alive();
+  };
+  for (auto iter = object_waiters_.begin(); iter != object_waiters_.end();) {
+    iter =
+        finished(iter->second) ? object_waiters_.erase(iter) : std::next(iter);
+  }
+  for (auto iter = name_waiters_.begin(); iter != name_waiters_.end();) {
+    iter = finished(iter->second) ? name_waiters_.erase(iter) : std::next(iter);
+  }
+  polling_waiters_.remove_if(finished);
+}
+
 const std::string VineyardServer::IPCSocket() {
   if (this->ipc_server_ptr_) {
     return ipc_server_ptr_->Socket();
@@ -22,6 +22,7 @@ limitations under the License.
 #include <set>
 #include <string>
 #include <thread>
+#include <unordered_map>
 #include <vector>
 
 #include "boost/asio.hpp"
@@ -32,6 +33,7 @@ limitations under the License.
 
 #include "server/memory/memory.h"
 #include "server/memory/stream_store.h"
+#include "server/util/meta_index.h"
 
 namespace vineyard {
 
@@ -46,24 +48,38 @@ class RPCServer;
  * @brief DeferredReq aims to defer a socket request such that the request
  * is executed only when the metadata satisfies some specific condition.
  *
+ * A deferred request may wait for several objects, and thus be registered
+ * under several keys. The request is marked as finished once it has been
+ * called (or its connection has gone), and the remaining registrations are
+ * dropped lazily.
  */
 class DeferredReq {
  public:
   using alive_t = std::function<bool()>;
-  using test_t = std::function<bool(const json& meta)>;
-  using call_t = std::function<Status(const json& meta)>;
+  using test_t = std::function<bool(const MetaIndex& meta)>;
+  using call_t = std::function<Status(const MetaIndex& meta)>;
 
   DeferredReq(alive_t alive_fn, test_t test_fn, call_t call_fn)
-      : alive_fn_(alive_fn), test_fn_(test_fn), call_fn_(call_fn) {}
+      : alive_fn_(alive_fn),
+        test_fn_(test_fn),
+        call_fn_(call_fn),
+        finished_(false) {}
 
   bool Alive() const;
 
-  bool TestThenCall(const json& meta) const;
+  bool Finished() const { return finished_; }
+
+  /**
+   * @brief Returns true if the request has finished, either being called or
+   * the connection is not alive anymore.
+   */
+  bool TestThenCall(const MetaIndex& meta);
 
  private:
   alive_t alive_fn_;
   test_t test_fn_;
   call_t call_fn_;
+  bool finished_;
 };
 
 /**
@@ -151,7 +167,12 @@ class VineyardServer : public std::enable_shared_from_this<VineyardServer> {
 
   Status InstanceStatus(callback_t<const json&> callback);
 
-  Status ProcessDeferred(const json& meta);
+  /**
+   * @brief Wake up the deferred requests that wait for the updated objects and
+   * names.
+   */
+  Status ProcessDeferred(const MetaIndex& meta,
+                         const MetaIndex::updated_t& updated);
 
   inline InstanceID instance_id() { return instance_id_; }
   inline std::string instance_name() { return instance_name_; }
@@ -204,7 +225,27 @@ class VineyardServer : public std::enable_shared_from_this<VineyardServer> {
   std::unique_ptr<IPCServer> ipc_server_ptr_;
   std::unique_ptr<RPCServer> rpc_server_ptr_;
 
-  std::list<DeferredReq> deferred_;
+  /**
+   * @brief Register a deferred request, which waits for the given objects and
+   * names. The `polling` requests (e.g., waiting for blobs, which are not
+   * tracked by the metadata) are tested on every metadata update.
+   */
+  void deferRequest(std::shared_ptr<DeferredReq> const& request,
+                    std::vector<ObjectID> const& objects,
+                    std::vector<std::string> const& names, bool const polling);
+
+  size_t deferredSize() const;
+
+  void sweepDeferred();
+
+  // the deferred requests, keyed by the object ids and names they wait for,
+  // accessed in the meta context only.
+  std::unordered_multimap<ObjectID, std::shared_ptr<DeferredReq>>
+      object_waiters_;
+  std::unordered_multimap<std::string, std::shared_ptr<DeferredReq>>
+      name_waiters_;
+  std::list<std::shared_ptr<DeferredReq>> polling_waiters_;
+  size_t deferred_sweep_threshold_;
 
   std::shared_ptr<BulkStore> bulk_store_;
   std::shared_ptr<StreamStore> stream_store_;
@@ -0,0 +1,221 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include "server/services/local_meta_service.h"
+
+#include <unistd.h>
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "common/util/boost.h"
+#include "common/util/logging.h"
+
+namespace vineyard {
+
+static const char kNextInstanceIdKey[] = "/next_instance_id";
+
+void LocalMetaService::requestLock(
+    std::string lock_name,
+    callback_t<std::shared_ptr<ILock>> callback_after_locked) {
+  auto lock_ptr = std::make_shared<LocalLock>(head_rev_);
+  server_ptr_->GetMetaContext().post(
+      boost::bind(callback_after_locked, Status::OK(), lock_ptr));
+}
+
+void LocalMetaService::commitUpdates(
+    const std::vector<op_t>& changes,
+    callback_t<unsigned> callback_after_updated) {
+  // the changes have already been applied to the meta tree, the key-values
+  // are kept to serve `requestAll`.
+  for (auto const& op : changes) {
+    if (op.op == op_t::kPut) {
+      kvs_[op.kv.key] = op.kv.value;
+    } else if (op.op == op_t::kDel) {
+      kvs_.erase(op.kv.key);
+    }
+  }
+  head_rev_ += 1;
+  auto status = appendToWAL(changes);
+  server_ptr_->GetMetaContext().post(
+      boost::bind(callback_after_updated, status, head_rev_));
+}
+
+void LocalMetaService::requestAll(
+    const std::string& prefix, unsigned base_rev,
+    callback_t<const std::vector<IMetaService::op_t>&, unsigned> callback) {
+  std::vector<IMetaService::op_t> ops;
+  for (auto iter = kvs_.lower_bound(prefix);
+       iter != kvs_.end() &&
+       boost::algorithm::starts_with(iter->first, prefix);
+       ++iter) {
+    ops.emplace_back(op_t::Put(iter->first, iter->second, head_rev_));
+  }
+  server_ptr_->GetMetaContext().post(
+      boost::bind(callback, Status::OK(), ops, head_rev_));
+}
+
+void LocalMetaService::requestUpdates(
+    const std::string& prefix, unsigned,
+    callback_t<const std::vector<op_t>&, unsigned> callback) {
+  // all updates are made by this instance, and have already been applied.
+  server_ptr_->GetMetaContext().post(
+      boost::bind(callback, Status::OK(), std::vector<op_t>{}, head_rev_));
+}
+
+void LocalMetaService::startDaemonWatch(
+    const std::string& prefix, unsigned since_rev,
+    callback_t<const std::vector<op_t>&, unsigned, callback_t<unsigned>>
+        callback) {
+  // nothing to watch, as there's no other instance.
+}
+
+Status LocalMetaService::preStart() {
+  if (wal_path_.empty()) {
+    LOG(INFO) << "local meta service starts without write-ahead log";
+    return Status::OK();
+  }
+  RETURN_ON_ERROR(recoverFromWAL());
+  // start with a compacted log.
+  return compactWAL();
+}
+
+Status LocalMetaService::recoverFromWAL() {
+  std::ifstream wal(wal_path_);
+  if (!wal.is_open()) {
+    LOG(INFO) << "write-ahead log '" << wal_path_
+              << "' doesn't exist, starts with empty metadata";
+    return Status::OK();
+  }
+  std::string line;
+  size_t records = 0;
+  while (std::getline(wal, line)) {
+    if (line.empty()) {
+      continue;
+    }
+    json record = json::parse(line, nullptr, false);
+    if (record.is_discarded() || !record.is_object() ||
+        !record.contains("op") || !record["op"].is_string() ||
+        !record.contains("key") || !record["key"].is_string()) {
+      // the last record might be partially written when crashed.
+      LOG(WARNING) << "skip the broken record in write-ahead log: " << line;
+      break;
+    }
+    // the logs written by the earlier versions may have the other keys
+    if (record["key"].get_ref<std::string const&>() != kNextInstanceIdKey) {
+      continue;
+    }
+    if (record["op"].get_ref<std::string const&>() == "put") {
+      kvs_[kNextInstanceIdKey] = record.value("value", "");
+    } else {
+      kvs_.erase(kNextInstanceIdKey);
+    }
+    records += 1;
+  }
+  LOG(INFO) << "replayed " << records << " records of the instance counter "
+            << "in write-ahead log '" << wal_path_ << "'";
+  return Status::OK();
+}
+
+static Status write_wal_record(FILE* wal, IMetaService::op_t const& op) {
+  json record;
+  if (op.op == IMetaService::op_t::kPut) {
+    record["op"] = "put";
+    record["value"] = op.kv.value;
+  } else {
+    record["op"] = "del";
+  }
+  record["key"] = op.kv.key;
+  std::string line = record.dump();
+  line.push_back('\n');
+  if (fwrite(line.data(), 1, line.size(), wal) != line.size()) {
+    return Status::IOError("Failed to write the write-ahead log: " +
+                           std::string(strerror(errno)));
+  }
+  return Status::OK();
+}
+
+static Status sync_wal(FILE* wal) {
+  if (fflush(wal) != 0 || fdatasync(fileno(wal)) != 0) {
+    return Status::IOError("Failed to sync the write-ahead log: " +
+                           std::string(strerror(errno)));
+  }
+  return Status::OK();
+}
+
+Status LocalMetaService::appendToWAL(const std::vector<op_t>& ops) {
+  if (wal_ == nullptr) {
+    return Status::OK();
+  }
+  // only the instance counter is recovered, thus the other updates are not
+  // logged, and the commits that don't touch the counter never sync.
+  size_t records = 0;
+  for (auto const& op : ops) {
+    if (op.kv.key == kNextInstanceIdKey) {
+      RETURN_ON_ERROR(write_wal_record(wal_, op));
+      records += 1;
+    }
+  }
+  if (records == 0) {
+    return Status::OK();
+  }
+  RETURN_ON_ERROR(sync_wal(wal_));
+  wal_records_ += records;
+  if (wal_records_ > 1024) {
+    RETURN_ON_ERROR(compactWAL());
+  }
+  return Status::OK();
+}
+
+Status LocalMetaService::compactWAL() {
+  if (wal_) {
+    fclose(wal_);
+    wal_ = nullptr;
+  }
+  std::string compacted_path = wal_path_ + ".compact";
+  FILE* compacted = fopen(compacted_path.c_str(), "w");
+  if (compacted == nullptr) {
+    return Status::IOError("Failed to create the write-ahead log '" +
+                           compacted_path + "': " + strerror(errno));
+  }
+  Status status;
+  auto counter = kvs_.find(kNextInstanceIdKey);
+  if (counter != kvs_.end()) {
+    status = write_wal_record(
+        compacted, op_t::Put(counter->first, counter->second, 0));
+  }
+  if (status.ok()) {
+    status = sync_wal(compacted);
+  }
+  fclose(compacted);
+  RETURN_ON_ERROR(status);
+  if (rename(compacted_path.c_str(), wal_path_.c_str()) != 0) {
+    return Status::IOError("Failed to replace the write-ahead log '" +
+                           wal_path_ + "': " + strerror(errno));
+  }
+  wal_ = fopen(wal_path_.c_str(), "a");
+  if (wal_ == nullptr) {
+    return Status::IOError("Failed to open the write-ahead log '" + wal_path_ +
+                           "': " + strerror(errno));
+  }
+  wal_records_ = counter != kvs_.end() ? 1 : 0;
+  return Status::OK();
+}
+
+}  // namespace vineyard
@@ -0,0 +1,121 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#ifndef SRC_SERVER_SERVICES_LOCAL_META_SERVICE_H_
+#define SRC_SERVER_SERVICES_LOCAL_META_SERVICE_H_
+
+#include <stdio.h>
+
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "server/services/meta_service.h"
+
+namespace vineyard {
+
+/**
+ * @brief LocalLock is a no-op lock, as there's only a single instance that
+ * accesses the local meta service.
+ *
+ */
+class LocalLock : public ILock {
+ public:
+  Status Release(unsigned& rev) override {
+    rev = GetRev();
+    return Status::OK();
+  }
+  ~LocalLock() override {}
+
+  explicit LocalLock(unsigned rev) : ILock(rev) {}
+};
+
+/**
+ * @brief LocalMetaService keeps the metadata in the process of vineyardd, for
+ * the single-node deployment, without the round trips to etcd. The metadata is
+ * scoped to a single instance, as the blobs are gone with the process, thus
+ * only the instance counter is persisted, to a write-ahead log on local disk
+ * if enabled, to keep the instance ids unique across restarts.
+ *
+ */
+class LocalMetaService : public IMetaService {
+ public:
+  inline void Stop() override {
+    if (wal_) {
+      fclose(wal_);
+      wal_ = nullptr;
+    }
+  }
+
+  ~LocalMetaService() override { Stop(); }
+
+ protected:
+  explicit LocalMetaService(vs_ptr_t& server_ptr)
+      : IMetaService(server_ptr),
+        meta_spec_(server_ptr_->GetSpec()["metastore_spec"]),
+        wal_path_(meta_spec_.value("wal", "")),
+        wal_(nullptr),
+        wal_records_(0),
+        head_rev_(1) {}
+
+  void requestLock(
+      std::string lock_name,
+      callback_t<std::shared_ptr<ILock>> callback_after_locked) override;
+
+  void requestAll(
+      const std::string& prefix, unsigned base_rev,
+      callback_t<const std::vector<op_t>&, unsigned> callback) override;
+
+  void requestUpdates(
+      const std::string& prefix, unsigned since_rev,
+      callback_t<const std::vector<op_t>&, unsigned> callback) override;
+
+  void commitUpdates(const std::vector<op_t>&,
+                     callback_t<unsigned> callback_after_updated) override;
+
+  void startDaemonWatch(
+      const std::string& prefix, unsigned since_rev,
+      callback_t<const std::vector<op_t>&, unsigned, callback_t<unsigned>>
+          callback) override;
+
+  Status probe() override { return Status::OK(); }
+
+  const json meta_spec_;
+  const std::string wal_path_;
+
+ private:
+  Status preStart() override;
+
+  // replay the instance counter from the write-ahead log into `kvs_`.
+  Status recoverFromWAL();
+
+  // logs the updates of the instance counter, the other updates are skipped.
+  Status appendToWAL(const std::vector<op_t>& ops);
+
+  // rewrite the write-ahead log with the latest instance counter only.
+  Status compactWAL();
+
+  FILE* wal_;
+  size_t wal_records_;
+
+  std::map<std::string, std::string> kvs_;
+  unsigned head_rev_;
+
+  friend class IMetaService;
+};
+
+}  // namespace vineyard
+
+#endif  // SRC_SERVER_SERVICES_LOCAL_META_SERVICE_H_
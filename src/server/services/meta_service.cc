@@ -21,11 +21,16 @@ limitations under the License.
 #include "glog/logging.h"
 
 #include "server/services/etcd_meta_service.h"
+#include "server/services/local_meta_service.h"
 #include "server/util/meta_tree.h"
 
 namespace vineyard {
 
 std::shared_ptr<IMetaService> IMetaService::Get(vs_ptr_t ptr) {
+  auto const& meta_spec = ptr->GetSpec()["metastore_spec"];
+  if (meta_spec.value("meta", "etcd") == "local") {
+    return std::shared_ptr<IMetaService>(new LocalMetaService(ptr));
+  }
   return std::shared_ptr<IMetaService>(new EtcdMetaService(ptr));
 }
 
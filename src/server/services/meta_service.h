@@ -16,10 +16,12 @@ limitations under the License.
 #ifndef SRC_SERVER_SERVICES_META_SERVICE_H_
 #define SRC_SERVER_SERVICES_META_SERVICE_H_
 
+#include <atomic>
 #include <chrono>
 #include <iostream>
 #include <map>
 #include <memory>
+#include <mutex>
 #include <set>
 #include <string>
 #include <vector>
@@ -37,6 +39,7 @@ limitations under the License.
 #include "common/util/logging.h"
 #include "common/util/status.h"
 #include "server/server/vineyard_server.h"
+#include "server/util/meta_index.h"
 #include "server/util/metrics.h"
 
 #define HEARTBEAT_TIME 60
@@ -125,7 +128,11 @@ class IMetaService {
   };
   virtual ~IMetaService() {}
   explicit IMetaService(vs_ptr_t& server_ptr)
-      : server_ptr_(server_ptr), rev_(0), meta_sync_lock_("/meta_sync_lock") {}
+      : server_ptr_(server_ptr),
+        rev_(0),
+        meta_sync_lock_("/meta_sync_lock"),
+        meta_version_(0),
+        snapshot_version_(0) {}
 
   static std::shared_ptr<IMetaService> Get(vs_ptr_t);
 
@@ -249,6 +256,52 @@ class IMetaService {
     }
   }
 
+  /**
+   * @brief Read the metadata from an immutable snapshot of the meta index. The
+   * callback runs on the worker threads, so readers don't queue up behind the
+   * tasks in the meta context. The snapshot is only rebuilt (in the meta
+   * context) when the meta tree has been changed since the last snapshot, thus
+   * the changes that have been replied to clients are always visible.
+   */
+  inline void RequestToReadSnapshot(callback_t<const MetaIndex&> callback) {
+    std::shared_ptr<const MetaIndex> snapshot = nullptr;
+    {
+      std::lock_guard<std::mutex> guard(snapshot_mutex_);
+      if (snapshot_ && snapshot_version_ == meta_version_.load()) {
+        snapshot = snapshot_;
+      }
+    }
+    if (snapshot) {
+      server_ptr_->GetContext().post([snapshot, callback]() {
+        VINEYARD_DISCARD(callback(Status::OK(), *snapshot));
+      });
+      return;
+    }
+    server_ptr_->GetMetaContext().post([this, callback]() {
+      auto snapshot = this->takeSnapshot();
+      server_ptr_->GetContext().post([snapshot, callback]() {
+        VINEYARD_DISCARD(callback(Status::OK(), *snapshot));
+      });
+    });
+  }
+
+  /**
+   * @brief Like `RequestToGetData`, but read the metadata from the index.
+   */
+  inline void RequestToGetIndex(const bool sync_remote,
+                                callback_t<const MetaIndex&> callback) {
+    if (sync_remote) {
+      requestValues("", [this, callback](const Status& status, const json& meta,
+                                         unsigned rev) {
+        return callback(status, index_);
+      });
+    } else {
+      server_ptr_->GetMetaContext().post([this, callback]() {
+        VINEYARD_DISCARD(callback(Status::OK(), index_));
+      });
+    }
+  }
+
   inline void RequestToDelete(
       const std::vector<ObjectID>& object_ids, const bool force,
       const bool deep,
@@ -574,7 +627,28 @@ class IMetaService {
 
   void printDepsGraph();
 
+  // must be called in the meta context.
+  std::shared_ptr<const MetaIndex> takeSnapshot() {
+    const uint64_t version = meta_version_.load();
+    {
+      std::lock_guard<std::mutex> guard(snapshot_mutex_);
+      if (snapshot_ && snapshot_version_ == version) {
+        return snapshot_;
+      }
+    }
+    // only the meta context changes `index_`, copy it outside the lock. The
+    // copy shares the shards of the index, and the next update only clones
+    // the shards it touches.
+    auto snapshot = std::make_shared<const MetaIndex>(index_);
+    std::lock_guard<std::mutex> guard(snapshot_mutex_);
+    snapshot_ = snapshot;
+    snapshot_version_ = version;
+    return snapshot;
+  }
+
   json meta_;
+  // the index of `meta_`, for the read requests.
+  MetaIndex index_;
   vs_ptr_t server_ptr_;
 
   unsigned rev_;
@@ -582,6 +656,12 @@ class IMetaService {
 
   std::string meta_sync_lock_;
 
+  // bumped after every change to `meta_`, to invalidate the snapshot.
+  std::atomic<uint64_t> meta_version_;
+  std::mutex snapshot_mutex_;  // protects snapshot_ and snapshot_version_
+  std::shared_ptr<const MetaIndex> snapshot_;
+  uint64_t snapshot_version_;
+
  private:
   virtual Status preStart() { return Status::OK(); }
 
@@ -614,6 +694,9 @@ class IMetaService {
     std::vector<op_t> add_datas, drop_datas;
     std::vector<op_t> add_others, drop_others;
 
+    // the keys to update in the index
+    std::set<std::string> index_keys;
+
     // group-by all changes
     for (const op_t& op : ops) {
       if (op.kv.rev != 0 && op.kv.rev <= rev_) {
@@ -645,6 +728,7 @@ class IMetaService {
         VLOG(11) << "update op in meta tree: " << op.ToString();
       }
 #endif
+      index_keys.emplace(op.kv.key);
 
       if (boost::algorithm::starts_with(op.kv.key, "/signatures/")) {
         if (op.op == op_t::op_type_t::kPut) {
@@ -722,6 +806,7 @@ class IMetaService {
       // 3. execute delete for every object
       for (auto const target : processed_delete_set) {
         delVal(target, blobs_to_delete);
+        index_keys.emplace("/data/" + ObjectIDToString(target));
       }
     }
 
@@ -745,8 +830,14 @@ class IMetaService {
     }
 #endif
 
+    MetaIndex::updated_t updated;
+    if (!index_keys.empty()) {
+      index_.Update(meta_, index_keys, updated);
+      meta_version_.fetch_add(1);
+    }
+
     VINEYARD_SUPPRESS(server_ptr_->DeleteBlobBatch(blobs_to_delete));
-    VINEYARD_SUPPRESS(server_ptr_->ProcessDeferred(meta_));
+    VINEYARD_SUPPRESS(server_ptr_->ProcessDeferred(index_, updated));
   }
 
   void instanceUpdate(const op_t& op) {
@@ -0,0 +1,345 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include "server/util/meta_index.h"
+
+#include <fnmatch.h>
+
+#include <algorithm>
+#include <regex>
+#include <utility>
+
+#include "boost/algorithm/string.hpp"
+
+#include "common/util/logging.h"
+#include "server/util/meta_tree.h"
+
+namespace vineyard {
+
+/**
+ * Split the key of meta tree into unescaped segments, following the rules of
+ * json pointer.
+ */
+static void split_key(const std::string& key,
+                      std::vector<std::string>& segments) {
+  segments.clear();
+  boost::algorithm::split(segments, key, [](const char c) { return c == '/'; });
+  if (!segments.empty() && segments[0].empty()) {
+    segments.erase(segments.begin());
+  }
+  for (auto& segment : segments) {
+    boost::algorithm::replace_all(segment, "~1", "/");
+    boost::algorithm::replace_all(segment, "~0", "~");
+  }
+}
+
+void MetaIndex::Update(const json& tree, const std::set<std::string>& keys,
+                       updated_t& updated) {
+  std::set<std::vector<std::string>> visited;
+  std::vector<std::string> segments;
+  for (auto const& key : keys) {
+    split_key(key, segments);
+    if (segments.empty() || segments[0].empty()) {
+      continue;
+    }
+    const std::string& section = segments[0];
+    size_t depth = section == "signatures" ? 3 : 2;
+    if (segments.size() > depth) {
+      segments.resize(depth);
+    }
+    if (!visited.emplace(segments).second) {
+      continue;
+    }
+    if (segments.size() < depth) {
+      updateSection(tree, section);
+      updated.all = true;
+    } else if (section == "data") {
+      updateObject(tree, segments[1]);
+      updated.objects.emplace(ObjectIDFromString(segments[1]));
+    } else if (section == "signatures") {
+      updateSignature(tree, segments[1], segments[2]);
+    } else if (section == "names") {
+      updateName(tree, segments[1]);
+      updated.names.emplace(segments[1]);
+    }
+  }
+}
+
+bool MetaIndex::Exists(const ObjectID id) const {
+  return objects_.find(id) != nullptr;
+}
+
+Status MetaIndex::GetData(const std::string& instance_name, const ObjectID id,
+                          json& sub_tree) const {
+  return GetData(instance_name, ObjectIDToString(id), sub_tree);
+}
+
+Status MetaIndex::GetData(const std::string& instance_name,
+                          const std::string& name, json& sub_tree) const {
+  sub_tree.clear();
+  if (name.find('/') != std::string::npos) {
+    LOG(ERROR) << "meta tree name invalid. " << name;
+    return Status::MetaTreeNameInvalid();
+  }
+  auto entry = objects_.find(ObjectIDFromString(name));
+  if (entry == nullptr || (*entry)->name != name) {
+    return Status::MetaTreeSubtreeNotExists("get subtree failed: " + name);
+  }
+  const object_t& object = **entry;
+  RETURN_ON_ERROR(object.status);
+  sub_tree = object.values;
+  for (auto const& member : object.members) {
+    std::string member_name = member.name;
+    // the member name might be a signature
+    if (member_name[0] == 's') {
+      member_name = objectIdFromSignature(instance_name, member_name);
+    }
+    json member_tree;
+    auto status = GetData(instance_name, member_name, member_tree);
+    if (status.ok()) {
+      sub_tree[member.key] = std::move(member_tree);
+    } else if (IsBlob(ObjectIDFromString(member_name)) &&
+               status.IsMetaTreeSubtreeNotExists()) {
+      // make an empty blob
+      member_tree["id"] = member_name;
+      member_tree["typename"] = "vineyard::Blob";
+      member_tree["length"] = 0;
+      member_tree["nbytes"] = 0;
+      member_tree["instance_id"] = member.instance_id;
+      member_tree["transient"] = true;
+      sub_tree[member.key] = std::move(member_tree);
+    } else {
+      sub_tree.clear();
+      return status;
+    }
+  }
+  sub_tree["id"] = name;
+  return Status::OK();
+}
+
+Status MetaIndex::ListData(const std::string& instance_name,
+                           const std::string& pattern, bool const regex,
+                           size_t const limit, json& tree_group) const {
+  std::regex regex_pattern;
+  if (regex) {
+    // pre-compile regex pattern, and for invalid regex pattern, return nothing.
+    try {
+      regex_pattern = std::regex(pattern);
+    } catch (std::regex_error const&) { return Status::OK(); }
+  }
+
+  // collect the matched (and invalid) objects, then visit them in the order of
+  // names, to be consistent with the meta tree.
+  std::vector<std::shared_ptr<const object_t>> candidates;
+  objects_.for_each([&](const ObjectID,
+                         std::shared_ptr<const object_t> const& object) {
+    if (!object->type_status.ok()) {
+      candidates.emplace_back(object);
+      return;
+    }
+    bool matched = false;
+    if (regex) /* regex match */ {
+      std::cmatch __m;
+      matched = std::regex_match(object->type.c_str(), __m, regex_pattern);
+    } else /* wildcard match */ {
+      // https://www.man7.org/linux/man-pages/man3/fnmatch.3.html
+      matched = fnmatch(pattern.c_str(), object->type.c_str(), 0) == 0;
+    }
+    if (matched) {
+      candidates.emplace_back(object);
+    }
+  });
+  std::sort(candidates.begin(), candidates.end(),
+            [](std::shared_ptr<const object_t> const& lhs,
+               std::shared_ptr<const object_t> const& rhs) {
+              return lhs->name < rhs->name;
+            });
+
+  size_t found = 0;
+  for (auto const& object : candidates) {
+    if (found >= limit) {
+      break;
+    }
+    RETURN_ON_ERROR(object->type_status);
+    found += 1;
+    json object_meta_tree;
+    RETURN_ON_ERROR(GetData(instance_name, object->name, object_meta_tree));
+    tree_group[object->name] = object_meta_tree;
+  }
+  return Status::OK();
+}
+
+bool MetaIndex::HasName(const std::string& name) const {
+  return names_.find(name) != nullptr;
+}
+
+Status MetaIndex::GetName(const std::string& name, ObjectID& id) const {
+  auto entry = names_.find(name);
+  if (entry == nullptr) {
+    return Status::ObjectNotExists("failed to find name: " + name);
+  }
+  id = *entry;
+  return Status::OK();
+}
+
+void MetaIndex::updateObject(const json& tree, const std::string& name) {
+  const ObjectID id = ObjectIDFromString(name);
+  auto data = tree.find("data");
+  if (data == tree.end() || !data->is_object() ||
+      data->find(name) == data->end()) {
+    objects_.erase(id);
+    return;
+  }
+  json const& sub_tree = (*data)[name];
+
+  auto object = std::make_shared<object_t>();
+  object->name = name;
+  object->values = json::object();
+  if (!sub_tree.is_object() || sub_tree.empty()) {
+    object->status =
+        Status::MetaTreeSubtreeNotExists("get subtree failed: " + name);
+    object->type_status = Status::MetaTreeInvalid();
+    objects_.at(id) = object;
+    return;
+  }
+
+  // decode the typename, see also `meta_tree::ListData`.
+  auto type_iter = sub_tree.find("typename");
+  if (type_iter == sub_tree.end()) {
+    object->type_status = Status::MetaTreeNameNotExists();
+  } else if (!type_iter->is_string()) {
+    object->type_status = Status::MetaTreeTypeInvalid();
+  } else {
+    meta_tree::NodeType node_type = meta_tree::NodeType::InvalidType;
+    meta_tree::decode_value(type_iter->get_ref<std::string const&>(),
+                            node_type, object->type);
+    if (node_type != meta_tree::NodeType::Value) {
+      object->type_status = Status::MetaTreeTypeInvalid();
+    }
+  }
+
+  // decode values and members, see also `meta_tree::GetData`.
+  for (auto const& item : json::iterator_wrapper(sub_tree)) {
+    if (!item.value().is_string()) {
+      object->values[item.key()] = item.value();
+      continue;
+    }
+    meta_tree::NodeType node_type = meta_tree::NodeType::InvalidType;
+    std::string value;
+    meta_tree::decode_value(item.value().get_ref<std::string const&>(),
+                            node_type, value);
+    if (node_type == meta_tree::NodeType::Value) {
+      object->values[item.key()] = value;
+    } else if (node_type == meta_tree::NodeType::Link) {
+      member_t member;
+      member.key = item.key();
+      std::string member_type;
+      object->status = meta_tree::parse_link(value, member_type, member.name,
+                                             member.instance_id);
+      if (!object->status.ok()) {
+        break;
+      }
+      object->members.emplace_back(std::move(member));
+    } else {
+      object->status = Status::MetaTreeTypeInvalid();
+      break;
+    }
+  }
+  objects_.at(id) = object;
+}
+
+void MetaIndex::updateSignature(const json& tree,
+                                const std::string& instance_name,
+                                const std::string& signature) {
+  auto signatures = tree.find("signatures");
+  if (signatures != tree.end() && signatures->is_object()) {
+    auto instance = signatures->find(instance_name);
+    if (instance != signatures->end() && instance->is_object()) {
+      auto value = instance->find(signature);
+      if (value != instance->end() && value->is_string()) {
+        signatures_.at(signature)[instance_name] =
+            value->get_ref<std::string const&>();
+        return;
+      }
+    }
+  }
+  auto entry = signatures_.find(signature);
+  if (entry != nullptr && entry->find(instance_name) != entry->end()) {
+    auto& instances = signatures_.at(signature);
+    instances.erase(instance_name);
+    if (instances.empty()) {
+      signatures_.erase(signature);
+    }
+  }
+}
+
+void MetaIndex::updateName(const json& tree, const std::string& name) {
+  auto names = tree.find("names");
+  if (names != tree.end() && names->is_object()) {
+    auto value = names->find(name);
+    if (value != names->end() && value->is_number_unsigned()) {
+      names_.at(name) = value->get<ObjectID>();
+      return;
+    }
+  }
+  names_.erase(name);
+}
+
+void MetaIndex::updateSection(const json& tree, const std::string& section) {
+  auto entries = tree.find(section);
+  if (section == "data") {
+    objects_.clear();
+    if (entries != tree.end() && entries->is_object()) {
+      for (auto const& item : json::iterator_wrapper(*entries)) {
+        updateObject(tree, item.key());
+      }
+    }
+  } else if (section == "signatures") {
+    signatures_.clear();
+    if (entries != tree.end() && entries->is_object()) {
+      for (auto const& instance : json::iterator_wrapper(*entries)) {
+        if (!instance.value().is_object()) {
+          continue;
+        }
+        for (auto const& item : json::iterator_wrapper(instance.value())) {
+          updateSignature(tree, instance.key(), item.key());
+        }
+      }
+    }
+  } else if (section == "names") {
+    names_.clear();
+    if (entries != tree.end() && entries->is_object()) {
+      for (auto const& item : json::iterator_wrapper(*entries)) {
+        updateName(tree, item.key());
+      }
+    }
+  }
+}
+
+std::string MetaIndex::objectIdFromSignature(
+    const std::string& instance_name, const std::string& signature) const {
+  auto entry = signatures_.find(signature);
+  if (entry != nullptr && !entry->empty()) {
+    auto instance = entry->find(instance_name);
+    if (instance != entry->end()) {
+      return instance->second;
+    }
+    return entry->begin()->second;
+  }
+  LOG(ERROR) << "Failed to resolve object ID from signature: for "
+             << signature;
+  return ObjectIDToString(InvalidObjectID());
+}
+
+}  // namespace vineyard
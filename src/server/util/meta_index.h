@@ -0,0 +1,196 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#ifndef SRC_SERVER_UTIL_META_INDEX_H_
+#define SRC_SERVER_UTIL_META_INDEX_H_
+
+#include <atomic>
+#include <functional>
+#include <map>
+#include <memory>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "common/util/json.h"
+#include "common/util/status.h"
+#include "common/util/uuid.h"
+
+namespace vineyard {
+
+/**
+ * @brief A hash map split into a fixed number of shards, which are shared
+ * between the copies of the map. Copying the map only copies the shard
+ * pointers, and a shard is cloned on its first write after being shared, thus
+ * a write costs the size of one shard rather than the whole map.
+ *
+ * The copies can be read concurrently, but all writes must happen on the
+ * thread that makes the copies.
+ */
+template <typename K, typename V>
+class CowShardedMap {
+ public:
+  using map_t = std::unordered_map<K, V>;
+
+  CowShardedMap() : shards_(kShards) {
+    for (auto& shard : shards_) {
+      shard = std::make_shared<map_t>();
+    }
+  }
+
+  const V* find(const K& key) const {
+    auto const& shard = *shards_[index(key)];
+    auto iter = shard.find(key);
+    return iter == shard.end() ? nullptr : &iter->second;
+  }
+
+  /**
+   * @brief Get the value of the key for writing, inserts a default one if the
+   * key doesn't exist.
+   */
+  V& at(const K& key) { return mutable_shard(key)[key]; }
+
+  void erase(const K& key) {
+    if (find(key) != nullptr) {
+      mutable_shard(key).erase(key);
+    }
+  }
+
+  void clear() {
+    for (auto& shard : shards_) {
+      shard = std::make_shared<map_t>();
+    }
+  }
+
+  size_t size() const {
+    size_t size = 0;
+    for (auto const& shard : shards_) {
+      size += shard->size();
+    }
+    return size;
+  }
+
+  void for_each(std::function<void(const K&, const V&)> fn) const {
+    for (auto const& shard : shards_) {
+      for (auto const& item : *shard) {
+        fn(item.first, item.second);
+      }
+    }
+  }
+
+ private:
+  static constexpr size_t kShards = 256;
+
+  size_t index(const K& key) const { return std::hash<K>()(key) % kShards; }
+
+  map_t& mutable_shard(const K& key) {
+    auto& shard = shards_[index(key)];
+    if (shard.use_count() > 1) {
+      shard = std::make_shared<map_t>(*shard);
+    } else {
+      // pairs with the release of the copies that dropped their references
+      std::atomic_thread_fence(std::memory_order_acquire);
+    }
+    return *shard;
+  }
+
+  std::vector<std::shared_ptr<map_t>> shards_;
+};
+
+/**
+ * @brief MetaIndex is a read-optimized view of the meta tree. The objects are
+ * indexed by `ObjectID`, with the members decoded into typed edges, and the
+ * signatures and names are indexed as well. Thus the existence checks are O(1)
+ * and the metadata of an object can be materialized without resolving json
+ * pointers or parsing the links again.
+ *
+ * The index is maintained by the meta service along with the meta tree, which
+ * is still the source of truth to synchronize with the metadata backend. The
+ * indexed objects are immutable, and the entries are kept in copy-on-write
+ * shards, so a copy (e.g., the snapshot for concurrent readers) doesn't copy
+ * the entries, and the next update only clones the shards it touches.
+ */
+class MetaIndex {
+ public:
+  struct member_t {
+    std::string key;
+    std::string name;  // object id, or signature of the member
+    InstanceID instance_id;
+  };
+
+  struct object_t {
+    std::string name;
+    Status status;       // error when decoding the object
+    Status type_status;  // error when decoding the typename
+    std::string type;
+    json values;  // decoded plain values
+    std::vector<member_t> members;
+  };
+
+  struct updated_t {
+    std::set<ObjectID> objects;
+    std::set<std::string> names;
+    bool all = false;  // the whole section has been reindexed
+  };
+
+  /**
+   * @brief Reindex the entries that are affected by the given keys of the meta
+   * tree, e.g., "/data/<object_id>/<field>", "/names/<name>", etc.
+   *
+   * The updated objects and names are reported in `updated`.
+   */
+  void Update(const json& tree, const std::set<std::string>& keys,
+              updated_t& updated);
+
+  bool Exists(const ObjectID id) const;
+
+  Status GetData(const std::string& instance_name, const ObjectID id,
+                 json& sub_tree) const;
+
+  Status GetData(const std::string& instance_name, const std::string& name,
+                 json& sub_tree) const;
+
+  Status ListData(const std::string& instance_name, const std::string& pattern,
+                  bool const regex, size_t const limit,
+                  json& tree_group) const;
+
+  bool HasName(const std::string& name) const;
+
+  Status GetName(const std::string& name, ObjectID& id) const;
+
+  size_t Size() const { return objects_.size(); }
+
+ private:
+  void updateObject(const json& tree, const std::string& name);
+
+  void updateSignature(const json& tree, const std::string& instance_name,
+                       const std::string& signature);
+
+  void updateName(const json& tree, const std::string& name);
+
+  void updateSection(const json& tree, const std::string& section);
+
+  std::string objectIdFromSignature(const std::string& instance_name,
+                                    const std::string& signature) const;
+
+  CowShardedMap<ObjectID, std::shared_ptr<const object_t>> objects_;
+  // signature -> instance name -> object id
+  CowShardedMap<std::string, std::map<std::string, std::string>> signatures_;
+  CowShardedMap<std::string, ObjectID> names_;
+};
+
+}  // namespace vineyard
+
+#endif  // SRC_SERVER_UTIL_META_INDEX_H_
@@ -44,8 +44,8 @@ namespace vineyard {
 
 namespace meta_tree {
 
-static void decode_value(const std::string& str, NodeType& type,
-                         std::string& value) {
+void decode_value(const std::string& str, NodeType& type,
+                  std::string& value) {
   if (str[0] == 'v') {
     type = NodeType::Value;
     value = str.substr(1);
@@ -84,8 +84,8 @@ static bool __attribute__((used)) is_value_node(const std::string& str) {
  * + for non-blob types, link is: "<name>.<type>".
  * + for blobs, link is "<name>.<type>@instance_id".
  */
-static Status parse_link(const std::string& str, std::string& type,
-                         std::string& name, InstanceID& instance_id) {
+Status parse_link(const std::string& str, std::string& type,
+                  std::string& name, InstanceID& instance_id) {
   std::string::size_type at = str.find('@');
 
   if (at != std::string::npos) {
@@ -33,6 +33,19 @@ enum class NodeType {
   InvalidType = 15,
 };
 
+/**
+ * @brief Decode the value of the meta tree node, which is prefixed by the
+ * `NodeType` ('v' for values and 'l' for links).
+ */
+void decode_value(const std::string& str, NodeType& type, std::string& value);
+
+/**
+ * @brief Parse the link node, which is "<name>.<type>" for non-blob types and
+ * "<name>.<type>@<instance_id>" for blobs.
+ */
+Status parse_link(const std::string& str, std::string& type, std::string& name,
+                  InstanceID& instance_id);
+
 Status GetData(const json& tree, const std::string& instance_name,
                const ObjectID id, json& sub_tree,
                InstanceID const& current_instance_id = UnspecifiedInstanceID());
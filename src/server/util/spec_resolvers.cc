@@ -26,6 +26,12 @@ namespace vineyard {
 
 // meta data
 DEFINE_string(deployment, "local", "deployment mode: local, distributed");
+DEFINE_string(meta, "etcd",
+              "metadata backend: etcd, or local for single-node deployment "
+              "that keeps the metadata in process");
+DEFINE_string(meta_wal, "",
+              "path of the write-ahead log to persist the instance counter of "
+              "the local metadata backend, disabled by default");
 DEFINE_string(etcd_endpoint, "http://127.0.0.1:2379", "endpoint of etcd");
 DEFINE_string(etcd_prefix, "vineyard", "path prefix in etcd");
 DEFINE_string(etcd_cmd, "", "path of etcd executable");
@@ -35,6 +41,12 @@ DEFINE_string(size, "256Mi",
               "1024000, 1G, or 1Gi");
 DEFINE_int64(stream_threshold, 80,
              "memory threshold of streams (percentage of total memory)");
+DEFINE_string(spill_path, "",
+              "directory that cold blobs are spilled to when the shared memory "
+              "is exhausted, spilling is disabled if empty");
+DEFINE_int32(allocator_arenas, 0,
+             "number of allocator arenas that serve concurrent blob creation, "
+             "0 means decided by the number of cores and the memory size");
 // ipc
 DEFINE_string(socket, "/var/run/vineyard.sock", "IPC socket file location");
 // rpc
@@ -77,6 +89,8 @@ json EtcdSpecResolver::resolve() const {
   spec["prefix"] = FLAGS_etcd_prefix;
   spec["etcd_endpoint"] = FLAGS_etcd_endpoint;
   spec["etcd_cmd"] = FLAGS_etcd_cmd;
+  spec["meta"] = FLAGS_meta;
+  spec["wal"] = FLAGS_meta_wal;
   return spec;
 }
 
@@ -85,6 +99,8 @@ json BulkstoreSpecResolver::resolve() const {
   size_t bulkstore_limit = parseMemoryLimit(FLAGS_size);
   spec["memory_size"] = bulkstore_limit;
   spec["stream_threshold"] = FLAGS_stream_threshold;
+  spec["allocator_arenas"] = FLAGS_allocator_arenas;
+  spec["spill_path"] = FLAGS_spill_path;
   return spec;
 }
 
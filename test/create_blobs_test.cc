@@ -0,0 +1,78 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "client/client.h"
+#include "client/ds/blob.h"
+#include "common/util/logging.h"
+
+using namespace vineyard;  // NOLINT(build/namespaces)
+
+int main(int argc, char** argv) {
+  if (argc < 2) {
+    printf("usage ./create_blobs_test <ipc_socket>");
+    return 1;
+  }
+  std::string ipc_socket = std::string(argv[1]);
+
+  Client client;
+  VINEYARD_CHECK_OK(client.Connect(ipc_socket));
+  LOG(INFO) << "Connected to IPCServer: " << ipc_socket;
+
+  std::vector<size_t> sizes = {16, 0, 1024, 1 << 20, 3};
+  std::vector<std::unique_ptr<BlobWriter>> writers;
+  VINEYARD_CHECK_OK(client.CreateBlobs(sizes, writers));
+  CHECK_EQ(writers.size(), sizes.size());
+
+  std::vector<ObjectID> ids;
+  for (size_t idx = 0; idx < sizes.size(); ++idx) {
+    CHECK_EQ(writers[idx]->size(), sizes[idx]);
+    if (sizes[idx] > 0) {
+      memset(writers[idx]->data(), static_cast<int>(idx + 1), sizes[idx]);
+    }
+    ids.emplace_back(writers[idx]->Seal(client)->id());
+  }
+  CHECK_EQ(ids[1], EmptyBlobID());
+
+  for (size_t idx = 0; idx < sizes.size(); ++idx) {
+    auto blob = client.GetObject<Blob>(ids[idx]);
+    CHECK(blob != nullptr);
+    CHECK_EQ(blob->allocated_size(), sizes[idx]);
+    for (size_t offset = 0; offset < sizes[idx]; ++offset) {
+      CHECK_EQ(blob->data()[offset], static_cast<char>(idx + 1));
+    }
+  }
+
+  // the batch should be rejected as a whole when exceeding the memory limit.
+  {
+    std::vector<std::unique_ptr<BlobWriter>> exceeded;
+    auto status = client.CreateBlobs({1024, static_cast<size_t>(1) << 60},
+                                     exceeded);
+    CHECK(!status.ok());
+    CHECK(exceeded.empty());
+  }
+
+  ids.erase(ids.begin() + 1);
+  VINEYARD_CHECK_OK(client.DelData(ids));
+  LOG(INFO) << "Passed create blobs tests...";
+
+  client.Disconnect();
+
+  return 0;
+}
@@ -0,0 +1,128 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include <algorithm>
+#include <chrono>
+#include <future>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "client/client.h"
+#include "client/ds/blob.h"
+#include "common/util/logging.h"
+
+using namespace vineyard;  // NOLINT(build/namespaces)
+
+constexpr size_t kClients = 4;
+constexpr size_t kWaitersPerClient = 1024;
+
+static std::string waiter_name(size_t client, size_t index) {
+  return "get_wait_stress_test_" + std::to_string(client) + "_" +
+         std::to_string(index);
+}
+
+int main(int argc, char** argv) {
+  if (argc < 2) {
+    printf("usage ./get_wait_stress_test <ipc_socket>");
+    return 1;
+  }
+  std::string ipc_socket = std::string(argv[1]);
+
+  std::vector<std::unique_ptr<Client>> clients;
+  for (size_t i = 0; i < kClients; ++i) {
+    clients.emplace_back(new Client());
+    VINEYARD_CHECK_OK(clients.back()->Connect(ipc_socket));
+    CHECK(clients.back()->Pipelined());
+  }
+  LOG(INFO) << "Connected to IPCServer: " << ipc_socket;
+
+  // thousands of waiters, each waits for a different name.
+  std::vector<std::vector<ObjectID>> ids(kClients);
+  std::vector<std::vector<std::future<Status>>> waiters(kClients);
+  for (size_t i = 0; i < kClients; ++i) {
+    ids[i].resize(kWaitersPerClient, InvalidObjectID());
+    for (size_t j = 0; j < kWaitersPerClient; ++j) {
+      waiters[i].emplace_back(
+          clients[i]->GetNameAsync(waiter_name(i, j), ids[i][j], true));
+    }
+  }
+
+  Client client;
+  VINEYARD_CHECK_OK(client.Connect(ipc_socket));
+  std::unique_ptr<BlobWriter> writer;
+  VINEYARD_CHECK_OK(client.CreateBlob(1024, writer));
+  ObjectID blob_id = writer->Seal(client)->id();
+
+  std::vector<std::pair<size_t, size_t>> order;
+  for (size_t i = 0; i < kClients; ++i) {
+    for (size_t j = 0; j < kWaitersPerClient; ++j) {
+      order.emplace_back(i, j);
+    }
+  }
+  std::mt19937 random_engine(std::random_device{}());
+  std::shuffle(order.begin(), order.end(), random_engine);
+
+  // put the first half of names, only the corresponding waiters are woken up.
+  size_t half = order.size() / 2;
+  for (size_t k = 0; k < half; ++k) {
+    auto const& item = order[k];
+    VINEYARD_CHECK_OK(
+        client.PutName(blob_id, waiter_name(item.first, item.second)));
+  }
+  for (size_t k = 0; k < half; ++k) {
+    auto const& item = order[k];
+    VINEYARD_CHECK_OK(waiters[item.first][item.second].get());
+    CHECK_EQ(ids[item.first][item.second], blob_id);
+  }
+  for (size_t k = half; k < order.size(); ++k) {
+    auto const& item = order[k];
+    CHECK(waiters[item.first][item.second].wait_for(std::chrono::seconds(0)) !=
+          std::future_status::ready);
+  }
+
+  // drop the connection of a client with pending waiters, the other waiters
+  // are not affected.
+  size_t dropped = order[half].first;
+  clients[dropped]->Disconnect();
+
+  for (size_t k = half; k < order.size(); ++k) {
+    auto const& item = order[k];
+    VINEYARD_CHECK_OK(
+        client.PutName(blob_id, waiter_name(item.first, item.second)));
+  }
+  for (size_t k = half; k < order.size(); ++k) {
+    auto const& item = order[k];
+    auto status = waiters[item.first][item.second].get();
+    if (item.first == dropped) {
+      continue;
+    }
+    VINEYARD_CHECK_OK(status);
+    CHECK_EQ(ids[item.first][item.second], blob_id);
+  }
+
+  for (auto const& item : order) {
+    VINEYARD_CHECK_OK(client.DropName(waiter_name(item.first, item.second)));
+  }
+  VINEYARD_CHECK_OK(client.DelData(blob_id));
+  LOG(INFO) << "Passed get wait stress tests...";
+
+  for (auto& c : clients) {
+    c->Disconnect();
+  }
+  client.Disconnect();
+
+  return 0;
+}
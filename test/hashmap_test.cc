@@ -72,6 +72,55 @@ int main(int argc, char** argv) {
 
   LOG(INFO) << "Passed double hashmap tests...";
 
+  {
+    // the last 1000 elements duplicate the first 1000 keys, the first wins.
+    size_t num_elements = 100000;
+    ParallelHashmapBuilder<int64_t, uint64_t> parallel_builder(
+        client, num_elements,
+        [](size_t index) {
+          return std::make_pair(static_cast<int64_t>(index % 99000 * 7),
+                                static_cast<uint64_t>(index));
+        },
+        4);
+    auto hashmap = std::dynamic_pointer_cast<Hashmap<int64_t, uint64_t>>(
+        parallel_builder.Seal(client));
+    CHECK_EQ(hashmap->size(), 99000);
+    for (size_t index = 0; index < 99000; ++index) {
+      CHECK_EQ(hashmap->at(static_cast<int64_t>(index * 7)), index);
+    }
+    CHECK_EQ(hashmap->count(1), 0);
+
+    size_t count = 0;
+    for (auto const& pair : *hashmap) {
+      CHECK_EQ(pair.first, static_cast<int64_t>(pair.second * 7));
+      ++count;
+    }
+    CHECK_EQ(count, 99000);
+  }
+
+  {
+    // the keys collide on the initial 2003 slots with the identity hash of
+    // integers, the builder grows the table rather than failing.
+    const size_t num_elements = 1000;
+    ParallelHashmapBuilder<int64_t, uint64_t> parallel_builder(
+        client, num_elements,
+        [](size_t index) {
+          return std::make_pair(static_cast<int64_t>(index * 2003),
+                                static_cast<uint64_t>(index));
+        },
+        4);
+    auto hashmap = std::dynamic_pointer_cast<Hashmap<int64_t, uint64_t>>(
+        parallel_builder.Seal(client));
+    CHECK(hashmap != nullptr);
+    CHECK_EQ(hashmap->size(), num_elements);
+    for (size_t index = 0; index < num_elements; ++index) {
+      CHECK_EQ(hashmap->at(static_cast<int64_t>(index * 2003)), index);
+    }
+    CHECK_EQ(hashmap->count(1), 0);
+  }
+
+  LOG(INFO) << "Passed parallel hashmap tests...";
+
   client.Disconnect();
 
   return 0;
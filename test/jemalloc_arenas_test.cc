@@ -0,0 +1,89 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "common/memory/jemalloc.h"
+#include "common/util/logging.h"
+
+#if defined(WITH_JEMALLOC)
+
+// Allocates blocks until the allocator fails, and returns them.
+std::vector<void*> AllocateAll(vineyard::memory::Jemalloc* allocator,
+                               const size_t block_size) {
+  std::vector<void*> blocks;
+  while (true) {
+    void* block = allocator->Allocate(block_size);
+    if (block == nullptr) {
+      break;
+    }
+    blocks.emplace_back(block);
+  }
+  return blocks;
+}
+
+int main(int argc, char** argv) {
+  const size_t space_size = 64 * 1024 * 1024;
+  const size_t block_size = 4 * 1024 * 1024;
+  void* base = malloc(space_size);
+
+  auto* allocator = new vineyard::memory::Jemalloc();
+  CHECK(allocator->Init(base, space_size, 2) != nullptr);
+  CHECK_EQ(allocator->Arenas(), 2);
+
+  // the threads are bound to the arenas round-robin, thus the two threads
+  // below allocate from different arenas.
+  size_t allocated_by_first = 0;
+  std::thread([&]() {
+    auto blocks = AllocateAll(allocator, block_size);
+    allocated_by_first = blocks.size();
+    for (void* block : blocks) {
+      allocator->Free(block);
+    }
+  }).join();
+  CHECK_GT(allocated_by_first, 0);
+
+  // the space has been carved into the extents of the first arena, which
+  // are retained by it after being freed, and must be reused for the second.
+  size_t allocated_by_second = 0;
+  std::thread([&]() {
+    auto blocks = AllocateAll(allocator, block_size);
+    allocated_by_second = blocks.size();
+    for (void* block : blocks) {
+      allocator->Free(block);
+    }
+  }).join();
+  LOG(INFO) << "allocated " << allocated_by_first << " blocks by the first, "
+            << allocated_by_second << " blocks by the second";
+  CHECK_GE(allocated_by_second * 2, allocated_by_first);
+
+  LOG(INFO) << "Passed jemalloc arenas tests...";
+
+  delete allocator;
+  free(base);
+  return 0;
+}
+
+#else
+
+int main(int argc, char** argv) {
+  LOG(INFO) << "Skipped jemalloc arenas tests without jemalloc...";
+  return 0;
+}
+
+#endif  // WITH_JEMALLOC
@@ -0,0 +1,101 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "arrow/status.h"
+#include "arrow/util/io_util.h"
+#include "arrow/util/logging.h"
+
+#include "basic/ds/array.h"
+#include "client/client.h"
+#include "client/ds/object_meta.h"
+#include "common/util/logging.h"
+
+using namespace vineyard;  // NOLINT(build/namespaces)
+
+static const char kName[] = "local_meta_wal_test_name";
+
+// Runs against a vineyardd with `--meta=local --meta_wal=<path>`, in two
+// phases: "create" before restarting vineyardd with the same log, and
+// "replay" after it. The state file is `<path>.state`.
+int main(int argc, char** argv) {
+  if (argc < 4) {
+    printf("usage ./local_meta_wal_test <ipc_socket> <create|replay> <state>");
+    return 1;
+  }
+  std::string ipc_socket = std::string(argv[1]);
+  std::string phase = std::string(argv[2]);
+  std::string state_path = std::string(argv[3]);
+
+  Client client;
+  VINEYARD_CHECK_OK(client.Connect(ipc_socket));
+  LOG(INFO) << "Connected to IPCServer: " << ipc_socket;
+
+  if (phase == "create") {
+    std::vector<double> double_array = {1.0, 7.0, 3.0, 4.0, 2.0};
+    ArrayBuilder<double> builder(client, double_array);
+    auto array = builder.Seal(client);
+    VINEYARD_CHECK_OK(array->Persist(client));
+    VINEYARD_CHECK_OK(client.PutName(array->id(), kName));
+
+    std::ofstream state(state_path);
+    state << array->id() << " " << client.instance_id() << std::endl;
+    LOG(INFO) << "Created object " << ObjectIDToString(array->id())
+              << " on instance " << client.instance_id();
+  } else {
+    ObjectID id = InvalidObjectID();
+    InstanceID instance_id = UnspecifiedInstanceID();
+    std::ifstream state(state_path);
+    state >> id >> instance_id;
+    CHECK(state);
+
+    // the metadata of the earlier instance is not replayed, ...
+    ObjectMeta meta;
+    CHECK(!client.GetMetaData(id, meta, true).ok());
+    bool exists = true;
+    VINEYARD_CHECK_OK(client.Exists(id, exists));
+    CHECK(!exists);
+    ObjectID named = InvalidObjectID();
+    CHECK(client.GetName(kName, named).IsObjectNotExists());
+
+    // ... but the instance counter is.
+    CHECK_GT(client.instance_id(), instance_id);
+
+    // and the log has nothing but the instance counter.
+    std::string wal_path = state_path.substr(0, state_path.rfind(".state"));
+    std::ifstream wal(wal_path);
+    CHECK(wal.is_open());
+    std::string record;
+    while (std::getline(wal, record)) {
+      CHECK_NE(record.find("\"/next_instance_id\""), std::string::npos);
+    }
+
+    std::vector<double> double_array = {1.0, 2.0};
+    ArrayBuilder<double> builder(client, double_array);
+    auto array = builder.Seal(client);
+    VINEYARD_CHECK_OK(client.GetMetaData(array->id(), meta));
+    CHECK_EQ(meta.GetId(), array->id());
+    LOG(INFO) << "Passed replaying the write-ahead log on instance "
+              << client.instance_id();
+  }
+
+  client.Disconnect();
+
+  return 0;
+}
@@ -0,0 +1,186 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "arrow/status.h"
+#include "arrow/util/io_util.h"
+#include "arrow/util/logging.h"
+
+#include "basic/ds/array.h"
+#include "client/client.h"
+#include "client/ds/object_meta.h"
+#include "common/util/logging.h"
+
+using namespace vineyard;  // NOLINT(build/namespaces)
+
+// The reads are served from a snapshot of the meta index, and must observe
+// every mutation that has been replied to the client.
+void ReadYourWrites(Client& client) {
+  std::vector<double> double_array = {1.0, 7.0, 3.0, 4.0, 2.0};
+  ArrayBuilder<double> builder(client, double_array);
+  auto array = std::dynamic_pointer_cast<Array<double>>(builder.Seal(client));
+  ObjectID id = array->id();
+
+  {
+    ObjectMeta meta;
+    VINEYARD_CHECK_OK(client.GetMetaData(id, meta));
+    CHECK_EQ(meta.GetId(), id);
+    CHECK_EQ(meta.GetTypeName(), type_name<Array<double>>());
+    CHECK_EQ(meta.GetKeyValue<size_t>("size_"), double_array.size());
+    // the members are resolved from the index
+    CHECK(meta.GetMemberMeta("buffer_").GetTypeName() == "vineyard::Blob");
+
+    bool exists = false;
+    VINEYARD_CHECK_OK(client.Exists(id, exists));
+    CHECK(exists);
+
+    std::unordered_map<ObjectID, json> trees;
+    VINEYARD_CHECK_OK(
+        client.ListData(type_name<Array<double>>(), false, 1000000, trees));
+    CHECK(trees.find(id) != trees.end());
+  }
+
+  {
+    ObjectMeta meta;
+    VINEYARD_CHECK_OK(client.GetMetaData(id, meta, true));
+    CHECK_EQ(meta.GetId(), id);
+  }
+
+  {
+    ObjectID copied_id = InvalidObjectID();
+    VINEYARD_CHECK_OK(client.ShallowCopy(id, copied_id));
+    ObjectMeta meta;
+    VINEYARD_CHECK_OK(client.GetMetaData(copied_id, meta));
+    CHECK_EQ(meta.GetKeyValue<size_t>("size_"), double_array.size());
+    VINEYARD_CHECK_OK(client.DelData(copied_id));
+  }
+
+  {
+    const std::string name = "meta_snapshot_test_name";
+    ObjectID named = InvalidObjectID();
+    VINEYARD_CHECK_OK(client.PutName(id, name));
+    VINEYARD_CHECK_OK(client.GetName(name, named));
+    CHECK_EQ(named, id);
+    VINEYARD_CHECK_OK(client.DropName(name));
+    CHECK(client.GetName(name, named).IsObjectNotExists());
+  }
+
+  {
+    VINEYARD_CHECK_OK(client.DelData(id));
+    ObjectMeta meta;
+    CHECK(!client.GetMetaData(id, meta).ok());
+
+    bool exists = true;
+    VINEYARD_CHECK_OK(client.Exists(id, exists));
+    CHECK(!exists);
+
+    std::unordered_map<ObjectID, json> trees;
+    VINEYARD_CHECK_OK(
+        client.ListData(type_name<Array<double>>(), false, 1000000, trees));
+    CHECK(trees.find(id) == trees.end());
+  }
+}
+
+// A waiting read that misses the snapshot is deferred, and woken up by the
+// mutation from another client.
+void WaitOnSnapshotMiss(Client& client, std::string const& ipc_socket) {
+  const std::string name = "meta_snapshot_test_wait";
+  ObjectID named = InvalidObjectID();
+  std::thread waiter([&]() {
+    Client waiter_client;
+    VINEYARD_CHECK_OK(waiter_client.Connect(ipc_socket));
+    VINEYARD_CHECK_OK(waiter_client.GetName(name, named, true));
+    waiter_client.Disconnect();
+  });
+  std::this_thread::sleep_for(std::chrono::milliseconds(200));
+
+  std::vector<double> double_array = {1.0, 2.0};
+  ArrayBuilder<double> builder(client, double_array);
+  auto array = builder.Seal(client);
+  VINEYARD_CHECK_OK(client.PutName(array->id(), name));
+  waiter.join();
+  CHECK_EQ(named, array->id());
+
+  VINEYARD_CHECK_OK(client.DropName(name));
+  VINEYARD_CHECK_OK(client.DelData(array->id()));
+}
+
+// Concurrent readers and writers on a growing index, where every write
+// invalidates the snapshot taken by the previous reads.
+void ConcurrentReadWrites(std::string const& ipc_socket) {
+  const int kThreads = 8, kRounds = 200;
+  std::vector<std::thread> threads;
+  for (int t = 0; t < kThreads; ++t) {
+    threads.emplace_back([&ipc_socket, t]() {
+      Client client;
+      VINEYARD_CHECK_OK(client.Connect(ipc_socket));
+      std::vector<ObjectID> ids;
+      for (int r = 0; r < kRounds; ++r) {
+        std::vector<int64_t> values = {t, r};
+        ArrayBuilder<int64_t> builder(client, values);
+        auto array = builder.Seal(client);
+        ids.emplace_back(array->id());
+
+        ObjectMeta meta;
+        VINEYARD_CHECK_OK(client.GetMetaData(array->id(), meta));
+        CHECK_EQ(meta.GetId(), array->id());
+        // an earlier object is still visible after later updates
+        ObjectMeta first;
+        VINEYARD_CHECK_OK(client.GetMetaData(ids.front(), first));
+        CHECK_EQ(first.GetId(), ids.front());
+      }
+      VINEYARD_CHECK_OK(client.DelData(ids));
+      for (auto const& id : ids) {
+        ObjectMeta meta;
+        CHECK(!client.GetMetaData(id, meta).ok());
+      }
+      client.Disconnect();
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+}
+
+int main(int argc, char** argv) {
+  if (argc < 2) {
+    printf("usage ./meta_snapshot_test <ipc_socket>");
+    return 1;
+  }
+  std::string ipc_socket = std::string(argv[1]);
+
+  Client client;
+  VINEYARD_CHECK_OK(client.Connect(ipc_socket));
+  LOG(INFO) << "Connected to IPCServer: " << ipc_socket;
+
+  ReadYourWrites(client);
+  LOG(INFO) << "Passed read-your-writes on the meta snapshot tests...";
+
+  WaitOnSnapshotMiss(client, ipc_socket);
+  LOG(INFO) << "Passed waiting on a snapshot miss tests...";
+
+  ConcurrentReadWrites(ipc_socket);
+  LOG(INFO) << "Passed concurrent reads and writes on the snapshot tests...";
+
+  client.Disconnect();
+
+  return 0;
+}
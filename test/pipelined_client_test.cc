@@ -0,0 +1,112 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include <chrono>
+#include <cstring>
+#include <future>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "client/client.h"
+#include "client/ds/blob.h"
+#include "common/util/logging.h"
+
+using namespace vineyard;  // NOLINT(build/namespaces)
+
+constexpr size_t kThreads = 8;
+constexpr size_t kRequests = 256;
+
+int main(int argc, char** argv) {
+  if (argc < 2) {
+    printf("usage ./pipelined_client_test <ipc_socket>");
+    return 1;
+  }
+  std::string ipc_socket = std::string(argv[1]);
+
+  Client client;
+  VINEYARD_CHECK_OK(client.Connect(ipc_socket));
+  LOG(INFO) << "Connected to IPCServer: " << ipc_socket;
+  CHECK(client.Pipelined());
+
+  // a waiting request must not block the requests after it.
+  ObjectID waited_id = InvalidObjectID();
+  auto waited =
+      client.GetNameAsync("pipelined_client_test_waited", waited_id, true);
+
+  std::vector<ObjectID> blob_ids;
+  for (size_t idx = 0; idx < kThreads; ++idx) {
+    std::unique_ptr<BlobWriter> writer;
+    VINEYARD_CHECK_OK(client.CreateBlob(1024, writer));
+    memset(writer->data(), static_cast<int>(idx + 1), 1024);
+    blob_ids.emplace_back(writer->Seal(client)->id());
+  }
+
+  std::vector<std::thread> threads;
+  for (size_t tid = 0; tid < kThreads; ++tid) {
+    threads.emplace_back([&, tid]() {
+      std::vector<ObjectID> ids(kRequests);
+      std::vector<std::future<Status>> puts, gets;
+      for (size_t idx = 0; idx < kRequests; ++idx) {
+        std::string name = "pipelined_client_test_" + std::to_string(tid) +
+                           "_" + std::to_string(idx);
+        puts.emplace_back(client.PutNameAsync(blob_ids[tid], name));
+      }
+      for (auto& put : puts) {
+        VINEYARD_CHECK_OK(put.get());
+      }
+      for (size_t idx = 0; idx < kRequests; ++idx) {
+        std::string name = "pipelined_client_test_" + std::to_string(tid) +
+                           "_" + std::to_string(idx);
+        gets.emplace_back(client.GetNameAsync(name, ids[idx]));
+      }
+      // the synchronous requests are interleaved with the asynchronous ones.
+      bool blob_exists = false;
+      VINEYARD_CHECK_OK(client.Exists(blob_ids[tid], blob_exists));
+      CHECK(blob_exists);
+      for (size_t idx = 0; idx < kRequests; ++idx) {
+        VINEYARD_CHECK_OK(gets[idx].get());
+        CHECK_EQ(ids[idx], blob_ids[tid]);
+      }
+
+      ObjectMeta meta;
+      VINEYARD_CHECK_OK(client.GetMetaDataAsync(blob_ids[tid], meta).get());
+      std::shared_ptr<arrow::Buffer> buffer;
+      VINEYARD_CHECK_OK(meta.GetBuffer(blob_ids[tid], buffer));
+      CHECK(buffer != nullptr);
+      CHECK_EQ(buffer->size(), 1024);
+      for (int64_t offset = 0; offset < buffer->size(); ++offset) {
+        CHECK_EQ(buffer->data()[offset], static_cast<uint8_t>(tid + 1));
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  CHECK(waited.wait_for(std::chrono::seconds(0)) !=
+        std::future_status::ready);
+
+  VINEYARD_CHECK_OK(
+      client.PutName(blob_ids.front(), "pipelined_client_test_waited"));
+  VINEYARD_CHECK_OK(waited.get());
+  CHECK_EQ(waited_id, blob_ids.front());
+
+  VINEYARD_CHECK_OK(client.DelData(blob_ids));
+  LOG(INFO) << "Passed pipelined client tests...";
+
+  client.Disconnect();
+
+  return 0;
+}
@@ -213,19 +213,24 @@ def run_single_vineyardd_tests():
         # FIXME: cannot be safely dtor after #350 and #354.
         # run_test('allocator_test')
         run_test('arrow_data_structure_test')
+        run_test('create_blobs_test')
         run_test('dataframe_test')
         run_test('delete_test')
         run_test('get_wait_test')
+        run_test('get_wait_stress_test')
         run_test('get_object_test')
         run_test('global_object_test')
         run_test('hashmap_test')
         run_test('id_test')
         run_test('invalid_connect_test', '127.0.0.1:%d' % rpc_socket_port)
+        run_test('jemalloc_arenas_test')
         run_test('large_meta_test')
         run_test('list_object_test')
+        run_test('meta_snapshot_test')
         run_test('name_test')
         run_test('pair_test')
         run_test('persist_test')
+        run_test('pipelined_client_test')
         run_test('rpc_delete_test', '127.0.0.1:%d' % rpc_socket_port)
         run_test('rpc_get_object_test', '127.0.0.1:%d' % rpc_socket_port)
         run_test('rpc_test', '127.0.0.1:%d' % rpc_socket_port)
@@ -243,6 +248,54 @@ def run_single_vineyardd_tests():
         run_invalid_client_test('127.0.0.1', rpc_socket_port)
 
 
+def run_local_meta_tests():
+    rpc_socket_port = find_port()
+    with start_program('vineyardd',
+                       '--size', str(1 * 1024 * 1024 * 1024),
+                       '--socket', VINEYARD_CI_IPC_SOCKET,
+                       '--rpc_socket_port', str(rpc_socket_port),
+                       '--meta', 'local',
+                       '--meta_wal', '/tmp/vineyard.ci.wal.%s' % time.time(),
+                       verbose=True):
+        run_test('create_blobs_test')
+        run_test('delete_test')
+        run_test('get_wait_test')
+        run_test('get_object_test')
+        run_test('list_object_test')
+        run_test('meta_snapshot_test')
+        run_test('name_test')
+        run_test('persist_test')
+        run_test('pipelined_client_test')
+
+
+def run_local_meta_wal_tests():
+    wal_path = '/tmp/vineyard.ci.wal.%s' % time.time()
+    state_path = '%s.state' % wal_path
+    for phase in ['create', 'replay']:
+        rpc_socket_port = find_port()
+        with start_program('vineyardd',
+                           '--size', str(256 * 1024 * 1024),
+                           '--socket', VINEYARD_CI_IPC_SOCKET,
+                           '--rpc_socket_port', str(rpc_socket_port),
+                           '--meta', 'local',
+                           '--meta_wal', wal_path,
+                           verbose=True):
+            run_test('local_meta_wal_test', phase, state_path)
+
+
+def run_spill_tests():
+    rpc_socket_port = find_port()
+    size = 64 * 1024 * 1024
+    with start_program('vineyardd',
+                       '--size', str(size),
+                       '--socket', VINEYARD_CI_IPC_SOCKET,
+                       '--rpc_socket_port', str(rpc_socket_port),
+                       '--meta', 'local',
+                       '--spill_path', '/tmp/vineyard.ci.spill.%s' % time.time(),
+                       verbose=True):
+        run_test('spill_test', size)
+
+
 def run_scale_in_out_tests(etcd_endpoints, instance_size=4):
     etcd_prefix = 'vineyard_test_%s' % time.time()
     with start_multiple_vineyardd(etcd_endpoints,
@@ -403,6 +456,9 @@ def main():
 
     if args.with_cpp:
         run_single_vineyardd_tests()
+        run_local_meta_tests()
+        run_local_meta_wal_tests()
+        run_spill_tests()
         with start_etcd() as (_, etcd_endpoints):
             run_scale_in_out_tests(etcd_endpoints, instance_size=4)
 
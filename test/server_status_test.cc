@@ -25,6 +25,7 @@ limitations under the License.
 #include "arrow/util/logging.h"
 
 #include "client/client.h"
+#include "client/ds/blob.h"
 #include "client/ds/object_meta.h"
 #include "common/util/logging.h"
 
@@ -47,6 +48,18 @@ int main(int argc, char** argv) {
   CHECK_GT(instance_status->memory_limit, instance_status->memory_usage);
   CHECK_EQ(instance_status->instance_id, client.instance_id());
 
+  {
+    // tiny blobs are served from the slabs
+    std::unique_ptr<BlobWriter> blob_writer;
+    VINEYARD_CHECK_OK(client.CreateBlob(100, blob_writer));
+    VINEYARD_CHECK_OK(client.InstanceStatus(instance_status));
+    CHECK_GT(instance_status->slab_usage, 0);
+    CHECK_GE(instance_status->memory_usage, instance_status->slab_usage);
+    CHECK_GE(instance_status->slab_fragmentation, 0.0);
+    CHECK_LT(instance_status->slab_fragmentation, 1.0);
+    VINEYARD_CHECK_OK(blob_writer->Abort(client));
+  }
+
   std::vector<InstanceID> instances;
   VINEYARD_CHECK_OK(client.Instances(instances));
   CHECK_GT(instances.size(), 0);
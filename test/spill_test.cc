@@ -0,0 +1,82 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <cstring>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "arrow/status.h"
+#include "arrow/util/io_util.h"
+#include "arrow/util/logging.h"
+
+#include "client/client.h"
+#include "client/ds/blob.h"
+#include "common/util/logging.h"
+
+using namespace vineyard;  // NOLINT(build/namespaces)
+
+// Runs against a vineyardd with a small `--size` and a `--spill_path`.
+int main(int argc, char** argv) {
+  if (argc < 3) {
+    printf("usage ./spill_test <ipc_socket> <size>");
+    return 1;
+  }
+  std::string ipc_socket = std::string(argv[1]);
+  size_t const memory_size = std::stoul(argv[2]);
+
+  // blobs of twice the size of the shared memory in total
+  size_t const blob_size = memory_size / 8;
+  size_t const blob_num = 16;
+  std::vector<ObjectID> ids;
+  for (size_t idx = 0; idx < blob_num; ++idx) {
+    // the blobs are pinned by the connection that creates them, and become
+    // cold after the connection is closed.
+    Client client;
+    VINEYARD_CHECK_OK(client.Connect(ipc_socket));
+    std::unique_ptr<BlobWriter> writer;
+    VINEYARD_CHECK_OK(client.CreateBlob(blob_size, writer));
+    memset(writer->data(), static_cast<int>(idx + 1), blob_size);
+    ids.emplace_back(writer->Seal(client)->id());
+    client.Disconnect();
+  }
+  LOG(INFO) << "Created " << blob_num << " blobs of " << blob_size
+            << " bytes past the memory limit";
+
+  // every blob can be read back, the spilled ones are reloaded on Get.
+  for (size_t idx = 0; idx < blob_num; ++idx) {
+    Client client;
+    VINEYARD_CHECK_OK(client.Connect(ipc_socket));
+    auto blob = client.GetObject<Blob>(ids[idx]);
+    CHECK(blob != nullptr);
+    CHECK_EQ(blob->allocated_size(), blob_size);
+    for (size_t offset = 0; offset < blob_size; offset += 4096) {
+      CHECK_EQ(blob->data()[offset], static_cast<char>(idx + 1));
+    }
+    CHECK_EQ(blob->data()[blob_size - 1], static_cast<char>(idx + 1));
+    client.Disconnect();
+  }
+
+  {
+    Client client;
+    VINEYARD_CHECK_OK(client.Connect(ipc_socket));
+    VINEYARD_CHECK_OK(client.DelData(ids));
+    client.Disconnect();
+  }
+  LOG(INFO) << "Passed spill tests...";
+
+  return 0;
+}
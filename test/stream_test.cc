@@ -13,16 +13,23 @@ See the License for the specific language governing permissions and
 limitations under the License.
 */
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
 #include <memory>
 #include <string>
 #include <thread>
 #include <unordered_map>
+#include <vector>
 
+#include "arrow/api.h"
 #include "arrow/status.h"
 #include "arrow/util/io_util.h"
 #include "arrow/util/logging.h"
 
 #include "basic/stream/byte_stream.h"
+#include "basic/stream/dataframe_stream.h"
 #include "client/client.h"
 #include "client/ds/object_meta.h"
 #include "common/util/logging.h"
@@ -180,6 +187,530 @@ int main(int argc, char** argv) {
     CHECK(empty_reader->GetNext(buffer).IsStreamDrained());
   }
 
+  // when stream is broadcast to many consumers
+  {
+    ByteStreamBuilder builder(client);
+    builder.SetParams(std::unordered_map<std::string, std::string>{
+        {"kind", "test"}, {"test_name", "stream_test"}});
+    StreamOptions options;
+    options.consumers = 2;
+    builder.SetStreamOptions(options);
+    auto bstream = std::dynamic_pointer_cast<ByteStream>(builder.Seal(client));
+    stream_id = bstream->id();
+    CHECK(stream_id != InvalidObjectID());
+  }
+
+  std::vector<std::vector<size_t>> broadcast_chunks_size(2);
+  std::vector<std::thread> broadcast_thrds;
+  for (size_t consumer = 0; consumer < 2; ++consumer) {
+    broadcast_thrds.emplace_back([&, consumer]() {
+      Client reader_client;
+      VINEYARD_CHECK_OK(reader_client.Connect(ipc_socket));
+
+      auto byte_stream = reader_client.GetObject<ByteStream>(stream_id);
+      CHECK(byte_stream != nullptr);
+
+      std::unique_ptr<ByteStreamReader> reader;
+      VINEYARD_CHECK_OK(byte_stream->OpenReader(reader_client, reader));
+
+      std::unique_ptr<ByteStreamReader> failed_reader;
+      auto status1 = byte_stream->OpenReader(reader_client, failed_reader);
+      CHECK(status1.IsStreamOpened());
+
+      while (true) {
+        std::unique_ptr<arrow::Buffer> buffer = nullptr;
+        auto status = reader->GetNext(buffer);
+        if (status.ok()) {
+          CHECK(buffer != nullptr);
+          broadcast_chunks_size[consumer].emplace_back(buffer->size());
+        } else {
+          CHECK(status.IsStreamDrained());
+          break;
+        }
+      }
+    });
+  }
+
+  {
+    auto byte_stream = client.GetObject<ByteStream>(stream_id);
+    std::unique_ptr<ByteStreamWriter> writer;
+    VINEYARD_CHECK_OK(byte_stream->OpenWriter(client, writer));
+    for (size_t idx = 1; idx <= 11; ++idx) {
+      std::unique_ptr<arrow::MutableBuffer> buffer = nullptr;
+      VINEYARD_CHECK_OK(writer->GetNext(1 << idx, buffer));
+      CHECK(buffer != nullptr);
+    }
+    VINEYARD_CHECK_OK(writer->Finish());
+  }
+
+  for (auto& thrd : broadcast_thrds) {
+    thrd.join();
+  }
+  for (auto const& chunks_size : broadcast_chunks_size) {
+    CHECK_EQ(chunks_size.size(), 11);
+    for (size_t idx = 0; idx < chunks_size.size(); ++idx) {
+      CHECK_EQ(chunks_size[idx], 1 << (idx + 1));
+    }
+  }
+
+  // when stream has bounded capacity
+  {
+    ByteStreamBuilder builder(client);
+    builder.SetParams(std::unordered_map<std::string, std::string>{
+        {"kind", "test"}, {"test_name", "stream_test"}});
+    StreamOptions options;
+    options.max_chunks = 2;
+    options.max_bytes = 1024;
+    builder.SetStreamOptions(options);
+    auto bstream = std::dynamic_pointer_cast<ByteStream>(builder.Seal(client));
+    stream_id = bstream->id();
+    CHECK(stream_id != InvalidObjectID());
+  }
+
+  auto bounded_byte_stream = client.GetObject<ByteStream>(stream_id);
+
+  std::unique_ptr<ByteStreamReader> bounded_reader = nullptr;
+  std::unique_ptr<ByteStreamWriter> bounded_writer = nullptr;
+  VINEYARD_CHECK_OK(bounded_byte_stream->OpenReader(client, bounded_reader));
+  VINEYARD_CHECK_OK(bounded_byte_stream->OpenWriter(client, bounded_writer));
+
+  for (size_t idx = 0; idx < 2; ++idx) {
+    std::unique_ptr<arrow::MutableBuffer> buffer = nullptr;
+    VINEYARD_CHECK_OK(bounded_writer->GetNext(256, buffer));
+    CHECK(buffer != nullptr);
+  }
+  VINEYARD_CHECK_OK(bounded_writer->Finish());
+
+  {
+    std::shared_ptr<InstanceStatus> instance_status;
+    VINEYARD_CHECK_OK(client.InstanceStatus(instance_status));
+    auto const& stats = instance_status->streams[ObjectIDToString(stream_id)];
+    CHECK_EQ(stats["queue_depth"].get<size_t>(), 2);
+    CHECK_EQ(stats["bytes"].get<size_t>(), 512);
+    CHECK_EQ(stats["max_chunks"].get<size_t>(), 2);
+    CHECK_EQ(stats["max_bytes"].get<size_t>(), 1024);
+  }
+
+  for (size_t idx = 0; idx < 2; ++idx) {
+    std::unique_ptr<arrow::Buffer> buffer = nullptr;
+    VINEYARD_CHECK_OK(bounded_reader->GetNext(buffer));
+    CHECK_EQ(buffer->size(), 256);
+  }
+  {
+    std::unique_ptr<arrow::Buffer> buffer = nullptr;
+    CHECK(bounded_reader->GetNext(buffer).IsStreamDrained());
+  }
+
+  // when stream has bounded capacity, the producer blocks on `max_chunks`
+  // until the consumer pulls, and on `max_bytes` until the consumer releases
+  {
+    ByteStreamBuilder builder(client);
+    builder.SetParams(std::unordered_map<std::string, std::string>{
+        {"kind", "test"}, {"test_name", "stream_test"}});
+    StreamOptions options;
+    options.max_chunks = 2;
+    options.max_bytes = 1024;
+    builder.SetStreamOptions(options);
+    auto bstream = std::dynamic_pointer_cast<ByteStream>(builder.Seal(client));
+    stream_id = bstream->id();
+    CHECK(stream_id != InvalidObjectID());
+  }
+
+  std::atomic<size_t> written_chunks(0);
+  std::thread blocking_send_thrd([&]() {
+    Client writer_client;
+    VINEYARD_CHECK_OK(writer_client.Connect(ipc_socket));
+    auto byte_stream = writer_client.GetObject<ByteStream>(stream_id);
+    std::unique_ptr<ByteStreamWriter> writer;
+    VINEYARD_CHECK_OK(byte_stream->OpenWriter(writer_client, writer));
+    for (size_t size : {256, 256, 256, 512}) {
+      std::unique_ptr<arrow::MutableBuffer> buffer = nullptr;
+      VINEYARD_CHECK_OK(writer->GetNext(size, buffer));
+      written_chunks.fetch_add(1);
+    }
+    VINEYARD_CHECK_OK(writer->Finish());
+  });
+
+  // the producer stays at `written` chunks
+  auto check_blocked = [&](size_t written) {
+    std::this_thread::sleep_for(std::chrono::seconds(1));
+    CHECK_EQ(written_chunks.load(), written);
+  };
+  // the producer goes on to `written` chunks
+  auto check_resumed = [&](size_t written) {
+    for (int retry = 0; retry < 1000 && written_chunks.load() < written;
+         ++retry) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    CHECK_EQ(written_chunks.load(), written);
+  };
+
+  {
+    VINEYARD_CHECK_OK(client.OpenStream(stream_id, OpenStreamMode::read, 4));
+
+    // the third chunk waits for the first two chunks to be pulled
+    check_blocked(2);
+    std::shared_ptr<arrow::Buffer> first, second, buffer;
+    VINEYARD_CHECK_OK(client.PullNextStreamChunk(stream_id, first));
+    check_resumed(3);
+
+    // the fourth chunk waits for the second chunk to be pulled, then for the
+    // memory held by the retained chunks
+    check_blocked(3);
+    VINEYARD_CHECK_OK(client.PullNextStreamChunk(stream_id, second));
+    check_blocked(3);
+    first.reset();
+    VINEYARD_CHECK_OK(client.ReleaseStreamChunks());
+    check_resumed(4);
+    blocking_send_thrd.join();
+
+    VINEYARD_CHECK_OK(client.PullNextStreamChunk(stream_id, buffer));
+    CHECK_EQ(buffer->size(), 256);
+    VINEYARD_CHECK_OK(client.PullNextStreamChunk(stream_id, buffer));
+    CHECK_EQ(buffer->size(), 512);
+    CHECK(client.PullNextStreamChunk(stream_id, buffer).IsStreamDrained());
+  }
+
+  // when stream is broadcast to a consumer that disconnects in the middle,
+  // with the chunks it is reading and retaining
+  {
+    ByteStreamBuilder builder(client);
+    builder.SetParams(std::unordered_map<std::string, std::string>{
+        {"kind", "test"}, {"test_name", "stream_test"}});
+    StreamOptions options;
+    options.consumers = 2;
+    options.max_chunks = 2;
+    options.max_bytes = 128;
+    builder.SetStreamOptions(options);
+    auto bstream = std::dynamic_pointer_cast<ByteStream>(builder.Seal(client));
+    stream_id = bstream->id();
+    CHECK(stream_id != InvalidObjectID());
+  }
+
+  std::thread leaving_thrd([&]() {
+    Client reader_client;
+    VINEYARD_CHECK_OK(reader_client.Connect(ipc_socket));
+    VINEYARD_CHECK_OK(
+        reader_client.OpenStream(stream_id, OpenStreamMode::read, 2));
+    std::shared_ptr<arrow::Buffer> first, second;
+    VINEYARD_CHECK_OK(reader_client.PullNextStreamChunk(stream_id, first));
+    VINEYARD_CHECK_OK(reader_client.PullNextStreamChunk(stream_id, second));
+    // both chunks are still held, they use up the `max_bytes` and block the
+    // producer until the consumer has gone
+    reader_client.Disconnect();
+  });
+
+  size_t staying_chunks = 0;
+  std::thread staying_thrd([&]() {
+    Client reader_client;
+    VINEYARD_CHECK_OK(reader_client.Connect(ipc_socket));
+    auto byte_stream = reader_client.GetObject<ByteStream>(stream_id);
+    std::unique_ptr<ByteStreamReader> reader;
+    VINEYARD_CHECK_OK(byte_stream->OpenReader(reader_client, reader));
+    while (true) {
+      std::unique_ptr<arrow::Buffer> buffer = nullptr;
+      auto status = reader->GetNext(buffer);
+      if (!status.ok()) {
+        CHECK(status.IsStreamDrained());
+        break;
+      }
+      CHECK_EQ(buffer->size(), 64);
+      staying_chunks += 1;
+    }
+  });
+
+  {
+    auto byte_stream = client.GetObject<ByteStream>(stream_id);
+    std::unique_ptr<ByteStreamWriter> writer;
+    VINEYARD_CHECK_OK(byte_stream->OpenWriter(client, writer));
+    for (size_t idx = 0; idx < 8; ++idx) {
+      std::unique_ptr<arrow::MutableBuffer> buffer = nullptr;
+      VINEYARD_CHECK_OK(writer->GetNext(64, buffer));
+    }
+    VINEYARD_CHECK_OK(writer->Finish());
+  }
+
+  leaving_thrd.join();
+  staying_thrd.join();
+  CHECK_EQ(staying_chunks, 8);
+  {
+    // every chunk has been released
+    std::shared_ptr<InstanceStatus> instance_status;
+    VINEYARD_CHECK_OK(client.InstanceStatus(instance_status));
+    auto const& stats = instance_status->streams[ObjectIDToString(stream_id)];
+    CHECK_EQ(stats["chunks"].get<size_t>(), 0);
+    CHECK_EQ(stats["bytes"].get<size_t>(), 0);
+  }
+
+  // when stream is written and read by blocks of lines
+  {
+    ByteStreamBuilder builder(client);
+    builder.SetParams(std::unordered_map<std::string, std::string>{
+        {"kind", "test"}, {"test_name", "stream_test"}});
+    auto bstream = std::dynamic_pointer_cast<ByteStream>(builder.Seal(client));
+    stream_id = bstream->id();
+    CHECK(stream_id != InvalidObjectID());
+  }
+
+  auto lines_byte_stream = client.GetObject<ByteStream>(stream_id);
+
+  std::unique_ptr<ByteStreamReader> lines_reader = nullptr;
+  std::unique_ptr<ByteStreamWriter> lines_writer = nullptr;
+  VINEYARD_CHECK_OK(lines_byte_stream->OpenReader(client, lines_reader));
+  VINEYARD_CHECK_OK(lines_byte_stream->OpenWriter(client, lines_writer));
+
+  std::vector<std::string> lines;
+  std::string block;
+  for (size_t idx = 0; idx < 64; ++idx) {
+    lines.emplace_back(std::string(idx % 7, 'a' + idx % 26));
+    block += lines.back() + "\n";
+  }
+  lines.emplace_back("without line break");
+  block += lines.back();
+
+  // the chunks must hold the whole stream, as the same client reads it later
+  lines_writer->SetBufferSizeLimit(16);
+  for (size_t offset = 0; offset < block.size(); offset += 10) {
+    VINEYARD_CHECK_OK(lines_writer->WriteBlock(
+        block.data() + offset, std::min<size_t>(10, block.size() - offset)));
+  }
+  VINEYARD_CHECK_OK(lines_writer->Finish());
+
+  {
+    // the lines that ReadLine has split but not returned come first
+    std::string line;
+    VINEYARD_CHECK_OK(lines_reader->ReadLine(line));
+    CHECK_EQ(line, lines[0]);
+    size_t idx = 1;
+    for (size_t round = 0; round < 2; ++round) {
+      std::vector<arrow::util::string_view> views;
+      VINEYARD_CHECK_OK(lines_reader->ReadLines(views));
+      CHECK(!views.empty());
+      for (auto const& view : views) {
+        CHECK_EQ(std::string(view.data(), view.size()), lines[idx++]);
+      }
+    }
+    Status status;
+    while ((status = lines_reader->ReadLine(line)).ok()) {
+      CHECK_EQ(line, lines[idx++]);
+    }
+    CHECK(status.IsEndOfFile());
+    CHECK_EQ(idx, lines.size());
+  }
+
+  // when stream of lines fails, the failure is not taken as the end
+  {
+    ByteStreamBuilder builder(client);
+    builder.SetParams(std::unordered_map<std::string, std::string>{
+        {"kind", "test"}, {"test_name", "stream_test"}});
+    auto bstream = std::dynamic_pointer_cast<ByteStream>(builder.Seal(client));
+    stream_id = bstream->id();
+    CHECK(stream_id != InvalidObjectID());
+  }
+
+  {
+    auto failed_lines_stream = client.GetObject<ByteStream>(stream_id);
+    std::unique_ptr<ByteStreamReader> reader = nullptr;
+    std::unique_ptr<ByteStreamWriter> writer = nullptr;
+    VINEYARD_CHECK_OK(failed_lines_stream->OpenReader(client, reader));
+    VINEYARD_CHECK_OK(failed_lines_stream->OpenWriter(client, writer));
+    VINEYARD_CHECK_OK(writer->Abort());
+
+    std::vector<arrow::util::string_view> views;
+    CHECK(reader->ReadLines(views).IsStreamFailed());
+  }
+
+  // when stream of lines is read by a consumer that is faster than the
+  // producer, the reader is pending when the producer finishes
+  for (size_t blocks : {0, 3}) {
+    {
+      ByteStreamBuilder builder(client);
+      builder.SetParams(std::unordered_map<std::string, std::string>{
+          {"kind", "test"}, {"test_name", "stream_test"}});
+      auto bstream =
+          std::dynamic_pointer_cast<ByteStream>(builder.Seal(client));
+      stream_id = bstream->id();
+      CHECK(stream_id != InvalidObjectID());
+    }
+
+    std::vector<std::string> read_lines;
+    std::thread lines_recv_thrd([&]() {
+      Client reader_client;
+      VINEYARD_CHECK_OK(reader_client.Connect(ipc_socket));
+      auto byte_stream = reader_client.GetObject<ByteStream>(stream_id);
+      std::unique_ptr<ByteStreamReader> reader;
+      VINEYARD_CHECK_OK(byte_stream->OpenReader(reader_client, reader));
+      std::string line;
+      Status status;
+      while ((status = reader->ReadLine(line)).ok()) {
+        read_lines.emplace_back(line);
+      }
+      CHECK(status.IsEndOfFile());
+    });
+
+    auto byte_stream = client.GetObject<ByteStream>(stream_id);
+    std::unique_ptr<ByteStreamWriter> writer;
+    VINEYARD_CHECK_OK(byte_stream->OpenWriter(client, writer));
+    writer->SetBufferSizeLimit(8);
+    std::string text;
+    for (size_t idx = 0; idx < blocks; ++idx) {
+      std::string block = "line-" + std::to_string(idx) + "\ntail";
+      VINEYARD_CHECK_OK(writer->WriteBlock(block.data(), block.size()));
+      text += block;
+      sleep(1);
+    }
+    // the reader has read everything, and waits for the next chunk
+    sleep(1);
+    VINEYARD_CHECK_OK(writer->Finish());
+    lines_recv_thrd.join();
+
+    // the last line has no line break
+    std::vector<std::string> written_lines;
+    size_t begin = 0;
+    for (size_t end = text.find('\n'); end != std::string::npos;
+         end = text.find('\n', begin)) {
+      written_lines.emplace_back(text.substr(begin, end - begin));
+      begin = end + 1;
+    }
+    if (begin < text.size()) {
+      written_lines.emplace_back(text.substr(begin));
+    }
+    CHECK(read_lines == written_lines);
+  }
+
+  // when stream reuses the pooled chunks, and a chunk is released late, after
+  // it has been released by the retain window, reused and pulled again
+  {
+    ByteStreamBuilder builder(client);
+    builder.SetParams(std::unordered_map<std::string, std::string>{
+        {"kind", "test"}, {"test_name", "stream_test"}});
+    StreamOptions options;
+    options.pooled_chunks = 4;
+    builder.SetStreamOptions(options);
+    auto bstream = std::dynamic_pointer_cast<ByteStream>(builder.Seal(client));
+    stream_id = bstream->id();
+    CHECK(stream_id != InvalidObjectID());
+  }
+
+  {
+    auto pooled_byte_stream = client.GetObject<ByteStream>(stream_id);
+    std::unique_ptr<ByteStreamWriter> writer;
+    VINEYARD_CHECK_OK(pooled_byte_stream->OpenWriter(client, writer));
+    VINEYARD_CHECK_OK(client.OpenStream(stream_id, OpenStreamMode::read, 2));
+
+    uint8_t value = 0;
+    auto write = [&]() {
+      std::unique_ptr<arrow::MutableBuffer> buffer = nullptr;
+      VINEYARD_CHECK_OK(writer->GetNext(64, buffer));
+      std::memset(buffer->mutable_data(), value++, buffer->size());
+    };
+    auto check = [](std::shared_ptr<arrow::Buffer> const& buffer,
+                    uint8_t expected) {
+      CHECK_EQ(buffer->size(), 64);
+      for (int64_t idx = 0; idx < buffer->size(); ++idx) {
+        CHECK_EQ(buffer->data()[idx], expected);
+      }
+    };
+
+    std::vector<std::shared_ptr<arrow::Buffer>> buffers(5);
+    write();
+    write();
+    write();
+    VINEYARD_CHECK_OK(client.PullNextStreamChunk(stream_id, buffers[0]));
+    VINEYARD_CHECK_OK(client.PullNextStreamChunk(stream_id, buffers[1]));
+    write();
+    // the first chunk leaves the window and is pooled, then reused by the
+    // fifth chunk
+    VINEYARD_CHECK_OK(client.PullNextStreamChunk(stream_id, buffers[2]));
+    write();
+    write();
+    VINEYARD_CHECK_OK(client.PullNextStreamChunk(stream_id, buffers[3]));
+    VINEYARD_CHECK_OK(client.PullNextStreamChunk(stream_id, buffers[4]));
+    CHECK_EQ(buffers[4]->data(), buffers[0]->data());
+    check(buffers[4], 4);
+
+    // the late release of the first handout leaves the fifth one alone, thus
+    // the chunk is not reused by the chunks to come
+    buffers[0].reset();
+    VINEYARD_CHECK_OK(client.ReleaseStreamChunks());
+    for (int idx = 0; idx < 4; ++idx) {
+      write();
+    }
+    check(buffers[4], 4);
+    VINEYARD_CHECK_OK(writer->Finish());
+
+    std::shared_ptr<arrow::Buffer> buffer;
+    for (uint8_t expected = 5; expected < value; ++expected) {
+      VINEYARD_CHECK_OK(client.PullNextStreamChunk(stream_id, buffer));
+      check(buffer, expected);
+    }
+    CHECK(client.PullNextStreamChunk(stream_id, buffer).IsStreamDrained());
+  }
+
+  // when stream of dataframes is read in place with a retain window smaller
+  // than the number of chunks, and every batch is kept alive
+  {
+    DataframeStreamBuilder builder(client);
+    builder.SetParams(std::unordered_map<std::string, std::string>{
+        {"kind", "test"}, {"test_name", "stream_test"}});
+    StreamOptions options;
+    options.pooled_chunks = 16;
+    builder.SetStreamOptions(options);
+    auto dstream =
+        std::dynamic_pointer_cast<DataframeStream>(builder.Seal(client));
+    stream_id = dstream->id();
+    CHECK(stream_id != InvalidObjectID());
+  }
+
+  const size_t retain_window = 3, batch_num = 16, batch_rows = 128;
+  std::thread dataframe_send_thrd([&]() {
+    Client writer_client;
+    VINEYARD_CHECK_OK(writer_client.Connect(ipc_socket));
+
+    auto dataframe_stream =
+        writer_client.GetObject<DataframeStream>(stream_id);
+    std::unique_ptr<DataframeStreamWriter> writer;
+    VINEYARD_CHECK_OK(dataframe_stream->OpenWriter(writer_client, writer));
+    for (size_t idx = 0; idx < batch_num; ++idx) {
+      arrow::Int64Builder value_builder;
+      for (size_t row = 0; row < batch_rows; ++row) {
+        CHECK(value_builder.Append(idx * batch_rows + row).ok());
+      }
+      std::shared_ptr<arrow::Array> values;
+      CHECK(value_builder.Finish(&values).ok());
+      auto batch = arrow::RecordBatch::Make(
+          arrow::schema({arrow::field("value", arrow::int64())}), batch_rows,
+          {values});
+      VINEYARD_CHECK_OK(writer->WriteBatch(batch));
+    }
+    VINEYARD_CHECK_OK(writer->Finish());
+  });
+
+  {
+    auto dataframe_stream = client.GetObject<DataframeStream>(stream_id);
+    std::unique_ptr<DataframeStreamReader> reader;
+    VINEYARD_CHECK_OK(
+        dataframe_stream->OpenReader(client, reader, retain_window));
+    std::shared_ptr<arrow::Table> table;
+    VINEYARD_CHECK_OK(reader->ReadTable(table));
+    dataframe_send_thrd.join();
+
+    // the chunks released by the server are pooled and reused by the later
+    // chunks, thus the batches that outlived their chunks would see the
+    // overwritten values
+    CHECK_EQ(table->num_rows(),
+             static_cast<int64_t>(batch_num * batch_rows));
+    auto column = table->column(0);
+    int64_t expected = 0;
+    for (int chunk = 0; chunk < column->num_chunks(); ++chunk) {
+      auto values =
+          std::dynamic_pointer_cast<arrow::Int64Array>(column->chunk(chunk));
+      for (int64_t row = 0; row < values->length(); ++row) {
+        CHECK_EQ(values->Value(row), expected++);
+      }
+    }
+  }
+
   LOG(INFO) << "Passed stream tests...";
 
   client.Disconnect();